@@ -41,6 +41,7 @@
 #include "TAppDecCfg.h"
 #include "TAppCommon/program_options_lite.h"
 #include "TLibCommon/TComChromaFormat.h"
+#include "TLibCommon/TComSimd.h"
 #ifdef WIN32
 #define strdup _strdup
 #endif
@@ -63,6 +64,7 @@ Bool TAppDecCfg::parseCfg( Int argc, TChar* argv[] )
   Bool do_help = false;
   string cfg_TargetDecLayerIdSetFile;
   string outputColourSpaceConvert;
+  string simdLevel;
   Int warnUnknowParameter = 0;
 
   po::Options opts;
@@ -91,6 +93,7 @@ Bool TAppDecCfg::parseCfg( Int argc, TChar* argv[] )
 #endif
   ("OutputDecodedSEIMessagesFilename",  m_outputDecodedSEIMessagesFilename,    string(""), "When non empty, output decoded SEI messages to the indicated file. If file is '-', then output to stdout\n")
   ("ClipOutputVideoToRec709Range",      m_bClipOutputVideoToRec709Range,  false, "If true then clip output video to the Rec. 709 Range on saving")
+  ("SIMD",                              simdLevel,                        string("auto"), "Highest vector instruction set to use, limited to those supported by the CPU. Permitted values are " + TComSimd::getListOfLevels())
   ;
 
   po::setDefaults(opts);
@@ -124,6 +127,14 @@ Bool TAppDecCfg::parseCfg( Int argc, TChar* argv[] )
     return false;
   }
 
+  const SIMDLevel maxSimdLevel = TComSimd::stringToLevel(simdLevel);
+  if (maxSimdLevel>=NUMBER_OF_SIMD_LEVELS)
+  {
+    fprintf(stderr, "Bad SIMD string, permitted values are %s\n", TComSimd::getListOfLevels().c_str());
+    return false;
+  }
+  TComSimd::setLevel(maxSimdLevel);
+
   if (m_bitstreamFileName.empty())
   {
     fprintf(stderr, "No input file specified, aborting\n");
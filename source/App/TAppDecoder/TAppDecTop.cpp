@@ -40,6 +40,11 @@
 #include <stdio.h>
 #include <fcntl.h>
 #include <assert.h>
+#if !defined(_WIN32)
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
 
 #include "TAppDecTop.h"
 #include "TLibDecoder/AnnexBread.h"
@@ -51,6 +56,59 @@
 //! \ingroup TAppDecoder
 //! \{
 
+/// read-only memory mapping of a whole file, so that the bitstream can be decoded without copying it
+class MemoryMappedFile
+{
+public:
+  MemoryMappedFile() : m_data(NULL), m_size(0) {}
+  ~MemoryMappedFile() { unmap(); }
+
+  /// returns false if the file cannot be mapped (e.g. it is empty or not a regular file, or mapping is not supported)
+  Bool map(const std::string &fileName)
+  {
+    unmap();
+#if !defined(_WIN32)
+    const Int fd = open(fileName.c_str(), O_RDONLY);
+    if (fd < 0)
+    {
+      return false;
+    }
+    struct stat status;
+    if (fstat(fd, &status) == 0 && S_ISREG(status.st_mode) && status.st_size > 0)
+    {
+      Void *data = mmap(NULL, size_t(status.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+      if (data != MAP_FAILED)
+      {
+        madvise(data, size_t(status.st_size), MADV_SEQUENTIAL);
+        m_data = static_cast<const uint8_t*>(data);
+        m_size = size_t(status.st_size);
+      }
+    }
+    close(fd);
+#endif
+    return m_data != NULL;
+  }
+
+  Void unmap()
+  {
+#if !defined(_WIN32)
+    if (m_data != NULL)
+    {
+      munmap(const_cast<uint8_t*>(m_data), m_size);
+    }
+#endif
+    m_data = NULL;
+    m_size = 0;
+  }
+
+  const uint8_t* getData() const { return m_data; }
+  size_t         getSize() const { return m_size; }
+
+private:
+  const uint8_t* m_data;
+  size_t         m_size;
+};
+
 // ====================================================================================================================
 // Constructor / destructor / initialization / destroy
 // ====================================================================================================================
@@ -88,14 +146,24 @@ Void TAppDecTop::decode()
   Int                 poc;
   TComList<TComPic*>* pcListPic = NULL;
 
-  ifstream bitstreamFile(m_bitstreamFileName.c_str(), ifstream::in | ifstream::binary);
-  if (!bitstreamFile)
+  // the bitstream file is memory-mapped where possible, so that NAL units are decoded in place
+  MemoryMappedFile bitstreamMapping;
+  const Bool bitstreamMapped = bitstreamMapping.map(m_bitstreamFileName);
+
+  ifstream bitstreamFile;
+  if (!bitstreamMapped)
   {
-    fprintf(stderr, "\nfailed to open bitstream file `%s' for reading\n", m_bitstreamFileName.c_str());
-    exit(EXIT_FAILURE);
+    bitstreamFile.open(m_bitstreamFileName.c_str(), ifstream::in | ifstream::binary);
+    if (!bitstreamFile)
+    {
+      fprintf(stderr, "\nfailed to open bitstream file `%s' for reading\n", m_bitstreamFileName.c_str());
+      exit(EXIT_FAILURE);
+    }
   }
 
-  InputByteStream bytestream(bitstreamFile);
+  InputByteStream  fileBytestream(bitstreamFile);
+  InputByteStream  mappedBytestream(bitstreamMapping.getData(), bitstreamMapping.getSize());
+  InputByteStream &bytestream = bitstreamMapped ? mappedBytestream : fileBytestream;
 
   if (!m_outputDecodedSEIMessagesFilename.empty() && m_outputDecodedSEIMessagesFilename!="-")
   {
@@ -127,7 +195,7 @@ Void TAppDecTop::decode()
   Bool openedReconFile = false; // reconstruction file not yet opened. (must be performed after SPS is seen)
   Bool loopFiltered = false;
 
-  while (!!bitstreamFile)
+  while (!bytestream.eofReached())
   {
     /* location serves to work around a design fault in the decoder, whereby
      * the process of reading a new slice that is the first slice of a new frame
@@ -135,18 +203,16 @@ Void TAppDecTop::decode()
      * nal unit. */
 #if RExt__DECODER_DEBUG_BIT_STATISTICS
     TComCodingStatistics::TComCodingStatisticsData backupStats(TComCodingStatistics::GetStatistics());
-    streampos location = bitstreamFile.tellg() - streampos(bytestream.GetNumBufferedBytes());
-#else
-    streampos location = bitstreamFile.tellg();
 #endif
+    streampos location = bytestream.getPosition();
     AnnexBStats stats = AnnexBStats();
 
     InputNALUnit nalu;
-    byteStreamNALUnit(bytestream, nalu.getBitstream().getFifo(), stats);
+    byteStreamNALUnit(bytestream, nalu.getBitstream(), stats);
 
     // call actual decoding function
     Bool bNewPicture = false;
-    if (nalu.getBitstream().getFifo().empty())
+    if (nalu.getBitstream().getDataSize() == 0)
     {
       /* this can happen if the following occur:
        *  - empty input file
@@ -167,27 +233,20 @@ Void TAppDecTop::decode()
         bNewPicture = m_cTDecTop.decode(nalu, m_iSkipFrame, m_iPOCLastDisplay);
         if (bNewPicture)
         {
-          bitstreamFile.clear();
-          /* location points to the current nalunit payload[1] due to the
-           * need for the annexB parser to read three extra bytes.
-           * [1] except for the first NAL unit in the file
-           *     (but bNewPicture doesn't happen then) */
+          /* location points to the start of the current nal unit
+           * (including any leading zero bytes and start code prefix) */
+          bytestream.setPosition(location);
 #if RExt__DECODER_DEBUG_BIT_STATISTICS
-          bitstreamFile.seekg(location);
-          bytestream.reset();
           TComCodingStatistics::SetStatistics(backupStats);
-#else
-          bitstreamFile.seekg(location-streamoff(3));
-          bytestream.reset();
 #endif
         }
       }
     }
 
-    if ( (bNewPicture || !bitstreamFile || nalu.m_nalUnitType == NAL_UNIT_EOS) &&
+    if ( (bNewPicture || bytestream.eofReached() || nalu.m_nalUnitType == NAL_UNIT_EOS) &&
         !m_cTDecTop.getFirstSliceInSequence () )
     {
-      if (!loopFiltered || bitstreamFile)
+      if (!loopFiltered || !bytestream.eofReached())
       {
         m_cTDecTop.executeLoopFilters(poc, pcListPic);
       }
@@ -197,7 +256,7 @@ Void TAppDecTop::decode()
         m_cTDecTop.setFirstSliceInSequence(true);
       }
     }
-    else if ( (bNewPicture || !bitstreamFile || nalu.m_nalUnitType == NAL_UNIT_EOS ) &&
+    else if ( (bNewPicture || bytestream.eofReached() || nalu.m_nalUnitType == NAL_UNIT_EOS ) &&
               m_cTDecTop.getFirstSliceInSequence () ) 
     {
       m_cTDecTop.setFirstSliceInPicture (true);
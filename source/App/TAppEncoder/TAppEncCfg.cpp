@@ -105,6 +105,7 @@ TAppEncCfg::TAppEncCfg()
 : m_inputColourSpaceConvert(IPCOLOURSPACE_UNCHANGED)
 , m_snrInternalColourSpace(false)
 , m_outputInternalColourSpace(false)
+, m_simdLevel(SIMD_AVX512)
 {
   m_aidQP = NULL;
   m_startOfCodedInterval = NULL;
@@ -609,11 +610,14 @@ Bool TAppEncCfg::parseCfg( Int argc, TChar* argv[] )
   Int tmpConstraintChromaFormat;
   Int tmpWeightedPredictionMethod;
   Int tmpFastInterSearchMode;
+  Int tmpMotionVectorCacheMode;
+  Int tmpCuSplitPredictorMode;
   Int tmpMotionEstimationSearchMethod;
   Int tmpSliceMode;
   Int tmpSliceSegmentMode;
   Int tmpDecodedPictureHashSEIMappedType;
   string inputColourSpaceConvert;
+  string simdLevel;
   ExtendedProfileName extendedProfile;
   Int saoOffsetBitShift[MAX_NUM_CHANNEL_TYPE];
 
@@ -688,6 +692,7 @@ Bool TAppEncCfg::parseCfg( Int argc, TChar* argv[] )
   ("PrintFrameMSE",                                   m_printFrameMSE,                                  false, "0 (default) emit only bit count and PSNRs for each frame, 1 = also emit MSE values")
   ("PrintSequenceMSE",                                m_printSequenceMSE,                               false, "0 (default) emit only bit rate and PSNRs for the whole sequence, 1 = also emit MSE values")
   ("CabacZeroWordPaddingEnabled",                     m_cabacZeroWordPaddingEnabled,                     true, "0 do not add conforming cabac-zero-words to bit streams, 1 (default) = add cabac-zero-words as required")
+  ("SIMD",                                            simdLevel,                               string("auto"), "Highest vector instruction set to use, limited to those supported by the CPU. Permitted values are " + TComSimd::getListOfLevels())
   ("ChromaFormatIDC,-cf",                             tmpChromaFormat,                                      0, "ChromaFormatIDC (400|420|422|444 or set 0 (default) for same as InputChromaFormat)")
   ("ConformanceMode",                                 m_conformanceWindowMode,                              0, "Deprecated alias of ConformanceWindowMode")
   ("ConformanceWindowMode",                           m_conformanceWindowMode,                              0, "Window conformance mode (0: no window, 1:automatic padding, 2:padding, 3:conformance")
@@ -746,6 +751,9 @@ Bool TAppEncCfg::parseCfg( Int argc, TChar* argv[] )
 
   ("QuadtreeTUMaxDepthIntra",                         m_uiQuadtreeTUMaxDepthIntra,                         1u, "Depth of TU tree for intra CUs")
   ("QuadtreeTUMaxDepthInter",                         m_uiQuadtreeTUMaxDepthInter,                         2u, "Depth of TU tree for inter CUs")
+  ("FastRQTZeroCbf",                                  m_fastRQTZeroCbf,                                 false, "Do not test splitting an inter TU whose unsplit residual quantises to zero")
+  ("FastRQTSatd",                                     m_fastRQTSatd,                                    false, "Choose between an inter TU and its four sub-TUs by Hadamard energy before the RD check, testing both only when it is ambiguous")
+  ("FastRQTFinalRDOQ",                                m_fastRQTFinalRDOQ,                               false, "Search the inter TU tree with plain quantisation and apply RDOQ to the selected tree only")
 
   // Coding structure paramters
   ("IntraPeriod,-ip",                                 m_iIntraPeriod,                                      -1, "Intra period in frames, (-1: only first frame)")
@@ -764,6 +772,10 @@ Bool TAppEncCfg::parseCfg( Int argc, TChar* argv[] )
   ("RestrictMESampling",                              m_bRestrictMESampling,                            false, "Restrict ME Sampling for selective inter motion search")
   ("ClipForBiPredMEEnabled",                          m_bClipForBiPredMeEnabled,                        false, "Enables clipping in the Bi-Pred ME. It is disabled to reduce encoder run-time")
   ("FastMEAssumingSmootherMVEnabled",                 m_bFastMEAssumingSmootherMVEnabled,                true, "Enables fast ME assuming a smoother MV.")
+  ("HierarchicalME",                                  m_bUseHierarchicalME,                             false, "Seed the diamond searches with a coarse-to-fine search of quarter- and half-resolution references")
+  ("SubPelPlanes",                                    m_bUseSubPelPlanes,                               false, "Interpolate the sub-sample planes of each reference picture once, for the fractional motion search")
+  ("MotionVectorCache",                               tmpMotionVectorCacheMode,                 Int(MV_CACHE_DISABLED), "Reuse the motion vectors of covering blocks of the same CTU: 0=off, 1=as diamond search start points, 2=also skip the integer search when they fit")
+  ("HashME",                                          m_bUseHashME,                                     false, "Look up exact matches of square prediction units in hash tables of the reference pictures before the motion search")
 
   ("HadamardME",                                      m_bUseHADME,                                       true, "Hadamard ME for fractional-pel")
   ("ASR",                                             m_bUseASR,                                        false, "Adaptive motion search range");
@@ -811,10 +823,14 @@ Bool TAppEncCfg::parseCfg( Int argc, TChar* argv[] )
 
   ("AdaptiveQP,-aq",                                  m_bUseAdaptiveQP,                                 false, "QP adaptation based on a psycho-visual model")
   ("MaxQPAdaptationRange,-aqr",                       m_iQPAdaptationRange,                                 6, "QP adaptation range")
+  ("LookaheadAnalysis",                               m_lookaheadAnalysis,                              false, "Low-resolution intra/inter cost, motion and scene-cut pre-analysis of the source pictures")
+  ("LookaheadDownsampleLog2",                         m_lookaheadDownsampleLog2,                           1u, "Downsampling of the lookahead pre-analysis: 1 = half, 2 = quarter resolution")
+  ("SceneCutIntra",                                   m_sceneCutIntra,                                  false, "Code pictures whose reference pictures all lie across a scene cut found by the lookahead pre-analysis with I slices")
   ("dQPFile,m",                                       m_dQPFileName,                               string(""), "dQP file name")
   ("RDOQ",                                            m_useRDOQ,                                         true)
   ("RDOQTS",                                          m_useRDOQTS,                                       true)
   ("SelectiveRDOQ",                                   m_useSelectiveRDOQ,                               false, "Enable selective RDOQ")
+  ("FastRDOQ",                                        m_useFastRDOQ,                                    false, "Enable fast RDOQ: skip coefficient groups without levels and prune the level search, without changing the RDOQ decisions")
   ("RDpenalty",                                       m_rdPenalty,                                          0,  "RD-penalty for 32x32 TU for intra in non-intra slices. 0:disabled  1:RD-penalty  2:maximum RD-penalty")
 
   // Deblocking filter parameters
@@ -859,6 +875,7 @@ Bool TAppEncCfg::parseCfg( Int argc, TChar* argv[] )
 
   ("ConstrainedIntraPred",                            m_bUseConstrainedIntraPred,                       false, "Constrained Intra Prediction")
   ("FastUDIUseMPMEnabled",                            m_bFastUDIUseMPMEnabled,                           true, "If enabled, adapt intra direction search, accounting for MPM")
+  ("IntraGradientModes",                              m_intraGradientModes,                                 0, "Restrict the intra rough mode search to planar, DC, the MPMs and the modes near this many dominant gradient directions of the source block (0: search all modes)")
   ("FastMEForGenBLowDelayEnabled",                    m_bFastMEForGenBLowDelayEnabled,                   true, "If enabled use a fast ME for generalised B Low Delay slices")
   ("UseBLambdaForNonKeyLowDelayPictures",             m_bUseBLambdaForNonKeyLowDelayPictures,            true, "Enables use of B-Lambda for non-key low-delay pictures")
   ("PCMEnabledFlag",                                  m_usePCM,                                         false)
@@ -900,6 +917,10 @@ Bool TAppEncCfg::parseCfg( Int argc, TChar* argv[] )
   ("FDM",                                             m_useFastDecisionForMerge,                         true, "Fast decision for Merge RD Cost")
   ("CFM",                                             m_bUseCbfFastMode,                                false, "Cbf fast mode setting")
   ("ESD",                                             m_useEarlySkipDetection,                          false, "Early SKIP detection setting")
+  ("CuSplitPredictor",                                tmpCuSplitPredictorMode, Int(CU_SPLIT_PREDICTOR_DISABLED), "CU split predictor: 0=off, 1=train a model on the full search and write it to CuSplitModelFile, 2=skip the split or non-split branch when the model of CuSplitModelFile is confident")
+  ("CuSplitModelFile",                                m_cuSplitModelFileName,                      string(""), "CU split predictor model file")
+  ("CuSplitTrainingDataFile",                         m_cuSplitTrainingDataFileName,               string(""), "Text file accumulating the features and split decisions collected with CuSplitPredictor=1; the model is fitted to all of its samples (optional)")
+  ("CuSplitThreshold",                                m_cuSplitThreshold,                                 0.9, "Probability of a decision required by CuSplitPredictor=2 to skip the other branch (0.5 to 1; higher is slower and closer to the full search)")
   ( "RateControl",                                    m_RCEnableRateControl,                            false, "Rate control: enable rate control" )
   ( "TargetBitrate",                                  m_RCTargetBitrate,                                    0, "Rate control: target bit-rate" )
   ( "KeepHierarchicalBit",                            m_RCKeepHierarchicalBit,                              0, "Rate control: 0: equal bit allocation; 1: fixed ratio bit allocation; 2: adaptive ratio bit allocation" )
@@ -1208,6 +1229,20 @@ Bool TAppEncCfg::parseCfg( Int argc, TChar* argv[] )
   }
   m_fastInterSearchMode = FastInterSearchMode(tmpFastInterSearchMode);
 
+  assert(tmpMotionVectorCacheMode>=0 && tmpMotionVectorCacheMode<MV_CACHE_NUMBER_OF_MODES);
+  if (tmpMotionVectorCacheMode<0 || tmpMotionVectorCacheMode>=MV_CACHE_NUMBER_OF_MODES)
+  {
+    exit(EXIT_FAILURE);
+  }
+  m_motionVectorCacheMode = MotionVectorCacheMode(tmpMotionVectorCacheMode);
+
+  assert(tmpCuSplitPredictorMode>=0 && tmpCuSplitPredictorMode<CU_SPLIT_PREDICTOR_NUMBER_OF_MODES);
+  if (tmpCuSplitPredictorMode<0 || tmpCuSplitPredictorMode>=CU_SPLIT_PREDICTOR_NUMBER_OF_MODES)
+  {
+    exit(EXIT_FAILURE);
+  }
+  m_cuSplitPredictorMode = CuSplitPredictorMode(tmpCuSplitPredictorMode);
+
   assert(tmpMotionEstimationSearchMethod>=0 && tmpMotionEstimationSearchMethod<MESEARCH_NUMBER_OF_METHODS);
   if (tmpMotionEstimationSearchMethod<0 || tmpMotionEstimationSearchMethod>=MESEARCH_NUMBER_OF_METHODS)
   {
@@ -1303,6 +1338,7 @@ Bool TAppEncCfg::parseCfg( Int argc, TChar* argv[] )
 
 
   m_inputColourSpaceConvert = stringToInputColourSpaceConvert(inputColourSpaceConvert, true);
+  m_simdLevel = TComSimd::stringToLevel(simdLevel);
 
   switch (m_conformanceWindowMode)
   {
@@ -1566,6 +1602,8 @@ Bool TAppEncCfg::parseCfg( Int argc, TChar* argv[] )
   m_uiMaxTotalCUDepth = m_uiMaxCUDepth + uiAddCUDepth + getMaxCUDepthOffset(m_chromaFormatIDC, m_uiQuadtreeTULog2MinSize); // if minimum TU larger than 4x4, allow for additional part indices for 4:2:2 SubTUs.
   m_uiLog2DiffMaxMinCodingBlockSize = m_uiMaxCUDepth - 1;
 
+  TComSimd::setLevel(m_simdLevel);
+
   // print-out parameters
   xPrintParameter();
 
@@ -1705,6 +1743,8 @@ Void TAppEncCfg::xCheckParameter()
   std::string sTempIPCSC="InputColourSpaceConvert must be empty, "+getListOfColourSpaceConverts(true);
   xConfirmPara( m_inputColourSpaceConvert >= NUMBER_INPUT_COLOUR_SPACE_CONVERSIONS,         sTempIPCSC.c_str() );
   xConfirmPara( m_InputChromaFormatIDC >= NUM_CHROMA_FORMAT,                                "InputChromaFormatIDC must be either 400, 420, 422 or 444" );
+  const std::string sTempSIMD="SIMD must be one of "+TComSimd::getListOfLevels();
+  xConfirmPara( m_simdLevel >= NUMBER_OF_SIMD_LEVELS,                                       sTempSIMD.c_str() );
   xConfirmPara( m_iFrameRate <= 0,                                                          "Frame rate must be more than 1" );
   xConfirmPara( m_temporalSubsampleRatio < 1,                                               "Temporal subsample rate must be no less than 1" );
   xConfirmPara( m_framesToBeEncoded <= 0,                                                   "Total Number Of Frames encoded must be more than 0" );
@@ -1764,6 +1804,9 @@ Void TAppEncCfg::xCheckParameter()
   xConfirmPara( m_iSearchRange < 0 ,                                                        "Search Range must be more than 0" );
   xConfirmPara( m_bipredSearchRange < 0 ,                                                   "Bi-prediction refinement search range must be more than 0" );
   xConfirmPara( m_minSearchWindow < 0,                                                      "Minimum motion search window size for the adaptive window ME must be greater than or equal to 0" );
+  xConfirmPara( m_intraGradientModes < 0,                                                   "IntraGradientModes must be greater than or equal to 0" );
+  xConfirmPara( m_cuSplitPredictorMode != CU_SPLIT_PREDICTOR_DISABLED && m_cuSplitModelFileName.empty(), "CuSplitPredictor requires a CuSplitModelFile" );
+  xConfirmPara( m_cuSplitThreshold <= 0.5 || m_cuSplitThreshold > 1.0,                      "CuSplitThreshold must be greater than 0.5 and less than or equal to 1" );
   xConfirmPara( m_iMaxDeltaQP > 7,                                                          "Absolute Delta QP exceeds supported range (0 to 7)" );
   xConfirmPara(m_lumaLevelToDeltaQPMapping.mode &&  m_uiDeltaQpRD > 0, "Luma-level-based Delta QP cannot be used together with slice level multiple-QP optimization\n" );
   xConfirmPara( m_iMaxCuDQPDepth > m_uiMaxCUDepth - 1,                                          "Absolute depth for a minimum CuDQP exceeds maximum coding unit depth" );
@@ -1774,6 +1817,8 @@ Void TAppEncCfg::xCheckParameter()
   xConfirmPara( m_crQpOffset >  12,   "Max. Chroma Cr QP Offset is  12" );
 
   xConfirmPara( m_iQPAdaptationRange <= 0,                                                  "QP Adaptation Range must be more than 0" );
+  xConfirmPara( m_lookaheadDownsampleLog2 < 1 || m_lookaheadDownsampleLog2 > 2,             "LookaheadDownsampleLog2 must be 1 or 2" );
+  xConfirmPara( m_sceneCutIntra && !m_lookaheadAnalysis,                                    "SceneCutIntra requires LookaheadAnalysis" );
   if (m_iDecodingRefreshType == 2)
   {
     xConfirmPara( m_iIntraPeriod > 0 && m_iIntraPeriod <= m_iGOPSize ,                      "Intra period must be larger than GOP size for periodic IDR pictures");
@@ -2406,6 +2451,7 @@ Void TAppEncCfg::xPrintParameter()
   printf("Sequence MSE output                    : %s\n", (m_printSequenceMSE ? "Enabled" : "Disabled") );
   printf("Frame MSE output                       : %s\n", (m_printFrameMSE    ? "Enabled" : "Disabled") );
   printf("Cabac-zero-word-padding                : %s\n", (m_cabacZeroWordPaddingEnabled? "Enabled" : "Disabled") );
+  printf("SIMD                                   : %s (CPU supports %s)\n", TComSimd::getLevelName(TComSimd::getLevel()), TComSimd::getLevelName(TComSimd::detectLevel()) );
   if (m_isField)
   {
     printf("Frame/Field                            : Field based coding\n");
@@ -2461,6 +2507,8 @@ Void TAppEncCfg::xPrintParameter()
   printf("Cb QP Offset                           : %d\n", m_cbQpOffset   );
   printf("Cr QP Offset                           : %d\n", m_crQpOffset);
   printf("QP adaptation                          : %d (range=%d)\n", m_bUseAdaptiveQP, (m_bUseAdaptiveQP ? m_iQPAdaptationRange : 0) );
+  printf("Lookahead analysis                     : %d (downsampling=%d)\n", m_lookaheadAnalysis, (m_lookaheadAnalysis ? 1<<m_lookaheadDownsampleLog2 : 0) );
+  printf("Scene cut intra                        : %d\n", m_sceneCutIntra );
   printf("GOP size                               : %d\n", m_iGOPSize );
   printf("Input bit depth                        : (Y:%d, C:%d)\n", m_inputBitDepth[CHANNEL_TYPE_LUMA], m_inputBitDepth[CHANNEL_TYPE_CHROMA] );
   printf("MSB-extended bit depth                 : (Y:%d, C:%d)\n", m_MSBExtendedBitDepth[CHANNEL_TYPE_LUMA], m_MSBExtendedBitDepth[CHANNEL_TYPE_CHROMA] );
@@ -2520,18 +2568,31 @@ Void TAppEncCfg::xPrintParameter()
   printf("HAD:%d ", m_bUseHADME                          );
   printf("RDQ:%d ", m_useRDOQ                            );
   printf("RDQTS:%d ", m_useRDOQTS                        );
+  printf("FastRDOQ:%d ", m_useFastRDOQ                   );
   printf("RDpenalty:%d ", m_rdPenalty                    );
   printf("LQP:%d ", m_lumaLevelToDeltaQPMapping.mode     );
   printf("SQP:%d ", m_uiDeltaQpRD                        );
   printf("ASR:%d ", m_bUseASR                            );
   printf("MinSearchWindow:%d ", m_minSearchWindow        );
   printf("RestrictMESampling:%d ", m_bRestrictMESampling );
+  printf("HME:%d ", m_bUseHierarchicalME                 );
+  printf("HashME:%d ", m_bUseHashME                      );
+  printf("MVC:%d ", Int(m_motionVectorCacheMode)          );
+  printf("SPP:%d ", m_bUseSubPelPlanes                   );
   printf("FEN:%d ", Int(m_fastInterSearchMode)           );
   printf("ECU:%d ", m_bUseEarlyCU                        );
   printf("FDM:%d ", m_useFastDecisionForMerge            );
   printf("CFM:%d ", m_bUseCbfFastMode                    );
   printf("ESD:%d ", m_useEarlySkipDetection              );
+  printf("CSP:%d ", Int(m_cuSplitPredictorMode)          );
+  if (m_cuSplitPredictorMode == CU_SPLIT_PREDICTOR_PREDICT)
+  {
+    printf("CSPThreshold:%g ", m_cuSplitThreshold        );
+  }
   printf("RQT:%d ", 1                                    );
+  printf("FastRQTZeroCbf:%d ", m_fastRQTZeroCbf         );
+  printf("FastRQTSatd:%d ", m_fastRQTSatd               );
+  printf("FastRQTFinalRDOQ:%d ", m_fastRQTFinalRDOQ     );
   printf("TransformSkip:%d ",     m_useTransformSkip     );
   printf("TransformSkipFast:%d ", m_useTransformSkipFast );
   printf("TransformSkipLog2MaxSize:%d ", m_log2MaxTransformSkipBlockSize);
@@ -2546,6 +2607,7 @@ Void TAppEncCfg::xPrintParameter()
     printf("A=%d ", m_sliceSegmentArgument);
   }
   printf("CIP:%d ", m_bUseConstrainedIntraPred);
+  printf("IGM:%d ", m_intraGradientModes);
   printf("SAO:%d ", (m_bUseSAO)?(1):(0));
   printf("PCM:%d ", (m_usePCM && (1<<m_uiPCMLog2MinSize) <= m_uiMaxCUWidth)? 1 : 0);
 
@@ -40,6 +40,7 @@
 
 #include "TLibCommon/CommonDef.h"
 
+#include "TLibCommon/TComSimd.h"
 #include "TLibEncoder/TEncCfg.h"
 #include <sstream>
 #include <vector>
@@ -90,6 +91,7 @@ protected:
   Bool      m_snrInternalColourSpace;                       ///< if true, then no colour space conversion is applied for snr calculation, otherwise inverse of input is applied.
   Bool      m_outputInternalColourSpace;                    ///< if true, then no colour space conversion is applied for reconstructed video, otherwise inverse of input is applied.
   ChromaFormat m_InputChromaFormatIDC;
+  SIMDLevel m_simdLevel;                                      ///< highest vector instruction set that may be used
 
   Bool      m_printMSEBasedSequencePSNR;
   Bool      m_printFrameMSE;
@@ -164,6 +166,9 @@ protected:
 
   Bool      m_bUseAdaptiveQP;                                 ///< Flag for enabling QP adaptation based on a psycho-visual model
   Int       m_iQPAdaptationRange;                             ///< dQP range by QP adaptation
+  Bool      m_lookaheadAnalysis;                              ///< Flag for enabling the low-resolution lookahead pre-analysis
+  UInt      m_lookaheadDownsampleLog2;                        ///< log2 of the downsampling factor of the lookahead pre-analysis
+  Bool      m_sceneCutIntra;                                  ///< Flag for coding pictures whose references all lie across a detected scene cut with I slices
 
   Int       m_maxTempLayer;                                  ///< Max temporal layer
 
@@ -181,6 +186,9 @@ protected:
 
   UInt      m_uiQuadtreeTUMaxDepthInter;
   UInt      m_uiQuadtreeTUMaxDepthIntra;
+  Bool      m_fastRQTZeroCbf;                                 ///< skip the sub-TUs of an inter TU whose residual quantises to zero
+  Bool      m_fastRQTSatd;                                    ///< pre-select the inter TU size by Hadamard energy
+  Bool      m_fastRQTFinalRDOQ;                               ///< apply RDOQ to the selected inter TU tree only
 
   // coding tools (bit-depth)
   Int       m_inputBitDepth   [MAX_NUM_CHANNEL_TYPE];         ///< bit-depth of input file
@@ -223,6 +231,7 @@ protected:
   Bool      m_useRDOQ;                                        ///< flag for using RD optimized quantization
   Bool      m_useRDOQTS;                                      ///< flag for using RD optimized quantization for transform skip
   Bool      m_useSelectiveRDOQ;                               ///< flag for using selective RDOQ
+  Bool      m_useFastRDOQ;                                    ///< flag for using the fast RDOQ search
   Int       m_rdPenalty;                                      ///< RD-penalty for 32x32 TU for intra in non-intra slices (0: no RD-penalty, 1: RD-penalty, 2: maximum RD-penalty)
   Bool      m_bDisableIntraPUsInInterSlices;                  ///< Flag for disabling intra predicted PUs in inter slices.
   MESearchMethod m_motionEstimationSearchMethod;
@@ -232,8 +241,16 @@ protected:
   Int       m_minSearchWindow;                                ///< ME minimum search window size for the Adaptive Window ME
   Bool      m_bClipForBiPredMeEnabled;                        ///< Enables clipping for Bi-Pred ME.
   Bool      m_bFastMEAssumingSmootherMVEnabled;               ///< Enables fast ME assuming a smoother MV.
+  Bool      m_bUseHierarchicalME;                             ///< Enables the coarse-to-fine search seeding the diamond searches
+  Bool      m_bUseHashME;                                     ///< Enables the hash-based search for exact matches
+  Bool      m_bUseSubPelPlanes;                               ///< Enables the precomputed sub-sample planes of the reference pictures
+  MotionVectorCacheMode m_motionVectorCacheMode;              ///< Use of the motion vectors of covering blocks of the same CTU
   FastInterSearchMode m_fastInterSearchMode;                  ///< Parameter that controls fast encoder settings
   Bool      m_bUseEarlyCU;                                    ///< flag for using Early CU setting
+  CuSplitPredictorMode m_cuSplitPredictorMode;                ///< training or use of the CU split predictor
+  std::string m_cuSplitModelFileName;                         ///< CU split model file, written when training and read when predicting
+  std::string m_cuSplitTrainingDataFileName;                  ///< optional text file receiving the CU split training samples
+  Double    m_cuSplitThreshold;                               ///< probability required by the CU split predictor to skip a branch
   Bool      m_useFastDecisionForMerge;                        ///< flag for using Fast Decision Merge RD-Cost
   Bool      m_bUseCbfFastMode;                                ///< flag for using Cbf Fast PU Mode Decision
   Bool      m_useEarlySkipDetection;                          ///< flag for using Early SKIP Detection
@@ -253,6 +270,7 @@ protected:
 
   Bool      m_bUseConstrainedIntraPred;                       ///< flag for using constrained intra prediction
   Bool      m_bFastUDIUseMPMEnabled;
+  Int       m_intraGradientModes;                             ///< number of dominant gradient directions searched by the intra rough pass (0: all modes)
   Bool      m_bFastMEForGenBLowDelayEnabled;
   Bool      m_bUseBLambdaForNonKeyLowDelayPictures;
 
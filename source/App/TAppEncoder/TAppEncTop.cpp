@@ -160,6 +160,10 @@ Void TAppEncTop::xInitLibCfg()
   m_cTEncTop.setFastMEAssumingSmootherMVEnabled                   ( m_bFastMEAssumingSmootherMVEnabled );
   m_cTEncTop.setMinSearchWindow                                   ( m_minSearchWindow );
   m_cTEncTop.setRestrictMESampling                                ( m_bRestrictMESampling );
+  m_cTEncTop.setUseHierarchicalME                                 ( m_bUseHierarchicalME );
+  m_cTEncTop.setUseHashME                                         ( m_bUseHashME );
+  m_cTEncTop.setUseSubPelPlanes                                   ( m_bUseSubPelPlanes );
+  m_cTEncTop.setMotionVectorCacheMode                             ( m_motionVectorCacheMode );
 
   //====== Quality control ========
   m_cTEncTop.setMaxDeltaQP                                        ( m_iMaxDeltaQP  );
@@ -177,6 +181,9 @@ Void TAppEncTop::xInitLibCfg()
 
   m_cTEncTop.setUseAdaptiveQP                                     ( m_bUseAdaptiveQP  );
   m_cTEncTop.setQPAdaptationRange                                 ( m_iQPAdaptationRange );
+  m_cTEncTop.setLookaheadAnalysis                                 ( m_lookaheadAnalysis );
+  m_cTEncTop.setLookaheadDownsampleLog2                           ( m_lookaheadDownsampleLog2 );
+  m_cTEncTop.setSceneCutIntra                                     ( m_sceneCutIntra );
   m_cTEncTop.setExtendedPrecisionProcessingFlag                   ( m_extendedPrecisionProcessingFlag );
   m_cTEncTop.setHighPrecisionOffsetsEnabledFlag                   ( m_highPrecisionOffsetsEnabledFlag );
 
@@ -196,6 +203,7 @@ Void TAppEncTop::xInitLibCfg()
   m_cTEncTop.setUseRDOQ                                           ( m_useRDOQ     );
   m_cTEncTop.setUseRDOQTS                                         ( m_useRDOQTS   );
   m_cTEncTop.setUseSelectiveRDOQ                                  ( m_useSelectiveRDOQ );
+  m_cTEncTop.setUseFastRDOQ                                       ( m_useFastRDOQ );
   m_cTEncTop.setRDpenalty                                         ( m_rdPenalty );
   m_cTEncTop.setMaxCUWidth                                        ( m_uiMaxCUWidth );
   m_cTEncTop.setMaxCUHeight                                       ( m_uiMaxCUHeight );
@@ -205,8 +213,15 @@ Void TAppEncTop::xInitLibCfg()
   m_cTEncTop.setQuadtreeTULog2MinSize                             ( m_uiQuadtreeTULog2MinSize );
   m_cTEncTop.setQuadtreeTUMaxDepthInter                           ( m_uiQuadtreeTUMaxDepthInter );
   m_cTEncTop.setQuadtreeTUMaxDepthIntra                           ( m_uiQuadtreeTUMaxDepthIntra );
+  m_cTEncTop.setFastRQTZeroCbf                                    ( m_fastRQTZeroCbf );
+  m_cTEncTop.setFastRQTSatd                                       ( m_fastRQTSatd );
+  m_cTEncTop.setFastRQTFinalRDOQ                                  ( m_fastRQTFinalRDOQ );
   m_cTEncTop.setFastInterSearchMode                               ( m_fastInterSearchMode );
   m_cTEncTop.setUseEarlyCU                                        ( m_bUseEarlyCU  );
+  m_cTEncTop.setCuSplitPredictorMode                              ( m_cuSplitPredictorMode );
+  m_cTEncTop.setCuSplitModelFileName                              ( m_cuSplitModelFileName );
+  m_cTEncTop.setCuSplitTrainingDataFileName                       ( m_cuSplitTrainingDataFileName );
+  m_cTEncTop.setCuSplitThreshold                                  ( m_cuSplitThreshold );
   m_cTEncTop.setUseFastDecisionForMerge                           ( m_useFastDecisionForMerge  );
   m_cTEncTop.setUseCbfFastMode                                    ( m_bUseCbfFastMode  );
   m_cTEncTop.setUseEarlySkipDetection                             ( m_useEarlySkipDetection );
@@ -227,6 +242,7 @@ Void TAppEncTop::xInitLibCfg()
   }
   m_cTEncTop.setUseConstrainedIntraPred                           ( m_bUseConstrainedIntraPred );
   m_cTEncTop.setFastUDIUseMPMEnabled                              ( m_bFastUDIUseMPMEnabled );
+  m_cTEncTop.setIntraGradientModes                                ( m_intraGradientModes );
   m_cTEncTop.setFastMEForGenBLowDelayEnabled                      ( m_bFastMEForGenBLowDelayEnabled );
   m_cTEncTop.setUseBLambdaForNonKeyLowDelayPictures               ( m_bUseBLambdaForNonKeyLowDelayPictures );
   m_cTEncTop.setPCMLog2MinSize                                    ( m_uiPCMLog2MinSize);
@@ -130,7 +130,7 @@ int main(int argc, char*argv[])
   unsigned numNALUnits = 0;
 
   cout << "NALUnits:" << endl;
-  while (!!in)
+  while (!bs.eofReached())
   {
     AnnexBStats annexBStatsSingle = AnnexBStats();
     vector<uint8_t> nalUnit;
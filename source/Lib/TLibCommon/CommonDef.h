@@ -179,6 +179,20 @@ static const Int RVM_VCEGAM10_M =                                   4;
 
 static const Int FAST_UDI_MAX_RDMODE_NUM =                         35; ///< maximum number of RD comparison in fast-UDI estimation loop
 
+static const Int LOOKAHEAD_BLOCK_SIZE =                             8; ///< block size of the lookahead pre-analysis, in downsampled luma samples
+static const Int LOOKAHEAD_SEARCH_RANGE =                          16; ///< search range of the lookahead motion estimation, in downsampled luma samples
+static const Int LOOKAHEAD_MV_COST =                                4; ///< cost per downsampled sample of motion vector difference in the lookahead motion estimation
+static const Double LOOKAHEAD_SCENE_CUT_THRESHOLD =             0.90; ///< a picture is marked as a scene cut when its lookahead scene-cut score exceeds this value
+
+static const Int HIERARCHICAL_ME_NUM_LEVELS =                       2; ///< number of downsampled levels (half and quarter resolution) of the hierarchical motion search
+static const Int HIERARCHICAL_ME_SEARCH_RANGE =                     8; ///< search range of the hierarchical motion search at the coarsest level, in downsampled luma samples
+static const Int HIERARCHICAL_ME_MIN_SIZE =                        16; ///< minimum width and height of a prediction unit for the hierarchical motion search
+
+static const Int HASH_ME_MIN_LOG2_SIZE =                            3; ///< log2 of the smallest square block indexed for the hash-based motion search
+static const Int HASH_ME_MAX_LOG2_SIZE =                            6; ///< log2 of the largest square block indexed for the hash-based motion search
+static const Int HASH_ME_NUM_SIZES = HASH_ME_MAX_LOG2_SIZE - HASH_ME_MIN_LOG2_SIZE + 1;
+static const Int HASH_ME_MAX_CANDIDATES =                          64; ///< maximum number of blocks with a matching hash that are checked by the hash-based motion search
+
 static const Int NUM_INTRA_MODE =                                  36;
 static const Int PLANAR_IDX =                                       0;
 static const Int VER_IDX =                                         26; ///< index for intra VERTICAL   mode
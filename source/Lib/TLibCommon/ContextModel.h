@@ -86,7 +86,7 @@ public:
   static Void buildNextStateTable();
   static Int getEntropyBitsTrm( Int val ) { return m_entropyBits[126 ^ val]; }
 #endif
-  Void setBinsCoded(UInt val)   { m_binsCoded = val;  }
+  Void setBinsCoded(UInt val)   { m_binsCoded = ( val != 0 ); }
   UInt getBinsCoded()           { return m_binsCoded;   }
 
 private:
@@ -99,7 +99,7 @@ private:
 #if FAST_BIT_EST
   static UChar m_nextState[m_totalStates][2 /*MPS = [0|1]*/];
 #endif
-  UInt          m_binsCoded;
+  UChar         m_binsCoded;                                                                ///< non-zero once a bin has been coded with this context (one byte, to keep context snapshots compact)
 };
 
 //! \}
@@ -38,9 +38,14 @@
 #include <stdint.h>
 #include <vector>
 #include "TComBitStream.h"
+#include "TComSimd.h"
 #include <string.h>
 #include <memory.h>
 
+#if VECTOR_CODING__BYTE_SEQUENCE_SEARCH && (RExt__HIGH_BIT_DEPTH_SUPPORT==0)
+#include <emmintrin.h>
+#endif
+
 using namespace std;
 
 //! \ingroup TLibCommon
@@ -63,6 +68,8 @@ TComOutputBitstream::~TComOutputBitstream()
 TComInputBitstream::TComInputBitstream()
 : m_fifo()
 , m_emulationPreventionByteLocation()
+, m_view(NULL)
+, m_viewSize(0)
 , m_fifo_idx(0)
 , m_num_held_bits(0)
 , m_held_bits(0)
@@ -72,6 +79,8 @@ TComInputBitstream::TComInputBitstream()
 TComInputBitstream::TComInputBitstream(const TComInputBitstream &src)
 : m_fifo(src.m_fifo)
 , m_emulationPreventionByteLocation(src.m_emulationPreventionByteLocation)
+, m_view(src.m_view)
+, m_viewSize(src.m_viewSize)
 , m_fifo_idx(src.m_fifo_idx)
 , m_num_held_bits(src.m_num_held_bits)
 , m_held_bits(src.m_held_bits)
@@ -90,13 +99,98 @@ Void TComInputBitstream::resetToStart()
   m_numBitsRead=0;
 }
 
+/**
+ * Load as many whole bytes as fit into the bits held. Eight bytes are
+ * loaded with a single (unaligned) word read when available.
+ */
+Void TComInputBitstream::xRefill()
+{
+  const UInt     dataSize = getDataSize();
+  const uint8_t *data     = getData();
+  UInt numBytes = (64 - m_num_held_bits) >> 3;
+
+  if (m_fifo_idx + 8 <= dataSize)
+  {
+    if (numBytes > 0)
+    {
+      const UInt64 bytes = readBigEndian64(data + m_fifo_idx) >> (64 - (numBytes << 3));
+      m_held_bits |= bytes << (64 - m_num_held_bits - (numBytes << 3));
+    }
+  }
+  else
+  {
+    numBytes = std::min(numBytes, dataSize - m_fifo_idx);
+    for (UInt i = 0; i < numBytes; i++)
+    {
+      m_held_bits |= UInt64(data[m_fifo_idx + i]) << (56 - m_num_held_bits - (i << 3));
+    }
+  }
+
+  m_fifo_idx      += numBytes;
+  m_num_held_bits += numBytes << 3;
+}
+
+/**
+ * Read an unsigned Exp-Golomb code, as used by ue(v) and se(v): the number of leading zero bits is found with
+ * a single count-leading-zeros when the whole code is held.
+ * \param ruiCodeNum decoded code number
+ * \param ruiLength  number of bits read
+ */
+Void TComInputBitstream::readExpGolomb( UInt &ruiCodeNum, UInt &ruiLength )
+{
+  if (m_num_held_bits < 32)
+  {
+    xRefill();
+  }
+
+  if (m_held_bits != 0)
+  {
+    const UInt numLeadingZeros = countLeadingZeros64(m_held_bits);
+    const UInt codeLength      = 2 * numLeadingZeros + 1;
+    if (codeLength <= m_num_held_bits)
+    {
+      m_held_bits <<= numLeadingZeros + 1;
+      ruiCodeNum = numLeadingZeros == 0 ? 0 : (1 << numLeadingZeros) - 1 + UInt(m_held_bits >> (64 - numLeadingZeros));
+      m_held_bits     <<= numLeadingZeros;
+      m_num_held_bits  -= codeLength;
+      m_numBitsRead    += codeLength;
+      ruiLength = codeLength;
+      return;
+    }
+  }
+
+  // the code extends beyond the bits held (only possible for very long codes, or at the end of the data)
+  UInt uiCode = 0;
+  UInt numLeadingZeros = 0;
+  read(1, uiCode);
+  while (uiCode == 0)
+  {
+    numLeadingZeros++;
+    read(1, uiCode);
+  }
+  read(numLeadingZeros, uiCode);
+  ruiCodeNum = uiCode + (1 << numLeadingZeros) - 1;
+  ruiLength  = 2 * numLeadingZeros + 1;
+}
+
+Void TComInputBitstream::copyViewToFifo()
+{
+  if (m_view != NULL)
+  {
+    m_fifo.assign(m_view, m_view + m_viewSize);
+    setView(NULL, 0);
+  }
+}
+
 UChar* TComOutputBitstream::getByteStream() const
 {
+  xFlushWholeBytes();
   return (UChar*) &m_fifo.front();
 }
 
 UInt TComOutputBitstream::getByteStreamLength()
 {
+  xFlushWholeBytes();
   return UInt(m_fifo.size());
 }
 
@@ -107,48 +201,14 @@ Void TComOutputBitstream::clear()
   m_num_held_bits = 0;
 }
 
-Void TComOutputBitstream::write   ( UInt uiBits, UInt uiNumberOfBits )
+Void TComOutputBitstream::xFlushWholeBytes() const
 {
-  assert( uiNumberOfBits <= 32 );
-  assert( uiNumberOfBits == 32 || (uiBits & (~0 << uiNumberOfBits)) == 0 );
-
-  /* any modulo 8 remainder of num_total_bits cannot be written this time,
-   * and will be held until next time. */
-  UInt num_total_bits = uiNumberOfBits + m_num_held_bits;
-  UInt next_num_held_bits = num_total_bits % 8;
-
-  /* form a byte aligned word (write_bits), by concatenating any held bits
-   * with the new bits, discarding the bits that will form the next_held_bits.
-   * eg: H = held bits, V = n new bits        /---- next_held_bits
-   * len(H)=7, len(V)=1: ... ---- HHHH HHHV . 0000 0000, next_num_held_bits=0
-   * len(H)=7, len(V)=2: ... ---- HHHH HHHV . V000 0000, next_num_held_bits=1
-   * if total_bits < 8, the value of v_ is not used */
-  UChar next_held_bits = uiBits << (8 - next_num_held_bits);
-
-  if (!(num_total_bits >> 3))
+  while (m_num_held_bits >= 8)
   {
-    /* insufficient bits accumulated to write out, append new_held_bits to
-     * current held_bits */
-    /* NB, this requires that v only contains 0 in bit positions {31..n} */
-    m_held_bits |= next_held_bits;
-    m_num_held_bits = next_num_held_bits;
-    return;
+    m_num_held_bits -= 8;
+    m_fifo.push_back(UChar(m_held_bits >> m_num_held_bits));
   }
-
-  /* topword serves to justify held_bits to align with the msb of uiBits */
-  UInt topword = (uiNumberOfBits - next_num_held_bits) & ~((1 << 3) -1);
-  UInt write_bits = (m_held_bits << topword) | (uiBits >> next_num_held_bits);
-
-  switch (num_total_bits >> 3)
-  {
-  case 4: m_fifo.push_back(write_bits >> 24);
-  case 3: m_fifo.push_back(write_bits >> 16);
-  case 2: m_fifo.push_back(write_bits >> 8);
-  case 1: m_fifo.push_back(write_bits);
-  }
-
-  m_held_bits = next_held_bits;
-  m_num_held_bits = next_num_held_bits;
+  m_held_bits &= (1 << m_num_held_bits) - 1;
 }
 
 Void TComOutputBitstream::writeAlignOne()
@@ -160,13 +220,7 @@ Void TComOutputBitstream::writeAlignOne()
 
 Void TComOutputBitstream::writeAlignZero()
 {
-  if (0 == m_num_held_bits)
-  {
-    return;
-  }
-  m_fifo.push_back(m_held_bits);
-  m_held_bits = 0;
-  m_num_held_bits = 0;
+  write(0, getNumBitsUntilByteAligned());
 }
 
 /**
@@ -179,9 +233,24 @@ Void   TComOutputBitstream::addSubstream( TComOutputBitstream* pcSubstream )
   UInt uiNumBits = pcSubstream->getNumberOfWrittenBits();
 
   const vector<uint8_t>& rbsp = pcSubstream->getFIFO();
-  for (vector<uint8_t>::const_iterator it = rbsp.begin(); it != rbsp.end();)
+  if (getNumBitsUntilByteAligned() == 0)
+  {
+    // byte aligned: append the whole bytes in one go
+    xFlushWholeBytes();
+    m_fifo.insert(m_fifo.end(), rbsp.begin(), rbsp.end());
+  }
+  else
   {
-    write(*it++, 8);
+    const size_t numWords = rbsp.size() >> 2;
+    for (size_t i = 0; i < numWords; i++)
+    {
+      const uint8_t *word = &rbsp[i << 2];
+      write((UInt(word[0]) << 24) | (UInt(word[1]) << 16) | (UInt(word[2]) << 8) | word[3], 32);
+    }
+    for (size_t i = numWords << 2; i < rbsp.size(); i++)
+    {
+      write(rbsp[i], 8);
+    }
   }
   if (uiNumBits&0x7)
   {
@@ -198,31 +267,17 @@ Void TComOutputBitstream::writeByteAlignment()
 Int TComOutputBitstream::countStartCodeEmulations()
 {
   UInt cnt = 0;
-  vector<uint8_t>& rbsp   = getFIFO();
-  for (vector<uint8_t>::iterator it = rbsp.begin(); it != rbsp.end();)
+  const vector<uint8_t>& rbsp = getFIFO();
+  const uint8_t *const data = rbsp.empty() ? NULL : &rbsp[0];
+  const size_t         size = rbsp.size();
+
+  // each emulated 00 00 {00,01,02,03} needs an emulation prevention byte before its third byte,
+  // with which the search restarts
+  for (size_t pos = findZeroZeroByteSequence(data, size, 0x03); pos < size; )
   {
-    vector<uint8_t>::iterator found = it;
-    do
-    {
-      // find the next emulated 00 00 {00,01,02,03}
-      // NB, end()-1, prevents finding a trailing two byte sequence
-      found = search_n(found, rbsp.end()-1, 2, 0);
-      found++;
-      // if not found, found == end, otherwise found = second zero byte
-      if (found == rbsp.end())
-      {
-        break;
-      }
-      if (*(++found) <= 3)
-      {
-        break;
-      }
-    } while (true);
-    it = found;
-    if (found != rbsp.end())
-    {
-      cnt++;
-    }
+    cnt++;
+    pos += 2;
+    pos += findZeroZeroByteSequence(data + pos, size - pos, 0x03);
   }
   return cnt;
 }
@@ -236,81 +291,15 @@ Int TComOutputBitstream::countStartCodeEmulations()
  * avoid the overrun.
  */
 Void TComInputBitstream::pseudoRead ( UInt uiNumberOfBits, UInt& ruiBits )
-{
-  UInt saved_num_held_bits = m_num_held_bits;
-  UChar saved_held_bits = m_held_bits;
-  UInt saved_fifo_idx = m_fifo_idx;
-
-  UInt num_bits_to_read = min(uiNumberOfBits, getNumBitsLeft());
-  read(num_bits_to_read, ruiBits);
-  ruiBits <<= (uiNumberOfBits - num_bits_to_read);
-
-  m_fifo_idx = saved_fifo_idx;
-  m_held_bits = saved_held_bits;
-  m_num_held_bits = saved_num_held_bits;
-}
-
-
-Void TComInputBitstream::read (UInt uiNumberOfBits, UInt& ruiBits)
 {
   assert( uiNumberOfBits <= 32 );
-
-  m_numBitsRead += uiNumberOfBits;
-
-  /* NB, bits are extracted from the MSB of each byte. */
-  UInt retval = 0;
-  if (uiNumberOfBits <= m_num_held_bits)
+  if (uiNumberOfBits > m_num_held_bits)
   {
-    /* n=1, len(H)=7:   -VHH HHHH, shift_down=6, mask=0xfe
-     * n=3, len(H)=7:   -VVV HHHH, shift_down=4, mask=0xf8
-     */
-    retval = m_held_bits >> (m_num_held_bits - uiNumberOfBits);
-    retval &= ~(0xff << uiNumberOfBits);
-    m_num_held_bits -= uiNumberOfBits;
-    ruiBits = retval;
-    return;
+    xRefill();
   }
 
-  /* all num_held_bits will go into retval
-   *   => need to mask leftover bits from previous extractions
-   *   => align retval with top of extracted word */
-  /* n=5, len(H)=3: ---- -VVV, mask=0x07, shift_up=5-3=2,
-   * n=9, len(H)=3: ---- -VVV, mask=0x07, shift_up=9-3=6 */
-  uiNumberOfBits -= m_num_held_bits;
-  retval = m_held_bits & ~(0xff << m_num_held_bits);
-  retval <<= uiNumberOfBits;
-
-  /* number of whole bytes that need to be loaded to form retval */
-  /* n=32, len(H)=0, load 4bytes, shift_down=0
-   * n=32, len(H)=1, load 4bytes, shift_down=1
-   * n=31, len(H)=1, load 4bytes, shift_down=1+1
-   * n=8,  len(H)=0, load 1byte,  shift_down=0
-   * n=8,  len(H)=3, load 1byte,  shift_down=3
-   * n=5,  len(H)=1, load 1byte,  shift_down=1+3
-   */
-  UInt aligned_word = 0;
-  UInt num_bytes_to_load = (uiNumberOfBits - 1) >> 3;
-  assert(m_fifo_idx + num_bytes_to_load < m_fifo.size());
-
-  switch (num_bytes_to_load)
-  {
-  case 3: aligned_word  = m_fifo[m_fifo_idx++] << 24;
-  case 2: aligned_word |= m_fifo[m_fifo_idx++] << 16;
-  case 1: aligned_word |= m_fifo[m_fifo_idx++] <<  8;
-  case 0: aligned_word |= m_fifo[m_fifo_idx++];
-  }
-
-  /* resolve remainder bits */
-  UInt next_num_held_bits = (32 - uiNumberOfBits) % 8;
-
-  /* copy required part of aligned_word into retval */
-  retval |= aligned_word >> next_num_held_bits;
-
-  /* store held bits */
-  m_num_held_bits = next_num_held_bits;
-  m_held_bits = aligned_word;
-
-  ruiBits = retval;
+  // the bits held beyond the end of the bitstream are zero
+  ruiBits = (uiNumberOfBits == 0) ? 0 : UInt(m_held_bits >> (64 - uiNumberOfBits));
 }
 
 /**
@@ -322,6 +311,8 @@ Void TComOutputBitstream::insertAt(const TComOutputBitstream& src, UInt pos)
   UInt src_bits = src.getNumberOfWrittenBits();
   assert(0 == src_bits % 8);
 
+  src.xFlushWholeBytes();
+  xFlushWholeBytes();
   vector<uint8_t>::iterator at = m_fifo.begin() + pos;
   m_fifo.insert(at, src.m_fifo.begin(), src.m_fifo.end());
 }
@@ -352,6 +343,8 @@ UInt TComInputBitstream::readOutTrailingBits ()
 
 /**
  Extract substream from the current bitstream.
+ A whole number of bytes starting at a byte-aligned position and lying within the current bitstream is not
+ copied: the substream is a view of this bitstream's bytes, which must then not be modified while it is in use.
 
  \param  uiNumBits    number of bits to transfer
  */
@@ -360,15 +353,28 @@ TComInputBitstream *TComInputBitstream::extractSubstream( UInt uiNumBits )
   UInt uiNumBytes = uiNumBits/8;
   TComInputBitstream *pResult = new TComInputBitstream;
 
+  if ((m_num_held_bits & 0x7) == 0)
+  {
+    // return the whole bytes held to the bitstream
+    setByteLocation(getByteLocation());
+  }
+
+  if (m_num_held_bits == 0 && (uiNumBits&0x7) == 0 && m_fifo_idx + uiNumBytes <= getDataSize())
+  {
+    pResult->setView(getData() + m_fifo_idx, uiNumBytes);
+    m_fifo_idx += uiNumBytes;
+    return pResult;
+  }
+
   std::vector<uint8_t> &buf = pResult->getFifo();
   buf.reserve((uiNumBits+7)>>3);
 
   if (m_num_held_bits == 0)
   {
     std::size_t currentOutputBufferSize=buf.size();
-    const UInt uiNumBytesToReadFromFifo = std::min<UInt>(uiNumBytes, (UInt)m_fifo.size() - m_fifo_idx);
+    const UInt uiNumBytesToReadFromFifo = std::min<UInt>(uiNumBytes, getDataSize() - m_fifo_idx);
     buf.resize(currentOutputBufferSize+uiNumBytes);
-    memcpy(&(buf[currentOutputBufferSize]), &(m_fifo[m_fifo_idx]), uiNumBytesToReadFromFifo); m_fifo_idx+=uiNumBytesToReadFromFifo;
+    memcpy(&(buf[currentOutputBufferSize]), getData() + m_fifo_idx, uiNumBytesToReadFromFifo); m_fifo_idx+=uiNumBytesToReadFromFifo;
     if (uiNumBytesToReadFromFifo != uiNumBytes)
     {
       memset(&(buf[currentOutputBufferSize+uiNumBytesToReadFromFifo]), 0, uiNumBytes - uiNumBytesToReadFromFifo);
@@ -393,6 +399,18 @@ TComInputBitstream *TComInputBitstream::extractSubstream( UInt uiNumBits )
   return pResult;
 }
 
+static size_t findZeroZeroByteSequenceScalar( const uint8_t *data, size_t size, uint8_t maxThirdByte )
+{
+  for( size_t pos = 0; pos + 2 < size; pos++ )
+  {
+    if( data[pos] == 0x00 && data[pos + 1] == 0x00 && data[pos + 2] <= maxThirdByte )
+    {
+      return pos;
+    }
+  }
+  return size;
+}
+
 UInt TComInputBitstream::readByteAlignment()
 {
   UInt code = 0;
@@ -409,4 +427,63 @@ UInt TComInputBitstream::readByteAlignment()
   return numBits+1;
 }
 
+#if VECTOR_CODING__BYTE_SEQUENCE_SEARCH && (RExt__HIGH_BIT_DEPTH_SUPPORT==0)
+/** Vector version of findZeroZeroByteSequence: tests 16 candidate positions at a time.
+ */
+static size_t simdFindZeroZeroByteSequence( const uint8_t *data, size_t size, uint8_t maxThirdByte )
+{
+  const __m128i mmZero = _mm_setzero_si128();
+  const __m128i mmMax  = _mm_set1_epi8( (SChar)maxThirdByte );
+
+  size_t pos = 0;
+  for( ; pos + 18 <= size; pos += 16 )
+  {
+    const __m128i mmByte0 = _mm_loadu_si128( ( const __m128i* )( data + pos ) );
+    const __m128i mmByte1 = _mm_loadu_si128( ( const __m128i* )( data + pos + 1 ) );
+    const __m128i mmByte2 = _mm_loadu_si128( ( const __m128i* )( data + pos + 2 ) );
+
+    const __m128i mmZeroZero = _mm_and_si128( _mm_cmpeq_epi8( mmByte0, mmZero ), _mm_cmpeq_epi8( mmByte1, mmZero ) );
+    const __m128i mmSmall    = _mm_cmpeq_epi8( _mm_min_epu8( mmByte2, mmMax ), mmByte2 );
+
+    Int mask = _mm_movemask_epi8( _mm_and_si128( mmZeroZero, mmSmall ) );
+    if( mask )
+    {
+      while( ( mask & 1 ) == 0 )
+      {
+        mask >>= 1;
+        pos++;
+      }
+      return pos;
+    }
+  }
+  return pos + findZeroZeroByteSequenceScalar( data + pos, size - pos, maxThirdByte );
+}
+#endif
+
+/// byte search kernels of the selected instruction set level (see TComSimd)
+struct ByteSearchKernels
+{
+  size_t (*findZeroZeroByteSequence)( const uint8_t *data, size_t size, uint8_t maxThirdByte );
+};
+
+static ByteSearchKernels byteSearchKernels;
+
+static Void initByteSearchKernels( const SIMDLevel level )
+{
+  byteSearchKernels.findZeroZeroByteSequence = findZeroZeroByteSequenceScalar;
+#if VECTOR_CODING__BYTE_SEQUENCE_SEARCH && (RExt__HIGH_BIT_DEPTH_SUPPORT==0)
+  if( level >= SIMD_SSE2 )
+  {
+    byteSearchKernels.findZeroZeroByteSequence = simdFindZeroZeroByteSequence;
+  }
+#endif
+}
+
+static const Bool byteSearchKernelsRegistered = TComSimd::registerKernels( initByteSearchKernels );
+
+size_t findZeroZeroByteSequence( const uint8_t *data, size_t size, uint8_t maxThirdByte )
+{
+  return byteSearchKernels.findZeroZeroByteSequence( data, size, maxThirdByte );
+}
+
 //! \}
@@ -45,11 +45,67 @@
 #include <stdint.h>
 #include <vector>
 #include <stdio.h>
+#include <string.h>
 #include "CommonDef.h"
 
+#if defined(_MSC_VER)
+#include <intrin.h>
+#include <stdlib.h>
+#endif
+
 //! \ingroup TLibCommon
 //! \{
 
+// ====================================================================================================================
+// Bit manipulation helpers
+// ====================================================================================================================
+
+/// read 8 bytes (at any alignment) as a big-endian 64-bit word, with a single load and byte swap where possible
+static inline UInt64 readBigEndian64( const uint8_t *data )
+{
+#if defined(_MSC_VER)
+  UInt64 word;
+  memcpy( &word, data, sizeof( word ) );
+  return _byteswap_uint64( word );
+#elif defined(__GNUC__) && defined(__BYTE_ORDER__) && (__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__)
+  UInt64 word;
+  memcpy( &word, data, sizeof( word ) );
+  return __builtin_bswap64( word );
+#elif defined(__GNUC__) && defined(__BYTE_ORDER__) && (__BYTE_ORDER__ == __ORDER_BIG_ENDIAN__)
+  UInt64 word;
+  memcpy( &word, data, sizeof( word ) );
+  return word;
+#else
+  UInt64 word = 0;
+  for( Int i = 0; i < 8; i++ )
+  {
+    word = ( word << 8 ) | data[i];
+  }
+  return word;
+#endif
+}
+
+/// number of leading zero bits of a non-zero 64-bit word
+static inline UInt countLeadingZeros64( UInt64 word )
+{
+  assert( word != 0 );
+#if defined(__GNUC__)
+  return UInt( __builtin_clzll( word ) );
+#elif defined(_MSC_VER) && defined(_M_X64)
+  unsigned long msb;
+  _BitScanReverse64( &msb, word );
+  return 63 - UInt( msb );
+#else
+  UInt numZeros = 0;
+  while( ( word & ( UInt64( 1 ) << 63 ) ) == 0 )
+  {
+    word <<= 1;
+    numZeros++;
+  }
+  return numZeros;
+#endif
+}
+
 // ====================================================================================================================
 // Class definition
 // ====================================================================================================================
@@ -79,12 +135,17 @@ class TComOutputBitstream : public TComBitIf
    *  - fifo.clear() to empty the FIFO
    *  - &fifo.front() to get a pointer to the data array.
    *    NB, this pointer is only valid until the next push_back()/clear()
+   * Whole bytes are moved from m_held_bits into the FIFO in 32-bit words
+   * as they are written, and the remainder on demand (xFlushWholeBytes()),
+   * so the members are mutable.
    */
-  std::vector<uint8_t> m_fifo;
+  mutable std::vector<uint8_t> m_fifo;
+
+  mutable UInt   m_num_held_bits; /// number of bits not flushed to bytestream (less than 32).
+  mutable UInt64 m_held_bits; /// the bits held and not flushed to bytestream.
+                              /// this value is lsb-aligned: only the m_num_held_bits least significant bits are valid.
 
-  UInt m_num_held_bits; /// number of bits not flushed to bytestream.
-  UChar m_held_bits; /// the bits held and not flushed to bytestream.
-                             /// this value is always msb-aligned, bigendian.
+  Void xFlushWholeBytes() const; ///< move the whole bytes held to the FIFO, leaving less than 8 bits held
 public:
   // create / destroy
   TComOutputBitstream();
@@ -95,7 +156,30 @@ public:
    * append uiNumberOfBits least significant bits of uiBits to
    * the current bitstream
    */
-  Void        write           ( UInt uiBits, UInt uiNumberOfBits );
+  Void        write           ( UInt uiBits, UInt uiNumberOfBits )
+  {
+    assert( uiNumberOfBits <= 32 );
+    assert( uiNumberOfBits == 32 || (uiBits & (~0 << uiNumberOfBits)) == 0 );
+
+    if( uiNumberOfBits == 0 )
+    {
+      return;
+    }
+    m_held_bits      = ( m_held_bits << uiNumberOfBits ) | uiBits;
+    m_num_held_bits += uiNumberOfBits;
+    if( m_num_held_bits >= 32 )
+    {
+      // write out a 32-bit word, big-endian
+      m_num_held_bits -= 32;
+      const UInt   word = UInt( m_held_bits >> m_num_held_bits );
+      const size_t size = m_fifo.size();
+      m_fifo.resize( size + 4 );
+      m_fifo[size    ] = word >> 24;
+      m_fifo[size + 1] = word >> 16;
+      m_fifo[size + 2] = word >>  8;
+      m_fifo[size + 3] = word;
+    }
+  }
 
   /** insert one bits until the bitstream is byte-aligned */
   Void        writeAlignOne   ();
@@ -126,6 +210,12 @@ public:
    */
   Void clear();
 
+  /**
+   * Reserve storage for numBytes bytes, to avoid reallocations while
+   * writing (e.g. from an estimate of the size of a slice).
+   */
+  Void reserve( UInt numBytes ) { m_fifo.reserve( numBytes ); }
+
   /**
    * returns the number of bits that need to be written to
    * achieve byte alignment.
@@ -142,13 +232,14 @@ public:
   /**
    * Return a reference to the internal fifo
    */
-  std::vector<uint8_t>& getFIFO() { return m_fifo; }
+  std::vector<uint8_t>& getFIFO() { xFlushWholeBytes(); return m_fifo; }
 
-  UChar getHeldBits  ()          { return m_held_bits;          }
+  /** the bits held and not flushed to the fifo, msb-aligned */
+  UChar getHeldBits  ()          { xFlushWholeBytes(); return UChar( m_held_bits << ( 8 - m_num_held_bits ) ); }
 
   //TComOutputBitstream& operator= (const TComOutputBitstream& src);
   /** Return a reference to the internal fifo */
-  const std::vector<uint8_t>& getFIFO() const { return m_fifo; }
+  const std::vector<uint8_t>& getFIFO() const { xFlushWholeBytes(); return m_fifo; }
 
   Void          addSubstream    ( TComOutputBitstream* pcSubstream );
   Void writeByteAlignment();
@@ -167,11 +258,16 @@ protected:
   std::vector<uint8_t> m_fifo; /// FIFO for storage of complete bytes
   std::vector<UInt>    m_emulationPreventionByteLocation;
 
-  UInt m_fifo_idx; /// Read index into m_fifo
+  const uint8_t *m_view;     /// external bytes read instead of m_fifo (see setView()), or NULL
+  UInt           m_viewSize; /// number of bytes at m_view
+
+  UInt m_fifo_idx; /// Read index into the bytes (m_fifo or m_view) of the next byte to be loaded into m_held_bits
 
-  UInt m_num_held_bits;
-  UChar m_held_bits;
-  UInt  m_numBitsRead;
+  UInt   m_num_held_bits; /// number of bits loaded but not yet read (0 to 64)
+  UInt64 m_held_bits;     /// the bits loaded but not yet read, MSB-aligned; the bits below them are zero
+  UInt   m_numBitsRead;
+
+  Void xRefill();         ///< load as many whole bytes into m_held_bits as fit
 
 public:
   /**
@@ -185,23 +281,44 @@ public:
 
   // interface for decoding
   Void        pseudoRead      ( UInt uiNumberOfBits, UInt& ruiBits );
-  Void        read            ( UInt uiNumberOfBits, UInt& ruiBits );
-  Void        readByte        ( UInt &ruiBits )
+  Void        read            ( UInt uiNumberOfBits, UInt& ruiBits )
   {
-    assert(m_fifo_idx < m_fifo.size());
-    ruiBits = m_fifo[m_fifo_idx++];
+    assert( uiNumberOfBits <= 32 );
+    if( uiNumberOfBits > m_num_held_bits )
+    {
+      xRefill();
+      assert( uiNumberOfBits <= m_num_held_bits );
+    }
+    m_numBitsRead += uiNumberOfBits;
+    if( uiNumberOfBits == 0 )
+    {
+      ruiBits = 0;
+      return;
+    }
+    ruiBits = UInt( m_held_bits >> ( 64 - uiNumberOfBits ) );
+    m_held_bits     <<= uiNumberOfBits;
+    m_num_held_bits  -= uiNumberOfBits;
   }
+  Void        readByte        ( UInt &ruiBits )                       { read( 8, ruiBits ); }
+  Void        readExpGolomb   ( UInt &ruiCodeNum, UInt &ruiLength );  ///< read a ue(v) code number, of ruiLength bits
 
   Void        peekPreviousByte( UInt &byte )
   {
-    assert(m_fifo_idx > 0);
-    byte = m_fifo[m_fifo_idx - 1];
+    assert(getByteLocation() > 0);
+    byte = getData()[getByteLocation() - 1];
   }
 
   UInt        readOutTrailingBits ();
-  UChar getHeldBits  ()          { return m_held_bits;          }
   TComOutputBitstream& operator= (const TComOutputBitstream& src);
-  UInt  getByteLocation              ( )                     { return m_fifo_idx                    ; }
+  // position of the next byte to be read (or of the byte after the one being read, if not byte aligned)
+  UInt  getByteLocation              ( )                     { return m_fifo_idx - ( m_num_held_bits >> 3 ); }
+  Void  setByteLocation              ( UInt byteLocation )
+  {
+    assert((m_num_held_bits & 0x7) == 0 && byteLocation <= getDataSize());
+    m_fifo_idx      = byteLocation;
+    m_num_held_bits = 0;
+    m_held_bits     = 0;
+  }
 
   // Peek at bits in word-storage. Used in determining if we have completed reading of current bitstream and therefore slice in LCEC.
   UInt        peekBits (UInt uiBits) { UInt tmp; pseudoRead(uiBits, tmp); return tmp; }
@@ -210,7 +327,7 @@ public:
   UInt read(UInt numberOfBits) { UInt tmp; read(numberOfBits, tmp); return tmp; }
   UInt     readByte() { UInt tmp; readByte( tmp ); return tmp; }
   UInt getNumBitsUntilByteAligned() { return m_num_held_bits & (0x7); }
-  UInt getNumBitsLeft() { return 8*((UInt)m_fifo.size() - m_fifo_idx) + m_num_held_bits; }
+  UInt getNumBitsLeft() { return 8*(getDataSize() - m_fifo_idx) + m_num_held_bits; }
   TComInputBitstream *extractSubstream( UInt uiNumBits ); // Read the nominated number of bits, and return as a bitstream.
   UInt  getNumBitsRead() { return m_numBitsRead; }
   UInt readByteAlignment();
@@ -224,8 +341,28 @@ public:
 
   const std::vector<uint8_t> &getFifo() const { return m_fifo; }
         std::vector<uint8_t> &getFifo()       { return m_fifo; }
+
+  /** Read from size bytes of external memory (e.g. a memory-mapped bitstream file) instead of from the FIFO.
+   * The memory is not copied: it must outlive this bitstream and any substreams extracted from it.
+   * setView(NULL, 0) returns to reading from the FIFO.
+   */
+  Void      setView       ( const uint8_t *data, UInt size ) { m_view = data; m_viewSize = size; }
+  Bool      isView        () const                           { return m_view != NULL; }
+  Void      copyViewToFifo();                                ///< make the FIFO hold a copy of the viewed bytes, and read from it
+
+  // bytes being read: the FIFO contents, or the external memory set with setView()
+  const uint8_t *getData    () const { return m_view != NULL ? m_view     : ( m_fifo.empty() ? NULL : &m_fifo[0] ); }
+  UInt           getDataSize() const { return m_view != NULL ? m_viewSize : UInt( m_fifo.size() );                  }
 };
 
+/**
+ * Find the first byte-aligned three-byte sequence 0x00 0x00 0xXX with 0xXX <= maxThirdByte in data[0 .. size-1],
+ * as used for start code prefixes (maxThirdByte = 0x02) and emulation prevention (maxThirdByte = 0x03).
+ *
+ * Returns the offset of the first byte of the sequence, or size if there is none.
+ */
+size_t findZeroZeroByteSequence( const uint8_t *data, size_t size, uint8_t maxThirdByte );
+
 //! \}
 
 #endif
@@ -120,4 +120,40 @@ const UChar TComCABACTables::sm_aucRenormTable[32] =
   1,  1,  1,  1
 };
 
+const UInt TComCABACTables::sm_auiRangeReciprocalTable[256] =
+{
+  16777216, 16711936, 16647161, 16582886, 16519105, 16455814, 16393005, 16330675,
+  16268816, 16207424, 16146494, 16086020, 16025998, 15966422, 15907287, 15848588,
+  15790321, 15732481, 15675064, 15618063, 15561476, 15505298, 15449523, 15394149,
+  15339169, 15284582, 15230381, 15176563, 15123125, 15070061, 15017369, 14965043,
+  14913081, 14861479, 14810233, 14759338, 14708793, 14658592, 14608733, 14559212,
+  14510025, 14461170, 14412642, 14364440, 14316558, 14268995, 14221747, 14174810,
+  14128182, 14081860, 14035841, 13990122, 13944700, 13899571, 13854734, 13810185,
+  13765921, 13721941, 13678240, 13634817, 13591669, 13548793, 13506187, 13463848,
+  13421773, 13379961, 13338408, 13297113, 13256072, 13215284, 13174747, 13134457,
+  13094413, 13054612, 13015053, 12975733, 12936649, 12897800, 12859184, 12820798,
+  12782641, 12744711, 12707004, 12669521, 12632257, 12595213, 12558384, 12521771,
+  12485371, 12449181, 12413201, 12377428, 12341861, 12306497, 12271336, 12236375,
+  12201612, 12167047, 12132676, 12098500, 12064515, 12030721, 11997116, 11963698,
+  11930465, 11897417, 11864551, 11831866, 11799361, 11767034, 11734884, 11702909,
+  11671107, 11639478, 11608020, 11576732, 11545612, 11514658, 11483870, 11453247,
+  11422786, 11392487, 11362348, 11332368, 11302546, 11272881, 11243370, 11214014,
+  11184811, 11155760, 11126859, 11098107, 11069504, 11041048, 11012737, 10984572,
+  10956550, 10928670, 10900933, 10873335, 10845878, 10818558, 10791376, 10764330,
+  10737419, 10710642, 10683999, 10657488, 10631108, 10604858, 10578738, 10552746,
+  10526881, 10501143, 10475530, 10450043, 10424678, 10399437, 10374318, 10349319,
+  10324441, 10299682, 10275042, 10250519, 10226113, 10201823, 10177648, 10153587,
+  10129640, 10105806, 10082083, 10058472, 10034971, 10011579,  9988297,  9965122,
+   9942054,  9919094,  9896239,  9873489,  9850843,  9828301,  9805862,  9783525,
+   9761290,  9739155,  9717121,  9695186,  9673350,  9651612,  9629972,  9608428,
+   9586981,  9565629,  9544372,  9523210,  9502141,  9481165,  9460281,  9439489,
+   9418788,  9398178,  9377658,  9357228,  9336886,  9316632,  9296467,  9276388,
+   9256396,  9236489,  9216669,  9196933,  9177281,  9157713,  9138229,  9118827,
+   9099507,  9080270,  9061113,  9042037,  9023041,  9004125,  8985288,  8966529,
+   8947849,  8929246,  8910721,  8892272,  8873900,  8855603,  8837382,  8819235,
+   8801163,  8783165,  8765240,  8747388,  8729609,  8711902,  8694266,  8676702,
+   8659209,  8641786,  8624433,  8607149,  8589935,  8572790,  8555712,  8538703,
+   8521761,  8504886,  8488078,  8471336,  8454661,  8438050,  8421505,  8405025
+};
+
 //! \}
@@ -53,6 +53,7 @@ class TComCABACTables
 public:
   const static UChar  sm_aucLPSTable[1 << CONTEXT_STATE_BITS][4];
   const static UChar  sm_aucRenormTable[32];
+  const static UInt   sm_auiRangeReciprocalTable[256]; ///< ceil(2^32 / range) for range = 256..511, used to decode bypass bins without a division
 };
 
 
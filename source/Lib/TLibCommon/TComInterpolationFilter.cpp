@@ -42,12 +42,16 @@
 
 #include "TComRom.h"
 #include "TComInterpolationFilter.h"
+#include "TComSimd.h"
 #include <assert.h>
 
 #include "TComChromaFormat.h"
 
 #if VECTOR_CODING__INTERPOLATION_FILTER && (RExt__HIGH_BIT_DEPTH_SUPPORT==0)
 #include <emmintrin.h>
+#if VECTOR_CODING__AVX2_KERNELS
+#include <immintrin.h>
+#endif
 #endif
 
 //! \ingroup TLibCommon
@@ -178,6 +182,275 @@ inline __m128i simdClip3( __m128i mmMin , __m128i mmMax , __m128i mmPix )
 }
 #endif
 
+// ====================================================================================================================
+// Kernels
+// ====================================================================================================================
+
+/// filter a block of samples with the taps c, adding offset and shifting by shift, and clipping to [0, maxVal] if isLast
+template<Int N, Bool isLast>
+static Void filterScalar(const Pel *src, Int srcStride, Int cStride, Pel *dst, Int dstStride, Int width, Int height, const Pel *c, Int offset, Int shift, Pel maxVal)
+{
+  Int row, col;
+
+  for (row = 0; row < height; row++)
+  {
+    for (col = 0; col < width; col++)
+    {
+      Int sum;
+
+      sum  = src[ col + 0 * cStride] * c[0];
+      sum += src[ col + 1 * cStride] * c[1];
+      if ( N >= 4 )
+      {
+        sum += src[ col + 2 * cStride] * c[2];
+        sum += src[ col + 3 * cStride] * c[3];
+      }
+      if ( N >= 6 )
+      {
+        sum += src[ col + 4 * cStride] * c[4];
+        sum += src[ col + 5 * cStride] * c[5];
+      }
+      if ( N == 8 )
+      {
+        sum += src[ col + 6 * cStride] * c[6];
+        sum += src[ col + 7 * cStride] * c[7];
+      }
+
+      Pel val = ( sum + offset ) >> shift;
+      if ( isLast )
+      {
+        val = ( val < 0 ) ? 0 : val;
+        val = ( val > maxVal ) ? maxVal : val;
+      }
+      dst[col] = val;
+    }
+
+    src += srcStride;
+    dst += dstStride;
+  }
+}
+
+#if VECTOR_CODING__INTERPOLATION_FILTER && (RExt__HIGH_BIT_DEPTH_SUPPORT==0)
+template<Int N, Bool isLast>
+static Void simdFilter(const Pel *src, Int srcStride, Int cStride, Pel *dst, Int dstStride, Int width, Int height, const Pel *c, Int offset, Int shift, Pel maxVal)
+{
+  Int row, col;
+
+  if( N == 8 && !( width & 0x07 ) )
+  {
+    Short minVal = 0;
+    __m128i mmOffset = _mm_set1_epi32( offset );
+    __m128i mmCoeff[8];
+    __m128i mmMin = _mm_set1_epi16( minVal );
+    __m128i mmMax = _mm_set1_epi16( maxVal );
+    for( Int n = 0 ; n < 8 ; n++ )
+      mmCoeff[n] = _mm_set1_epi16( c[n] );
+    for( row = 0 ; row < height ; row++ )
+    {
+      for( col = 0 ; col < width ; col += 8 )
+      {
+        __m128i mmFiltered = simdInterpolateLuma8( src + col , cStride , mmCoeff , mmOffset , shift );
+        if( isLast )
+        {
+          mmFiltered = simdClip3( mmMin , mmMax , mmFiltered );
+        }
+        _mm_storeu_si128( ( __m128i * )( dst + col ) , mmFiltered );
+      }
+      src += srcStride;
+      dst += dstStride;
+    }
+    return;
+  }
+  else if( N == 8 && !( width & 0x03 ) )
+  {
+    Short minVal = 0;
+    __m128i mmOffset = _mm_set1_epi32( offset );
+    __m128i mmCoeff[8];
+    __m128i mmMin = _mm_set1_epi16( minVal );
+    __m128i mmMax = _mm_set1_epi16( maxVal );
+    for( Int n = 0 ; n < 8 ; n++ )
+      mmCoeff[n] = _mm_set1_epi16( c[n] );
+    for( row = 0 ; row < height ; row++ )
+    {
+      for( col = 0 ; col < width ; col += 4 )
+      {
+        __m128i mmFiltered = simdInterpolateLuma4( src + col , cStride , mmCoeff , mmOffset , shift );
+        if( isLast )
+        {
+          mmFiltered = simdClip3( mmMin , mmMax , mmFiltered );
+        }
+        _mm_storel_epi64( ( __m128i * )( dst + col ) , mmFiltered );
+      }
+      src += srcStride;
+      dst += dstStride;
+    }
+    return;
+  }
+  else if( N == 4 && !( width & 0x03 ) )
+  {
+    Short minVal = 0;
+    __m128i mmOffset = _mm_set1_epi32( offset );
+    __m128i mmCoeff[8];
+    __m128i mmMin = _mm_set1_epi16( minVal );
+    __m128i mmMax = _mm_set1_epi16( maxVal );
+    for( Int n = 0 ; n < 4 ; n++ )
+      mmCoeff[n] = _mm_set1_epi16( c[n] );
+    for( row = 0 ; row < height ; row++ )
+    {
+      for( col = 0 ; col < width ; col += 4 )
+      {
+        __m128i mmFiltered = simdInterpolateChroma4( src + col , cStride , mmCoeff , mmOffset , shift );
+        if( isLast )
+        {
+          mmFiltered = simdClip3( mmMin , mmMax , mmFiltered );
+        }
+        _mm_storel_epi64( ( __m128i * )( dst + col ) , mmFiltered );
+      }
+      src += srcStride;
+      dst += dstStride;
+    }
+    return;
+  }
+  else if( N == 2 && !( width & 0x07 ) )
+  {
+    Short minVal = 0;
+    __m128i mmOffset = _mm_set1_epi32( offset );
+    __m128i mmCoeff[2];
+    __m128i mmMin = _mm_set1_epi16( minVal );
+    __m128i mmMax = _mm_set1_epi16( maxVal );
+    for( Int n = 0 ; n < 2 ; n++ )
+      mmCoeff[n] = _mm_set1_epi16( c[n] );
+    for( row = 0 ; row < height ; row++ )
+    {
+      for( col = 0 ; col < width ; col += 8 )
+      {
+        __m128i mmFiltered = simdInterpolateLuma2P8( src + col , cStride , mmCoeff , mmOffset , shift );
+        if( isLast )
+        {
+          mmFiltered = simdClip3( mmMin , mmMax , mmFiltered );
+        }
+        _mm_storeu_si128( ( __m128i * )( dst + col ) , mmFiltered );
+      }
+      src += srcStride;
+      dst += dstStride;
+    }
+    return;
+  }
+  else if( N == 2 && !( width & 0x03 ) )
+  {
+    Short minVal = 0;
+    __m128i mmOffset = _mm_set1_epi32( offset );
+    __m128i mmCoeff[8];
+    __m128i mmMin = _mm_set1_epi16( minVal );
+    __m128i mmMax = _mm_set1_epi16( maxVal );
+    for( Int n = 0 ; n < 2 ; n++ )
+      mmCoeff[n] = _mm_set1_epi16( c[n] );
+    for( row = 0 ; row < height ; row++ )
+    {
+      for( col = 0 ; col < width ; col += 4 )
+      {
+        __m128i mmFiltered = simdInterpolateLuma2P4( src + col , cStride , mmCoeff , mmOffset , shift );
+        if( isLast )
+        {
+          mmFiltered = simdClip3( mmMin , mmMax , mmFiltered );
+        }
+        _mm_storel_epi64( ( __m128i * )( dst + col ) , mmFiltered );
+      }
+      src += srcStride;
+      dst += dstStride;
+    }
+    return;
+  }
+
+  filterScalar<N, isLast>( src, srcStride, cStride, dst, dstStride, width, height, c, offset, shift, maxVal );
+}
+
+#if VECTOR_CODING__AVX2_KERNELS
+template<Int N, Bool isLast>
+SIMD_TARGET_AVX2 static Void simdFilterAVX2(const Pel *src, Int srcStride, Int cStride, Pel *dst, Int dstStride, Int width, Int height, const Pel *c, Int offset, Int shift, Pel maxVal)
+{
+  if( width & 0x0f )
+  {
+    simdFilter<N, isLast>( src, srcStride, cStride, dst, dstStride, width, height, c, offset, shift, maxVal );
+    return;
+  }
+  // the taps are paired, so that each multiply-add applies two of them with 32-bit sums
+  __m256i mmCoeff[N / 2];
+  for( Int n = 0 ; n < N ; n += 2 )
+  {
+    mmCoeff[n / 2] = _mm256_unpacklo_epi16( _mm256_set1_epi16( c[n] ) , _mm256_set1_epi16( c[n + 1] ) );
+  }
+  const __m256i mmOffset = _mm256_set1_epi32( offset );
+  const __m128i mmShift  = _mm_cvtsi32_si128( shift );
+  const __m256i mmMin    = _mm256_setzero_si256();
+  const __m256i mmMax    = _mm256_set1_epi16( maxVal );
+  for( Int row = 0 ; row < height ; row++ )
+  {
+    for( Int col = 0 ; col < width ; col += 16 )
+    {
+      const Pel *pSrc = src + col;
+      __m256i sumLo = mmOffset;
+      __m256i sumHi = mmOffset;
+      for( Int n = 0 ; n < N ; n += 2 , pSrc += 2 * cStride )
+      {
+        const __m256i mmPix0 = _mm256_loadu_si256( ( const __m256i* )pSrc );
+        const __m256i mmPix1 = _mm256_loadu_si256( ( const __m256i* )( pSrc + cStride ) );
+        sumLo = _mm256_add_epi32( sumLo , _mm256_madd_epi16( _mm256_unpacklo_epi16( mmPix0 , mmPix1 ) , mmCoeff[n / 2] ) );
+        sumHi = _mm256_add_epi32( sumHi , _mm256_madd_epi16( _mm256_unpackhi_epi16( mmPix0 , mmPix1 ) , mmCoeff[n / 2] ) );
+      }
+      __m256i mmFiltered = _mm256_packs_epi32( _mm256_sra_epi32( sumLo , mmShift ) , _mm256_sra_epi32( sumHi , mmShift ) );
+      if( isLast )
+      {
+        mmFiltered = _mm256_min_epi16( _mm256_max_epi16( mmFiltered , mmMin ) , mmMax );
+      }
+      _mm256_storeu_si256( ( __m256i * )( dst + col ) , mmFiltered );
+    }
+    src += srcStride;
+    dst += dstStride;
+  }
+}
+#endif
+
+typedef Void (*InterpolationKernel)(const Pel *src, Int srcStride, Int cStride, Pel *dst, Int dstStride, Int width, Int height, const Pel *c, Int offset, Int shift, Pel maxVal);
+
+/// interpolation kernels of the selected instruction set level (see TComSimd), indexed by the number of taps / 4 and isLast; the vector kernels require samples of at most 10 bits
+struct InterpolationKernels
+{
+  InterpolationKernel filter[3][2];
+};
+
+static InterpolationKernels interpolationKernels;
+
+template<Int N>
+static Void initInterpolationKernels( const SIMDLevel level )
+{
+  InterpolationKernel *filter = interpolationKernels.filter[N >> 2];
+  filter[false] = filterScalar<N, false>;
+  filter[true]  = filterScalar<N, true>;
+  if( level >= SIMD_SSE2 )
+  {
+    filter[false] = simdFilter<N, false>;
+    filter[true]  = simdFilter<N, true>;
+  }
+#if VECTOR_CODING__AVX2_KERNELS
+  if( level >= SIMD_AVX2 )
+  {
+    filter[false] = simdFilterAVX2<N, false>;
+    filter[true]  = simdFilterAVX2<N, true>;
+  }
+#endif
+}
+
+static Void initInterpolationKernels( const SIMDLevel level )
+{
+  initInterpolationKernels<2>( level );
+  initInterpolationKernels<4>( level );
+  initInterpolationKernels<8>( level );
+}
+
+static const Bool interpolationKernelsRegistered = TComSimd::registerKernels( initInterpolationKernels );
+#endif
+
 // ====================================================================================================================
 // Private member functions
 // ====================================================================================================================
@@ -276,8 +549,6 @@ Void TComInterpolationFilter::filterCopy(Int bitDepth, const Pel *src, Int srcSt
 template<Int N, Bool isVertical, Bool isFirst, Bool isLast>
 Void TComInterpolationFilter::filter(Int bitDepth, Pel const *src, Int srcStride, Pel *dst, Int dstStride, Int width, Int height, TFilterCoeff const *coeff)
 {
-  Int row, col;
-
   Pel c[8];
   c[0] = coeff[0];
   c[1] = coeff[1];
@@ -325,170 +596,11 @@ Void TComInterpolationFilter::filter(Int bitDepth, Pel const *src, Int srcStride
 #if VECTOR_CODING__INTERPOLATION_FILTER && (RExt__HIGH_BIT_DEPTH_SUPPORT==0)
   if( bitDepth <= 10 )
   {
-    if( N == 8 && !( width & 0x07 ) )
-    {
-      Short minVal = 0;
-      __m128i mmOffset = _mm_set1_epi32( offset );
-      __m128i mmCoeff[8];
-      __m128i mmMin = _mm_set1_epi16( minVal );
-      __m128i mmMax = _mm_set1_epi16( maxVal );
-      for( Int n = 0 ; n < 8 ; n++ )
-        mmCoeff[n] = _mm_set1_epi16( c[n] );
-      for( row = 0 ; row < height ; row++ )
-      {
-        for( col = 0 ; col < width ; col += 8 )
-        {
-          __m128i mmFiltered = simdInterpolateLuma8( src + col , cStride , mmCoeff , mmOffset , shift );
-          if( isLast )
-          {
-            mmFiltered = simdClip3( mmMin , mmMax , mmFiltered );
-          }
-          _mm_storeu_si128( ( __m128i * )( dst + col ) , mmFiltered );
-        }
-        src += srcStride;
-        dst += dstStride;
-      }
-      return;
-    }
-    else if( N == 8 && !( width & 0x03 ) )
-    {
-      Short minVal = 0;
-      __m128i mmOffset = _mm_set1_epi32( offset );
-      __m128i mmCoeff[8];
-      __m128i mmMin = _mm_set1_epi16( minVal );
-      __m128i mmMax = _mm_set1_epi16( maxVal );
-      for( Int n = 0 ; n < 8 ; n++ )
-        mmCoeff[n] = _mm_set1_epi16( c[n] );
-      for( row = 0 ; row < height ; row++ )
-      {
-        for( col = 0 ; col < width ; col += 4 )
-        {
-          __m128i mmFiltered = simdInterpolateLuma4( src + col , cStride , mmCoeff , mmOffset , shift );
-          if( isLast )
-          {
-            mmFiltered = simdClip3( mmMin , mmMax , mmFiltered );
-          }
-          _mm_storel_epi64( ( __m128i * )( dst + col ) , mmFiltered );
-        }
-        src += srcStride;
-        dst += dstStride;
-      }
-      return;
-    }
-    else if( N == 4 && !( width & 0x03 ) )
-    {
-      Short minVal = 0;
-      __m128i mmOffset = _mm_set1_epi32( offset );
-      __m128i mmCoeff[8];
-      __m128i mmMin = _mm_set1_epi16( minVal );
-      __m128i mmMax = _mm_set1_epi16( maxVal );
-      for( Int n = 0 ; n < 4 ; n++ )
-        mmCoeff[n] = _mm_set1_epi16( c[n] );
-      for( row = 0 ; row < height ; row++ )
-      {
-        for( col = 0 ; col < width ; col += 4 )
-        {
-          __m128i mmFiltered = simdInterpolateChroma4( src + col , cStride , mmCoeff , mmOffset , shift );
-          if( isLast )
-          {
-            mmFiltered = simdClip3( mmMin , mmMax , mmFiltered );
-          }
-          _mm_storel_epi64( ( __m128i * )( dst + col ) , mmFiltered );
-        }
-        src += srcStride;
-        dst += dstStride;
-      }
-      return;
-    }
-    else if( N == 2 && !( width & 0x07 ) )
-    {
-      Short minVal = 0;
-      __m128i mmOffset = _mm_set1_epi32( offset );
-      __m128i mmCoeff[2];
-      __m128i mmMin = _mm_set1_epi16( minVal );
-      __m128i mmMax = _mm_set1_epi16( maxVal );
-      for( Int n = 0 ; n < 2 ; n++ )
-        mmCoeff[n] = _mm_set1_epi16( c[n] );
-      for( row = 0 ; row < height ; row++ )
-      {
-        for( col = 0 ; col < width ; col += 8 )
-        {
-          __m128i mmFiltered = simdInterpolateLuma2P8( src + col , cStride , mmCoeff , mmOffset , shift );
-          if( isLast )
-          {
-            mmFiltered = simdClip3( mmMin , mmMax , mmFiltered );
-          }
-          _mm_storeu_si128( ( __m128i * )( dst + col ) , mmFiltered );
-        }
-        src += srcStride;
-        dst += dstStride;
-      }
-      return;
-    }
-    else if( N == 2 && !( width & 0x03 ) )
-    {
-      Short minVal = 0;
-      __m128i mmOffset = _mm_set1_epi32( offset );
-      __m128i mmCoeff[8];
-      __m128i mmMin = _mm_set1_epi16( minVal );
-      __m128i mmMax = _mm_set1_epi16( maxVal );
-      for( Int n = 0 ; n < 2 ; n++ )
-        mmCoeff[n] = _mm_set1_epi16( c[n] );
-      for( row = 0 ; row < height ; row++ )
-      {
-        for( col = 0 ; col < width ; col += 4 )
-        {
-          __m128i mmFiltered = simdInterpolateLuma2P4( src + col , cStride , mmCoeff , mmOffset , shift );
-          if( isLast )
-          {
-            mmFiltered = simdClip3( mmMin , mmMax , mmFiltered );
-          }
-          _mm_storel_epi64( ( __m128i * )( dst + col ) , mmFiltered );
-        }
-        src += srcStride;
-        dst += dstStride;
-      }
-      return;
-    }
+    interpolationKernels.filter[N >> 2][isLast]( src, srcStride, cStride, dst, dstStride, width, height, c, offset, shift, maxVal );
+    return;
   }
 #endif
-
-  for (row = 0; row < height; row++)
-  {
-    for (col = 0; col < width; col++)
-    {
-      Int sum;
-
-      sum  = src[ col + 0 * cStride] * c[0];
-      sum += src[ col + 1 * cStride] * c[1];
-      if ( N >= 4 )
-      {
-        sum += src[ col + 2 * cStride] * c[2];
-        sum += src[ col + 3 * cStride] * c[3];
-      }
-      if ( N >= 6 )
-      {
-        sum += src[ col + 4 * cStride] * c[4];
-        sum += src[ col + 5 * cStride] * c[5];
-      }
-      if ( N == 8 )
-      {
-        sum += src[ col + 6 * cStride] * c[6];
-        sum += src[ col + 7 * cStride] * c[7];
-      }
-
-      Pel val = ( sum + offset ) >> shift;
-      if ( isLast )
-      {
-        val = ( val < 0 ) ? 0 : val;
-        val = ( val > maxVal ) ? maxVal : val;
-      }
-      dst[col] = val;
-    }
-
-    src += srcStride;
-    dst += dstStride;
-  }
+  filterScalar<N, isLast>( src, srcStride, cStride, dst, dstStride, width, height, c, offset, shift, maxVal );
 }
 
 /**
@@ -36,10 +36,15 @@
 */
 
 #include "TComLoopFilter.h"
+#include "TComSimd.h"
 #include "TComSlice.h"
 #include "TComMv.h"
 #include "TComTU.h"
 
+#if VECTOR_CODING__DEBLOCKING_FILTER && (RExt__HIGH_BIT_DEPTH_SUPPORT==0)
+#include <emmintrin.h>
+#endif
+
 //! \ingroup TLibCommon
 //! \{
 
@@ -66,6 +71,287 @@ const UChar TComLoopFilter::sm_betaTable[MAX_QP + 1] =
   0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,6,7,8,9,10,11,12,13,14,15,16,17,18,20,22,24,26,28,30,32,34,36,38,40,42,44,46,48,50,52,54,56,58,60,62,64
 };
 
+// ====================================================================================================================
+// Kernels
+// ====================================================================================================================
+
+static Void edgeFilterLuma4 ( Pel *piSrc, Int iOffset, Int iSrcStep, Int iTc, Int iBeta, Int iSideThreshold, Int iThrCut, Bool bPartPNoFilter, Bool bPartQNoFilter, Int bitDepthLuma );
+static Void edgeFilterChroma( Pel *piSrc, Int iOffset, Int iSrcStep, Int iNumLines, Int iTc, Bool bPartPNoFilter, Bool bPartQNoFilter, Int bitDepthChroma );
+
+/// deblocking kernels of the selected instruction set level (see TComSimd)
+struct DeblockingKernels
+{
+  Void (*edgeFilterLuma4) ( Pel *piSrc, Int iOffset, Int iSrcStep, Int iTc, Int iBeta, Int iSideThreshold, Int iThrCut, Bool bPartPNoFilter, Bool bPartQNoFilter, Int bitDepthLuma );
+  Void (*edgeFilterChroma)( Pel *piSrc, Int iOffset, Int iSrcStep, Int iNumLines, Int iTc, Bool bPartPNoFilter, Bool bPartQNoFilter, Int bitDepthChroma );
+};
+
+static DeblockingKernels deblockingKernels;
+
+#if VECTOR_CODING__DEBLOCKING_FILTER && (RExt__HIGH_BIT_DEPTH_SUPPORT==0)
+static inline __m128i simdAbs16( const __m128i &mmVal )
+{
+  return _mm_max_epi16( mmVal , _mm_sub_epi16( _mm_setzero_si128() , mmVal ) );
+}
+
+static inline __m128i simdClip16( const __m128i &mmMin , const __m128i &mmMax , const __m128i &mmVal )
+{
+  return _mm_min_epi16( _mm_max_epi16( mmVal , mmMin ) , mmMax );
+}
+
+static inline __m128i simdSelect16( const __m128i &mmMask , const __m128i &mmTrue , const __m128i &mmFalse )
+{
+  return _mm_or_si128( _mm_and_si128( mmMask , mmTrue ) , _mm_andnot_si128( mmMask , mmFalse ) );
+}
+
+/** Load the eight samples m0..m7 across an edge for four consecutive lines.
+ *  Each output vector holds one sample position with the four lines in its low 64 bits.
+ *  Horizontal edges are loaded directly, vertical edges are loaded as rows and transposed.
+ */
+static inline Void simdLoadEdgeLines4( const Pel *piSrc , Int iOffset , Int iSrcStep , __m128i *m )
+{
+  if( iOffset == 1 )
+  {
+    __m128i r0 = _mm_loadu_si128( ( const __m128i * )( piSrc - 4 ) );
+    __m128i r1 = _mm_loadu_si128( ( const __m128i * )( piSrc - 4 + iSrcStep ) );
+    __m128i r2 = _mm_loadu_si128( ( const __m128i * )( piSrc - 4 + iSrcStep * 2 ) );
+    __m128i r3 = _mm_loadu_si128( ( const __m128i * )( piSrc - 4 + iSrcStep * 3 ) );
+    __m128i t0 = _mm_unpacklo_epi16( r0 , r1 );
+    __m128i t1 = _mm_unpacklo_epi16( r2 , r3 );
+    __m128i t2 = _mm_unpackhi_epi16( r0 , r1 );
+    __m128i t3 = _mm_unpackhi_epi16( r2 , r3 );
+    __m128i u0 = _mm_unpacklo_epi32( t0 , t1 );
+    __m128i u1 = _mm_unpackhi_epi32( t0 , t1 );
+    __m128i u2 = _mm_unpacklo_epi32( t2 , t3 );
+    __m128i u3 = _mm_unpackhi_epi32( t2 , t3 );
+    m[0] = u0;
+    m[1] = _mm_unpackhi_epi64( u0 , u0 );
+    m[2] = u1;
+    m[3] = _mm_unpackhi_epi64( u1 , u1 );
+    m[4] = u2;
+    m[5] = _mm_unpackhi_epi64( u2 , u2 );
+    m[6] = u3;
+    m[7] = _mm_unpackhi_epi64( u3 , u3 );
+  }
+  else
+  {
+    for( Int k = 0 ; k < 8 ; k++ )
+    {
+      m[k] = _mm_loadl_epi64( ( const __m128i * )( piSrc + ( k - 4 ) * iOffset ) );
+    }
+  }
+}
+
+/** Store the samples m1..m6 across an edge for four consecutive lines (inverse of simdLoadEdgeLines4).
+ */
+static inline Void simdStoreEdgeLines4( Pel *piSrc , Int iOffset , Int iSrcStep , const __m128i *m )
+{
+  if( iOffset == 1 )
+  {
+    __m128i a0 = _mm_unpacklo_epi16( m[0] , m[1] );
+    __m128i a1 = _mm_unpacklo_epi16( m[2] , m[3] );
+    __m128i a2 = _mm_unpacklo_epi16( m[4] , m[5] );
+    __m128i a3 = _mm_unpacklo_epi16( m[6] , m[7] );
+    __m128i b0 = _mm_unpacklo_epi32( a0 , a1 );
+    __m128i b1 = _mm_unpackhi_epi32( a0 , a1 );
+    __m128i b2 = _mm_unpacklo_epi32( a2 , a3 );
+    __m128i b3 = _mm_unpackhi_epi32( a2 , a3 );
+    _mm_storeu_si128( ( __m128i * )( piSrc - 4                ) , _mm_unpacklo_epi64( b0 , b2 ) );
+    _mm_storeu_si128( ( __m128i * )( piSrc - 4 + iSrcStep     ) , _mm_unpackhi_epi64( b0 , b2 ) );
+    _mm_storeu_si128( ( __m128i * )( piSrc - 4 + iSrcStep * 2 ) , _mm_unpacklo_epi64( b1 , b3 ) );
+    _mm_storeu_si128( ( __m128i * )( piSrc - 4 + iSrcStep * 3 ) , _mm_unpackhi_epi64( b1 , b3 ) );
+  }
+  else
+  {
+    for( Int k = 1 ; k < 7 ; k++ )
+    {
+      _mm_storel_epi64( ( __m128i * )( piSrc + ( k - 4 ) * iOffset ) , m[k] );
+    }
+  }
+}
+
+/** Decide and filter one four-line luma edge segment (equivalent to the xCalcDP/xCalcDQ decisions,
+ *  xUseStrongFiltering and four calls of xPelFilterLuma).
+ */
+static Void simdEdgeFilterLuma4( Pel *piSrc , Int iOffset , Int iSrcStep , Int iTc , Int iBeta , Int iSideThreshold , Int iThrCut , Bool bPartPNoFilter , Bool bPartQNoFilter , Int bitDepthLuma )
+{
+  if( bitDepthLuma > 10 )
+  {
+    edgeFilterLuma4( piSrc, iOffset, iSrcStep, iTc, iBeta, iSideThreshold, iThrCut, bPartPNoFilter, bPartQNoFilter, bitDepthLuma );
+    return;
+  }
+  __m128i m[8];
+  simdLoadEdgeLines4( piSrc , iOffset , iSrcStep , m );
+
+  const __m128i mmDP = simdAbs16( _mm_sub_epi16( _mm_add_epi16( m[1] , m[3] ) , _mm_add_epi16( m[2] , m[2] ) ) );
+  const __m128i mmDQ = simdAbs16( _mm_sub_epi16( _mm_add_epi16( m[4] , m[6] ) , _mm_add_epi16( m[5] , m[5] ) ) );
+
+  const Int dp0 = _mm_extract_epi16( mmDP , 0 );
+  const Int dp3 = _mm_extract_epi16( mmDP , 3 );
+  const Int dq0 = _mm_extract_epi16( mmDQ , 0 );
+  const Int dq3 = _mm_extract_epi16( mmDQ , 3 );
+  const Int d0  = dp0 + dq0;
+  const Int d3  = dp3 + dq3;
+
+  if( d0 + d3 >= iBeta )
+  {
+    return;
+  }
+
+  const Bool bFilterP = ( dp0 + dp3 ) < iSideThreshold;
+  const Bool bFilterQ = ( dq0 + dq3 ) < iSideThreshold;
+
+  const __m128i mmStrong = _mm_add_epi16( simdAbs16( _mm_sub_epi16( m[0] , m[3] ) ) , simdAbs16( _mm_sub_epi16( m[7] , m[4] ) ) );
+  const __m128i mmStep   = simdAbs16( _mm_sub_epi16( m[3] , m[4] ) );
+  const Int     tcStrong = ( iTc * 5 + 1 ) >> 1;
+
+  const Bool sw = ( _mm_extract_epi16( mmStrong , 0 ) < ( iBeta >> 3 ) ) && ( 2 * d0 < ( iBeta >> 2 ) ) && ( _mm_extract_epi16( mmStep , 0 ) < tcStrong )
+               && ( _mm_extract_epi16( mmStrong , 3 ) < ( iBeta >> 3 ) ) && ( 2 * d3 < ( iBeta >> 2 ) ) && ( _mm_extract_epi16( mmStep , 3 ) < tcStrong );
+
+  __m128i f[8];
+  for( Int k = 0 ; k < 8 ; k++ )
+  {
+    f[k] = m[k];
+  }
+
+  if( sw )
+  {
+    const __m128i mmTc2  = _mm_set1_epi16( 2 * iTc );
+    const __m128i mmRnd2 = _mm_set1_epi16( 2 );
+    const __m128i mmRnd4 = _mm_set1_epi16( 4 );
+    const __m128i mmSum  = _mm_add_epi16( _mm_add_epi16( m[2] , m[3] ) , m[4] );
+
+    // p0' = ( p2 + 2*p1 + 2*p0 + 2*q0 + q1 + 4 ) >> 3 and its mirror
+    __m128i mmVal = _mm_add_epi16( _mm_add_epi16( mmSum , mmSum ) , _mm_add_epi16( m[1] , m[5] ) );
+    f[3] = simdClip16( _mm_sub_epi16( m[3] , mmTc2 ) , _mm_add_epi16( m[3] , mmTc2 ) , _mm_srai_epi16( _mm_add_epi16( mmVal , mmRnd4 ) , 3 ) );
+    mmVal = _mm_add_epi16( _mm_add_epi16( m[2] , m[6] ) , _mm_slli_epi16( _mm_add_epi16( _mm_add_epi16( m[3] , m[4] ) , m[5] ) , 1 ) );
+    f[4] = simdClip16( _mm_sub_epi16( m[4] , mmTc2 ) , _mm_add_epi16( m[4] , mmTc2 ) , _mm_srai_epi16( _mm_add_epi16( mmVal , mmRnd4 ) , 3 ) );
+
+    // p1' = ( p2 + p1 + p0 + q0 + 2 ) >> 2 and its mirror
+    mmVal = _mm_add_epi16( _mm_add_epi16( m[1] , m[2] ) , _mm_add_epi16( m[3] , m[4] ) );
+    f[2] = simdClip16( _mm_sub_epi16( m[2] , mmTc2 ) , _mm_add_epi16( m[2] , mmTc2 ) , _mm_srai_epi16( _mm_add_epi16( mmVal , mmRnd2 ) , 2 ) );
+    mmVal = _mm_add_epi16( _mm_add_epi16( m[3] , m[4] ) , _mm_add_epi16( m[5] , m[6] ) );
+    f[5] = simdClip16( _mm_sub_epi16( m[5] , mmTc2 ) , _mm_add_epi16( m[5] , mmTc2 ) , _mm_srai_epi16( _mm_add_epi16( mmVal , mmRnd2 ) , 2 ) );
+
+    // p2' = ( 2*p3 + 3*p2 + p1 + p0 + q0 + 4 ) >> 3 and its mirror
+    mmVal = _mm_add_epi16( _mm_slli_epi16( _mm_add_epi16( m[0] , m[1] ) , 1 ) , _mm_add_epi16( m[1] , mmSum ) );
+    f[1] = simdClip16( _mm_sub_epi16( m[1] , mmTc2 ) , _mm_add_epi16( m[1] , mmTc2 ) , _mm_srai_epi16( _mm_add_epi16( mmVal , mmRnd4 ) , 3 ) );
+    mmVal = _mm_add_epi16( _mm_add_epi16( m[3] , m[4] ) , _mm_add_epi16( m[5] , _mm_add_epi16( _mm_slli_epi16( _mm_add_epi16( m[6] , m[7] ) , 1 ) , m[6] ) ) );
+    f[6] = simdClip16( _mm_sub_epi16( m[6] , mmTc2 ) , _mm_add_epi16( m[6] , mmTc2 ) , _mm_srai_epi16( _mm_add_epi16( mmVal , mmRnd4 ) , 3 ) );
+  }
+  else
+  {
+    const __m128i mmTc     = _mm_set1_epi16( iTc );
+    const __m128i mmTcNeg  = _mm_set1_epi16( -iTc );
+    const __m128i mmTcH    = _mm_set1_epi16( iTc >> 1 );
+    const __m128i mmTcHNeg = _mm_set1_epi16( -( iTc >> 1 ) );
+    const __m128i mmMin    = _mm_setzero_si128();
+    const __m128i mmMax    = _mm_set1_epi16( ( 1 << bitDepthLuma ) - 1 );
+    const __m128i mmOne    = _mm_set1_epi16( 1 );
+
+    // delta = ( 9*( q0 - p0 ) - 3*( q1 - p1 ) + 8 ) >> 4
+    const __m128i mmDiff0 = _mm_sub_epi16( m[4] , m[3] );
+    const __m128i mmDiff1 = _mm_sub_epi16( m[5] , m[2] );
+    __m128i mmDelta = _mm_add_epi16( _mm_slli_epi16( mmDiff0 , 3 ) , mmDiff0 );
+    mmDelta = _mm_sub_epi16( mmDelta , _mm_add_epi16( _mm_add_epi16( mmDiff1 , mmDiff1 ) , mmDiff1 ) );
+    mmDelta = _mm_srai_epi16( _mm_add_epi16( mmDelta , _mm_set1_epi16( 8 ) ) , 4 );
+
+    const __m128i mmApply = _mm_cmplt_epi16( simdAbs16( mmDelta ) , _mm_set1_epi16( iThrCut ) );
+    mmDelta = simdClip16( mmTcNeg , mmTc , mmDelta );
+
+    f[3] = simdSelect16( mmApply , simdClip16( mmMin , mmMax , _mm_add_epi16( m[3] , mmDelta ) ) , m[3] );
+    f[4] = simdSelect16( mmApply , simdClip16( mmMin , mmMax , _mm_sub_epi16( m[4] , mmDelta ) ) , m[4] );
+
+    if( bFilterP )
+    {
+      __m128i mmDelta1 = _mm_srai_epi16( _mm_add_epi16( _mm_add_epi16( m[1] , m[3] ) , mmOne ) , 1 );
+      mmDelta1 = _mm_srai_epi16( _mm_add_epi16( _mm_sub_epi16( mmDelta1 , m[2] ) , mmDelta ) , 1 );
+      mmDelta1 = simdClip16( mmTcHNeg , mmTcH , mmDelta1 );
+      f[2] = simdSelect16( mmApply , simdClip16( mmMin , mmMax , _mm_add_epi16( m[2] , mmDelta1 ) ) , m[2] );
+    }
+    if( bFilterQ )
+    {
+      __m128i mmDelta2 = _mm_srai_epi16( _mm_add_epi16( _mm_add_epi16( m[6] , m[4] ) , mmOne ) , 1 );
+      mmDelta2 = _mm_srai_epi16( _mm_sub_epi16( _mm_sub_epi16( mmDelta2 , m[5] ) , mmDelta ) , 1 );
+      mmDelta2 = simdClip16( mmTcHNeg , mmTcH , mmDelta2 );
+      f[5] = simdSelect16( mmApply , simdClip16( mmMin , mmMax , _mm_add_epi16( m[5] , mmDelta2 ) ) , m[5] );
+    }
+  }
+
+  if( bPartPNoFilter )
+  {
+    f[1] = m[1];
+    f[2] = m[2];
+    f[3] = m[3];
+  }
+  if( bPartQNoFilter )
+  {
+    f[4] = m[4];
+    f[5] = m[5];
+    f[6] = m[6];
+  }
+
+  simdStoreEdgeLines4( piSrc , iOffset , iSrcStep , f );
+}
+
+/** Filter up to four lines of a chroma edge (equivalent to xPelFilterChroma on each line).
+ */
+static Void simdEdgeFilterChroma( Pel *piSrc , Int iOffset , Int iSrcStep , Int iNumLines , Int iTc , Bool bPartPNoFilter , Bool bPartQNoFilter , Int bitDepthChroma )
+{
+  if( bitDepthChroma > 10 )
+  {
+    edgeFilterChroma( piSrc, iOffset, iSrcStep, iNumLines, iTc, bPartPNoFilter, bPartQNoFilter, bitDepthChroma );
+    return;
+  }
+  __m128i m[4];
+
+  if( iOffset == 1 )
+  {
+    __m128i r[4];
+    for( Int i = 0 ; i < 4 ; i++ )
+    {
+      r[i] = ( i < iNumLines ) ? _mm_loadl_epi64( ( const __m128i * )( piSrc - 2 + iSrcStep * i ) ) : _mm_setzero_si128();
+    }
+    const __m128i t0 = _mm_unpacklo_epi16( r[0] , r[1] );
+    const __m128i t1 = _mm_unpacklo_epi16( r[2] , r[3] );
+    const __m128i u0 = _mm_unpacklo_epi32( t0 , t1 );
+    const __m128i u1 = _mm_unpackhi_epi32( t0 , t1 );
+    m[0] = u0;
+    m[1] = _mm_unpackhi_epi64( u0 , u0 );
+    m[2] = u1;
+    m[3] = _mm_unpackhi_epi64( u1 , u1 );
+  }
+  else
+  {
+    for( Int k = 0 ; k < 4 ; k++ )
+    {
+      m[k] = _mm_loadl_epi64( ( const __m128i * )( piSrc + ( k - 2 ) * iOffset ) );
+    }
+  }
+
+  const __m128i mmTc  = _mm_set1_epi16( iTc );
+  const __m128i mmMin = _mm_setzero_si128();
+  const __m128i mmMax = _mm_set1_epi16( ( 1 << bitDepthChroma ) - 1 );
+
+  // delta = ( ( ( q0 - p0 ) << 2 ) + p1 - q1 + 4 ) >> 3
+  __m128i mmDelta = _mm_slli_epi16( _mm_sub_epi16( m[2] , m[1] ) , 2 );
+  mmDelta = _mm_add_epi16( mmDelta , _mm_sub_epi16( m[0] , m[3] ) );
+  mmDelta = _mm_srai_epi16( _mm_add_epi16( mmDelta , _mm_set1_epi16( 4 ) ) , 3 );
+  mmDelta = simdClip16( _mm_sub_epi16( mmMin , mmTc ) , mmTc , mmDelta );
+
+  const __m128i mmP0 = bPartPNoFilter ? m[1] : simdClip16( mmMin , mmMax , _mm_add_epi16( m[1] , mmDelta ) );
+  const __m128i mmQ0 = bPartQNoFilter ? m[2] : simdClip16( mmMin , mmMax , _mm_sub_epi16( m[2] , mmDelta ) );
+
+  Pel p0[4], q0[4];
+  _mm_storel_epi64( ( __m128i * )p0 , mmP0 );
+  _mm_storel_epi64( ( __m128i * )q0 , mmQ0 );
+  for( Int i = 0 ; i < iNumLines ; i++ )
+  {
+    piSrc[iSrcStep * i - iOffset] = p0[i];
+    piSrc[iSrcStep * i]           = q0[i];
+  }
+}
+#endif
+
 // ====================================================================================================================
 // Constructor / destructor / create / destroy
 // ====================================================================================================================
@@ -632,17 +918,6 @@ Void TComLoopFilter::xEdgeFilterLuma( TComDataCU* const pcCU, const UInt uiAbsZo
       UInt  uiBlocksInPart = uiPelsInPart / 4 ? uiPelsInPart / 4 : 1;
       for (UInt iBlkIdx = 0; iBlkIdx<uiBlocksInPart; iBlkIdx ++)
       {
-        Int dp0 = xCalcDP( piTmpSrc+iSrcStep*(iIdx*uiPelsInPart+iBlkIdx*4+0), iOffset);
-        Int dq0 = xCalcDQ( piTmpSrc+iSrcStep*(iIdx*uiPelsInPart+iBlkIdx*4+0), iOffset);
-        Int dp3 = xCalcDP( piTmpSrc+iSrcStep*(iIdx*uiPelsInPart+iBlkIdx*4+3), iOffset);
-        Int dq3 = xCalcDQ( piTmpSrc+iSrcStep*(iIdx*uiPelsInPart+iBlkIdx*4+3), iOffset);
-        Int d0 = dp0 + dq0;
-        Int d3 = dp3 + dq3;
-
-        Int dp = dp0 + dp3;
-        Int dq = dq0 + dq3;
-        Int d =  d0 + d3;
-
         if (bPCMFilter || ppsTransquantBypassEnabledFlag)
         {
           // Check if each of PUs is I_PCM with LF disabling
@@ -654,19 +929,7 @@ Void TComLoopFilter::xEdgeFilterLuma( TComDataCU* const pcCU, const UInt uiAbsZo
           bPartQNoFilter = bPartQNoFilter || (pcCUQ->isLosslessCoded(uiPartQIdx) );
         }
 
-        if (d < iBeta)
-        {
-          Bool bFilterP = (dp < iSideThreshold);
-          Bool bFilterQ = (dq < iSideThreshold);
-
-          Bool sw =  xUseStrongFiltering( iOffset, 2*d0, iBeta, iTc, piTmpSrc+iSrcStep*(iIdx*uiPelsInPart+iBlkIdx*4+0))
-          && xUseStrongFiltering( iOffset, 2*d3, iBeta, iTc, piTmpSrc+iSrcStep*(iIdx*uiPelsInPart+iBlkIdx*4+3));
-
-          for ( Int i = 0; i < DEBLOCK_SMALLEST_BLOCK/2; i++)
-          {
-            xPelFilterLuma( piTmpSrc+iSrcStep*(iIdx*uiPelsInPart+iBlkIdx*4+i), iOffset, iTc, sw, bPartPNoFilter, bPartQNoFilter, iThrCut, bFilterP, bFilterQ, bitDepthLuma);
-          }
-        }
+        deblockingKernels.edgeFilterLuma4( piTmpSrc+iSrcStep*(iIdx*uiPelsInPart+iBlkIdx*4), iOffset, iSrcStep, iTc, iBeta, iSideThreshold, iThrCut, bPartPNoFilter, bPartQNoFilter, bitDepthLuma );
       }
     }
   }
@@ -804,9 +1067,9 @@ Void TComLoopFilter::xEdgeFilterChroma( TComDataCU* const pcCU, const UInt uiAbs
         Int iIndexTC = Clip3(0, MAX_QP+DEFAULT_INTRA_TC_OFFSET, iQP + DEFAULT_INTRA_TC_OFFSET*(ucBs - 1) + (tcOffsetDiv2 << 1));
         Int iTc =  sm_tcTable[iIndexTC]*iBitdepthScale;
 
-        for ( UInt uiStep = 0; uiStep < uiLoopLength; uiStep++ )
+        for ( UInt uiStep = 0; uiStep < uiLoopLength; uiStep += 4 )
         {
-          xPelFilterChroma( piTmpSrcChroma + iSrcStep*(uiStep+iIdx*uiLoopLength), iOffset, iTc , bPartPNoFilter, bPartQNoFilter, bitDepthChroma);
+          deblockingKernels.edgeFilterChroma( piTmpSrcChroma + iSrcStep*(uiStep+iIdx*uiLoopLength), iOffset, iSrcStep, std::min<Int>(4, uiLoopLength-uiStep), iTc, bPartPNoFilter, bPartQNoFilter, bitDepthChroma );
         }
       }
     }
@@ -827,7 +1090,7 @@ Void TComLoopFilter::xEdgeFilterChroma( TComDataCU* const pcCU, const UInt uiAbs
  \param bFilterSecondQ  decision weak filter/no filter for partQ
  \param bitDepthLuma    luma bit depth
 */
-__inline Void TComLoopFilter::xPelFilterLuma( Pel* piSrc, Int iOffset, Int tc, Bool sw, Bool bPartPNoFilter, Bool bPartQNoFilter, Int iThrCut, Bool bFilterSecondP, Bool bFilterSecondQ, const Int bitDepthLuma)
+static inline Void xPelFilterLuma( Pel* piSrc, Int iOffset, Int tc, Bool sw, Bool bPartPNoFilter, Bool bPartQNoFilter, Int iThrCut, Bool bFilterSecondP, Bool bFilterSecondQ, const Int bitDepthLuma)
 {
   Int delta;
 
@@ -898,7 +1161,7 @@ __inline Void TComLoopFilter::xPelFilterLuma( Pel* piSrc, Int iOffset, Int tc, B
  \param bPartQNoFilter  indicator to disable filtering on partQ
  \param bitDepthChroma  chroma bit depth
  */
-__inline Void TComLoopFilter::xPelFilterChroma( Pel* piSrc, Int iOffset, Int tc, Bool bPartPNoFilter, Bool bPartQNoFilter, const Int bitDepthChroma)
+static inline Void xPelFilterChroma( Pel* piSrc, Int iOffset, Int tc, Bool bPartPNoFilter, Bool bPartQNoFilter, const Int bitDepthChroma)
 {
   Int delta;
 
@@ -930,7 +1193,7 @@ __inline Void TComLoopFilter::xPelFilterChroma( Pel* piSrc, Int iOffset, Int tc,
  \param tc              tc value
  \param piSrc           pointer to picture data
  */
-__inline Bool TComLoopFilter::xUseStrongFiltering( Int offset, Int d, Int beta, Int tc, Pel* piSrc)
+static inline Bool xUseStrongFiltering( Int offset, Int d, Int beta, Int tc, Pel* piSrc)
 {
   Pel m4  = piSrc[0];
   Pel m3  = piSrc[-offset];
@@ -942,13 +1205,67 @@ __inline Bool TComLoopFilter::xUseStrongFiltering( Int offset, Int d, Int beta,
   return ( (d_strong < (beta>>3)) && (d<(beta>>2)) && ( abs(m3-m4) < ((tc*5+1)>>1)) );
 }
 
-__inline Int TComLoopFilter::xCalcDP( Pel* piSrc, Int iOffset)
+static inline Int xCalcDP( Pel* piSrc, Int iOffset)
 {
   return abs( piSrc[-iOffset*3] - 2*piSrc[-iOffset*2] + piSrc[-iOffset] ) ;
 }
 
-__inline Int TComLoopFilter::xCalcDQ( Pel* piSrc, Int iOffset)
+static inline Int xCalcDQ( Pel* piSrc, Int iOffset)
 {
   return abs( piSrc[0] - 2*piSrc[iOffset] + piSrc[iOffset*2] );
 }
+/** Decide and filter one four-line luma edge segment.
+ */
+static Void edgeFilterLuma4( Pel *piSrc, Int iOffset, Int iSrcStep, Int iTc, Int iBeta, Int iSideThreshold, Int iThrCut, Bool bPartPNoFilter, Bool bPartQNoFilter, Int bitDepthLuma )
+{
+  Int dp0 = xCalcDP( piSrc+iSrcStep*0, iOffset);
+  Int dq0 = xCalcDQ( piSrc+iSrcStep*0, iOffset);
+  Int dp3 = xCalcDP( piSrc+iSrcStep*3, iOffset);
+  Int dq3 = xCalcDQ( piSrc+iSrcStep*3, iOffset);
+  Int d0 = dp0 + dq0;
+  Int d3 = dp3 + dq3;
+
+  Int dp = dp0 + dp3;
+  Int dq = dq0 + dq3;
+  Int d =  d0 + d3;
+
+  if (d < iBeta)
+  {
+    Bool bFilterP = (dp < iSideThreshold);
+    Bool bFilterQ = (dq < iSideThreshold);
+
+    Bool sw =  xUseStrongFiltering( iOffset, 2*d0, iBeta, iTc, piSrc+iSrcStep*0)
+    && xUseStrongFiltering( iOffset, 2*d3, iBeta, iTc, piSrc+iSrcStep*3);
+
+    for ( Int i = 0; i < DEBLOCK_SMALLEST_BLOCK/2; i++)
+    {
+      xPelFilterLuma( piSrc+iSrcStep*i, iOffset, iTc, sw, bPartPNoFilter, bPartQNoFilter, iThrCut, bFilterP, bFilterQ, bitDepthLuma);
+    }
+  }
+}
+
+/** Filter iNumLines lines of a chroma edge.
+ */
+static Void edgeFilterChroma( Pel *piSrc, Int iOffset, Int iSrcStep, Int iNumLines, Int iTc, Bool bPartPNoFilter, Bool bPartQNoFilter, Int bitDepthChroma )
+{
+  for ( Int i = 0; i < iNumLines; i++ )
+  {
+    xPelFilterChroma( piSrc + iSrcStep*i, iOffset, iTc, bPartPNoFilter, bPartQNoFilter, bitDepthChroma);
+  }
+}
+
+static Void initDeblockingKernels( const SIMDLevel level )
+{
+  deblockingKernels.edgeFilterLuma4  = edgeFilterLuma4;
+  deblockingKernels.edgeFilterChroma = edgeFilterChroma;
+#if VECTOR_CODING__DEBLOCKING_FILTER && (RExt__HIGH_BIT_DEPTH_SUPPORT==0)
+  if( level >= SIMD_SSE2 )
+  {
+    deblockingKernels.edgeFilterLuma4  = simdEdgeFilterLuma4;
+    deblockingKernels.edgeFilterChroma = simdEdgeFilterChroma;
+  }
+#endif
+}
+
+static const Bool deblockingKernelsRegistered = TComSimd::registerKernels( initDeblockingKernels );
 //! \}
@@ -46,8 +46,13 @@
 #endif
 
 #include "TComPicYuv.h"
+#include "TComSimd.h"
 #include "TLibVideoIO/TVideoIOYuv.h"
 
+#if VECTOR_CODING__PICTURE_BORDER_EXTENSION && (RExt__HIGH_BIT_DEPTH_SUPPORT==0)
+#include <emmintrin.h>
+#endif
+
 //! \ingroup TLibCommon
 //! \{
 
@@ -226,6 +231,66 @@ Void  TComPicYuv::copyToPic (TComPicYuv*  pcPicYuvDst) const
 }
 
 
+#if VECTOR_CODING__PICTURE_BORDER_EXTENSION && (RExt__HIGH_BIT_DEPTH_SUPPORT==0)
+/** Fill the left and right margins of a number of rows by broadcasting the first and last samples of each row.
+ */
+static Void simdExtendRowMargins( Pel *pi , Int stride , Int width , Int height , Int marginX )
+{
+  for( Int y = 0 ; y < height ; y++ , pi += stride )
+  {
+    const __m128i mmLeft  = _mm_set1_epi16( pi[0] );
+    const __m128i mmRight = _mm_set1_epi16( pi[width-1] );
+    Pel *piLeft  = pi - marginX;
+    Pel *piRight = pi + width;
+    Int x = 0;
+    for( ; x + 8 <= marginX ; x += 8 )
+    {
+      _mm_storeu_si128( ( __m128i* )( piLeft + x ) , mmLeft );
+      _mm_storeu_si128( ( __m128i* )( piRight + x ) , mmRight );
+    }
+    for( ; x < marginX ; x++ )
+    {
+      piLeft[x]  = pi[0];
+      piRight[x] = pi[width-1];
+    }
+  }
+}
+#endif
+
+static Void extendRowMarginsScalar( Pel *pi , Int stride , Int width , Int height , Int marginX )
+{
+  for (Int y = 0; y < height; y++)
+  {
+    for (Int x = 0; x < marginX; x++ )
+    {
+      pi[ -marginX + x ] = pi[0];
+      pi[    width + x ] = pi[width-1];
+    }
+    pi += stride;
+  }
+}
+
+/// border extension kernels of the selected instruction set level (see TComSimd)
+struct BorderExtensionKernels
+{
+  Void (*extendRowMargins)( Pel *pi , Int stride , Int width , Int height , Int marginX );
+};
+
+static BorderExtensionKernels borderExtensionKernels;
+
+static Void initBorderExtensionKernels( const SIMDLevel level )
+{
+  borderExtensionKernels.extendRowMargins = extendRowMarginsScalar;
+#if VECTOR_CODING__PICTURE_BORDER_EXTENSION && (RExt__HIGH_BIT_DEPTH_SUPPORT==0)
+  if( level >= SIMD_SSE2 )
+  {
+    borderExtensionKernels.extendRowMargins = simdExtendRowMargins;
+  }
+#endif
+}
+
+static const Bool borderExtensionKernelsRegistered = TComSimd::registerKernels( initBorderExtensionKernels );
+
 Void TComPicYuv::extendPicBorder ()
 {
   if ( m_bIsBorderExtended )
@@ -233,46 +298,55 @@ Void TComPicYuv::extendPicBorder ()
     return;
   }
 
+  extendPicBorder( 0, m_picHeight );
+}
+
+/** Extend the border of the luma rows [startY, endY) (and the co-located chroma rows).
+ *  The top margin is filled when startY is 0 and the bottom margin when endY is the picture height,
+ *  at which point the picture is marked as extended; rows should therefore be extended in top-to-bottom order.
+ */
+Void TComPicYuv::extendPicBorder ( const Int startY, const Int endY )
+{
   for(Int comp=0; comp<getNumberValidComponents(); comp++)
   {
     const ComponentID compId=ComponentID(comp);
-    Pel *piTxt=getAddr(compId); // piTxt = point to (0,0) of image within bigger picture.
     const Int stride=getStride(compId);
     const Int width=getWidth(compId);
     const Int height=getHeight(compId);
     const Int marginX=getMarginX(compId);
     const Int marginY=getMarginY(compId);
+    const Int compStartY=startY >> getComponentScaleY(compId);
+    const Int compEndY=std::min(height, endY >> getComponentScaleY(compId));
+    Pel*  pi = getAddr(compId) + compStartY*stride; // pi = point to (0,compStartY) of image within bigger picture.
 
-    Pel*  pi = piTxt;
     // do left and right margins
-    for (Int y = 0; y < height; y++)
+    borderExtensionKernels.extendRowMargins(pi, stride, width, compEndY-compStartY, marginX);
+
+    if (compEndY == height)
     {
-      for (Int x = 0; x < marginX; x++ )
+      pi = getAddr(compId) + (height-1)*stride - marginX;
+      // pi is now (-marginX, height-1)
+      for (Int y = 0; y < marginY; y++ )
       {
-        pi[ -marginX + x ] = pi[0];
-        pi[    width + x ] = pi[width-1];
+        ::memcpy( pi + (y+1)*stride, pi, sizeof(Pel)*(width + (marginX<<1)) );
       }
-      pi += stride;
-    }
-
-    // pi is now the (0,height) (bottom left of image within bigger picture
-    pi -= (stride + marginX);
-    // pi is now the (-marginX, height-1)
-    for (Int y = 0; y < marginY; y++ )
-    {
-      ::memcpy( pi + (y+1)*stride, pi, sizeof(Pel)*(width + (marginX<<1)) );
     }
 
-    // pi is still (-marginX, height-1)
-    pi -= ((height-1) * stride);
-    // pi is now (-marginX, 0)
-    for (Int y = 0; y < marginY; y++ )
+    if (compStartY == 0)
     {
-      ::memcpy( pi - (y+1)*stride, pi, sizeof(Pel)*(width + (marginX<<1)) );
+      pi = getAddr(compId) - marginX;
+      // pi is now (-marginX, 0)
+      for (Int y = 0; y < marginY; y++ )
+      {
+        ::memcpy( pi - (y+1)*stride, pi, sizeof(Pel)*(width + (marginX<<1)) );
+      }
     }
   }
 
-  m_bIsBorderExtended = true;
+  if (endY >= m_picHeight)
+  {
+    m_bIsBorderExtended = true;
+  }
 }
 
 
@@ -162,6 +162,7 @@ public:
 
   //  Extend function of picture buffer
   Void          extendPicBorder   ();
+  Void          extendPicBorder   (const Int startY, const Int endY); ///< extend the border of luma rows [startY, endY) only
 
   //  Dump picture
   Void          dump              (const std::string &fileName, const BitDepths &bitDepths, const Bool bAppend=false, const Bool bForceTo8Bit=false) const ;
@@ -39,10 +39,29 @@
 #include "TComPrediction.h"
 #include "TComPic.h"
 #include "TComTU.h"
+#include "TComSimd.h"
+
+#if VECTOR_CODING__INTRA_PREDICTION && (RExt__HIGH_BIT_DEPTH_SUPPORT==0)
+#include <emmintrin.h>
+#endif
 
 //! \ingroup TLibCommon
 //! \{
 
+// ====================================================================================================================
+// Kernels
+// ====================================================================================================================
+
+static Void xPredIntraPlanar( const Pel* pSrc, Int srcStride, Pel* rpDst, Int dstStride, UInt width, UInt height );
+
+/// intra prediction kernels of the selected instruction set level (see TComSimd)
+struct IntraPredictionKernels
+{
+  Void (*predPlanar)( const Pel* pSrc, Int srcStride, Pel* rpDst, Int dstStride, UInt width, UInt height );
+};
+
+static IntraPredictionKernels intraPredictionKernels;
+
 // ====================================================================================================================
 // Tables
 // ====================================================================================================================
@@ -448,7 +467,7 @@ Void TComPrediction::predIntraAng( const ComponentID compID, UInt uiDirMode, Pel
 
     if ( uiDirMode == PLANAR_IDX )
     {
-      xPredIntraPlanar( ptrSrc+sw+1, sw, pDst, uiStride, iWidth, iHeight );
+      intraPredictionKernels.predPlanar( ptrSrc+sw+1, sw, pDst, uiStride, iWidth, iHeight );
     }
     else
     {
@@ -728,7 +747,7 @@ Void TComPrediction::getMvPredAMVP( TComDataCU* pcCU, UInt uiPartIdx, UInt uiPar
  * This function derives the prediction samples for planar mode (intra coding).
  */
 //NOTE: Bit-Limit - 24-bit source
-Void TComPrediction::xPredIntraPlanar( const Pel* pSrc, Int srcStride, Pel* rpDst, Int dstStride, UInt width, UInt height )
+static Void xPredIntraPlanar( const Pel* pSrc, Int srcStride, Pel* rpDst, Int dstStride, UInt width, UInt height )
 {
   assert(width <= height);
 
@@ -780,6 +799,64 @@ Void TComPrediction::xPredIntraPlanar( const Pel* pSrc, Int srcStride, Pel* rpDs
   }
 }
 
+#if VECTOR_CODING__INTRA_PREDICTION && (RExt__HIGH_BIT_DEPTH_SUPPORT==0)
+/** SSE2 version of xPredIntraPlanar, four samples at a time. The vertical interpolation is accumulated row by row
+ *  as in the scalar function; the horizontal one starts each row at left + (x+1)*(topRight-left).
+ */
+static Void simdPredIntraPlanar( const Pel* pSrc, Int srcStride, Pel* rpDst, Int dstStride, UInt width, UInt height )
+{
+  assert(width <= height);
+  assert(width <= MAX_CU_SIZE && ( width & 3 ) == 0);
+
+  const UInt shift1Dhor = g_aucConvertToBit[ width ] + 2;
+  const UInt shift1Dver = g_aucConvertToBit[ height ] + 2;
+  const Int  iWidth     = Int( width );
+  const Int  iHeight    = Int( height );
+  const Int  bottomLeft = pSrc[iHeight*srcStride-1];
+  const Int  topRight   = pSrc[iWidth-srcStride];
+
+  const __m128i mmZero     = _mm_setzero_si128();
+  const __m128i mmShiftVer = _mm_cvtsi32_si128( shift1Dver );
+  const __m128i mmShift    = _mm_cvtsi32_si128( shift1Dhor + 1 );
+  __m128i mmTopRow   [MAX_CU_SIZE/4];
+  __m128i mmBottomRow[MAX_CU_SIZE/4];
+  for( Int x = 0; x < iWidth; x += 4 )
+  {
+    const __m128i mmAbove = _mm_unpacklo_epi16( _mm_loadl_epi64( ( const __m128i * )( pSrc + x - srcStride ) ), mmZero );
+    mmBottomRow[x >> 2] = _mm_sub_epi32( _mm_set1_epi32( bottomLeft ), mmAbove );
+    mmTopRow   [x >> 2] = _mm_sll_epi32( mmAbove, mmShiftVer );
+  }
+
+  for( Int y = 0; y < iHeight; y++ )
+  {
+    const Int left  = pSrc[y*srcStride-1];
+    const Int right = topRight - left;
+    const __m128i mmHorStep = _mm_set1_epi32( 4 * right );
+    __m128i mmHorPred = _mm_add_epi32( _mm_set1_epi32( ( left << shift1Dhor ) + iWidth ), _mm_set_epi32( 4 * right, 3 * right, 2 * right, right ) );
+    for( Int x = 0; x < iWidth; x += 4 )
+    {
+      mmTopRow[x >> 2] = _mm_add_epi32( mmTopRow[x >> 2], mmBottomRow[x >> 2] );
+      const __m128i mmPred = _mm_sra_epi32( _mm_add_epi32( mmHorPred, mmTopRow[x >> 2] ), mmShift );
+      _mm_storel_epi64( ( __m128i * )( rpDst + y * dstStride + x ), _mm_packs_epi32( mmPred, mmPred ) );
+      mmHorPred = _mm_add_epi32( mmHorPred, mmHorStep );
+    }
+  }
+}
+#endif
+
+static Void initIntraPredictionKernels( const SIMDLevel level )
+{
+  intraPredictionKernels.predPlanar = xPredIntraPlanar;
+#if VECTOR_CODING__INTRA_PREDICTION && (RExt__HIGH_BIT_DEPTH_SUPPORT==0)
+  if( level >= SIMD_SSE2 )
+  {
+    intraPredictionKernels.predPlanar = simdPredIntraPlanar;
+  }
+#endif
+}
+
+static const Bool intraPredictionKernelsRegistered = TComSimd::registerKernels( initIntraPredictionKernels );
+
 /** Function for filtering intra DC predictor.
  * \param pSrc pointer to reconstructed sample array
  * \param iSrcStride the stride of the reconstructed sample array
@@ -40,15 +40,32 @@
 #include <limits>
 #include "TComRom.h"
 #include "TComRdCost.h"
+#include "TComSimd.h"
 
 #if VECTOR_CODING__DISTORTION_CALCULATIONS && (RExt__HIGH_BIT_DEPTH_SUPPORT==0)
 #include <emmintrin.h>
 #include <xmmintrin.h>
+#if VECTOR_CODING__AVX2_KERNELS
+#include <immintrin.h>
+#endif
 #endif
 
 //! \ingroup TLibCommon
 //! \{
 
+static Distortion calcHADs8x8( const Pel *piOrg, const Pel *piCur, Int iStrideOrg, Int iStrideCur, Int bitDepth );
+
+#if VECTOR_CODING__DISTORTION_CALCULATIONS && (RExt__HIGH_BIT_DEPTH_SUPPORT==0)
+/// distortion kernels of the selected instruction set level (see TComSimd)
+struct DistortionKernels
+{
+  Distortion (*sad)    ( const Pel *piOrg, Int iStrideOrg, const Pel *piCur, Int iStrideCur, Int iCols, Int iRows ); ///< iCols must be a multiple of 4 and the samples must have at most 10 bits
+  Distortion (*hads8x8)( const Pel *piOrg, const Pel *piCur, Int iStrideOrg, Int iStrideCur, Int bitDepth );
+};
+
+static DistortionKernels distortionKernels;
+#endif
+
 TComRdCost::TComRdCost()
 {
   init();
@@ -305,11 +322,11 @@ Distortion TComRdCost::calcHAD( Int bitDepth, const Pel* pi0, Int iStride0, cons
     {
       for ( x=0; x<iWidth; x+= 8 )
       {
-        uiSum += xCalcHADs8x8( &pi0[x], &pi1[x], iStride0, iStride1, 1
 #if VECTOR_CODING__DISTORTION_CALCULATIONS && (RExt__HIGH_BIT_DEPTH_SUPPORT==0)
-          , bitDepth
+        uiSum += distortionKernels.hads8x8( &pi0[x], &pi1[x], iStride0, iStride1, bitDepth );
+#else
+        uiSum += calcHADs8x8( &pi0[x], &pi1[x], iStride0, iStride1, bitDepth );
 #endif
-          );
       }
       pi0 += iStride0*8;
       pi1 += iStride1*8;
@@ -470,19 +487,8 @@ inline __m128i simdAbs32b( __m128i m )
   return( _mm_or_si128( _mm_and_si128( mask , m ) , _mm_andnot_si128( mask , tmp ) ) );
 }
 
-UInt simdHADs8x8( const Pel * piOrg, const Pel * piCur, Int iStrideOrg, Int iStrideCur )
+static UInt simdHADs8x8Core( __m128i mmDiff[8][2] )
 {
-  __m128i mmDiff[8][2];
-  __m128i mmZero = _mm_setzero_si128();
-  for( Int n = 0 ; n < 8 ; n++ , piOrg += iStrideOrg , piCur += iStrideCur )
-  {
-    __m128i diff = _mm_sub_epi16( _mm_loadu_si128( ( __m128i* )piOrg ) , _mm_loadu_si128( ( __m128i* )piCur ) );
-    // sign extension
-    __m128i mask = _mm_cmplt_epi16( diff , mmZero );
-    mmDiff[n][0] = _mm_unpacklo_epi16( diff , mask );
-    mmDiff[n][1] = _mm_unpackhi_epi16( diff , mask );
-  }
-
   // transpose
   simd8x8Transpose32b( &mmDiff[0][0] );
 
@@ -509,6 +515,202 @@ UInt simdHADs8x8( const Pel * piOrg, const Pel * piCur, Int iStrideOrg, Int iStr
 
   return( sad );
 }
+
+static Distortion simdHADs8x8( const Pel * piOrg, const Pel * piCur, Int iStrideOrg, Int iStrideCur, Int bitDepth )
+{
+  if( bitDepth > 10 )
+  {
+    return calcHADs8x8( piOrg, piCur, iStrideOrg, iStrideCur, bitDepth );
+  }
+  __m128i mmDiff[8][2];
+  __m128i mmZero = _mm_setzero_si128();
+  for( Int n = 0 ; n < 8 ; n++ , piOrg += iStrideOrg , piCur += iStrideCur )
+  {
+    __m128i diff = _mm_sub_epi16( _mm_loadu_si128( ( __m128i* )piOrg ) , _mm_loadu_si128( ( __m128i* )piCur ) );
+    // sign extension
+    __m128i mask = _mm_cmplt_epi16( diff , mmZero );
+    mmDiff[n][0] = _mm_unpacklo_epi16( diff , mask );
+    mmDiff[n][1] = _mm_unpackhi_epi16( diff , mask );
+  }
+
+  return( simdHADs8x8Core( mmDiff ) );
+}
+
+UInt simdHADs8x8( const TCoeff * piDiff )
+{
+  __m128i mmDiff[8][2];
+  for( Int n = 0 ; n < 8 ; n++ , piDiff += 8 )
+  {
+    mmDiff[n][0] = _mm_loadu_si128( ( const __m128i* )piDiff );
+    mmDiff[n][1] = _mm_loadu_si128( ( const __m128i* )( piDiff + 4 ) );
+  }
+
+  return( simdHADs8x8Core( mmDiff ) );
+}
+
+static Distortion sadScalar( const Pel *piOrg, Int iStrideOrg, const Pel *piCur, Int iStrideCur, Int iCols, Int iRows )
+{
+  Distortion uiSum = 0;
+  for( ; iRows != 0; iRows-- )
+  {
+    for( Int n = 0; n < iCols; n++ )
+    {
+      uiSum += abs( piOrg[n] - piCur[n] );
+    }
+    piOrg += iStrideOrg;
+    piCur += iStrideCur;
+  }
+  return uiSum;
+}
+
+static Distortion simdSAD( const Pel *piOrg, Int iStrideOrg, const Pel *piCur, Int iStrideCur, Int iCols, Int iRows )
+{
+  Distortion uiSum = 0;
+  if( ( iCols & 0x07 ) == 0 )
+  {
+    for( ; iRows != 0; iRows-- )
+    {
+      uiSum += simdSADLine8n16b( piOrg , piCur , iCols );
+      piOrg += iStrideOrg;
+      piCur += iStrideCur;
+    }
+  }
+  else
+  {
+    for( ; iRows != 0; iRows-- )
+    {
+      uiSum += simdSADLine4n16b( piOrg , piCur , iCols );
+      piOrg += iStrideOrg;
+      piCur += iStrideCur;
+    }
+  }
+  return uiSum;
+}
+
+#if VECTOR_CODING__AVX2_KERNELS
+SIMD_TARGET_AVX2 static inline Int simdHorizontalSumAVX2( const __m256i &mmSum )
+{
+  __m128i sum = _mm_add_epi32( _mm256_castsi256_si128( mmSum ), _mm256_extracti128_si256( mmSum, 1 ) );
+  sum = _mm_add_epi32( sum , _mm_shuffle_epi32( sum , _MM_SHUFFLE( 2 , 3 , 0 , 1 ) ) );
+  sum = _mm_add_epi32( sum , _mm_shuffle_epi32( sum , _MM_SHUFFLE( 1 , 0 , 3 , 2 ) ) );
+  return( _mm_cvtsi128_si32( sum ) );
+}
+
+SIMD_TARGET_AVX2 static Distortion simdSADAVX2( const Pel *piOrg, Int iStrideOrg, const Pel *piCur, Int iStrideCur, Int iCols, Int iRows )
+{
+  if( iCols & 0x0f )
+  {
+    return simdSAD( piOrg, iStrideOrg, piCur, iStrideCur, iCols, iRows );
+  }
+  const __m256i mmOne = _mm256_set1_epi16( 1 );
+  __m256i mmSum = _mm256_setzero_si256();
+  for( ; iRows != 0; iRows-- )
+  {
+    // the absolute differences of 10-bit samples can be summed in 16 bits for up to 32 vectors
+    __m256i mmRowSum = _mm256_setzero_si256();
+    for( Int n = 0; n < iCols; n += 16 )
+    {
+      const __m256i org = _mm256_loadu_si256( ( const __m256i* )( piOrg + n ) );
+      const __m256i cur = _mm256_loadu_si256( ( const __m256i* )( piCur + n ) );
+      mmRowSum = _mm256_add_epi16( mmRowSum, _mm256_abs_epi16( _mm256_sub_epi16( org, cur ) ) );
+    }
+    mmSum = _mm256_add_epi32( mmSum, _mm256_madd_epi16( mmRowSum, mmOne ) );
+    piOrg += iStrideOrg;
+    piCur += iStrideCur;
+  }
+  return simdHorizontalSumAVX2( mmSum );
+}
+
+SIMD_TARGET_AVX2 static inline Void simdHAD1D8x8AVX2( __m256i *m )
+{
+  for( Int step = 4; step != 0; step >>= 1 )
+  {
+    for( Int n = 0; n < 8; n++ )
+    {
+      if( ( n & step ) == 0 )
+      {
+        const __m256i a = m[n];
+        const __m256i b = m[n + step];
+        m[n]        = _mm256_add_epi32( a, b );
+        m[n + step] = _mm256_sub_epi32( a, b );
+      }
+    }
+  }
+}
+
+SIMD_TARGET_AVX2 static inline Void simd8x8Transpose32bAVX2( __m256i *m )
+{
+  __m256i t[8], u[8];
+  for( Int n = 0; n < 8; n += 4 )
+  {
+    t[n  ] = _mm256_unpacklo_epi32( m[n  ], m[n+1] );
+    t[n+1] = _mm256_unpackhi_epi32( m[n  ], m[n+1] );
+    t[n+2] = _mm256_unpacklo_epi32( m[n+2], m[n+3] );
+    t[n+3] = _mm256_unpackhi_epi32( m[n+2], m[n+3] );
+    u[n  ] = _mm256_unpacklo_epi64( t[n  ], t[n+2] );
+    u[n+1] = _mm256_unpackhi_epi64( t[n  ], t[n+2] );
+    u[n+2] = _mm256_unpacklo_epi64( t[n+1], t[n+3] );
+    u[n+3] = _mm256_unpackhi_epi64( t[n+1], t[n+3] );
+  }
+  for( Int n = 0; n < 4; n++ )
+  {
+    m[n  ] = _mm256_permute2x128_si256( u[n], u[n+4], 0x20 );
+    m[n+4] = _mm256_permute2x128_si256( u[n], u[n+4], 0x31 );
+  }
+}
+
+SIMD_TARGET_AVX2 static Distortion simdHADs8x8AVX2( const Pel *piOrg, const Pel *piCur, Int iStrideOrg, Int iStrideCur, Int bitDepth )
+{
+  if( bitDepth > 10 )
+  {
+    return calcHADs8x8( piOrg, piCur, iStrideOrg, iStrideCur, bitDepth );
+  }
+  // one row of 32-bit differences per register
+  __m256i m[8];
+  for( Int n = 0 ; n < 8 ; n++ , piOrg += iStrideOrg , piCur += iStrideCur )
+  {
+    m[n] = _mm256_cvtepi16_epi32( _mm_sub_epi16( _mm_loadu_si128( ( const __m128i* )piOrg ) , _mm_loadu_si128( ( const __m128i* )piCur ) ) );
+  }
+
+  // vertical
+  simdHAD1D8x8AVX2( m );
+
+  // horizontal
+  simd8x8Transpose32bAVX2( m );
+  simdHAD1D8x8AVX2( m );
+
+  __m256i mmSum = _mm256_abs_epi32( m[0] );
+  for( Int n = 1 ; n < 8 ; n++ )
+  {
+    mmSum = _mm256_add_epi32( mmSum , _mm256_abs_epi32( m[n] ) );
+  }
+
+  UInt sad = simdHorizontalSumAVX2( mmSum );
+  sad = ( sad + 2 ) >> 2;
+
+  return( sad );
+}
+#endif
+
+static Void initDistortionKernels( const SIMDLevel level )
+{
+  distortionKernels.sad     = sadScalar;
+  distortionKernels.hads8x8 = calcHADs8x8;
+  if( level >= SIMD_SSE2 )
+  {
+    distortionKernels.sad     = simdSAD;
+    distortionKernels.hads8x8 = simdHADs8x8;
+  }
+#if VECTOR_CODING__AVX2_KERNELS
+  if( level >= SIMD_AVX2 )
+  {
+    distortionKernels.sad     = simdSADAVX2;
+    distortionKernels.hads8x8 = simdHADs8x8AVX2;
+  }
+#endif
+}
+
+static const Bool distortionKernelsRegistered = TComSimd::registerKernels( initDistortionKernels );
 #endif
 
 // --------------------------------------------------------------------------------------------------------------------
@@ -533,24 +735,7 @@ Distortion TComRdCost::xGetSAD( DistParam* pcDtParam )
 #if VECTOR_CODING__DISTORTION_CALCULATIONS && (RExt__HIGH_BIT_DEPTH_SUPPORT==0)
   if( pcDtParam->bitDepth <= 10 )
   {
-    if( ( iCols & 0x07 ) == 0 )
-    {
-      for( Int iRows   = pcDtParam->iRows ; iRows != 0; iRows-- )
-      {
-        uiSum += simdSADLine8n16b( piOrg , piCur , iCols );
-        piOrg += iStrideOrg;
-        piCur += iStrideCur;
-      }
-    }
-    else
-    {
-      for( Int  iRows   = pcDtParam->iRows; iRows != 0; iRows-- )
-      {
-        uiSum += simdSADLine4n16b( piOrg , piCur , iCols );
-        piOrg += iStrideOrg;
-        piCur += iStrideCur;
-      }
-    }
+    uiSum = distortionKernels.sad( piOrg, iStrideOrg, piCur, iStrideCur, iCols, pcDtParam->iRows );
   }
   else
   {
@@ -594,12 +779,7 @@ Distortion TComRdCost::xGetSAD4( DistParam* pcDtParam )
 #if VECTOR_CODING__DISTORTION_CALCULATIONS && (RExt__HIGH_BIT_DEPTH_SUPPORT==0)
   if( pcDtParam->bitDepth <= 10 )
   {
-    for( ; iRows != 0; iRows-=iSubStep )
-    {
-      uiSum += simdSADLine4n16b( piOrg , piCur , 4 );
-      piOrg += iStrideOrg;
-      piCur += iStrideCur;
-    }
+    uiSum = distortionKernels.sad( piOrg, iStrideOrg, piCur, iStrideCur, 4, iRows >> iSubShift );
   }
   else
   {
@@ -641,12 +821,7 @@ Distortion TComRdCost::xGetSAD8( DistParam* pcDtParam )
 #if VECTOR_CODING__DISTORTION_CALCULATIONS && (RExt__HIGH_BIT_DEPTH_SUPPORT==0)
   if( pcDtParam->bitDepth <= 10 )
   {
-    for( ; iRows != 0; iRows-=iSubStep )
-    {
-      uiSum += simdSADLine8n16b( piOrg , piCur , 8 );
-      piOrg += iStrideOrg;
-      piCur += iStrideCur;
-    }
+    uiSum = distortionKernels.sad( piOrg, iStrideOrg, piCur, iStrideCur, 8, iRows >> iSubShift );
   }
   else
   {
@@ -692,12 +867,7 @@ Distortion TComRdCost::xGetSAD16( DistParam* pcDtParam )
 #if VECTOR_CODING__DISTORTION_CALCULATIONS && (RExt__HIGH_BIT_DEPTH_SUPPORT==0)
   if( pcDtParam->bitDepth <= 10 )
   {
-    for( ; iRows != 0; iRows-=iSubStep )
-    {
-      uiSum += simdSADLine8n16b( piOrg , piCur , 16 );
-      piOrg += iStrideOrg;
-      piCur += iStrideCur;
-    }
+    uiSum = distortionKernels.sad( piOrg, iStrideOrg, piCur, iStrideCur, 16, iRows >> iSubShift );
   }
   else
   {
@@ -787,12 +957,7 @@ Distortion TComRdCost::xGetSAD16N( DistParam* pcDtParam )
 #if VECTOR_CODING__DISTORTION_CALCULATIONS && (RExt__HIGH_BIT_DEPTH_SUPPORT==0)
   if( pcDtParam->bitDepth <= 10 )
   {
-    for( ; iRows != 0; iRows-=iSubStep )
-    {
-      uiSum += simdSADLine8n16b( piOrg , piCur , iCols );
-      piOrg += iStrideOrg;
-      piCur += iStrideCur;
-    }
+    uiSum = distortionKernels.sad( piOrg, iStrideOrg, piCur, iStrideCur, iCols, iRows >> iSubShift );
   }
   else
   {
@@ -848,12 +1013,7 @@ Distortion TComRdCost::xGetSAD32( DistParam* pcDtParam )
 #if VECTOR_CODING__DISTORTION_CALCULATIONS && (RExt__HIGH_BIT_DEPTH_SUPPORT==0)
   if( pcDtParam->bitDepth <= 10 )
   {
-    for( ; iRows != 0; iRows-=iSubStep )
-    {
-      uiSum += simdSADLine8n16b( piOrg , piCur , 32 );
-      piOrg += iStrideOrg;
-      piCur += iStrideCur;
-    }
+    uiSum = distortionKernels.sad( piOrg, iStrideOrg, piCur, iStrideCur, 32, iRows >> iSubShift );
   }
   else
   {
@@ -923,12 +1083,7 @@ Distortion TComRdCost::xGetSAD24( DistParam* pcDtParam )
 #if VECTOR_CODING__DISTORTION_CALCULATIONS && (RExt__HIGH_BIT_DEPTH_SUPPORT==0)
   if( pcDtParam->bitDepth <= 10 )
   {
-    for( ; iRows != 0; iRows-=iSubStep )
-    {
-      uiSum += simdSADLine8n16b( piOrg , piCur , 24 );
-      piOrg += iStrideOrg;
-      piCur += iStrideCur;
-    }
+    uiSum = distortionKernels.sad( piOrg, iStrideOrg, piCur, iStrideCur, 24, iRows >> iSubShift );
   }
   else
   {
@@ -990,12 +1145,7 @@ Distortion TComRdCost::xGetSAD64( DistParam* pcDtParam )
 #if VECTOR_CODING__DISTORTION_CALCULATIONS && (RExt__HIGH_BIT_DEPTH_SUPPORT==0)
   if( pcDtParam->bitDepth <= 10 )
   {
-    for( ; iRows != 0; iRows-=iSubStep )
-    {
-      uiSum += simdSADLine8n16b( piOrg , piCur , 64 );
-      piOrg += iStrideOrg;
-      piCur += iStrideCur;
-    }
+    uiSum = distortionKernels.sad( piOrg, iStrideOrg, piCur, iStrideCur, 64, iRows >> iSubShift );
   }
   else
   {
@@ -1097,12 +1247,7 @@ Distortion TComRdCost::xGetSAD48( DistParam* pcDtParam )
 #if VECTOR_CODING__DISTORTION_CALCULATIONS && (RExt__HIGH_BIT_DEPTH_SUPPORT==0)
   if( pcDtParam->bitDepth <= 10 )
   {
-    for( ; iRows != 0; iRows-=iSubStep )
-    {
-      uiSum += simdSADLine8n16b( piOrg , piCur , 48 );
-      piOrg += iStrideOrg;
-      piCur += iStrideCur;
-    }
+    uiSum = distortionKernels.sad( piOrg, iStrideOrg, piCur, iStrideCur, 48, iRows >> iSubShift );
   }
   else
   {
@@ -1642,22 +1787,11 @@ Distortion TComRdCost::xCalcHADs4x4( const Pel *piOrg, const Pel *piCur, Int iSt
   return satd;
 }
 
-Distortion TComRdCost::xCalcHADs8x8( const Pel *piOrg, const Pel *piCur, Int iStrideOrg, Int iStrideCur, Int iStep
-#if VECTOR_CODING__DISTORTION_CALCULATIONS && (RExt__HIGH_BIT_DEPTH_SUPPORT==0)
-  , Int bitDepth
-#endif
-  )
+static Distortion calcHADs8x8( const Pel *piOrg, const Pel *piCur, Int iStrideOrg, Int iStrideCur, Int bitDepth )
 {
-#if VECTOR_CODING__DISTORTION_CALCULATIONS && (RExt__HIGH_BIT_DEPTH_SUPPORT==0)
-  if( bitDepth <= 10 )
-  {
-    return( simdHADs8x8( piOrg , piCur , iStrideOrg , iStrideCur ) );
-  }
-#endif
   Int k, i, j, jj;
   Distortion sad = 0;
   TCoeff diff[64], m1[8][8], m2[8][8], m3[8][8];
-  assert( iStep == 1 );
   for( k = 0; k < 64; k += 8 )
   {
     diff[k+0] = piOrg[0] - piCur[0];
@@ -1772,15 +1906,16 @@ Distortion TComRdCost::xGetHADs( DistParam* pcDtParam )
   {
     Int  iOffsetOrg = iStrideOrg<<3;
     Int  iOffsetCur = iStrideCur<<3;
+    assert( iStep == 1 );
     for ( y=0; y<iRows; y+= 8 )
     {
       for ( x=0; x<iCols; x+= 8 )
       {
-        uiSum += xCalcHADs8x8( &piOrg[x], &piCur[x*iStep], iStrideOrg, iStrideCur, iStep
 #if VECTOR_CODING__DISTORTION_CALCULATIONS && (RExt__HIGH_BIT_DEPTH_SUPPORT==0)
-          , pcDtParam->bitDepth
+        uiSum += distortionKernels.hads8x8( &piOrg[x], &piCur[x], iStrideOrg, iStrideCur, pcDtParam->bitDepth );
+#else
+        uiSum += calcHADs8x8( &piOrg[x], &piCur[x], iStrideOrg, iStrideCur, pcDtParam->bitDepth );
 #endif
-                            );
       }
       piOrg += iOffsetOrg;
       piCur += iOffsetCur;
@@ -198,11 +198,6 @@ private:
   static Distortion xGetHADs          ( DistParam* pcDtParam );
   static Distortion xCalcHADs2x2      ( const Pel *piOrg, const Pel *piCurr, Int iStrideOrg, Int iStrideCur, Int iStep );
   static Distortion xCalcHADs4x4      ( const Pel *piOrg, const Pel *piCurr, Int iStrideOrg, Int iStrideCur, Int iStep );
-  static Distortion xCalcHADs8x8      ( const Pel *piOrg, const Pel *piCurr, Int iStrideOrg, Int iStrideCur, Int iStep
-#if VECTOR_CODING__DISTORTION_CALCULATIONS && (RExt__HIGH_BIT_DEPTH_SUPPORT==0)
-                                      , Int bitDepth
-#endif
-                                      );
 
 public:
 
@@ -210,6 +205,10 @@ public:
 
 };// END CLASS DEFINITION TComRdCost
 
+#if VECTOR_CODING__DISTORTION_CALCULATIONS && (RExt__HIGH_BIT_DEPTH_SUPPORT==0)
+UInt simdHADs8x8( const TCoeff * piDiff ); ///< 8x8 Hadamard of a block of 32-bit differences
+#endif
+
 //! \}
 
 #endif // __TCOMRDCOST__
@@ -39,20 +39,321 @@
 #include <assert.h>
 #include "TComRdCost.h"
 #include "TComRdCostWeightPrediction.h"
+#include "TComSimd.h"
+
+#if VECTOR_CODING__WEIGHTED_PREDICTION && (RExt__HIGH_BIT_DEPTH_SUPPORT==0)
+#include <emmintrin.h>
+#endif
 
 static Distortion xCalcHADs2x2w( const WPScalingParam &wpCur, const Pel *piOrg, const Pel *piCurr, Int iStrideOrg, Int iStrideCur, Int iStep );
 static Distortion xCalcHADs4x4w( const WPScalingParam &wpCur, const Pel *piOrg, const Pel *piCurr, Int iStrideOrg, Int iStrideCur, Int iStep );
 static Distortion xCalcHADs8x8w( const WPScalingParam &wpCur, const Pel *piOrg, const Pel *piCurr, Int iStrideOrg, Int iStrideCur, Int iStep );
+static Distortion xCalcHADs4x4Diff( const TCoeff *diff );
+
+/// weighted distortion kernels of the selected instruction set level (see TComSimd)
+struct WeightedDistortionKernels
+{
+  Distortion (*sad)    ( DistParam* pcDtParam );
+  Distortion (*sse)    ( DistParam* pcDtParam );
+  Distortion (*hads4x4)( const WPScalingParam &wpCur, const Pel *piOrg, const Pel *piCurr, Int iStrideOrg, Int iStrideCur, Int iStep );
+  Distortion (*hads8x8)( const WPScalingParam &wpCur, const Pel *piOrg, const Pel *piCurr, Int iStrideOrg, Int iStrideCur, Int iStep );
+};
+
+static WeightedDistortionKernels weightedDistortionKernels;
+
+
+#if VECTOR_CODING__WEIGHTED_PREDICTION && (RExt__HIGH_BIT_DEPTH_SUPPORT==0)
+// The scalar distortion functions below differ only in whether the weighted prediction is truncated to Pel
+// and whether it is clipped to the sample range; the kernels take these as flags and reproduce each variant
+// exactly. The default weight (w0 == 1<<shift) gives ((w0*x + round) >> shift) == x, so it needs no special case.
+
+static inline Int simdScalarWeightedPred( Int cur, Int w0, Int round, Int shift, Int offset, Bool bTruncate, Bool bClip, Int maxValue )
+{
+  Int pred = ( ( w0*cur + round ) >> shift ) + offset;
+  if( bTruncate )
+  {
+    pred = Pel( pred );
+  }
+  return bClip ? Clip3( 0, maxValue, pred ) : pred;
+}
+
+static inline __m128i simdSignExtend16Lo( const __m128i &mm )
+{
+  return _mm_srai_epi32( _mm_unpacklo_epi16( mm, mm ), 16 );
+}
+
+static inline __m128i simdSignExtend16Hi( const __m128i &mm )
+{
+  return _mm_srai_epi32( _mm_unpackhi_epi16( mm, mm ), 16 );
+}
+
+static inline __m128i simdAbs32( const __m128i &mm )
+{
+  const __m128i mmSign = _mm_srai_epi32( mm, 31 );
+  return _mm_sub_epi32( _mm_xor_si128( mm, mmSign ), mmSign );
+}
+
+static inline __m128i simdClip32( const __m128i &mm, const __m128i &mmMax )
+{
+  __m128i mmRes = _mm_andnot_si128( _mm_srai_epi32( mm, 31 ), mm );
+  const __m128i mmGt = _mm_cmpgt_epi32( mmRes, mmMax );
+  return _mm_or_si128( _mm_and_si128( mmGt, mmMax ), _mm_andnot_si128( mmGt, mmRes ) );
+}
+
+//! weighted prediction of eight samples as two vectors of 32-bit values
+static inline Void simdWeightedPred( const __m128i &mmCur, const __m128i &mmWeight, const __m128i &mmRound, const __m128i &mmShift, const __m128i &mmOffset,
+                                     Bool bTruncate, Bool bClip, const __m128i &mmMax, __m128i &mmLo, __m128i &mmHi )
+{
+  const __m128i mmProdLo = _mm_mullo_epi16( mmCur, mmWeight );
+  const __m128i mmProdHi = _mm_mulhi_epi16( mmCur, mmWeight );
+  mmLo = _mm_add_epi32( _mm_sra_epi32( _mm_add_epi32( _mm_unpacklo_epi16( mmProdLo, mmProdHi ), mmRound ), mmShift ), mmOffset );
+  mmHi = _mm_add_epi32( _mm_sra_epi32( _mm_add_epi32( _mm_unpackhi_epi16( mmProdLo, mmProdHi ), mmRound ), mmShift ), mmOffset );
+  if( bTruncate )
+  {
+    mmLo = _mm_srai_epi32( _mm_slli_epi32( mmLo, 16 ), 16 );
+    mmHi = _mm_srai_epi32( _mm_slli_epi32( mmHi, 16 ), 16 );
+  }
+  if( bClip )
+  {
+    mmLo = simdClip32( mmLo, mmMax );
+    mmHi = simdClip32( mmHi, mmMax );
+  }
+}
+
+static inline UInt simdHorizontalSum32( const __m128i &mm )
+{
+  __m128i mmSum = _mm_add_epi32( mm, _mm_shuffle_epi32( mm, _MM_SHUFFLE( 2, 3, 0, 1 ) ) );
+  mmSum = _mm_add_epi32( mmSum, _mm_shuffle_epi32( mmSum, _MM_SHUFFLE( 1, 0, 3, 2 ) ) );
+  return UInt( _mm_cvtsi128_si32( mmSum ) );
+}
+
+template<Bool bTruncate, Bool bClip>
+static Distortion simdGetSADw( const Pel *piOrg, Int iStrideOrg, const Pel *piCur, Int iStrideCur, Int iCols, Int iRows,
+                               Int w0, Int round, Int shift, Int offset, Int maxValue,
+                               Int distortionShift, Distortion maximumDistortionForEarlyExit )
+{
+  const __m128i mmWeight = _mm_set1_epi16( w0 );
+  const __m128i mmRound  = _mm_set1_epi32( round );
+  const __m128i mmShift  = _mm_cvtsi32_si128( shift );
+  const __m128i mmOffset = _mm_set1_epi32( offset );
+  const __m128i mmMax    = _mm_set1_epi32( maxValue );
+  const __m128i mmZero   = _mm_setzero_si128();
+
+  Distortion uiSum = 0;
+  for( Int y = 0; y < iRows; y++ )
+  {
+    __m128i mmSum = _mm_setzero_si128();
+    __m128i mmLo, mmHi;
+    Int n = 0;
+    for( ; n + 8 <= iCols; n += 8 )
+    {
+      const __m128i mmOrg = _mm_loadu_si128( ( const __m128i * )( piOrg + n ) );
+      simdWeightedPred( _mm_loadu_si128( ( const __m128i * )( piCur + n ) ), mmWeight, mmRound, mmShift, mmOffset, bTruncate, bClip, mmMax, mmLo, mmHi );
+      if( bTruncate )
+      {
+        // both operands are 16-bit, so max - min is exact as an unsigned 16-bit value
+        const __m128i mmPred = _mm_packs_epi32( mmLo, mmHi );
+        const __m128i mmAbs  = _mm_sub_epi16( _mm_max_epi16( mmOrg, mmPred ), _mm_min_epi16( mmOrg, mmPred ) );
+        mmSum = _mm_add_epi32( mmSum, _mm_add_epi32( _mm_unpacklo_epi16( mmAbs, mmZero ), _mm_unpackhi_epi16( mmAbs, mmZero ) ) );
+      }
+      else
+      {
+        mmSum = _mm_add_epi32( mmSum, simdAbs32( _mm_sub_epi32( simdSignExtend16Lo( mmOrg ), mmLo ) ) );
+        mmSum = _mm_add_epi32( mmSum, simdAbs32( _mm_sub_epi32( simdSignExtend16Hi( mmOrg ), mmHi ) ) );
+      }
+    }
+    if( n + 4 <= iCols )
+    {
+      const __m128i mmOrg = _mm_loadl_epi64( ( const __m128i * )( piOrg + n ) );
+      simdWeightedPred( _mm_loadl_epi64( ( const __m128i * )( piCur + n ) ), mmWeight, mmRound, mmShift, mmOffset, bTruncate, bClip, mmMax, mmLo, mmHi );
+      mmSum = _mm_add_epi32( mmSum, simdAbs32( _mm_sub_epi32( simdSignExtend16Lo( mmOrg ), mmLo ) ) );
+      n += 4;
+    }
+    uiSum += simdHorizontalSum32( mmSum );
+    for( ; n < iCols; n++ )
+    {
+      uiSum += abs( piOrg[n] - simdScalarWeightedPred( piCur[n], w0, round, shift, offset, bTruncate, bClip, maxValue ) );
+    }
+    if( maximumDistortionForEarlyExit < ( uiSum >> distortionShift ) )
+    {
+      return uiSum >> distortionShift;
+    }
+    piOrg += iStrideOrg;
+    piCur += iStrideCur;
+  }
+  return uiSum >> distortionShift;
+}
 
+//! squares of the lower four 16-bit residuals, each shifted right by the distortion shift
+static inline __m128i simdSquareShift32( const __m128i &mmResidual, const __m128i &mmDistShift )
+{
+  // the residual is a (wrapped) 16-bit value, as is the Pel residual of the scalar code
+  const __m128i mmRes = _mm_unpacklo_epi16( mmResidual, _mm_setzero_si128() );
+  return _mm_srl_epi32( _mm_madd_epi16( mmRes, mmRes ), mmDistShift );
+}
+
+template<Bool bClip>
+static Distortion simdGetSSEw( const Pel *piOrg, Int iStrideOrg, const Pel *piCur, Int iStrideCur, Int iCols, Int iRows,
+                               Int w0, Int round, Int shift, Int offset, Int maxValue, UInt distortionShift )
+{
+  const __m128i mmWeight    = _mm_set1_epi16( w0 );
+  const __m128i mmRound     = _mm_set1_epi32( round );
+  const __m128i mmShift     = _mm_cvtsi32_si128( shift );
+  const __m128i mmOffset    = _mm_set1_epi32( offset );
+  const __m128i mmMax       = _mm_set1_epi32( maxValue );
+  const __m128i mmDistShift = _mm_cvtsi32_si128( distortionShift );
+
+  __m128i mmSum = _mm_setzero_si128();
+  Distortion sum = 0;
+  for( Int y = 0; y < iRows; y++ )
+  {
+    __m128i mmLo, mmHi;
+    Int n = 0;
+    for( ; n + 8 <= iCols; n += 8 )
+    {
+      const __m128i mmOrg = _mm_loadu_si128( ( const __m128i * )( piOrg + n ) );
+      simdWeightedPred( _mm_loadu_si128( ( const __m128i * )( piCur + n ) ), mmWeight, mmRound, mmShift, mmOffset, true, bClip, mmMax, mmLo, mmHi );
+      const __m128i mmResidual = _mm_sub_epi16( mmOrg, _mm_packs_epi32( mmLo, mmHi ) );
+      mmSum = _mm_add_epi32( mmSum, simdSquareShift32( mmResidual, mmDistShift ) );
+      mmSum = _mm_add_epi32( mmSum, simdSquareShift32( _mm_unpackhi_epi64( mmResidual, mmResidual ), mmDistShift ) );
+    }
+    if( n + 4 <= iCols )
+    {
+      const __m128i mmOrg = _mm_loadl_epi64( ( const __m128i * )( piOrg + n ) );
+      simdWeightedPred( _mm_loadl_epi64( ( const __m128i * )( piCur + n ) ), mmWeight, mmRound, mmShift, mmOffset, true, bClip, mmMax, mmLo, mmHi );
+      mmSum = _mm_add_epi32( mmSum, simdSquareShift32( _mm_sub_epi16( mmOrg, _mm_packs_epi32( mmLo, mmLo ) ), mmDistShift ) );
+      n += 4;
+    }
+    for( ; n < iCols; n++ )
+    {
+      const Pel residual = piOrg[n] - simdScalarWeightedPred( piCur[n], w0, round, shift, offset, true, bClip, maxValue );
+      sum += ( Distortion(residual) * Distortion(residual) ) >> distortionShift;
+    }
+    piOrg += iStrideOrg;
+    piCur += iStrideCur;
+  }
+  return sum + simdHorizontalSum32( mmSum );
+}
+
+//! weighted SAD of a block, see TComRdCostWeightPrediction::xGetSADw
+static Distortion simdSADw( DistParam* pcDtParam )
+{
+  const Pel            *piOrg           = pcDtParam->pOrg;
+  const Pel            *piCur           = pcDtParam->pCur;
+  const Int             iCols           = pcDtParam->iCols;
+  const Int             iStrideCur      = pcDtParam->iStrideCur;
+  const Int             iStrideOrg      = pcDtParam->iStrideOrg;
+  const WPScalingParam &wpCur           = pcDtParam->wpCur[pcDtParam->compIdx];
+  const Int             w0              = wpCur.w;
+  const Int             offset          = wpCur.offset;
+  const Int             shift           = wpCur.shift;
+  const Int             round           = wpCur.round;
+  const Int             distortionShift = DISTORTION_PRECISION_ADJUSTMENT(pcDtParam->bitDepth-8);
+
+  const Bool bDefaultWeight = (w0 == 1 << shift);
+  const Bool bIsBiPred      = pcDtParam->bIsBiPred;
+  const Int  maxValue       = (1 << pcDtParam->bitDepth) - 1;
+  const Int  iRows          = pcDtParam->iRows;
+  const Distortion maxDist  = pcDtParam->m_maximumDistortionForEarlyExit;
+  if (bDefaultWeight && (offset == 0 || bIsBiPred))
+  {
+    return simdGetSADw<false, false>( piOrg, iStrideOrg, piCur, iStrideCur, iCols, iRows, 1, 0, 0, offset, maxValue, distortionShift, maxDist );
+  }
+  else if (bIsBiPred)
+  {
+    return simdGetSADw<true, false>( piOrg, iStrideOrg, piCur, iStrideCur, iCols, iRows, w0, round, shift, offset, maxValue, distortionShift, maxDist );
+  }
+  else
+  {
+    return simdGetSADw<true, true>( piOrg, iStrideOrg, piCur, iStrideCur, iCols, iRows, bDefaultWeight ? 1 : w0, bDefaultWeight ? 0 : round, bDefaultWeight ? 0 : shift, offset, maxValue, distortionShift, maxDist );
+  }
+}
+
+//! weighted SSE of a block, see TComRdCostWeightPrediction::xGetSSEw
+static Distortion simdSSEw( DistParam* pcDtParam )
+{
+  const Pel            *piOrg           = pcDtParam->pOrg;
+  const Pel            *piCur           = pcDtParam->pCur;
+  const Int             iCols           = pcDtParam->iCols;
+  const Int             iStrideOrg      = pcDtParam->iStrideOrg;
+  const Int             iStrideCur      = pcDtParam->iStrideCur;
+  const WPScalingParam &wpCur           = pcDtParam->wpCur[pcDtParam->compIdx];
+  const Int             w0              = wpCur.w;
+  const Int             offset          = wpCur.offset;
+  const Int             shift           = wpCur.shift;
+  const Int             round           = wpCur.round;
+  const UInt            distortionShift = DISTORTION_PRECISION_ADJUSTMENT((pcDtParam->bitDepth-8) << 1);
+
+  if (pcDtParam->bIsBiPred)
+  {
+    return simdGetSSEw<false>( piOrg, iStrideOrg, piCur, iStrideCur, iCols, pcDtParam->iRows, w0, round, shift, offset, (1 << pcDtParam->bitDepth) - 1, distortionShift );
+  }
+  return simdGetSSEw<true>( piOrg, iStrideOrg, piCur, iStrideCur, iCols, pcDtParam->iRows, w0, round, shift, offset, (1 << pcDtParam->bitDepth) - 1, distortionShift );
+}
+
+//! weighted Hadamard cost of a 4x4 block; only the differences are formed with vectors
+static Distortion simdHADs4x4w( const WPScalingParam &wpCur, const Pel *piOrg, const Pel *piCur, Int iStrideOrg, Int iStrideCur, Int iStep )
+{
+  if( iStep != 1 )
+  {
+    return xCalcHADs4x4w( wpCur, piOrg, piCur, iStrideOrg, iStrideCur, iStep );
+  }
+
+  const Int round  = wpCur.round;
+  const Int shift  = wpCur.shift;
+  const Int offset = wpCur.offset;
+  const Int w0     = wpCur.w;
+
+  TCoeff diff[16];
+  const __m128i mmWeight = _mm_set1_epi16( w0 );
+  const __m128i mmRound  = _mm_set1_epi32( round );
+  const __m128i mmShift  = _mm_cvtsi32_si128( shift );
+  const __m128i mmOffset = _mm_set1_epi32( offset );
+  for( Int k = 0; k < 16; k += 4 )
+  {
+    __m128i mmLo, mmHi;
+    simdWeightedPred( _mm_loadl_epi64( ( const __m128i * )piCur ), mmWeight, mmRound, mmShift, mmOffset, true, false, mmOffset, mmLo, mmHi );
+    _mm_storeu_si128( ( __m128i * )( diff + k ), _mm_sub_epi32( simdSignExtend16Lo( _mm_loadl_epi64( ( const __m128i * )piOrg ) ), mmLo ) );
+
+    piCur += iStrideCur;
+    piOrg += iStrideOrg;
+  }
+
+  return xCalcHADs4x4Diff( diff );
+}
+#endif
+
+#if VECTOR_CODING__WEIGHTED_PREDICTION && VECTOR_CODING__DISTORTION_CALCULATIONS && (RExt__HIGH_BIT_DEPTH_SUPPORT==0)
+//! weighted Hadamard cost of an 8x8 block: the 32-bit differences to the weighted prediction are passed to the unweighted vector Hadamard
+static Distortion simdHADs8x8w( const WPScalingParam &wpCur, const Pel *piOrg, const Pel *piCur, Int iStrideOrg, Int iStrideCur, Int iStep )
+{
+  if( iStep != 1 )
+  {
+    return xCalcHADs8x8w( wpCur, piOrg, piCur, iStrideOrg, iStrideCur, iStep );
+  }
+
+  const __m128i mmWeight = _mm_set1_epi16( wpCur.w );
+  const __m128i mmRound  = _mm_set1_epi32( wpCur.round );
+  const __m128i mmShift  = _mm_cvtsi32_si128( wpCur.shift );
+  const __m128i mmOffset = _mm_set1_epi32( wpCur.offset );
+  TCoeff diff[64];
+  for( Int k = 0; k < 8; k++ )
+  {
+    const __m128i mmOrg = _mm_loadu_si128( ( const __m128i * )( piOrg + k * iStrideOrg ) );
+    __m128i mmLo, mmHi;
+    simdWeightedPred( _mm_loadu_si128( ( const __m128i * )( piCur + k * iStrideCur ) ), mmWeight, mmRound, mmShift, mmOffset, true, false, mmOffset, mmLo, mmHi );
+    _mm_storeu_si128( ( __m128i * )( diff + 8 * k     ), _mm_sub_epi32( simdSignExtend16Lo( mmOrg ), mmLo ) );
+    _mm_storeu_si128( ( __m128i * )( diff + 8 * k + 4 ), _mm_sub_epi32( simdSignExtend16Hi( mmOrg ), mmHi ) );
+  }
+  return simdHADs8x8( diff );
+}
+#endif
 
 // --------------------------------------------------------------------------------------------------------------------
 // SAD
 // --------------------------------------------------------------------------------------------------------------------
-/** get weighted SAD cost
- * \param pcDtParam
- * \returns Distortion
- */
-Distortion TComRdCostWeightPrediction::xGetSADw( DistParam* pcDtParam )
+//! weighted SAD cost, scalar kernel
+static Distortion getSADwScalar( DistParam* pcDtParam )
 {
   const Pel            *piOrg      = pcDtParam->pOrg;
   const Pel            *piCur      = pcDtParam->pCur;
@@ -206,15 +507,21 @@ Distortion TComRdCostWeightPrediction::xGetSADw( DistParam* pcDtParam )
   return uiSum >> distortionShift;
 }
 
+/** get weighted SAD cost
+ * \param pcDtParam
+ * \returns Distortion
+ */
+Distortion TComRdCostWeightPrediction::xGetSADw( DistParam* pcDtParam )
+{
+  return weightedDistortionKernels.sad( pcDtParam );
+}
+
 
 // --------------------------------------------------------------------------------------------------------------------
 // SSE
 // --------------------------------------------------------------------------------------------------------------------
-/** get weighted SSD cost
- * \param pcDtParam
- * \returns Distortion
- */
-Distortion TComRdCostWeightPrediction::xGetSSEw( DistParam* pcDtParam )
+//! weighted SSE cost, scalar kernel
+static Distortion getSSEwScalar( DistParam* pcDtParam )
 {
   const Pel            *piOrg           = pcDtParam->pOrg;
   const Pel            *piCur           = pcDtParam->pCur;
@@ -271,6 +578,15 @@ Distortion TComRdCostWeightPrediction::xGetSSEw( DistParam* pcDtParam )
   return sum;
 }
 
+/** get weighted SSD cost
+ * \param pcDtParam
+ * \returns Distortion
+ */
+Distortion TComRdCostWeightPrediction::xGetSSEw( DistParam* pcDtParam )
+{
+  return weightedDistortionKernels.sse( pcDtParam );
+}
+
 
 // --------------------------------------------------------------------------------------------------------------------
 // HADAMARD with step (used in fractional search)
@@ -320,11 +636,7 @@ Distortion xCalcHADs4x4w( const WPScalingParam &wpCur, const Pel *piOrg, const P
   const Int offset = wpCur.offset;
   const Int w0     = wpCur.w;
 
-  Distortion satd = 0;
   TCoeff     diff[16];
-  TCoeff     m[16];
-  TCoeff     d[16];
-
 
   for(Int k = 0; k < 16; k+=4 )
   {
@@ -342,6 +654,17 @@ Distortion xCalcHADs4x4w( const WPScalingParam &wpCur, const Pel *piOrg, const P
     piOrg += iStrideOrg;
   }
 
+  return xCalcHADs4x4Diff( diff );
+}
+
+
+//! Hadamard cost of a 4x4 block of differences
+Distortion xCalcHADs4x4Diff( const TCoeff *diff )
+{
+  Distortion satd = 0;
+  TCoeff     m[16];
+  TCoeff     d[16];
+
   /*===== hadamard transform =====*/
   m[ 0] = diff[ 0] + diff[12];
   m[ 1] = diff[ 1] + diff[13];
@@ -563,7 +886,7 @@ Distortion TComRdCostWeightPrediction::xGetHADsw( DistParam* pcDtParam )
     {
       for (Int x=0; x<iCols; x+= 8 )
       {
-        uiSum += xCalcHADs8x8w( wpCur, &piOrg[x], &piCur[x*iStep], iStrideOrg, iStrideCur, iStep );
+        uiSum += weightedDistortionKernels.hads8x8( wpCur, &piOrg[x], &piCur[x*iStep], iStrideOrg, iStrideCur, iStep );
       }
       piOrg += iOffsetOrg;
       piCur += iOffsetCur;
@@ -578,7 +901,7 @@ Distortion TComRdCostWeightPrediction::xGetHADsw( DistParam* pcDtParam )
     {
       for (Int x=0; x<iCols; x+= 4 )
       {
-        uiSum += xCalcHADs4x4w( wpCur, &piOrg[x], &piCur[x*iStep], iStrideOrg, iStrideCur, iStep );
+        uiSum += weightedDistortionKernels.hads4x4( wpCur, &piOrg[x], &piCur[x*iStep], iStrideOrg, iStrideCur, iStep );
       }
       piOrg += iOffsetOrg;
       piCur += iOffsetCur;
@@ -599,3 +922,27 @@ Distortion TComRdCostWeightPrediction::xGetHADsw( DistParam* pcDtParam )
 
   return uiSum >> DISTORTION_PRECISION_ADJUSTMENT(pcDtParam->bitDepth-8);
 }
+
+static Void initWeightedDistortionKernels( const SIMDLevel level )
+{
+  weightedDistortionKernels.sad     = getSADwScalar;
+  weightedDistortionKernels.sse     = getSSEwScalar;
+  weightedDistortionKernels.hads4x4 = xCalcHADs4x4w;
+  weightedDistortionKernels.hads8x8 = xCalcHADs8x8w;
+#if VECTOR_CODING__WEIGHTED_PREDICTION && (RExt__HIGH_BIT_DEPTH_SUPPORT==0)
+  if( level >= SIMD_SSE2 )
+  {
+    weightedDistortionKernels.sad     = simdSADw;
+    weightedDistortionKernels.sse     = simdSSEw;
+    weightedDistortionKernels.hads4x4 = simdHADs4x4w;
+  }
+#endif
+#if VECTOR_CODING__WEIGHTED_PREDICTION && VECTOR_CODING__DISTORTION_CALCULATIONS && (RExt__HIGH_BIT_DEPTH_SUPPORT==0)
+  if( level >= SIMD_SSE2 )
+  {
+    weightedDistortionKernels.hads8x8 = simdHADs8x8w;
+  }
+#endif
+}
+
+static const Bool weightedDistortionKernelsRegistered = TComSimd::registerKernels( initWeightedDistortionKernels );
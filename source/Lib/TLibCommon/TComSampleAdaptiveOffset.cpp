@@ -36,11 +36,16 @@
 */
 
 #include "TComSampleAdaptiveOffset.h"
+#include "TComSimd.h"
 #include <string.h>
 #include <stdlib.h>
 #include <stdio.h>
 #include <math.h>
 
+#if VECTOR_CODING__SAMPLE_ADAPTIVE_OFFSET && (RExt__HIGH_BIT_DEPTH_SUPPORT==0)
+#include <emmintrin.h>
+#endif
+
 //! \ingroup TLibCommon
 //! \{
 
@@ -310,29 +315,77 @@ Void TComSampleAdaptiveOffset::reconstructBlkSAOParams(TComPic* pic, SAOBlkParam
 }
 
 
-Void TComSampleAdaptiveOffset::offsetBlock(const Int channelBitDepth, Int typeIdx, Int* offset
-                                          , Pel* srcBlk, Pel* resBlk, Int srcStride, Int resStride,  Int width, Int height
-                                          , Bool isLeftAvail,  Bool isRightAvail, Bool isAboveAvail, Bool isBelowAvail, Bool isAboveLeftAvail, Bool isAboveRightAvail, Bool isBelowLeftAvail, Bool isBelowRightAvail)
+#if VECTOR_CODING__SAMPLE_ADAPTIVE_OFFSET && (RExt__HIGH_BIT_DEPTH_SUPPORT==0)
+/** Apply edge offset to samples [startX, endX) of one line.
+ *  The edge class of each sample is sgn(c - a) + sgn(c - b), where a and b are the neighbours at
+ *  srcLine[x + neighbourA] and srcLine[x + neighbourB]. mmOffset holds the offsets of edge classes -2..2.
+ */
+static Void simdSaoEdgeOffsetLine( const Pel *srcLine , Pel *resLine , Int startX , Int endX , Int neighbourA , Int neighbourB
+                                 , const Int *offset , const __m128i *mmOffset , const __m128i &mmMax , Int maxSampleValueIncl )
 {
-  if(m_lineBufWidth != m_maxCUWidth)
+  const __m128i mmZero = _mm_setzero_si128();
+  const __m128i mmTwo  = _mm_set1_epi16( 2 );
+  const __m128i mmOne  = _mm_set1_epi16( 1 );
+  Int x = startX;
+  for( ; x + 8 <= endX ; x += 8 )
   {
-    m_lineBufWidth = m_maxCUWidth;
-
-    if (m_signLineBuf1)
-    {
-      delete[] m_signLineBuf1;
-      m_signLineBuf1 = NULL;
-    }
-    m_signLineBuf1 = new SChar[m_lineBufWidth+1];
+    const __m128i mmCur  = _mm_loadu_si128( ( const __m128i * )( srcLine + x ) );
+    const __m128i mmA    = _mm_loadu_si128( ( const __m128i * )( srcLine + x + neighbourA ) );
+    const __m128i mmB    = _mm_loadu_si128( ( const __m128i * )( srcLine + x + neighbourB ) );
+    const __m128i mmSgnA = _mm_sub_epi16( _mm_cmpgt_epi16( mmA , mmCur ) , _mm_cmpgt_epi16( mmCur , mmA ) );
+    const __m128i mmSgnB = _mm_sub_epi16( _mm_cmpgt_epi16( mmB , mmCur ) , _mm_cmpgt_epi16( mmCur , mmB ) );
+    const __m128i mmEdge = _mm_add_epi16( mmSgnA , mmSgnB );
+
+    __m128i mmOff = _mm_and_si128( _mm_cmpeq_epi16( mmEdge , _mm_sub_epi16( mmZero , mmTwo ) ) , mmOffset[0] );
+    mmOff = _mm_or_si128( mmOff , _mm_and_si128( _mm_cmpeq_epi16( mmEdge , _mm_sub_epi16( mmZero , mmOne ) ) , mmOffset[1] ) );
+    mmOff = _mm_or_si128( mmOff , _mm_and_si128( _mm_cmpeq_epi16( mmEdge , mmZero ) , mmOffset[2] ) );
+    mmOff = _mm_or_si128( mmOff , _mm_and_si128( _mm_cmpeq_epi16( mmEdge , mmOne  ) , mmOffset[3] ) );
+    mmOff = _mm_or_si128( mmOff , _mm_and_si128( _mm_cmpeq_epi16( mmEdge , mmTwo  ) , mmOffset[4] ) );
+
+    const __m128i mmRes = _mm_min_epi16( _mm_max_epi16( _mm_add_epi16( mmCur , mmOff ) , mmZero ) , mmMax );
+    _mm_storeu_si128( ( __m128i * )( resLine + x ) , mmRes );
+  }
+  for( ; x < endX ; x++ )
+  {
+    const Int edgeType = sgn( srcLine[x] - srcLine[x + neighbourA] ) + sgn( srcLine[x] - srcLine[x + neighbourB] );
+    resLine[x] = Clip3<Int>( 0 , maxSampleValueIncl , srcLine[x] + offset[edgeType] );
+  }
+}
 
-    if (m_signLineBuf2)
+/** Apply band offset to one line. mmBand/mmOffset list the numBands bands that carry a non-zero offset.
+ */
+static Void simdSaoBandOffsetLine( const Pel *srcLine , Pel *resLine , Int width , Int shiftBits , const Int *offset
+                                 , const __m128i *mmBand , const __m128i *mmOffset , Int numBands
+                                 , const __m128i &mmMax , Int maxSampleValueIncl )
+{
+  const __m128i mmZero = _mm_setzero_si128();
+  Int x = 0;
+  for( ; x + 8 <= width ; x += 8 )
+  {
+    const __m128i mmCur   = _mm_loadu_si128( ( const __m128i * )( srcLine + x ) );
+    const __m128i mmClass = _mm_srai_epi16( mmCur , shiftBits );
+    __m128i mmOff = mmZero;
+    for( Int i = 0 ; i < numBands ; i++ )
     {
-      delete[] m_signLineBuf2;
-      m_signLineBuf2 = NULL;
+      mmOff = _mm_or_si128( mmOff , _mm_and_si128( _mm_cmpeq_epi16( mmClass , mmBand[i] ) , mmOffset[i] ) );
     }
-    m_signLineBuf2 = new SChar[m_lineBufWidth+1];
+    const __m128i mmRes = _mm_min_epi16( _mm_max_epi16( _mm_add_epi16( mmCur , mmOff ) , mmZero ) , mmMax );
+    _mm_storeu_si128( ( __m128i * )( resLine + x ) , mmRes );
+  }
+  for( ; x < width ; x++ )
+  {
+    resLine[x] = Clip3<Int>( 0 , maxSampleValueIncl , srcLine[x] + offset[srcLine[x] >> shiftBits] );
   }
+}
+#endif
 
+/** Apply the SAO offsets of one block. signLineBuf1 and signLineBuf2 hold at least width+1 signs each.
+ */
+static Void offsetBlockScalar(const Int channelBitDepth, Int typeIdx, Int* offset
+                             , Pel* srcBlk, Pel* resBlk, Int srcStride, Int resStride,  Int width, Int height
+                             , Bool isLeftAvail,  Bool isRightAvail, Bool isAboveAvail, Bool isBelowAvail, Bool isAboveLeftAvail, Bool isAboveRightAvail, Bool isBelowLeftAvail, Bool isBelowRightAvail
+                             , SChar* signLineBuf1, SChar* signLineBuf2)
+{
   const Int maxSampleValueIncl = (1<< channelBitDepth )-1;
 
   Int x,y, startX, startY, endX, endY, edgeType;
@@ -369,7 +422,7 @@ Void TComSampleAdaptiveOffset::offsetBlock(const Int channelBitDepth, Int typeId
   case SAO_TYPE_EO_90:
     {
       offset += 2;
-      SChar *signUpLine = m_signLineBuf1;
+      SChar *signUpLine = signLineBuf1;
 
       startY = isAboveAvail ? 0 : 1;
       endY   = isBelowAvail ? height : height-1;
@@ -409,8 +462,8 @@ Void TComSampleAdaptiveOffset::offsetBlock(const Int channelBitDepth, Int typeId
       offset += 2;
       SChar *signUpLine, *signDownLine, *signTmpLine;
 
-      signUpLine  = m_signLineBuf1;
-      signDownLine= m_signLineBuf2;
+      signUpLine  = signLineBuf1;
+      signDownLine= signLineBuf2;
 
       startX = isLeftAvail ? 0 : 1 ;
       endX   = isRightAvail ? width : (width-1);
@@ -474,7 +527,7 @@ Void TComSampleAdaptiveOffset::offsetBlock(const Int channelBitDepth, Int typeId
   case SAO_TYPE_EO_45:
     {
       offset += 2;
-      SChar *signUpLine = m_signLineBuf1+1;
+      SChar *signUpLine = signLineBuf1+1;
 
       startX = isLeftAvail ? 0 : 1;
       endX   = isRightAvail ? width : (width -1);
@@ -551,6 +604,171 @@ Void TComSampleAdaptiveOffset::offsetBlock(const Int channelBitDepth, Int typeId
   }
 }
 
+#if VECTOR_CODING__SAMPLE_ADAPTIVE_OFFSET && (RExt__HIGH_BIT_DEPTH_SUPPORT==0)
+/** Apply band or edge offsets with the line kernels above; other types are left to the scalar kernel.
+ */
+static Void simdOffsetBlock(const Int channelBitDepth, Int typeIdx, Int* offset
+                            , Pel* srcBlk, Pel* resBlk, Int srcStride, Int resStride,  Int width, Int height
+                            , Bool isLeftAvail,  Bool isRightAvail, Bool isAboveAvail, Bool isBelowAvail, Bool isAboveLeftAvail, Bool isAboveRightAvail, Bool isBelowLeftAvail, Bool isBelowRightAvail
+                            , SChar* signLineBuf1, SChar* signLineBuf2)
+{
+  const Int maxSampleValueIncl = (1<< channelBitDepth )-1;
+
+  Int y, startX, endX;
+
+  const Pel* srcLine = srcBlk;
+  Pel* resLine = resBlk;
+
+  if (typeIdx == SAO_TYPE_BO)
+  {
+    const Int shiftBits = channelBitDepth - NUM_SAO_BO_CLASSES_LOG2;
+    const __m128i mmMax = _mm_set1_epi16( maxSampleValueIncl );
+    __m128i mmBand[NUM_SAO_BO_CLASSES];
+    __m128i mmOffset[NUM_SAO_BO_CLASSES];
+    Int     numBands = 0;
+    for (Int band = 0; band < NUM_SAO_BO_CLASSES; band++)
+    {
+      if (offset[band] != 0)
+      {
+        mmBand  [numBands] = _mm_set1_epi16( band );
+        mmOffset[numBands] = _mm_set1_epi16( offset[band] );
+        numBands++;
+      }
+    }
+    for (y=0; y< height; y++)
+    {
+      simdSaoBandOffsetLine(srcLine, resLine, width, shiftBits, offset, mmBand, mmOffset, numBands, mmMax, maxSampleValueIncl);
+      srcLine += srcStride;
+      resLine += resStride;
+    }
+    return;
+  }
+  else if (typeIdx >= SAO_TYPE_START_EO && typeIdx < SAO_TYPE_START_BO)
+  {
+    // Every edge class is sgn(c - a) + sgn(c - b) for the two neighbours along the EO direction.
+    // The line ranges below reproduce the availability handling of the scalar implementation.
+    const __m128i mmMax = _mm_set1_epi16( maxSampleValueIncl );
+    __m128i mmOffset[NUM_SAO_EO_CLASSES];
+    for (Int classIdx = 0; classIdx < NUM_SAO_EO_CLASSES; classIdx++)
+    {
+      mmOffset[classIdx] = _mm_set1_epi16( offset[classIdx] );
+    }
+    offset += 2;
+
+    startX = isLeftAvail ? 0 : 1;
+    endX   = isRightAvail ? width : (width -1);
+
+    Int neighbourA, neighbourB;
+    switch(typeIdx)
+    {
+    case SAO_TYPE_EO_0:   neighbourA = -1;            neighbourB =  1;            break;
+    case SAO_TYPE_EO_90:  neighbourA = -srcStride;    neighbourB =  srcStride;    break;
+    case SAO_TYPE_EO_135: neighbourA = -srcStride-1;  neighbourB =  srcStride+1;  break;
+    default:              neighbourA = -srcStride+1;  neighbourB =  srcStride-1;  break;
+    }
+
+    for (y=0; y< height; y++)
+    {
+      Int lineStartX = startX;
+      Int lineEndX   = endX;
+      switch(typeIdx)
+      {
+      case SAO_TYPE_EO_0:
+        break;
+      case SAO_TYPE_EO_90:
+        lineStartX = 0;
+        lineEndX   = ((y == 0 && !isAboveAvail) || (y == height-1 && !isBelowAvail)) ? 0 : width;
+        break;
+      case SAO_TYPE_EO_135:
+        if (y == 0)
+        {
+          lineStartX = isAboveLeftAvail ? 0 : 1;
+          lineEndX   = isAboveAvail ? endX : 1;
+        }
+        else if (y == height-1)
+        {
+          lineStartX = isBelowAvail ? startX : (width -1);
+          lineEndX   = isBelowRightAvail ? width : (width -1);
+        }
+        break;
+      default:
+        if (y == 0)
+        {
+          lineStartX = isAboveAvail ? startX : (width -1);
+          lineEndX   = isAboveRightAvail ? width : (width -1);
+        }
+        else if (y == height-1)
+        {
+          lineStartX = isBelowLeftAvail ? 0 : 1;
+          lineEndX   = isBelowAvail ? endX : 1;
+        }
+        break;
+      }
+      simdSaoEdgeOffsetLine(srcLine, resLine, lineStartX, lineEndX, neighbourA, neighbourB, offset, mmOffset, mmMax, maxSampleValueIncl);
+      srcLine += srcStride;
+      resLine += resStride;
+    }
+    return;
+  }
+
+  offsetBlockScalar(channelBitDepth, typeIdx, offset, srcBlk, resBlk, srcStride, resStride, width, height
+                   , isLeftAvail, isRightAvail, isAboveAvail, isBelowAvail, isAboveLeftAvail, isAboveRightAvail, isBelowLeftAvail, isBelowRightAvail
+                   , signLineBuf1, signLineBuf2);
+}
+#endif
+
+/// SAO kernels of the selected instruction set level (see TComSimd)
+struct SaoKernels
+{
+  Void (*offsetBlock)(const Int channelBitDepth, Int typeIdx, Int* offset
+                      , Pel* srcBlk, Pel* resBlk, Int srcStride, Int resStride,  Int width, Int height
+                      , Bool isLeftAvail,  Bool isRightAvail, Bool isAboveAvail, Bool isBelowAvail, Bool isAboveLeftAvail, Bool isAboveRightAvail, Bool isBelowLeftAvail, Bool isBelowRightAvail
+                      , SChar* signLineBuf1, SChar* signLineBuf2);
+};
+
+static SaoKernels saoKernels;
+
+static Void initSaoKernels( const SIMDLevel level )
+{
+  saoKernels.offsetBlock = offsetBlockScalar;
+#if VECTOR_CODING__SAMPLE_ADAPTIVE_OFFSET && (RExt__HIGH_BIT_DEPTH_SUPPORT==0)
+  if( level >= SIMD_SSE2 )
+  {
+    saoKernels.offsetBlock = simdOffsetBlock;
+  }
+#endif
+}
+
+static const Bool saoKernelsRegistered = TComSimd::registerKernels( initSaoKernels );
+
+Void TComSampleAdaptiveOffset::offsetBlock(const Int channelBitDepth, Int typeIdx, Int* offset
+                                          , Pel* srcBlk, Pel* resBlk, Int srcStride, Int resStride,  Int width, Int height
+                                          , Bool isLeftAvail,  Bool isRightAvail, Bool isAboveAvail, Bool isBelowAvail, Bool isAboveLeftAvail, Bool isAboveRightAvail, Bool isBelowLeftAvail, Bool isBelowRightAvail)
+{
+  if(m_lineBufWidth != m_maxCUWidth)
+  {
+    m_lineBufWidth = m_maxCUWidth;
+
+    if (m_signLineBuf1)
+    {
+      delete[] m_signLineBuf1;
+      m_signLineBuf1 = NULL;
+    }
+    m_signLineBuf1 = new SChar[m_lineBufWidth+1];
+
+    if (m_signLineBuf2)
+    {
+      delete[] m_signLineBuf2;
+      m_signLineBuf2 = NULL;
+    }
+    m_signLineBuf2 = new SChar[m_lineBufWidth+1];
+  }
+
+  saoKernels.offsetBlock(channelBitDepth, typeIdx, offset, srcBlk, resBlk, srcStride, resStride, width, height
+                        , isLeftAvail, isRightAvail, isAboveAvail, isBelowAvail, isAboveLeftAvail, isAboveRightAvail, isBelowLeftAvail, isBelowRightAvail
+                        , m_signLineBuf1, m_signLineBuf2);
+}
+
 Void TComSampleAdaptiveOffset::offsetCTU(Int ctuRsAddr, TComPicYuv* srcYuv, TComPicYuv* resYuv, SAOBlkParam& saoblkParam, TComPic* pPic)
 {
   Bool isLeftAvail,isRightAvail,isAboveAvail,isBelowAvail,isAboveLeftAvail,isAboveRightAvail,isBelowLeftAvail,isBelowRightAvail;
@@ -630,12 +848,41 @@ Void TComSampleAdaptiveOffset::SAOProcess(TComPic* pDecPic)
   TComPicYuv* resYuv = pDecPic->getPicYuvRec();
   TComPicYuv* srcYuv = m_tempPicYuv;
   resYuv->copyToPic(srcYuv);
+#if INCREMENTAL_BORDER_EXTENSION
+  const Bool bExtendBorder = !xIsPCMRestorationRequired(pDecPic);
+#endif
   for(Int ctuRsAddr= 0; ctuRsAddr < m_numCTUsPic; ctuRsAddr++)
   {
     offsetCTU(ctuRsAddr, srcYuv, resYuv, (pDecPic->getPicSym()->getSAOBlkParam())[ctuRsAddr], pDecPic);
+#if INCREMENTAL_BORDER_EXTENSION
+    if (bExtendBorder)
+    {
+      xExtendCompletedCtuRowBorder(pDecPic, ctuRsAddr);
+    }
+#endif
   } //ctu
 }
 
+#if INCREMENTAL_BORDER_EXTENSION
+/** Extend the border of the reconstructed picture for the CTU row that ends with the given CTU.
+ * \param pPic      picture (TComPic) pointer
+ * \param ctuRsAddr raster scan address of the CTU whose samples have just been finalised
+ *
+ * \note The rows of the reconstructed picture must not be modified afterwards, so this is not used when PCM restoration follows SAO.
+ */
+Void TComSampleAdaptiveOffset::xExtendCompletedCtuRowBorder(TComPic* pPic, Int ctuRsAddr)
+{
+  if ((ctuRsAddr + 1) % m_numCTUInWidth != 0)
+  {
+    return;
+  }
+
+  const Int startY = (ctuRsAddr / m_numCTUInWidth) * m_maxCUHeight;
+  const Int endY   = std::min(startY + m_maxCUHeight, m_picHeight);
+  pPic->getPicYuvRec()->extendPicBorder(startY, endY);
+}
+#endif
+
 
 /** PCM LF disable process.
  * \param pcPic picture (TComPic) pointer
@@ -652,9 +899,7 @@ Void TComSampleAdaptiveOffset::PCMLFDisableProcess (TComPic* pcPic)
  */
 Void TComSampleAdaptiveOffset::xPCMRestoration(TComPic* pcPic)
 {
-  Bool  bPCMFilter = (pcPic->getSlice(0)->getSPS()->getUsePCM() && pcPic->getSlice(0)->getSPS()->getPCMFilterDisableFlag())? true : false;
-
-  if(bPCMFilter || pcPic->getSlice(0)->getPPS()->getTransquantBypassEnabledFlag())
+  if(xIsPCMRestorationRequired(pcPic))
   {
     for( UInt ctuRsAddr = 0; ctuRsAddr < pcPic->getNumberOfCtusInFrame() ; ctuRsAddr++ )
     {
@@ -665,6 +910,16 @@ Void TComSampleAdaptiveOffset::xPCMRestoration(TComPic* pcPic)
   }
 }
 
+/** Check whether PCM / lossless samples have to be restored after the in-loop filters.
+ * \param pcPic picture (TComPic) pointer
+ */
+Bool TComSampleAdaptiveOffset::xIsPCMRestorationRequired(TComPic* pcPic) const
+{
+  const Bool bPCMFilter = (pcPic->getSlice(0)->getSPS()->getUsePCM() && pcPic->getSlice(0)->getSPS()->getPCMFilterDisableFlag())? true : false;
+
+  return bPCMFilter || pcPic->getSlice(0)->getPPS()->getTransquantBypassEnabledFlag();
+}
+
 /** PCM CU restoration.
  * \param pcCU            pointer to current CU
  * \param uiAbsZorderIdx  part index
@@ -80,6 +80,10 @@ protected:
   Int  getMergeList(TComPic* pic, Int ctuRsAddr, SAOBlkParam* blkParams, SAOBlkParam* mergeList[NUM_SAO_MERGE_TYPES]);
   Void offsetCTU(Int ctuRsAddr, TComPicYuv* srcYuv, TComPicYuv* resYuv, SAOBlkParam& saoblkParam, TComPic* pPic);
   Void xPCMRestoration(TComPic* pcPic);
+  Bool xIsPCMRestorationRequired(TComPic* pcPic) const;
+#if INCREMENTAL_BORDER_EXTENSION
+  Void xExtendCompletedCtuRowBorder(TComPic* pPic, Int ctuRsAddr);
+#endif
   Void xPCMCURestoration ( TComDataCU* pcCU, UInt uiAbsZorderIdx, UInt uiDepth );
   Void xPCMSampleRestoration (TComDataCU* pcCU, UInt uiAbsZorderIdx, UInt uiDepth, const ComponentID compID);
 protected:
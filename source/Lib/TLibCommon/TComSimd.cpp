@@ -0,0 +1,193 @@
+/* The copyright in this software is being made available under the BSD
+ * License, included below. This software may be subject to other third party
+ * and contributor rights, including patent rights, and no such rights are
+ * granted under this license.
+ *
+ * Copyright (c) 2010-2016, ITU/ISO/IEC
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  * Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *  * Neither the name of the ITU/ISO/IEC nor the names of its contributors may
+ *    be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** \file     TComSimd.cpp
+    \brief    run-time selection of the vector (SIMD) code paths
+*/
+
+#include "TComSimd.h"
+#include <algorithm>
+
+#if defined(_MSC_VER) && (defined(_M_IX86) || defined(_M_X64) || defined(_M_AMD64))
+#include <intrin.h>
+#define SIMD_DETECTION_MSVC 1
+#elif (defined(__GNUC__) || defined(__clang__)) && (defined(__i386__) || defined(__x86_64__))
+#define SIMD_DETECTION_GCC  1
+#endif
+
+//! \ingroup TLibCommon
+//! \{
+
+static const TChar *const simdLevelNames[NUMBER_OF_SIMD_LEVELS] = { "scalar", "sse2", "sse41", "avx2", "avx512" };
+
+static SIMDLevel selectLevel( const SIMDLevel maxLevel )
+{
+  SIMDLevel level = std::min( maxLevel, TComSimd::detectLevel() );
+  while( !TComSimd::isLevelAvailable( level ) )
+  {
+    level = SIMDLevel( level - 1 );
+  }
+  return level;
+}
+
+SIMDLevel& TComSimd::xGetLevel()
+{
+  static SIMDLevel level = selectLevel( SIMD_AVX512 );
+  return level;
+}
+
+std::vector<SIMDKernelInit>& TComSimd::xGetKernelInits()
+{
+  static std::vector<SIMDKernelInit> kernelInits;
+  return kernelInits;
+}
+
+SIMDLevel TComSimd::detectLevel()
+{
+#if SIMD_DETECTION_GCC
+  // __builtin_cpu_supports also checks that the operating system saves the extended (AVX) register state.
+  __builtin_cpu_init();
+  if( __builtin_cpu_supports( "avx512f" ) && __builtin_cpu_supports( "avx512bw" ) )
+  {
+    return SIMD_AVX512;
+  }
+  if( __builtin_cpu_supports( "avx2" ) )
+  {
+    return SIMD_AVX2;
+  }
+  if( __builtin_cpu_supports( "sse4.1" ) )
+  {
+    return SIMD_SSE41;
+  }
+  if( __builtin_cpu_supports( "sse2" ) )
+  {
+    return SIMD_SSE2;
+  }
+  return SIMD_SCALAR;
+#elif SIMD_DETECTION_MSVC
+  Int info[4];
+  __cpuid( info, 0 );
+  const Int maxLeaf = info[0];
+  __cpuid( info, 1 );
+  const Bool sse2    = ( info[3] & ( 1 << 26 ) ) != 0;
+  const Bool sse41   = ( info[2] & ( 1 << 19 ) ) != 0;
+  const Bool osxsave = ( info[2] & ( 1 << 27 ) ) != 0;
+  const Bool avx     = ( info[2] & ( 1 << 28 ) ) != 0;
+  const UInt64 xcr0  = osxsave ? _xgetbv( 0 ) : 0;
+  Bool avx2   = false;
+  Bool avx512 = false;
+  if( maxLeaf >= 7 )
+  {
+    __cpuidex( info, 7, 0 );
+    avx2   = avx && ( ( xcr0 & 0x06 ) == 0x06 ) && ( info[1] & ( 1 << 5 ) ) != 0;
+    avx512 = avx2 && ( ( xcr0 & 0xe6 ) == 0xe6 ) && ( info[1] & ( 1 << 16 ) ) != 0 && ( info[1] & ( 1 << 30 ) ) != 0;
+  }
+  return avx512 ? SIMD_AVX512 : avx2 ? SIMD_AVX2 : sse41 ? SIMD_SSE41 : sse2 ? SIMD_SSE2 : SIMD_SCALAR;
+#else
+  return SIMD_SCALAR;
+#endif
+}
+
+Bool TComSimd::isLevelAvailable( const SIMDLevel level )
+{
+  switch( level )
+  {
+    case SIMD_SCALAR:
+      return true;
+#if ( VECTOR_CODING__INTERPOLATION_FILTER || VECTOR_CODING__DISTORTION_CALCULATIONS || VECTOR_CODING__DEBLOCKING_FILTER || VECTOR_CODING__SAMPLE_ADAPTIVE_OFFSET || VECTOR_CODING__YUV_ARITHMETIC || VECTOR_CODING__WEIGHTED_PREDICTION || VECTOR_CODING__PICTURE_BORDER_EXTENSION || VECTOR_CODING__BYTE_SEQUENCE_SEARCH || VECTOR_CODING__INTRA_GRADIENT_ANALYSIS || VECTOR_CODING__QUANTISATION || VECTOR_CODING__INTRA_PREDICTION ) && (RExt__HIGH_BIT_DEPTH_SUPPORT==0)
+    case SIMD_SSE2:
+      return true;
+#endif
+#if VECTOR_CODING__AVX2_KERNELS && (RExt__HIGH_BIT_DEPTH_SUPPORT==0)
+    case SIMD_AVX2:
+      return true;
+#endif
+    default:
+      // no kernels are written for SSE4.1 or AVX-512
+      return false;
+  }
+}
+
+Void TComSimd::setLevel( const SIMDLevel maxLevel )
+{
+  xGetLevel() = selectLevel( maxLevel );
+  const std::vector<SIMDKernelInit> &kernelInits = xGetKernelInits();
+  for( size_t i = 0; i < kernelInits.size(); i++ )
+  {
+    kernelInits[i]( xGetLevel() );
+  }
+}
+
+Bool TComSimd::registerKernels( SIMDKernelInit init )
+{
+  xGetKernelInits().push_back( init );
+  init( xGetLevel() );
+  return true;
+}
+
+const TChar* TComSimd::getLevelName( const SIMDLevel level )
+{
+  return ( level < NUMBER_OF_SIMD_LEVELS ) ? simdLevelNames[level] : "unknown";
+}
+
+SIMDLevel TComSimd::stringToLevel( const std::string &value )
+{
+  if( value.empty() || value == "auto" )
+  {
+    return SIMD_AVX512;
+  }
+  for( Int level = 0; level < NUMBER_OF_SIMD_LEVELS; level++ )
+  {
+    if( value == simdLevelNames[level] && isLevelAvailable( SIMDLevel( level ) ) )
+    {
+      return SIMDLevel( level );
+    }
+  }
+  return NUMBER_OF_SIMD_LEVELS;
+}
+
+std::string TComSimd::getListOfLevels()
+{
+  std::string list( "auto" );
+  for( Int level = 0; level < NUMBER_OF_SIMD_LEVELS; level++ )
+  {
+    if( isLevelAvailable( SIMDLevel( level ) ) )
+    {
+      list += ", ";
+      list += simdLevelNames[level];
+    }
+  }
+  return list;
+}
+
+//! \}
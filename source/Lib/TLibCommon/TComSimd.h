@@ -0,0 +1,97 @@
+/* The copyright in this software is being made available under the BSD
+ * License, included below. This software may be subject to other third party
+ * and contributor rights, including patent rights, and no such rights are
+ * granted under this license.
+ *
+ * Copyright (c) 2010-2016, ITU/ISO/IEC
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  * Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *  * Neither the name of the ITU/ISO/IEC nor the names of its contributors may
+ *    be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** \file     TComSimd.h
+    \brief    run-time selection of the vector (SIMD) code paths (header)
+*/
+
+#ifndef __TCOMSIMD__
+#define __TCOMSIMD__
+
+#include "CommonDef.h"
+#include <string>
+#include <vector>
+
+//! \ingroup TLibCommon
+//! \{
+
+/// instruction set levels, in increasing order of capability
+enum SIMDLevel
+{
+  SIMD_SCALAR           = 0,
+  SIMD_SSE2             = 1,
+  SIMD_SSE41            = 2,
+  SIMD_AVX2             = 3,
+  SIMD_AVX512           = 4,
+  NUMBER_OF_SIMD_LEVELS = 5
+};
+
+/// function filling the kernel table of a module for the given level
+typedef Void (*SIMDKernelInit)( const SIMDLevel level );
+
+#if VECTOR_CODING__AVX2_KERNELS && ( defined(__GNUC__) || defined(__clang__) )
+#define SIMD_TARGET_AVX2 __attribute__((target("avx2")))   ///< compiles a function for AVX2 without compiling the whole build for it
+#else
+#define SIMD_TARGET_AVX2
+#endif
+
+/** Registry of the vector kernels.
+ *  Each module that has vector kernels keeps a table of function pointers to them, and registers a function that fills
+ *  the table for a given instruction set level (see registerKernels()). The tables start with the highest level that
+ *  is supported by both the CPU and the compiled-in kernels, and are filled again for a lower level by setLevel(),
+ *  e.g. for A/B testing. The kernels of a level above SSE2 are compiled with function target attributes, so a single
+ *  binary runs on any x86 CPU and uses, for instance, the AVX2 kernels only where AVX2 is available.
+ *  Only levels for which kernels are compiled in can be selected (see isLevelAvailable()).
+ */
+class TComSimd
+{
+public:
+  static SIMDLevel    detectLevel      ();                              ///< highest level supported by the CPU and operating system
+  static Bool         isLevelAvailable ( const SIMDLevel level );       ///< true for the scalar level and the levels of the compiled-in kernels
+  static Void         setLevel         ( const SIMDLevel maxLevel );    ///< select the highest available level not above maxLevel, and fill all kernel tables for it
+  static SIMDLevel    getLevel         ()                               { return xGetLevel(); }
+
+  static Bool         registerKernels  ( SIMDKernelInit init );         ///< add the kernel table of a module and fill it for the current level; returns true
+
+  static const TChar* getLevelName     ( const SIMDLevel level );
+  static SIMDLevel    stringToLevel    ( const std::string &value );    ///< "auto" or empty selects the highest level; NUMBER_OF_SIMD_LEVELS if invalid or not available
+  static std::string  getListOfLevels  ();
+
+private:
+  static SIMDLevel&   xGetLevel        ();                              // function-local static, as the tables are registered during static initialisation
+  static std::vector<SIMDKernelInit>& xGetKernelInits();
+};
+
+//! \}
+
+#endif // __TCOMSIMD__
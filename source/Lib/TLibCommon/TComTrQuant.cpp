@@ -43,8 +43,13 @@
 #include "TComPic.h"
 #include "ContextTables.h"
 #include "TComTU.h"
+#include "TComSimd.h"
 #include "Debug.h"
 
+#if VECTOR_CODING__QUANTISATION && (RExt__HIGH_BIT_DEPTH_SUPPORT==0)
+#include <emmintrin.h>
+#endif
+
 typedef struct
 {
   Int    iNNZbeforePos0;
@@ -64,6 +69,83 @@ typedef struct
 #define RDOQ_CHROMA                 1           ///< use of RDOQ in chroma
 
 
+// ====================================================================================================================
+// Kernels
+// ====================================================================================================================
+
+/** Flat-scaled dequantisation with rounding (rightShift > 0), see TComTrQuant::xDeQuant.
+ */
+static Void deQuantScalar( const TCoeff *piQCoef, TCoeff *piCoef, Int numSamples, Int scale, Int rightShift,
+                           Intermediate_Int inputMinimum, Intermediate_Int inputMaximum, TCoeff transformMinimum, TCoeff transformMaximum )
+{
+  const Intermediate_Int iAdd = 1 << (rightShift - 1);
+
+  for( Int n = 0; n < numSamples; n++ )
+  {
+    const TCoeff           clipQCoef = TCoeff(Clip3<Intermediate_Int>(inputMinimum, inputMaximum, piQCoef[n]));
+    const Intermediate_Int iCoeffQ   = (Intermediate_Int(clipQCoef) * scale + iAdd) >> rightShift;
+
+    piCoef[n] = TCoeff(Clip3<Intermediate_Int>(transformMinimum,transformMaximum,iCoeffQ));
+  }
+}
+
+#if VECTOR_CODING__QUANTISATION && (RExt__HIGH_BIT_DEPTH_SUPPORT==0)
+/** SSE2 version of deQuantScalar for 16-bit input and transform ranges (i.e. without extended precision processing).
+ *  The clipped levels and the scale fit in 16 bits, so the products are formed exactly with mullo/mulhi_epi16, and
+ *  the clip to the transform range is the saturation of _mm_packs_epi32.
+ */
+static Void simdDeQuant( const TCoeff *piQCoef, TCoeff *piCoef, Int numSamples, Int scale, Int rightShift,
+                         Intermediate_Int inputMinimum, Intermediate_Int inputMaximum, TCoeff transformMinimum, TCoeff transformMaximum )
+{
+  if( inputMinimum < -32768 || inputMaximum > 32767 || transformMinimum != -32768 || transformMaximum != 32767 || ( numSamples & 7 ) != 0 )
+  {
+    deQuantScalar( piQCoef, piCoef, numSamples, scale, rightShift, inputMinimum, inputMaximum, transformMinimum, transformMaximum );
+    return;
+  }
+
+  const __m128i mmInputMin = _mm_set1_epi16( inputMinimum );
+  const __m128i mmInputMax = _mm_set1_epi16( inputMaximum );
+  const __m128i mmScale    = _mm_set1_epi16( scale );
+  const __m128i mmAdd      = _mm_set1_epi32( 1 << ( rightShift - 1 ) );
+  const __m128i mmShift    = _mm_cvtsi32_si128( rightShift );
+  for( Int n = 0; n < numSamples; n += 8 )
+  {
+    __m128i mmLevel = _mm_packs_epi32( _mm_loadu_si128( ( const __m128i * )( piQCoef + n ) ), _mm_loadu_si128( ( const __m128i * )( piQCoef + n + 4 ) ) );
+    mmLevel = _mm_min_epi16( _mm_max_epi16( mmLevel, mmInputMin ), mmInputMax );
+    const __m128i mmProdLo = _mm_mullo_epi16( mmLevel, mmScale );
+    const __m128i mmProdHi = _mm_mulhi_epi16( mmLevel, mmScale );
+    const __m128i mmCoef0  = _mm_sra_epi32( _mm_add_epi32( _mm_unpacklo_epi16( mmProdLo, mmProdHi ), mmAdd ), mmShift );
+    const __m128i mmCoef1  = _mm_sra_epi32( _mm_add_epi32( _mm_unpackhi_epi16( mmProdLo, mmProdHi ), mmAdd ), mmShift );
+    const __m128i mmCoef   = _mm_packs_epi32( mmCoef0, mmCoef1 );
+    _mm_storeu_si128( ( __m128i * )( piCoef + n     ), _mm_srai_epi32( _mm_unpacklo_epi16( mmCoef, mmCoef ), 16 ) );
+    _mm_storeu_si128( ( __m128i * )( piCoef + n + 4 ), _mm_srai_epi32( _mm_unpackhi_epi16( mmCoef, mmCoef ), 16 ) );
+  }
+}
+#endif
+
+/// quantisation kernels of the selected instruction set level (see TComSimd)
+struct QuantisationKernels
+{
+  Void (*deQuant)( const TCoeff *piQCoef, TCoeff *piCoef, Int numSamples, Int scale, Int rightShift,
+                   Intermediate_Int inputMinimum, Intermediate_Int inputMaximum, TCoeff transformMinimum, TCoeff transformMaximum );
+};
+
+static QuantisationKernels quantisationKernels;
+
+static Void initQuantisationKernels( const SIMDLevel level )
+{
+  quantisationKernels.deQuant = deQuantScalar;
+#if VECTOR_CODING__QUANTISATION && (RExt__HIGH_BIT_DEPTH_SUPPORT==0)
+  if( level >= SIMD_SSE2 )
+  {
+    quantisationKernels.deQuant = simdDeQuant;
+  }
+#endif
+}
+
+static const Bool quantisationKernelsRegistered = TComSimd::registerKernels( initQuantisationKernels );
+
+
 // ====================================================================================================================
 // QpParam constructor
 // ====================================================================================================================
@@ -1398,15 +1480,7 @@ Void TComTrQuant::xDeQuant(       TComTU        &rTu,
 
     if (rightShift > 0)
     {
-      const Intermediate_Int iAdd = 1 << (rightShift - 1);
-
-      for( Int n = 0; n < numSamplesInBlock; n++ )
-      {
-        const TCoeff           clipQCoef = TCoeff(Clip3<Intermediate_Int>(inputMinimum, inputMaximum, piQCoef[n]));
-        const Intermediate_Int iCoeffQ   = (Intermediate_Int(clipQCoef) * scale + iAdd) >> rightShift;
-
-        piCoef[n] = TCoeff(Clip3<Intermediate_Int>(transformMinimum,transformMaximum,iCoeffQ));
-      }
+      quantisationKernels.deQuant( piQCoef, piCoef, numSamplesInBlock, scale, rightShift, inputMinimum, inputMaximum, transformMinimum, transformMaximum );
     }
     else
     {
@@ -1428,6 +1502,7 @@ Void TComTrQuant::init(   UInt  uiMaxTrSize,
                           Bool  bUseRDOQ,
                           Bool  bUseRDOQTS,
                           Bool  useSelectiveRDOQ,
+                          Bool  useFastRDOQ,
                           Bool  bEnc,
                           Bool  useTransformSkipFast
 #if ADAPTIVE_QP_SELECTION
@@ -1440,6 +1515,7 @@ Void TComTrQuant::init(   UInt  uiMaxTrSize,
   m_useRDOQ      = bUseRDOQ;
   m_useRDOQTS    = bUseRDOQTS;
   m_useSelectiveRDOQ = useSelectiveRDOQ;
+  m_useFastRDOQ      = useFastRDOQ;
 #if ADAPTIVE_QP_SELECTION
   m_bUseAdaptQpSelect = bUseAdaptQpSelect;
 #endif
@@ -2223,6 +2299,45 @@ Void TComTrQuant::xRateDistOptQuant                 (       TComTU       &rTu,
   coeffGroupRDStats rdStats;
 
   const UInt significanceMapContextOffset = getSignificanceMapContextOffset(compID);
+  const Bool bSignHiding                  = pcCU->getSlice()->getPPS()->getSignDataHidingEnabledFlag();
+
+  // fast RDOQ: find the coefficient groups in which no coefficient rounds to a non-zero level. RDOQ can only lower levels,
+  // so these groups stay zero and are not searched
+  Bool bGroupHasLevel[ MLS_GRP_NUM ];
+  if ( m_useFastRDOQ )
+  {
+    Bool bAnyLevel = false;
+    for (Int iCGScanPos = uiCGNum-1; iCGScanPos >= 0; iCGScanPos--)
+    {
+      bGroupHasLevel[ iCGScanPos ] = false;
+      for (Int iScanPosinCG = uiCGSize-1; iScanPosinCG >= 0 && !bGroupHasLevel[ iCGScanPos ]; iScanPosinCG--)
+      {
+        const UInt   uiBlkPos                = codingParameters.scan[ iCGScanPos*uiCGSize + iScanPosinCG ];
+        const Int    quantisationCoefficient = (enableScalingLists) ? piQCoef[uiBlkPos] : defaultQuantisationCoefficient;
+        const Int64  tmpLevel                = Int64(abs(plSrcCoeff[ uiBlkPos ])) * quantisationCoefficient;
+        bGroupHasLevel[ iCGScanPos ]         = tmpLevel >= ( Int64(1) << (iQBits - 1) );
+      }
+      bAnyLevel = bAnyLevel || bGroupHasLevel[ iCGScanPos ];
+    }
+
+    if ( !bAnyLevel )
+    {
+      memset( piDstCoeff, 0, sizeof(TCoeff) * uiMaxNumCoeff );
+#if ADAPTIVE_QP_SELECTION
+      if( m_bUseAdaptQpSelect )
+      {
+        for ( UInt uiBlkPos = 0; uiBlkPos < uiMaxNumCoeff; uiBlkPos++ )
+        {
+          const Int quantisationCoefficient = (enableScalingLists) ? piQCoef[uiBlkPos] : defaultQuantisationCoefficient;
+          const Int64 tmpLevel              = Int64(abs(plSrcCoeff[ uiBlkPos ])) * quantisationCoefficient;
+          const Intermediate_Int lLevelDouble = (Intermediate_Int)min<Int64>(tmpLevel, std::numeric_limits<Intermediate_Int>::max() - (Intermediate_Int(1) << (iQBits - 1)));
+          piArlDstCoeff[uiBlkPos]           = (TCoeff)(( lLevelDouble + iAddC) >> iQBitsC );
+        }
+      }
+#endif
+      return;
+    }
+  }
 
   for (Int iCGScanPos = uiCGNum-1; iCGScanPos >= 0; iCGScanPos--)
   {
@@ -2234,6 +2349,9 @@ Void TComTrQuant::xRateDistOptQuant                 (       TComTU       &rTu,
 
     const Int patternSigCtx = TComTrQuant::calcPatternSigCtx(uiSigCoeffGroupFlag, uiCGPosX, uiCGPosY, codingParameters.widthInGroups, codingParameters.heightInGroups);
 
+    // a group without levels is coded with its significance flag only; the first group is not skipped, since its flag is inferred
+    const Bool bSkipGroup = m_useFastRDOQ && !bGroupHasLevel[ iCGScanPos ] && iCGScanPos > 0;
+
     for (Int iScanPosinCG = uiCGSize-1; iScanPosinCG >= 0; iScanPosinCG--)
     {
       iScanPos = iCGScanPos*uiCGSize + iScanPosinCG;
@@ -2261,6 +2379,13 @@ Void TComTrQuant::xRateDistOptQuant                 (       TComTU       &rTu,
       d64BlockUncodedCost      += pdCostCoeff0[ iScanPos ];
       piDstCoeff[ uiBlkPos ]    = uiMaxAbsLevel;
 
+      if ( bSkipGroup )
+      {
+        pdCostCoeff[ iScanPos ] = pdCostCoeff0[ iScanPos ];
+        d64BaseCost            += pdCostCoeff0[ iScanPos ];
+        continue;
+      }
+
       if ( uiMaxAbsLevel > 0 && iLastScanPos < 0 )
       {
         iLastScanPos            = iScanPos;
@@ -2296,7 +2421,11 @@ Void TComTrQuant::xRateDistOptQuant                 (       TComTU       &rTu,
 
         deltaU[ uiBlkPos ]        = TCoeff((lLevelDouble - (Intermediate_Int(uiLevel) << iQBits)) >> (iQBits-8));
 
-        if( uiLevel > 0 )
+        if( m_useFastRDOQ && !bSignHiding )
+        {
+          // the rate increments are used by sign data hiding only
+        }
+        else if( uiLevel > 0 )
         {
           Int rateNow = xGetICRate( uiLevel, uiOneCtx, uiAbsCtx, uiGoRiceParam, c1Idx, c2Idx, extendedPrecision, maxLog2TrDynamicRange );
           rateIncUp   [ uiBlkPos ] = xGetICRate( uiLevel+1, uiOneCtx, uiAbsCtx, uiGoRiceParam, c1Idx, c2Idx, extendedPrecision, maxLog2TrDynamicRange ) - rateNow;
@@ -2366,6 +2495,17 @@ Void TComTrQuant::xRateDistOptQuant                 (       TComTU       &rTu,
       }
     } //end for (iScanPosinCG)
 
+    if ( bSkipGroup && iLastScanPos >= 0 )
+    {
+      // context update of the skipped group, as done at its first coefficient
+      uiCtxSet          = getContextSetIndex(compID, iCGScanPos - 1, (c1 == 0));
+      c1                = 1;
+      c2                = 0;
+      c1Idx             = 0;
+      c2Idx             = 0;
+      uiGoRiceParam     = initialGolombRiceParameter;
+    }
+
     if (iCGLastScanPos >= 0)
     {
       if( iCGScanPos )
@@ -2459,6 +2599,19 @@ Void TComTrQuant::xRateDistOptQuant                 (       TComTU       &rTu,
     d64BaseCost += xGetICost( m_pcEstBitsSbac->blockCbpBits[ ui16CtxCbf ][ 1 ] );
   }
 
+  // fast RDOQ: integer rates of the last position prefixes and suffixes, indexed by the prefix context
+  Int aiRateLastX[ LAST_SIGNIFICANT_GROUPS ];
+  Int aiRateLastY[ LAST_SIGNIFICANT_GROUPS ];
+  if ( m_useFastRDOQ )
+  {
+    const UInt uiNumLastCtx = g_uiGroupIdx[ std::max( uiWidth, uiHeight ) - 1 ] + 1;
+    for ( UInt uiCtx = 0; uiCtx < uiNumLastCtx; uiCtx++ )
+    {
+      const Int iSuffixRate = ( uiCtx > 3 ) ? Int( xGetIEPRate() ) * Int( ( uiCtx - 2 ) >> 1 ) : 0;
+      aiRateLastX[ uiCtx ]  = m_pcEstBitsSbac->lastXBits[ channelType ][ uiCtx ] + iSuffixRate;
+      aiRateLastY[ uiCtx ]  = m_pcEstBitsSbac->lastYBits[ channelType ][ uiCtx ] + iSuffixRate;
+    }
+  }
 
   Bool bFoundLast = false;
   for (Int iCGScanPos = iCGLastScanPos; iCGScanPos >= 0; iCGScanPos--)
@@ -2483,7 +2636,17 @@ Void TComTrQuant::xRateDistOptQuant                 (       TComTU       &rTu,
           UInt   uiPosY       = uiBlkPos >> uiLog2BlockWidth;
           UInt   uiPosX       = uiBlkPos - ( uiPosY << uiLog2BlockWidth );
 
-          Double d64CostLast= codingParameters.scanType == SCAN_VER ? xGetRateLast( uiPosY, uiPosX, compID ) : xGetRateLast( uiPosX, uiPosY, compID );
+          Double d64CostLast;
+          if ( m_useFastRDOQ )
+          {
+            const UInt uiLastX = codingParameters.scanType == SCAN_VER ? uiPosY : uiPosX;
+            const UInt uiLastY = codingParameters.scanType == SCAN_VER ? uiPosX : uiPosY;
+            d64CostLast        = xGetICost( aiRateLastX[ g_uiGroupIdx[ uiLastX ] ] + aiRateLastY[ g_uiGroupIdx[ uiLastY ] ] );
+          }
+          else
+          {
+            d64CostLast        = codingParameters.scanType == SCAN_VER ? xGetRateLast( uiPosY, uiPosX, compID ) : xGetRateLast( uiPosX, uiPosY, compID );
+          }
           Double totalCost = d64BaseCost + d64CostLast - pdCostSig[ iScanPos ];
 
           if( totalCost < d64BestCost )
@@ -2527,7 +2690,7 @@ Void TComTrQuant::xRateDistOptQuant                 (       TComTU       &rTu,
   }
 
 
-  if( pcCU->getSlice()->getPPS()->getSignDataHidingEnabledFlag() && uiAbsSum>=2)
+  if( bSignHiding && uiAbsSum>=2)
   {
     const Double inverseQuantScale = Double(g_invQuantScales[cQP.rem]);
     Int64 rdFactor = (Int64)(inverseQuantScale * inverseQuantScale * (1 << (2 * cQP.per))
@@ -2853,6 +3016,10 @@ __inline UInt TComTrQuant::xGetCodedLevel ( Double&          rd64CodedCost,
   for( Int uiAbsLevel  = uiMaxAbsLevel; uiAbsLevel >= uiMinAbsLevel ; uiAbsLevel-- )
   {
     Double dErr         = Double( lLevelDouble  - ( Intermediate_Int(uiAbsLevel) << iQBits ) );
+    if( m_useFastRDOQ && dErr * dErr * errorScale + dCurrCostSig >= rd64CodedCost )
+    {
+      continue; // the distortion alone is not lower than the best cost, so the rate is not needed
+    }
     Double dCurrCost    = dErr * dErr * errorScale + xGetICost( xGetICRate( uiAbsLevel, ui16CtxNumOne, ui16CtxNumAbs, ui16AbsGoRice, c1Idx, c2Idx, useLimitedPrefixLength, maxLog2TrDynamicRange ) );
     dCurrCost          += dCurrCostSig;
 
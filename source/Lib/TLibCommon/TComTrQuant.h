@@ -106,6 +106,7 @@ public:
                               Bool useRDOQ                = false,
                               Bool useRDOQTS              = false,
                               Bool useSelectiveRDOQ       = false,
+                              Bool useFastRDOQ            = false,
                               Bool bEnc                   = false,
                               Bool useTransformSkipFast   = false
 #if ADAPTIVE_QP_SELECTION
@@ -151,6 +152,8 @@ public:
   Void setLambda(Double dLambda) { m_dLambda = dLambda;}
 #endif
   Void setRDOQOffset( UInt uiRDOQOffset ) { m_uiRDOQOffset = uiRDOQOffset; }
+  Void setUseRDOQ( const Bool useRDOQ, const Bool useRDOQTS ) { m_useRDOQ = useRDOQ; m_useRDOQTS = useRDOQTS; }
+  Bool getUseRDOQ( const Bool useTransformSkip ) const { return useTransformSkip ? m_useRDOQTS : m_useRDOQ; }
 
   estBitsSbacStruct* m_pcEstBitsSbac;
 
@@ -217,6 +220,7 @@ protected:
   Bool     m_useRDOQ;
   Bool     m_useRDOQTS;
   Bool     m_useSelectiveRDOQ;
+  Bool     m_useFastRDOQ;
 #if ADAPTIVE_QP_SELECTION
   Bool     m_bUseAdaptQpSelect;
 #endif
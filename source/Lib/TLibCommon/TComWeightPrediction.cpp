@@ -41,7 +41,11 @@
 #include "TComPic.h"
 #include "TComInterpolationFilter.h"
 #include "TComWeightPrediction.h"
+#include "TComSimd.h"
 
+#if VECTOR_CODING__WEIGHTED_PREDICTION && (RExt__HIGH_BIT_DEPTH_SUPPORT==0)
+#include <emmintrin.h>
+#endif
 
 static inline Pel weightBidir( Int w0, Pel P0, Int w1, Pel P1, Int round, Int shift, Int offset, Int clipBD)
 {
@@ -64,6 +68,217 @@ static inline Pel noWeightOffsetUnidir( Pel P0, Int round, Int shift, Int clipBD
   return ClipBD( ( ((P0 + IF_INTERNAL_OFFS) + round) >> shift ), clipBD );
 }
 
+static Void addWeightBiScalar( const Pel *pSrc0, Int iSrc0Stride, const Pel *pSrc1, Int iSrc1Stride, Pel *pDst, Int iDstStride, Int iWidth, Int iHeight,
+                               Int w0, Int w1, Int round, Int shift, Int offset, Int clipBD )
+{
+  for ( Int y = iHeight-1; y >= 0; y-- )
+  {
+    // do it in batches of 4 (partial unroll)
+    Int x = iWidth-1;
+    for ( ; x >= 3; )
+    {
+      pDst[x] = weightBidir(w0,pSrc0[x], w1,pSrc1[x], round, shift, offset, clipBD); x--;
+      pDst[x] = weightBidir(w0,pSrc0[x], w1,pSrc1[x], round, shift, offset, clipBD); x--;
+      pDst[x] = weightBidir(w0,pSrc0[x], w1,pSrc1[x], round, shift, offset, clipBD); x--;
+      pDst[x] = weightBidir(w0,pSrc0[x], w1,pSrc1[x], round, shift, offset, clipBD); x--;
+    }
+    for( ; x >= 0; x-- )
+    {
+      pDst[x] = weightBidir(w0,pSrc0[x], w1,pSrc1[x], round, shift, offset, clipBD);
+    }
+
+    pSrc0 += iSrc0Stride;
+    pSrc1 += iSrc1Stride;
+    pDst  += iDstStride;
+  } // y loop
+}
+
+// The default weight is passed as w0=1 with shift=shiftNum.
+static Void addWeightUniScalar( const Pel *pSrc0, Int iSrc0Stride, Pel *pDst, Int iDstStride, Int iWidth, Int iHeight,
+                                Int w0, Int round, Int shift, Int offset, Int clipBD )
+{
+  if (w0 != 1)
+  {
+    for (Int y = iHeight-1; y >= 0; y-- )
+    {
+      Int x = iWidth-1;
+      for ( ; x >= 3; )
+      {
+        pDst[x] = weightUnidir(w0, pSrc0[x], round, shift, offset, clipBD); x--;
+        pDst[x] = weightUnidir(w0, pSrc0[x], round, shift, offset, clipBD); x--;
+        pDst[x] = weightUnidir(w0, pSrc0[x], round, shift, offset, clipBD); x--;
+        pDst[x] = weightUnidir(w0, pSrc0[x], round, shift, offset, clipBD); x--;
+      }
+      for( ; x >= 0; x--)
+      {
+        pDst[x] = weightUnidir(w0, pSrc0[x], round, shift, offset, clipBD);
+      }
+      pSrc0 += iSrc0Stride;
+      pDst  += iDstStride;
+    }
+  }
+  else
+  {
+    if (offset == 0)
+    {
+      for (Int y = iHeight-1; y >= 0; y-- )
+      {
+        Int x = iWidth-1;
+        for ( ; x >= 3; )
+        {
+          pDst[x] = noWeightOffsetUnidir(pSrc0[x], round, shift, clipBD); x--;
+          pDst[x] = noWeightOffsetUnidir(pSrc0[x], round, shift, clipBD); x--;
+          pDst[x] = noWeightOffsetUnidir(pSrc0[x], round, shift, clipBD); x--;
+          pDst[x] = noWeightOffsetUnidir(pSrc0[x], round, shift, clipBD); x--;
+        }
+        for( ; x >= 0; x--)
+        {
+          pDst[x] = noWeightOffsetUnidir(pSrc0[x], round, shift, clipBD);
+        }
+        pSrc0 += iSrc0Stride;
+        pDst  += iDstStride;
+      }
+    }
+    else
+    {
+      for (Int y = iHeight-1; y >= 0; y-- )
+      {
+        Int x = iWidth-1;
+        for ( ; x >= 3; )
+        {
+          pDst[x] = noWeightUnidir(pSrc0[x], round, shift, offset, clipBD); x--;
+          pDst[x] = noWeightUnidir(pSrc0[x], round, shift, offset, clipBD); x--;
+          pDst[x] = noWeightUnidir(pSrc0[x], round, shift, offset, clipBD); x--;
+          pDst[x] = noWeightUnidir(pSrc0[x], round, shift, offset, clipBD); x--;
+        }
+        for( ; x >= 0; x--)
+        {
+          pDst[x] = noWeightUnidir(pSrc0[x], round, shift, offset, clipBD);
+        }
+        pSrc0 += iSrc0Stride;
+        pDst  += iDstStride;
+      }
+    }
+  }
+}
+
+#if VECTOR_CODING__WEIGHTED_PREDICTION && (RExt__HIGH_BIT_DEPTH_SUPPORT==0)
+// The weighted sums are formed in 32 bits, exactly as in the scalar functions above; the constant terms
+// (IF_INTERNAL_OFFS scaled by the weights, rounding and offset) are folded into a single addend.
+
+static inline __m128i simdWeightBi( const __m128i &mmSrc0, const __m128i &mmSrc1, const __m128i &mmWeight, const __m128i &mmAdd, const __m128i &mmShift, const __m128i &mmMax )
+{
+  __m128i mmLo = _mm_madd_epi16( _mm_unpacklo_epi16( mmSrc0, mmSrc1 ), mmWeight );
+  __m128i mmHi = _mm_madd_epi16( _mm_unpackhi_epi16( mmSrc0, mmSrc1 ), mmWeight );
+  mmLo = _mm_sra_epi32( _mm_add_epi32( mmLo, mmAdd ), mmShift );
+  mmHi = _mm_sra_epi32( _mm_add_epi32( mmHi, mmAdd ), mmShift );
+  return _mm_min_epi16( _mm_max_epi16( _mm_packs_epi32( mmLo, mmHi ), _mm_setzero_si128() ), mmMax );
+}
+
+static Void simdAddWeightBi( const Pel *pSrc0, Int iSrc0Stride, const Pel *pSrc1, Int iSrc1Stride, Pel *pDst, Int iDstStride, Int iWidth, Int iHeight,
+                             Int w0, Int w1, Int round, Int shift, Int offset, Int clipBD )
+{
+  const __m128i mmWeight = _mm_set_epi16( w1, w0, w1, w0, w1, w0, w1, w0 );
+  const __m128i mmAdd    = _mm_set1_epi32( ( w0 + w1 ) * IF_INTERNAL_OFFS + round + ( offset << ( shift - 1 ) ) );
+  const __m128i mmShift  = _mm_cvtsi32_si128( shift );
+  const __m128i mmMax    = _mm_set1_epi16( ( 1 << clipBD ) - 1 );
+  for( Int y = 0; y < iHeight; y++ )
+  {
+    Int x = 0;
+    for( ; x + 8 <= iWidth; x += 8 )
+    {
+      const __m128i mmSrc0 = _mm_loadu_si128( ( const __m128i * )( pSrc0 + x ) );
+      const __m128i mmSrc1 = _mm_loadu_si128( ( const __m128i * )( pSrc1 + x ) );
+      _mm_storeu_si128( ( __m128i * )( pDst + x ), simdWeightBi( mmSrc0, mmSrc1, mmWeight, mmAdd, mmShift, mmMax ) );
+    }
+    if( x + 4 <= iWidth )
+    {
+      const __m128i mmSrc0 = _mm_loadl_epi64( ( const __m128i * )( pSrc0 + x ) );
+      const __m128i mmSrc1 = _mm_loadl_epi64( ( const __m128i * )( pSrc1 + x ) );
+      _mm_storel_epi64( ( __m128i * )( pDst + x ), simdWeightBi( mmSrc0, mmSrc1, mmWeight, mmAdd, mmShift, mmMax ) );
+      x += 4;
+    }
+    for( ; x < iWidth; x++ )
+    {
+      pDst[x] = weightBidir( w0, pSrc0[x], w1, pSrc1[x], round, shift, offset, clipBD );
+    }
+    pSrc0 += iSrc0Stride;
+    pSrc1 += iSrc1Stride;
+    pDst  += iDstStride;
+  }
+}
+
+static inline __m128i simdWeightUni( const __m128i &mmSrc, const __m128i &mmWeight, const __m128i &mmAdd, const __m128i &mmShift, const __m128i &mmOffset, const __m128i &mmMax )
+{
+  const __m128i mmProdLo = _mm_mullo_epi16( mmSrc, mmWeight );
+  const __m128i mmProdHi = _mm_mulhi_epi16( mmSrc, mmWeight );
+  __m128i mmLo = _mm_add_epi32( _mm_unpacklo_epi16( mmProdLo, mmProdHi ), mmAdd );
+  __m128i mmHi = _mm_add_epi32( _mm_unpackhi_epi16( mmProdLo, mmProdHi ), mmAdd );
+  mmLo = _mm_add_epi32( _mm_sra_epi32( mmLo, mmShift ), mmOffset );
+  mmHi = _mm_add_epi32( _mm_sra_epi32( mmHi, mmShift ), mmOffset );
+  return _mm_min_epi16( _mm_max_epi16( _mm_packs_epi32( mmLo, mmHi ), _mm_setzero_si128() ), mmMax );
+}
+
+// Also covers the default-weight cases (noWeightUnidir/noWeightOffsetUnidir) with w0=1 and shift=shiftNum.
+static Void simdAddWeightUni( const Pel *pSrc0, Int iSrc0Stride, Pel *pDst, Int iDstStride, Int iWidth, Int iHeight,
+                              Int w0, Int round, Int shift, Int offset, Int clipBD )
+{
+  const __m128i mmWeight = _mm_set1_epi16( w0 );
+  const __m128i mmAdd    = _mm_set1_epi32( w0 * IF_INTERNAL_OFFS + round );
+  const __m128i mmShift  = _mm_cvtsi32_si128( shift );
+  const __m128i mmOffset = _mm_set1_epi32( offset );
+  const __m128i mmMax    = _mm_set1_epi16( ( 1 << clipBD ) - 1 );
+  for( Int y = 0; y < iHeight; y++ )
+  {
+    Int x = 0;
+    for( ; x + 8 <= iWidth; x += 8 )
+    {
+      const __m128i mmSrc = _mm_loadu_si128( ( const __m128i * )( pSrc0 + x ) );
+      _mm_storeu_si128( ( __m128i * )( pDst + x ), simdWeightUni( mmSrc, mmWeight, mmAdd, mmShift, mmOffset, mmMax ) );
+    }
+    if( x + 4 <= iWidth )
+    {
+      const __m128i mmSrc = _mm_loadl_epi64( ( const __m128i * )( pSrc0 + x ) );
+      _mm_storel_epi64( ( __m128i * )( pDst + x ), simdWeightUni( mmSrc, mmWeight, mmAdd, mmShift, mmOffset, mmMax ) );
+      x += 4;
+    }
+    for( ; x < iWidth; x++ )
+    {
+      pDst[x] = weightUnidir( w0, pSrc0[x], round, shift, offset, clipBD );
+    }
+    pSrc0 += iSrc0Stride;
+    pDst  += iDstStride;
+  }
+}
+#endif
+
+
+/// weighted prediction kernels of the selected instruction set level (see TComSimd)
+struct WeightPredictionKernels
+{
+  Void (*addWeightBi) ( const Pel *pSrc0, Int iSrc0Stride, const Pel *pSrc1, Int iSrc1Stride, Pel *pDst, Int iDstStride, Int iWidth, Int iHeight,
+                        Int w0, Int w1, Int round, Int shift, Int offset, Int clipBD );
+  Void (*addWeightUni)( const Pel *pSrc0, Int iSrc0Stride, Pel *pDst, Int iDstStride, Int iWidth, Int iHeight,
+                        Int w0, Int round, Int shift, Int offset, Int clipBD );
+};
+
+static WeightPredictionKernels weightPredictionKernels;
+
+static Void initWeightPredictionKernels( const SIMDLevel level )
+{
+  weightPredictionKernels.addWeightBi  = addWeightBiScalar;
+  weightPredictionKernels.addWeightUni = addWeightUniScalar;
+#if VECTOR_CODING__WEIGHTED_PREDICTION && (RExt__HIGH_BIT_DEPTH_SUPPORT==0)
+  if( level >= SIMD_SSE2 )
+  {
+    weightPredictionKernels.addWeightBi  = simdAddWeightBi;
+    weightPredictionKernels.addWeightUni = simdAddWeightUni;
+  }
+#endif
+}
+
+static const Bool weightPredictionKernelsRegistered = TComSimd::registerKernels( initWeightPredictionKernels );
+
 
 // ====================================================================================================================
 // Class definition
@@ -116,26 +331,7 @@ Void TComWeightPrediction::addWeightBi( const TComYuv              *pcYuvSrc0,
     const UInt iSrc1Stride = pcYuvSrc1->getStride(compID);
     const UInt iDstStride  = rpcYuvDst->getStride(compID);
 
-    for ( Int y = iHeight-1; y >= 0; y-- )
-    {
-      // do it in batches of 4 (partial unroll)
-      Int x = iWidth-1;
-      for ( ; x >= 3; )
-      {
-        pDst[x] = weightBidir(w0,pSrc0[x], w1,pSrc1[x], round, shift, offset, clipBD); x--;
-        pDst[x] = weightBidir(w0,pSrc0[x], w1,pSrc1[x], round, shift, offset, clipBD); x--;
-        pDst[x] = weightBidir(w0,pSrc0[x], w1,pSrc1[x], round, shift, offset, clipBD); x--;
-        pDst[x] = weightBidir(w0,pSrc0[x], w1,pSrc1[x], round, shift, offset, clipBD); x--;
-      }
-      for( ; x >= 0; x-- )
-      {
-        pDst[x] = weightBidir(w0,pSrc0[x], w1,pSrc1[x], round, shift, offset, clipBD);
-      }
-
-      pSrc0 += iSrc0Stride;
-      pSrc1 += iSrc1Stride;
-      pDst  += iDstStride;
-    } // y loop
+    weightPredictionKernels.addWeightBi( pSrc0, iSrc0Stride, pSrc1, iSrc1Stride, pDst, iDstStride, iWidth, iHeight, w0, w1, round, shift, offset, clipBD );
   } // compID loop
 }
 
@@ -173,68 +369,11 @@ Void TComWeightPrediction::addWeightUni( const TComYuv        *const pcYuvSrc0,
 
     if (w0 != 1 << wp0[compID].shift)
     {
-      const Int  round       = (shift > 0) ? (1<<(shift-1)) : 0;
-      for (Int y = iHeight-1; y >= 0; y-- )
-      {
-        Int x = iWidth-1;
-        for ( ; x >= 3; )
-        {
-          pDst[x] = weightUnidir(w0, pSrc0[x], round, shift, offset, clipBD); x--;
-          pDst[x] = weightUnidir(w0, pSrc0[x], round, shift, offset, clipBD); x--;
-          pDst[x] = weightUnidir(w0, pSrc0[x], round, shift, offset, clipBD); x--;
-          pDst[x] = weightUnidir(w0, pSrc0[x], round, shift, offset, clipBD); x--;
-        }
-        for( ; x >= 0; x--)
-        {
-          pDst[x] = weightUnidir(w0, pSrc0[x], round, shift, offset, clipBD);
-        }
-        pSrc0 += iSrc0Stride;
-        pDst  += iDstStride;
-      }
+      weightPredictionKernels.addWeightUni( pSrc0, iSrc0Stride, pDst, iDstStride, iWidth, iHeight, w0, (shift > 0) ? (1<<(shift-1)) : 0, shift, offset, clipBD );
     }
     else
     {
-      const Int  round       = (shiftNum > 0) ? (1<<(shiftNum-1)) : 0;
-      if (offset == 0)
-      {
-        for (Int y = iHeight-1; y >= 0; y-- )
-        {
-          Int x = iWidth-1;
-          for ( ; x >= 3; )
-          {
-            pDst[x] = noWeightOffsetUnidir(pSrc0[x], round, shiftNum, clipBD); x--;
-            pDst[x] = noWeightOffsetUnidir(pSrc0[x], round, shiftNum, clipBD); x--;
-            pDst[x] = noWeightOffsetUnidir(pSrc0[x], round, shiftNum, clipBD); x--;
-            pDst[x] = noWeightOffsetUnidir(pSrc0[x], round, shiftNum, clipBD); x--;
-          }
-          for( ; x >= 0; x--)
-          {
-            pDst[x] = noWeightOffsetUnidir(pSrc0[x], round, shiftNum, clipBD);
-          }
-          pSrc0 += iSrc0Stride;
-          pDst  += iDstStride;
-        }
-      }
-      else
-      {
-        for (Int y = iHeight-1; y >= 0; y-- )
-        {
-          Int x = iWidth-1;
-          for ( ; x >= 3; )
-          {
-            pDst[x] = noWeightUnidir(pSrc0[x], round, shiftNum, offset, clipBD); x--;
-            pDst[x] = noWeightUnidir(pSrc0[x], round, shiftNum, offset, clipBD); x--;
-            pDst[x] = noWeightUnidir(pSrc0[x], round, shiftNum, offset, clipBD); x--;
-            pDst[x] = noWeightUnidir(pSrc0[x], round, shiftNum, offset, clipBD); x--;
-          }
-          for( ; x >= 0; x--)
-          {
-            pDst[x] = noWeightUnidir(pSrc0[x], round, shiftNum, offset, clipBD);
-          }
-          pSrc0 += iSrc0Stride;
-          pDst  += iDstStride;
-        }
-      }
+      weightPredictionKernels.addWeightUni( pSrc0, iSrc0Stride, pDst, iDstStride, iWidth, iHeight, 1, (shiftNum > 0) ? (1<<(shiftNum-1)) : 0, shiftNum, offset, clipBD );
     }
   }
 }
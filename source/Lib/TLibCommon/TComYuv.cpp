@@ -44,10 +44,331 @@
 #include "CommonDef.h"
 #include "TComYuv.h"
 #include "TComInterpolationFilter.h"
+#include "TComSimd.h"
+
+#if VECTOR_CODING__YUV_ARITHMETIC && (RExt__HIGH_BIT_DEPTH_SUPPORT==0)
+#include <emmintrin.h>
+#endif
 
 //! \ingroup TLibCommon
 //! \{
 
+static Void subtractScalar( const Pel *pSrc0, Int iSrc0Stride, const Pel *pSrc1, Int iSrc1Stride, Pel *pDst, Int iDstStride, Int iWidth, Int iHeight )
+{
+  for (Int y = iHeight-1; y >= 0; y-- )
+  {
+    for (Int x = iWidth-1; x >= 0; x-- )
+    {
+      pDst[x] = pSrc0[x] - pSrc1[x];
+    }
+    pSrc0 += iSrc0Stride;
+    pSrc1 += iSrc1Stride;
+    pDst  += iDstStride;
+  }
+}
+
+static Void addClipScalar( const Pel *pSrc0, Int iSrc0Stride, const Pel *pSrc1, Int iSrc1Stride, Pel *pDst, Int iDstStride, Int iWidth, Int iHeight, Int clipBd )
+{
+  for ( Int y = iHeight-1; y >= 0; y-- )
+  {
+    for ( Int x = iWidth-1; x >= 0; x-- )
+    {
+      pDst[x] = Pel(ClipBD<Int>( Int(pSrc0[x]) + Int(pSrc1[x]), clipBd));
+    }
+    pSrc0 += iSrc0Stride;
+    pSrc1 += iSrc1Stride;
+    pDst  += iDstStride;
+  }
+}
+
+static Void addAvgScalar( const Pel *pSrc0, Int iSrc0Stride, const Pel *pSrc1, Int iSrc1Stride, Pel *pDst, Int iDstStride, Int iWidth, Int iHeight, Int shiftNum, Int offset, Int clipBd )
+{
+  if (iWidth&2)
+  {
+    for ( Int y = 0; y < iHeight; y++ )
+    {
+      for (Int x=0 ; x < iWidth; x+=2 )
+      {
+        pDst[ x + 0 ] = ClipBD( rightShift(( pSrc0[ x + 0 ] + pSrc1[ x + 0 ] + offset ), shiftNum), clipBd );
+        pDst[ x + 1 ] = ClipBD( rightShift(( pSrc0[ x + 1 ] + pSrc1[ x + 1 ] + offset ), shiftNum), clipBd );
+      }
+      pSrc0 += iSrc0Stride;
+      pSrc1 += iSrc1Stride;
+      pDst  += iDstStride;
+    }
+  }
+  else
+  {
+    for ( Int y = 0; y < iHeight; y++ )
+    {
+      for (Int x=0 ; x < iWidth; x+=4 )
+      {
+        pDst[ x + 0 ] = ClipBD( rightShift(( pSrc0[ x + 0 ] + pSrc1[ x + 0 ] + offset ), shiftNum), clipBd );
+        pDst[ x + 1 ] = ClipBD( rightShift(( pSrc0[ x + 1 ] + pSrc1[ x + 1 ] + offset ), shiftNum), clipBd );
+        pDst[ x + 2 ] = ClipBD( rightShift(( pSrc0[ x + 2 ] + pSrc1[ x + 2 ] + offset ), shiftNum), clipBd );
+        pDst[ x + 3 ] = ClipBD( rightShift(( pSrc0[ x + 3 ] + pSrc1[ x + 3 ] + offset ), shiftNum), clipBd );
+      }
+      pSrc0 += iSrc0Stride;
+      pSrc1 += iSrc1Stride;
+      pDst  += iDstStride;
+    }
+  }
+}
+
+static Void removeHighFreqScalar( const Pel *pSrc, Int iSrcStride, Pel *pDst, Int iDstStride, Int iWidth, Int iHeight, Bool bClip, Int clipBd )
+{
+  if (bClip)
+  {
+    for ( Int y = iHeight-1; y >= 0; y-- )
+    {
+      for ( Int x = iWidth-1; x >= 0; x-- )
+      {
+        pDst[x ] = ClipBD((2 * pDst[x]) - pSrc[x], clipBd);
+      }
+      pSrc += iSrcStride;
+      pDst += iDstStride;
+    }
+  }
+  else
+  {
+    for ( Int y = iHeight-1; y >= 0; y-- )
+    {
+      for ( Int x = iWidth-1; x >= 0; x-- )
+      {
+        pDst[x ] = (2 * pDst[x]) - pSrc[x];
+      }
+      pSrc += iSrcStride;
+      pDst += iDstStride;
+    }
+  }
+}
+
+#if VECTOR_CODING__YUV_ARITHMETIC && (RExt__HIGH_BIT_DEPTH_SUPPORT==0)
+// Each kernel handles eight samples per step, then one four-sample step and finally any remaining
+// samples in scalar code, so that all block widths from 2 to 64 (including the AMP widths) are covered.
+// subtract and addClip are called for transform units, whose widths are powers of two: 4-wide blocks
+// pack two rows into one register, and narrower chroma blocks are left to the scalar kernels.
+
+static inline __m128i simdLoad4x2( const Pel *pSrc, Int iStride )
+{
+  return _mm_unpacklo_epi64( _mm_loadl_epi64( ( const __m128i * )pSrc ), _mm_loadl_epi64( ( const __m128i * )( pSrc + iStride ) ) );
+}
+
+static inline Void simdStore4x2( Pel *pDst, Int iStride, const __m128i &mmVal )
+{
+  _mm_storel_epi64( ( __m128i * )pDst, mmVal );
+  _mm_storel_epi64( ( __m128i * )( pDst + iStride ), _mm_unpackhi_epi64( mmVal, mmVal ) );
+}
+
+static Void simdSubtract( const Pel *pSrc0, Int iSrc0Stride, const Pel *pSrc1, Int iSrc1Stride, Pel *pDst, Int iDstStride, Int iWidth, Int iHeight )
+{
+  if( iWidth < 4 )
+  {
+    subtractScalar( pSrc0, iSrc0Stride, pSrc1, iSrc1Stride, pDst, iDstStride, iWidth, iHeight );
+    return;
+  }
+  if( iWidth == 4 && ( iHeight & 1 ) == 0 )
+  {
+    for( Int y = 0; y < iHeight; y += 2 )
+    {
+      simdStore4x2( pDst, iDstStride, _mm_sub_epi16( simdLoad4x2( pSrc0, iSrc0Stride ), simdLoad4x2( pSrc1, iSrc1Stride ) ) );
+      pSrc0 += 2 * iSrc0Stride;
+      pSrc1 += 2 * iSrc1Stride;
+      pDst  += 2 * iDstStride;
+    }
+    return;
+  }
+
+  for( Int y = 0; y < iHeight; y++ )
+  {
+    Int x = 0;
+    for( ; x + 8 <= iWidth; x += 8 )
+    {
+      const __m128i mmSrc0 = _mm_loadu_si128( ( const __m128i * )( pSrc0 + x ) );
+      const __m128i mmSrc1 = _mm_loadu_si128( ( const __m128i * )( pSrc1 + x ) );
+      _mm_storeu_si128( ( __m128i * )( pDst + x ), _mm_sub_epi16( mmSrc0, mmSrc1 ) );
+    }
+    if( x + 4 <= iWidth )
+    {
+      const __m128i mmSrc0 = _mm_loadl_epi64( ( const __m128i * )( pSrc0 + x ) );
+      const __m128i mmSrc1 = _mm_loadl_epi64( ( const __m128i * )( pSrc1 + x ) );
+      _mm_storel_epi64( ( __m128i * )( pDst + x ), _mm_sub_epi16( mmSrc0, mmSrc1 ) );
+      x += 4;
+    }
+    for( ; x < iWidth; x++ )
+    {
+      pDst[x] = pSrc0[x] - pSrc1[x];
+    }
+    pSrc0 += iSrc0Stride;
+    pSrc1 += iSrc1Stride;
+    pDst  += iDstStride;
+  }
+}
+
+static Void simdAddClip( const Pel *pSrc0, Int iSrc0Stride, const Pel *pSrc1, Int iSrc1Stride, Pel *pDst, Int iDstStride, Int iWidth, Int iHeight, Int clipBd )
+{
+  if( iWidth < 4 )
+  {
+    addClipScalar( pSrc0, iSrc0Stride, pSrc1, iSrc1Stride, pDst, iDstStride, iWidth, iHeight, clipBd );
+    return;
+  }
+  // a saturating add followed by the clip gives the same result as the clip of the full-precision sum
+  const __m128i mmMin = _mm_setzero_si128();
+  const __m128i mmMax = _mm_set1_epi16( ( 1 << clipBd ) - 1 );
+  if( iWidth == 4 && ( iHeight & 1 ) == 0 )
+  {
+    for( Int y = 0; y < iHeight; y += 2 )
+    {
+      const __m128i mmSum = _mm_adds_epi16( simdLoad4x2( pSrc0, iSrc0Stride ), simdLoad4x2( pSrc1, iSrc1Stride ) );
+      simdStore4x2( pDst, iDstStride, _mm_min_epi16( _mm_max_epi16( mmSum, mmMin ), mmMax ) );
+      pSrc0 += 2 * iSrc0Stride;
+      pSrc1 += 2 * iSrc1Stride;
+      pDst  += 2 * iDstStride;
+    }
+    return;
+  }
+
+  for( Int y = 0; y < iHeight; y++ )
+  {
+    Int x = 0;
+    for( ; x + 8 <= iWidth; x += 8 )
+    {
+      const __m128i mmSrc0 = _mm_loadu_si128( ( const __m128i * )( pSrc0 + x ) );
+      const __m128i mmSrc1 = _mm_loadu_si128( ( const __m128i * )( pSrc1 + x ) );
+      _mm_storeu_si128( ( __m128i * )( pDst + x ), _mm_min_epi16( _mm_max_epi16( _mm_adds_epi16( mmSrc0, mmSrc1 ), mmMin ), mmMax ) );
+    }
+    if( x + 4 <= iWidth )
+    {
+      const __m128i mmSrc0 = _mm_loadl_epi64( ( const __m128i * )( pSrc0 + x ) );
+      const __m128i mmSrc1 = _mm_loadl_epi64( ( const __m128i * )( pSrc1 + x ) );
+      _mm_storel_epi64( ( __m128i * )( pDst + x ), _mm_min_epi16( _mm_max_epi16( _mm_adds_epi16( mmSrc0, mmSrc1 ), mmMin ), mmMax ) );
+      x += 4;
+    }
+    for( ; x < iWidth; x++ )
+    {
+      pDst[x] = Pel( ClipBD<Int>( Int( pSrc0[x] ) + Int( pSrc1[x] ), clipBd ) );
+    }
+    pSrc0 += iSrc0Stride;
+    pSrc1 += iSrc1Stride;
+    pDst  += iDstStride;
+  }
+}
+
+static inline __m128i simdAvgClip( const __m128i &mmSrc0, const __m128i &mmSrc1, const __m128i &mmOffset, Int shiftNum, const __m128i &mmMin, const __m128i &mmMax )
+{
+  // the sums are formed in 32 bits, as the two 14-bit intermediate values plus the offset may exceed 16 bits
+  const __m128i mmOne = _mm_set1_epi16( 1 );
+  __m128i mmLo = _mm_madd_epi16( _mm_unpacklo_epi16( mmSrc0, mmSrc1 ), mmOne );
+  __m128i mmHi = _mm_madd_epi16( _mm_unpackhi_epi16( mmSrc0, mmSrc1 ), mmOne );
+  mmLo = _mm_srai_epi32( _mm_add_epi32( mmLo, mmOffset ), shiftNum );
+  mmHi = _mm_srai_epi32( _mm_add_epi32( mmHi, mmOffset ), shiftNum );
+  return _mm_min_epi16( _mm_max_epi16( _mm_packs_epi32( mmLo, mmHi ), mmMin ), mmMax );
+}
+
+static Void simdAddAvg( const Pel *pSrc0, Int iSrc0Stride, const Pel *pSrc1, Int iSrc1Stride, Pel *pDst, Int iDstStride, Int iWidth, Int iHeight, Int shiftNum, Int offset, Int clipBd )
+{
+  const __m128i mmOffset = _mm_set1_epi32( offset );
+  const __m128i mmMin    = _mm_setzero_si128();
+  const __m128i mmMax    = _mm_set1_epi16( ( 1 << clipBd ) - 1 );
+  for( Int y = 0; y < iHeight; y++ )
+  {
+    Int x = 0;
+    for( ; x + 8 <= iWidth; x += 8 )
+    {
+      const __m128i mmSrc0 = _mm_loadu_si128( ( const __m128i * )( pSrc0 + x ) );
+      const __m128i mmSrc1 = _mm_loadu_si128( ( const __m128i * )( pSrc1 + x ) );
+      _mm_storeu_si128( ( __m128i * )( pDst + x ), simdAvgClip( mmSrc0, mmSrc1, mmOffset, shiftNum, mmMin, mmMax ) );
+    }
+    if( x + 4 <= iWidth )
+    {
+      const __m128i mmSrc0 = _mm_loadl_epi64( ( const __m128i * )( pSrc0 + x ) );
+      const __m128i mmSrc1 = _mm_loadl_epi64( ( const __m128i * )( pSrc1 + x ) );
+      _mm_storel_epi64( ( __m128i * )( pDst + x ), simdAvgClip( mmSrc0, mmSrc1, mmOffset, shiftNum, mmMin, mmMax ) );
+      x += 4;
+    }
+    for( ; x < iWidth; x++ )
+    {
+      pDst[x] = ClipBD( rightShift( ( pSrc0[x] + pSrc1[x] + offset ), shiftNum ), clipBd );
+    }
+    pSrc0 += iSrc0Stride;
+    pSrc1 += iSrc1Stride;
+    pDst  += iDstStride;
+  }
+}
+
+static inline __m128i simdRemoveHighFreqStep( const __m128i &mmDst, const __m128i &mmSrc, Bool bClip, const __m128i &mmMin, const __m128i &mmMax )
+{
+  if( !bClip )
+  {
+    // wrap-around matches the truncation of the scalar Int result to Pel
+    return _mm_sub_epi16( _mm_add_epi16( mmDst, mmDst ), mmSrc );
+  }
+  const __m128i mmCoeff = _mm_set_epi16( -1, 2, -1, 2, -1, 2, -1, 2 );
+  const __m128i mmLo    = _mm_madd_epi16( _mm_unpacklo_epi16( mmDst, mmSrc ), mmCoeff );
+  const __m128i mmHi    = _mm_madd_epi16( _mm_unpackhi_epi16( mmDst, mmSrc ), mmCoeff );
+  return _mm_min_epi16( _mm_max_epi16( _mm_packs_epi32( mmLo, mmHi ), mmMin ), mmMax );
+}
+
+static Void simdRemoveHighFreq( const Pel *pSrc, Int iSrcStride, Pel *pDst, Int iDstStride, Int iWidth, Int iHeight, Bool bClip, Int clipBd )
+{
+  const __m128i mmMin = _mm_setzero_si128();
+  const __m128i mmMax = _mm_set1_epi16( ( 1 << clipBd ) - 1 );
+  for( Int y = 0; y < iHeight; y++ )
+  {
+    Int x = 0;
+    for( ; x + 8 <= iWidth; x += 8 )
+    {
+      const __m128i mmSrc = _mm_loadu_si128( ( const __m128i * )( pSrc + x ) );
+      const __m128i mmDst = _mm_loadu_si128( ( const __m128i * )( pDst + x ) );
+      _mm_storeu_si128( ( __m128i * )( pDst + x ), simdRemoveHighFreqStep( mmDst, mmSrc, bClip, mmMin, mmMax ) );
+    }
+    if( x + 4 <= iWidth )
+    {
+      const __m128i mmSrc = _mm_loadl_epi64( ( const __m128i * )( pSrc + x ) );
+      const __m128i mmDst = _mm_loadl_epi64( ( const __m128i * )( pDst + x ) );
+      _mm_storel_epi64( ( __m128i * )( pDst + x ), simdRemoveHighFreqStep( mmDst, mmSrc, bClip, mmMin, mmMax ) );
+      x += 4;
+    }
+    for( ; x < iWidth; x++ )
+    {
+      pDst[x] = bClip ? ClipBD( ( 2 * pDst[x] ) - pSrc[x], clipBd ) : ( 2 * pDst[x] ) - pSrc[x];
+    }
+    pSrc += iSrcStride;
+    pDst += iDstStride;
+  }
+}
+#endif
+
+/// block arithmetic kernels of the selected instruction set level (see TComSimd)
+struct YuvKernels
+{
+  Void (*subtract)      ( const Pel *pSrc0, Int iSrc0Stride, const Pel *pSrc1, Int iSrc1Stride, Pel *pDst, Int iDstStride, Int iWidth, Int iHeight );
+  Void (*addClip)       ( const Pel *pSrc0, Int iSrc0Stride, const Pel *pSrc1, Int iSrc1Stride, Pel *pDst, Int iDstStride, Int iWidth, Int iHeight, Int clipBd );
+  Void (*addAvg)        ( const Pel *pSrc0, Int iSrc0Stride, const Pel *pSrc1, Int iSrc1Stride, Pel *pDst, Int iDstStride, Int iWidth, Int iHeight, Int shiftNum, Int offset, Int clipBd );
+  Void (*removeHighFreq)( const Pel *pSrc, Int iSrcStride, Pel *pDst, Int iDstStride, Int iWidth, Int iHeight, Bool bClip, Int clipBd );
+};
+
+static YuvKernels yuvKernels;
+
+static Void initYuvKernels( const SIMDLevel level )
+{
+  yuvKernels.subtract       = subtractScalar;
+  yuvKernels.addClip        = addClipScalar;
+  yuvKernels.addAvg         = addAvgScalar;
+  yuvKernels.removeHighFreq = removeHighFreqScalar;
+#if VECTOR_CODING__YUV_ARITHMETIC && (RExt__HIGH_BIT_DEPTH_SUPPORT==0)
+  if( level >= SIMD_SSE2 )
+  {
+    yuvKernels.subtract       = simdSubtract;
+    yuvKernels.addClip        = simdAddClip;
+    yuvKernels.addAvg         = simdAddAvg;
+    yuvKernels.removeHighFreq = simdRemoveHighFreq;
+  }
+#endif
+}
+
+static const Bool yuvKernelsRegistered = TComSimd::registerKernels( initYuvKernels );
+
 TComYuv::TComYuv()
 {
   for(Int comp=0; comp<MAX_NUM_COMPONENT; comp++)
@@ -299,20 +620,20 @@ Void TComYuv::addClip( const TComYuv* pcYuvSrc0, const TComYuv* pcYuvSrc1, const
     const Int bitDepthDelta = clipBitDepths.stream[toChannelType(compID)] - clipbd;
 #endif
 
+#if O0043_BEST_EFFORT_DECODING
     for ( Int y = uiPartHeight-1; y >= 0; y-- )
     {
       for ( Int x = uiPartWidth-1; x >= 0; x-- )
       {
-#if O0043_BEST_EFFORT_DECODING
         pDst[x] = Pel(ClipBD<Int>( Int(pSrc0[x]) + rightShiftEvenRounding<Pel>(pSrc1[x], bitDepthDelta), clipbd));
-#else
-        pDst[x] = Pel(ClipBD<Int>( Int(pSrc0[x]) + Int(pSrc1[x]), clipbd));
-#endif
       }
       pSrc0 += iSrc0Stride;
       pSrc1 += iSrc1Stride;
       pDst  += iDstStride;
     }
+#else
+    yuvKernels.addClip( pSrc0, iSrc0Stride, pSrc1, iSrc1Stride, pDst, iDstStride, uiPartWidth, uiPartHeight, clipbd );
+#endif
   }
 }
 
@@ -335,16 +656,7 @@ Void TComYuv::subtract( const TComYuv* pcYuvSrc0, const TComYuv* pcYuvSrc1, cons
     const Int  iSrc1Stride = pcYuvSrc1->getStride(compID);
     const Int  iDstStride  = getStride(compID);
 
-    for (Int y = uiPartHeight-1; y >= 0; y-- )
-    {
-      for (Int x = uiPartWidth-1; x >= 0; x-- )
-      {
-        pDst[x] = pSrc0[x] - pSrc1[x];
-      }
-      pSrc0 += iSrc0Stride;
-      pSrc1 += iSrc1Stride;
-      pDst  += iDstStride;
-    }
+    yuvKernels.subtract( pSrc0, iSrc0Stride, pSrc1, iSrc1Stride, pDst, iDstStride, uiPartWidth, uiPartHeight );
   }
 }
 
@@ -375,36 +687,7 @@ Void TComYuv::addAvg( const TComYuv* pcYuvSrc0, const TComYuv* pcYuvSrc1, const
       assert(0);
       exit(-1);
     }
-    else if (iWidth&2)
-    {
-      for ( Int y = 0; y < iHeight; y++ )
-      {
-        for (Int x=0 ; x < iWidth; x+=2 )
-        {
-          pDst[ x + 0 ] = ClipBD( rightShift(( pSrc0[ x + 0 ] + pSrc1[ x + 0 ] + offset ), shiftNum), clipbd );
-          pDst[ x + 1 ] = ClipBD( rightShift(( pSrc0[ x + 1 ] + pSrc1[ x + 1 ] + offset ), shiftNum), clipbd );
-        }
-        pSrc0 += iSrc0Stride;
-        pSrc1 += iSrc1Stride;
-        pDst  += iDstStride;
-      }
-    }
-    else
-    {
-      for ( Int y = 0; y < iHeight; y++ )
-      {
-        for (Int x=0 ; x < iWidth; x+=4 )
-        {
-          pDst[ x + 0 ] = ClipBD( rightShift(( pSrc0[ x + 0 ] + pSrc1[ x + 0 ] + offset ), shiftNum), clipbd );
-          pDst[ x + 1 ] = ClipBD( rightShift(( pSrc0[ x + 1 ] + pSrc1[ x + 1 ] + offset ), shiftNum), clipbd );
-          pDst[ x + 2 ] = ClipBD( rightShift(( pSrc0[ x + 2 ] + pSrc1[ x + 2 ] + offset ), shiftNum), clipbd );
-          pDst[ x + 3 ] = ClipBD( rightShift(( pSrc0[ x + 3 ] + pSrc1[ x + 3 ] + offset ), shiftNum), clipbd );
-        }
-        pSrc0 += iSrc0Stride;
-        pSrc1 += iSrc1Stride;
-        pDst  += iDstStride;
-      }
-    }
+    yuvKernels.addAvg( pSrc0, iSrc0Stride, pSrc1, iSrc1Stride, pDst, iDstStride, iWidth, iHeight, shiftNum, offset, clipbd );
   }
 }
 
@@ -426,31 +709,7 @@ Void TComYuv::removeHighFreq( const TComYuv* pcYuvSrc,
     const Int iDstStride = getStride(compID);
     const Int iWidth  = uiWidth >>getComponentScaleX(compID);
     const Int iHeight = uiHeight>>getComponentScaleY(compID);
-    if (bClipToBitDepths)
-    {
-      const Int clipBd=bitDepths[toChannelType(compID)];
-      for ( Int y = iHeight-1; y >= 0; y-- )
-      {
-        for ( Int x = iWidth-1; x >= 0; x-- )
-        {
-          pDst[x ] = ClipBD((2 * pDst[x]) - pSrc[x], clipBd);
-        }
-        pSrc += iSrcStride;
-        pDst += iDstStride;
-      }
-    }
-    else
-    {
-      for ( Int y = iHeight-1; y >= 0; y-- )
-      {
-        for ( Int x = iWidth-1; x >= 0; x-- )
-        {
-          pDst[x ] = (2 * pDst[x]) - pSrc[x];
-        }
-        pSrc += iSrcStride;
-        pDst += iDstStride;
-      }
-    }
+    yuvKernels.removeHighFreq( pSrc, iSrcStride, pDst, iDstStride, iWidth, iHeight, bClipToBitDepths, bitDepths[toChannelType(compID)] );
   }
 }
 
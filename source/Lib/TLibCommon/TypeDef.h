@@ -114,17 +114,44 @@
 
 #define RDOQ_CHROMA_LAMBDA                                1 ///< F386: weighting of chroma for RDOQ
 
+#define INCREMENTAL_BORDER_EXTENSION                      1 ///< 0 = extend the reconstructed picture border in a separate pass when it is first used as a reference, 1 (default) = extend it CTU row by CTU row as the in-loop filters complete each row
+
 // This can be enabled by the makefile
 #ifndef RExt__HIGH_BIT_DEPTH_SUPPORT
 #define RExt__HIGH_BIT_DEPTH_SUPPORT                      0 ///< 0 (default) use data type definitions for 8-10 bit video, 1 = use larger data types to allow for up to 16-bit video (originally developed as part of N0188)
 #endif
 
+// The VECTOR_CODING__ switches select which vector kernels are compiled in; which of them are used is decided at run time (see TComSimd)
 #if defined __SSE2__ || defined __AVX2__ || defined __AVX__ || defined _M_AMD64 || defined _M_X64
 #define VECTOR_CODING__INTERPOLATION_FILTER               1 ///< enable vector coding for the interpolation filter. 1 (default if SSE possible) disable SSE vector coding. Should not affect RD costs/decisions. Code back-ported from JEM2.0.
 #define VECTOR_CODING__DISTORTION_CALCULATIONS            1 ///< enable vector coding for distortion calculations   1 (default if SSE possible) disable SSE vector coding. Should not affect RD costs/decisions. Code back-ported from JEM2.0.
+#define VECTOR_CODING__DEBLOCKING_FILTER                  1 ///< enable vector coding for the deblocking filter.    1 (default if SSE possible) disable SSE vector coding. Should not affect RD costs/decisions.
+#define VECTOR_CODING__SAMPLE_ADAPTIVE_OFFSET             1 ///< enable vector coding for SAO application/statistics. 1 (default if SSE possible) disable SSE vector coding. Should not affect RD costs/decisions.
+#define VECTOR_CODING__YUV_ARITHMETIC                     1 ///< enable vector coding for TComYuv block arithmetic.  1 (default if SSE possible) disable SSE vector coding. Should not affect RD costs/decisions.
+#define VECTOR_CODING__WEIGHTED_PREDICTION                1 ///< enable vector coding for weighted prediction/distortion. 1 (default if SSE possible) disable SSE vector coding. Should not affect RD costs/decisions.
+#define VECTOR_CODING__PICTURE_BORDER_EXTENSION           1 ///< enable vector coding for picture border extension. 1 (default if SSE possible) disable SSE vector coding. Should not affect RD costs/decisions.
+#define VECTOR_CODING__BYTE_SEQUENCE_SEARCH               1 ///< enable vector coding for start code and emulation prevention searches. 1 (default if SSE possible) disable SSE vector coding. Should not affect RD costs/decisions.
+#define VECTOR_CODING__INTRA_GRADIENT_ANALYSIS            1 ///< enable vector coding for the gradients of the intra mode pre-selection. 1 (default if SSE possible) disable SSE vector coding. Should not affect RD costs/decisions.
+#define VECTOR_CODING__QUANTISATION                       1 ///< enable vector coding for the inverse quantisation. 1 (default if SSE possible) disable SSE vector coding. Should not affect RD costs/decisions.
+#define VECTOR_CODING__INTRA_PREDICTION                   1 ///< enable vector coding for the planar intra prediction. 1 (default if SSE possible) disable SSE vector coding. Should not affect RD costs/decisions.
+#if defined _MSC_VER ? ( _MSC_VER >= 1700 ) : ( defined __clang__ || __GNUC__ > 4 || ( __GNUC__ == 4 && __GNUC_MINOR__ >= 9 ) )
+#define VECTOR_CODING__AVX2_KERNELS                       1 ///< compile the AVX2 distortion and interpolation kernels, which are used when the CPU supports AVX2. 1 (default if the compiler supports AVX2 intrinsics in functions with a target attribute). Should not affect RD costs/decisions.
+#else
+#define VECTOR_CODING__AVX2_KERNELS                       0 ///< compile the AVX2 distortion and interpolation kernels, which are used when the CPU supports AVX2. 0 (default if the compiler does not support AVX2 intrinsics in functions with a target attribute). Should not affect RD costs/decisions.
+#endif
 #else
 #define VECTOR_CODING__INTERPOLATION_FILTER               0 ///< enable vector coding for the interpolation filter. 0 (default if SSE not possible) disable SSE vector coding. Should not affect RD costs/decisions. Code back-ported from JEM2.0.
 #define VECTOR_CODING__DISTORTION_CALCULATIONS            0 ///< enable vector coding for distortion calculations   0 (default if SSE not possible) disable SSE vector coding. Should not affect RD costs/decisions. Code back-ported from JEM2.0.
+#define VECTOR_CODING__DEBLOCKING_FILTER                  0 ///< enable vector coding for the deblocking filter.    0 (default if SSE not possible) disable SSE vector coding. Should not affect RD costs/decisions.
+#define VECTOR_CODING__SAMPLE_ADAPTIVE_OFFSET             0 ///< enable vector coding for SAO application/statistics. 0 (default if SSE not possible) disable SSE vector coding. Should not affect RD costs/decisions.
+#define VECTOR_CODING__YUV_ARITHMETIC                     0 ///< enable vector coding for TComYuv block arithmetic.  0 (default if SSE not possible) disable SSE vector coding. Should not affect RD costs/decisions.
+#define VECTOR_CODING__WEIGHTED_PREDICTION                0 ///< enable vector coding for weighted prediction/distortion. 0 (default if SSE not possible) disable SSE vector coding. Should not affect RD costs/decisions.
+#define VECTOR_CODING__PICTURE_BORDER_EXTENSION           0 ///< enable vector coding for picture border extension. 0 (default if SSE not possible) disable SSE vector coding. Should not affect RD costs/decisions.
+#define VECTOR_CODING__BYTE_SEQUENCE_SEARCH               0 ///< enable vector coding for start code and emulation prevention searches. 0 (default if SSE not possible) disable SSE vector coding. Should not affect RD costs/decisions.
+#define VECTOR_CODING__INTRA_GRADIENT_ANALYSIS            0 ///< enable vector coding for the gradients of the intra mode pre-selection. 0 (default if SSE not possible) disable SSE vector coding. Should not affect RD costs/decisions.
+#define VECTOR_CODING__QUANTISATION                       0 ///< enable vector coding for the inverse quantisation. 0 (default if SSE not possible) disable SSE vector coding. Should not affect RD costs/decisions.
+#define VECTOR_CODING__INTRA_PREDICTION                   0 ///< enable vector coding for the planar intra prediction. 0 (default if SSE not possible) disable SSE vector coding. Should not affect RD costs/decisions.
+#define VECTOR_CODING__AVX2_KERNELS                       0 ///< compile the AVX2 distortion and interpolation kernels, which are used when the CPU supports AVX2. 0 (default if SSE not possible). Should not affect RD costs/decisions.
 #endif
 
 // ====================================================================================================================
@@ -622,6 +649,24 @@ enum FastInterSearchMode
   FASTINTERSEARCH_MODE3    = 3
 };
 
+/// use of the motion vectors found for blocks covering a prediction unit earlier in the same CTU
+enum MotionVectorCacheMode
+{
+  MV_CACHE_DISABLED          = 0,
+  MV_CACHE_SEED              = 1, ///< the cached vector is an additional start point of the diamond search
+  MV_CACHE_SEED_AND_SKIP     = 2, ///< in addition, the integer search is skipped when the cached vector fits the prediction unit as well as it fit the covering block
+  MV_CACHE_NUMBER_OF_MODES   = 3
+};
+
+/// use of the CU split predictor
+enum CuSplitPredictorMode
+{
+  CU_SPLIT_PREDICTOR_DISABLED        = 0,
+  CU_SPLIT_PREDICTOR_TRAIN           = 1, ///< all branches are searched; a model is fitted to the split decisions and written to the model file
+  CU_SPLIT_PREDICTOR_PREDICT         = 2, ///< the split or the non-split branch is skipped when the model read from the model file is confident
+  CU_SPLIT_PREDICTOR_NUMBER_OF_MODES = 3
+};
+
 enum SPSExtensionFlagIndex
 {
   SPS_EXT__REXT           = 0,
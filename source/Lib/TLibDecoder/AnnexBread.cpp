@@ -39,8 +39,10 @@
 
 #include <stdint.h>
 #include <cassert>
+#include <string.h>
 #include <vector>
 #include "AnnexBread.h"
+#include "TLibCommon/TComBitStream.h"
 #if RExt__DECODER_DEBUG_BIT_STATISTICS
 #include "TLibCommon/TComCodingStatistics.h"
 #endif
@@ -50,6 +52,115 @@ using namespace std;
 //! \ingroup TLibDecoder
 //! \{
 
+/**
+ * Move the unconsumed bytes to the start of the buffer and fill the
+ * rest of it from the input stream.
+ */
+Void InputByteStream::xFillBuffer()
+{
+  if (m_Input == NULL)
+  {
+    // reading from memory: all of the bytes are available
+    return;
+  }
+
+  const size_t numUnconsumed = m_BufferEnd - m_BufferPos;
+  if (m_BufferPos > 0)
+  {
+    memmove(&m_Buffer[0], &m_Buffer[m_BufferPos], numUnconsumed);
+    m_BufferStart += std::streamoff(m_BufferPos);
+    m_BufferPos = 0;
+    m_BufferEnd = numUnconsumed;
+  }
+
+  if (m_Input->good())
+  {
+    m_Input->read(reinterpret_cast<char*>(&m_Buffer[m_BufferEnd]), std::streamsize(m_Buffer.size() - m_BufferEnd));
+    m_BufferEnd += size_t(m_Input->gcount());
+  }
+}
+
+Bool InputByteStream::readBytesUntilStartCodePrefix(vector<uint8_t>& bytes)
+{
+  while (!eofBeforeNBytes(24/8))
+  {
+    const size_t numAvailable = m_BufferEnd - m_BufferPos;
+    const size_t seqPos = findZeroZeroByteSequence(m_Data + m_BufferPos, numAvailable, 0x02);
+
+    // without a match, the last two bytes cannot be tested until more input has been read
+    const size_t numConsumed = (seqPos < numAvailable) ? seqPos : numAvailable - 2;
+    bytes.insert(bytes.end(), m_Data + m_BufferPos, m_Data + (m_BufferPos + numConsumed));
+    m_BufferPos += numConsumed;
+
+    if (seqPos < numAvailable)
+    {
+      return true;
+    }
+  }
+
+  bytes.insert(bytes.end(), m_Data + m_BufferPos, m_Data + m_BufferEnd);
+  m_BufferPos = m_BufferEnd;
+  return false;
+}
+
+Bool InputByteStream::readBytesUntilStartCodePrefix(const uint8_t *&bytes, size_t &numBytes)
+{
+  assert(isMemoryBacked());
+
+  const size_t numAvailable = m_BufferEnd - m_BufferPos;
+  const size_t seqPos = findZeroZeroByteSequence(m_Data + m_BufferPos, numAvailable, 0x02);
+
+  bytes = m_Data + m_BufferPos;
+  numBytes = seqPos;
+  m_BufferPos += seqPos;
+  if (seqPos < numAvailable)
+  {
+    return true;
+  }
+
+  m_EofReached = true;
+  return false;
+}
+
+/**
+ * Read the bytes of a NAL unit into nalUnit, appending them to any
+ * bytes already held.
+ */
+static Bool
+readNALUnitBytes(
+  InputByteStream& bs,
+  vector<uint8_t>& nalUnit)
+{
+  return bs.readBytesUntilStartCodePrefix(nalUnit);
+}
+
+/**
+ * Read the bytes of a NAL unit into nalUnit. When bs is read from
+ * memory, nalUnit is set to read directly from that memory rather than
+ * holding a copy of the bytes.
+ */
+static Bool
+readNALUnitBytes(
+  InputByteStream& bs,
+  TComInputBitstream& nalUnit)
+{
+  if (!bs.isMemoryBacked())
+  {
+    return bs.readBytesUntilStartCodePrefix(nalUnit.getFifo());
+  }
+
+  const uint8_t *bytes;
+  size_t numBytes;
+  const Bool foundStartCodePrefix = bs.readBytesUntilStartCodePrefix(bytes, numBytes);
+  nalUnit.setView(bytes, UInt(numBytes));
+  return foundStartCodePrefix;
+}
+
+#if RExt__DECODER_DEBUG_BIT_STATISTICS
+static UInt getNumNALUnitBytes(const vector<uint8_t>& nalUnit)   { return UInt(nalUnit.size());    }
+static UInt getNumNALUnitBytes(const TComInputBitstream& nalUnit) { return nalUnit.getDataSize(); }
+#endif
+
 /**
  * Parse an AVC AnnexB Bytestream bs to extract a single nalUnit
  * while accumulating bytestream statistics into stats.
@@ -58,10 +169,11 @@ using namespace std;
  * of std::ios_base::failure is thrown.  The contsnts of stats will
  * be correct at this point.
  */
+template <class NALUnitBytes>
 static Void
 _byteStreamNALUnit(
   InputByteStream& bs,
-  vector<uint8_t>& nalUnit,
+  NALUnitBytes& nalUnit,
   AnnexBStats& stats)
 {
   /* At the beginning of the decoding process, the decoder initialises its
@@ -134,14 +246,16 @@ _byteStreamNALUnit(
 #if RExt__DECODER_DEBUG_BIT_STATISTICS
   TComCodingStatistics::SStat &bodyStats=TComCodingStatistics::GetStatisticEP(STATS__NAL_UNIT_TOTAL_BODY);
 #endif
-  while (bs.eofBeforeNBytes(24/8) || bs.peekBytes(24/8) > 2)
-  {
 #if RExt__DECODER_DEBUG_BIT_STATISTICS
-    uint8_t thebyte=bs.readByte();bodyStats.bits+=8;bodyStats.count++;
-    nalUnit.push_back(thebyte);
-#else
-    nalUnit.push_back(bs.readByte());
+  const UInt numBytesBefore = getNumNALUnitBytes(nalUnit);
 #endif
+  const Bool foundStartCodePrefix = readNALUnitBytes(bs, nalUnit);
+#if RExt__DECODER_DEBUG_BIT_STATISTICS
+  bodyStats.bits += 8*Int64(getNumNALUnitBytes(nalUnit) - numBytesBefore); bodyStats.count += Int64(getNumNALUnitBytes(nalUnit) - numBytesBefore);
+#endif
+  if (!foundStartCodePrefix)
+  {
+    throw std::ios_base::failure("end of bytestream");
   }
 
   /* 5. When the current position in the byte stream is:
@@ -196,4 +310,28 @@ byteStreamNALUnit(
   stats.m_numBytesInNALUnit = UInt(nalUnit.size());
   return eof;
 }
+
+/**
+ * As above, but reading the nalUnit into a bitstream. When bs is read
+ * from memory the NAL unit is not copied: nalUnit reads directly from
+ * that memory.
+ */
+Bool
+byteStreamNALUnit(
+  InputByteStream& bs,
+  TComInputBitstream& nalUnit,
+  AnnexBStats& stats)
+{
+  Bool eof = false;
+  try
+  {
+    _byteStreamNALUnit(bs, nalUnit, stats);
+  }
+  catch (...)
+  {
+    eof = true;
+  }
+  stats.m_numBytesInNALUnit = nalUnit.getDataSize();
+  return eof;
+}
 //! \}
@@ -43,9 +43,11 @@
 
 #include <stdint.h>
 #include <istream>
+#include <ios>
 #include <vector>
 
 #include "TLibCommon/CommonDef.h"
+#include "TLibCommon/TComBitStream.h"
 
 //! \ingroup TLibDecoder
 //! \{
@@ -58,26 +60,100 @@ public:
    * istream.
    *
    * NB, it isn't safe to access istream while in use by a
-   * InputByteStream.
-   *
-   * Side-effects: the exception mask of istream is set to eofbit
+   * InputByteStream. The input is read in blocks, so the position of
+   * istream is ahead of the position of the InputByteStream (see
+   * getPosition()) and the end of the bytestream is signalled by
+   * eofReached() rather than by the state of istream.
    */
   InputByteStream(std::istream& istream)
-  : m_NumFutureBytes(0)
-  , m_FutureBytes(0)
-  , m_Input(istream)
+  : m_Input(&istream)
+  , m_Buffer(INPUT_BUFFER_SIZE)
+  , m_Data(&m_Buffer[0])
+  , m_BufferPos(0)
+  , m_BufferEnd(0)
+  , m_BufferStart(0)
+  , m_EofReached(false)
+  {
+    reset();
+  }
+
+  /**
+   * Create a bytestream reader that will extract bytes from the size
+   * bytes of memory at data (e.g. a memory-mapped bitstream file).
+   * The memory is not copied, and must outlive the InputByteStream and
+   * the NAL units read from it by byteStreamNALUnit().
+   */
+  InputByteStream(const uint8_t *data, size_t size)
+  : m_Input(NULL)
+  , m_Buffer()
+  , m_Data(data)
+  , m_BufferPos(0)
+  , m_BufferEnd(size)
+  , m_BufferStart(0)
+  , m_EofReached(false)
   {
-    istream.exceptions(std::istream::eofbit | std::istream::badbit);
   }
 
   /**
    * Reset the internal state.  Must be called if input stream is
-   * modified externally to this class
+   * modified externally to this class (e.g. repositioned with seekg()).
+   * Has no effect when reading from memory.
    */
   Void reset()
   {
-    m_NumFutureBytes = 0;
-    m_FutureBytes = 0;
+    if (m_Input != NULL)
+    {
+      m_BufferPos = 0;
+      m_BufferEnd = 0;
+      m_BufferStart = m_Input->tellg();
+      m_EofReached = !*m_Input;
+    }
+  }
+
+  /**
+   * continue reading from position pos, a value previously returned
+   * by getPosition().
+   */
+  Void setPosition(std::streampos pos)
+  {
+    if (m_Input != NULL)
+    {
+      m_Input->clear();
+      m_Input->seekg(pos);
+      reset();
+    }
+    else
+    {
+      m_BufferPos = size_t(std::streamoff(pos));
+      m_EofReached = false;
+    }
+  }
+
+  /**
+   * returns true if the bytes are read from memory, in which case
+   * byteStreamNALUnit() does not copy the NAL units.
+   */
+  Bool isMemoryBacked() const
+  {
+    return m_Input == NULL;
+  }
+
+  /**
+   * returns the position in the input stream of the next byte to be
+   * consumed.
+   */
+  std::streampos getPosition() const
+  {
+    return m_BufferStart + std::streamoff(m_BufferPos);
+  }
+
+  /**
+   * returns true once an attempt has been made to read beyond the end
+   * of the input stream (or the input stream has failed).
+   */
+  Bool eofReached() const
+  {
+    return m_EofReached;
   }
 
   /**
@@ -87,25 +163,18 @@ public:
   Bool eofBeforeNBytes(UInt n)
   {
     assert(n <= 4);
-    if (m_NumFutureBytes >= n)
+    if (m_BufferEnd - m_BufferPos >= n)
     {
       return false;
     }
 
-    n -= m_NumFutureBytes;
-    try
-    {
-      for (UInt i = 0; i < n; i++)
-      {
-        m_FutureBytes = (m_FutureBytes << 8) | m_Input.get();
-        m_NumFutureBytes++;
-      }
-    }
-    catch (...)
+    xFillBuffer();
+    if (m_BufferEnd - m_BufferPos >= n)
     {
-      return true;
+      return false;
     }
-    return false;
+    m_EofReached = true;
+    return true;
   }
 
   /**
@@ -123,7 +192,12 @@ public:
   uint32_t peekBytes(UInt n)
   {
     eofBeforeNBytes(n);
-    return m_FutureBytes >> 8*(m_NumFutureBytes - n);
+    uint32_t val = 0;
+    for (UInt i = 0; i < n; i++)
+    {
+      val = (val << 8) | ((m_BufferPos + i < m_BufferEnd) ? m_Data[m_BufferPos + i] : 0);
+    }
+    return val;
   }
 
   /**
@@ -134,15 +208,11 @@ public:
    */
   uint8_t readByte()
   {
-    if (!m_NumFutureBytes)
+    if (eofBeforeNBytes(1))
     {
-      uint8_t byte = m_Input.get();
-      return byte;
+      throw std::ios_base::failure("end of bytestream");
     }
-    m_NumFutureBytes--;
-    uint8_t wanted_byte = m_FutureBytes >> 8*m_NumFutureBytes;
-    m_FutureBytes &= ~(0xff << 8*m_NumFutureBytes);
-    return wanted_byte;
+    return m_Data[m_BufferPos++];
   }
 
   /**
@@ -160,14 +230,39 @@ public:
     return val;
   }
 
+  /**
+   * consume the bytes up to (not including) the next byte-aligned
+   * three-byte sequence 0x000000, 0x000001 or 0x000002, appending them
+   * to bytes.
+   *
+   * Returns false if the end of the input is reached first, in which
+   * case all remaining bytes are appended.
+   */
+  Bool readBytesUntilStartCodePrefix(std::vector<uint8_t>& bytes);
+
+  /**
+   * as above, but without copying: bytes is set to point to the
+   * consumed bytes, and numBytes to their number. Only available when
+   * reading from memory (see isMemoryBacked()).
+   */
+  Bool readBytesUntilStartCodePrefix(const uint8_t *&bytes, size_t &numBytes);
+
 #if RExt__DECODER_DEBUG_BIT_STATISTICS
-  UInt GetNumBufferedBytes() const { return m_NumFutureBytes; }
+  UInt GetNumBufferedBytes() const { return UInt(m_BufferEnd - m_BufferPos); }
 #endif
 
 private:
-  UInt m_NumFutureBytes; /* number of valid bytes in m_FutureBytes */
-  uint32_t m_FutureBytes; /* bytes that have been peeked */
-  std::istream& m_Input; /* Input stream to read from */
+  Void xFillBuffer();
+
+  static const size_t INPUT_BUFFER_SIZE = 1 << 16;
+
+  std::istream* m_Input; /* Input stream to read from, or NULL when reading from memory */
+  std::vector<uint8_t> m_Buffer; /* block of bytes read from m_Input */
+  const uint8_t* m_Data; /* bytes being read: m_Buffer, or the memory being read from */
+  size_t m_BufferPos; /* index in m_Data of the next byte to be consumed */
+  size_t m_BufferEnd; /* number of valid bytes in m_Data */
+  std::streampos m_BufferStart; /* position in m_Input of m_Data[0] */
+  Bool m_EofReached; /* an attempt has been made to read beyond the end of m_Input */
 };
 
 /**
@@ -193,6 +288,7 @@ struct AnnexBStats
 };
 
 Bool byteStreamNALUnit(InputByteStream& bs, std::vector<uint8_t>& nalUnit, AnnexBStats& stats);
+Bool byteStreamNALUnit(InputByteStream& bs, TComInputBitstream& nalUnit, AnnexBStats& stats);
 
 //! \}
 
@@ -40,6 +40,7 @@
 #include <vector>
 #include <algorithm>
 #include <ostream>
+#include <string.h>
 
 #include "NALread.h"
 #include "TLibCommon/NAL.h"
@@ -55,44 +56,66 @@ using namespace std;
 
 //! \ingroup TLibDecoder
 //! \{
-static Void convertPayloadToRBSP(vector<uint8_t>& nalUnitBuf, TComInputBitstream *bitstream, Bool isVclNalUnit)
+/**
+ * Remove the emulation prevention bytes (and any trailing cabac_zero_words) from the NAL unit held by bitstream.
+ * A NAL unit read directly from the bytestream's memory (see TComInputBitstream::setView()) is only copied
+ * if it contains emulation prevention bytes; otherwise the view is just shortened.
+ */
+static Void convertPayloadToRBSP(TComInputBitstream& bitstream, Bool isVclNalUnit)
 {
-  UInt zeroCount = 0;
-  vector<uint8_t>::iterator it_read, it_write;
+  size_t writePos = bitstream.getDataSize();
+  Bool   endsWithEmulationPreventionByte = false;
 
-  UInt pos = 0;
-  bitstream->clearEmulationPreventionByteLocation();
-  for (it_read = it_write = nalUnitBuf.begin(); it_read != nalUnitBuf.end(); it_read++, it_write++, pos++)
+  bitstream.clearEmulationPreventionByteLocation();
+
+  if (!bitstream.isView() || findZeroZeroByteSequence(bitstream.getData(), writePos, 0x03) < writePos)
   {
-    assert(zeroCount < 2 || *it_read >= 0x03);
-    if (zeroCount == 2 && *it_read == 0x03)
+    bitstream.copyViewToFifo();
+
+    vector<uint8_t>& nalUnitBuf = bitstream.getFifo();
+    uint8_t *const buf  = nalUnitBuf.empty() ? NULL : &nalUnitBuf[0];
+    const size_t   size = nalUnitBuf.size();
+    size_t readPos  = 0;
+    writePos = 0;
+
+    // copy the spans between emulation prevention bytes (0x000003 sequences) down over the removed bytes
+    while (readPos < size)
     {
-      bitstream->pushEmulationPreventionByteLocation( pos );
-      pos++;
-      it_read++;
-      zeroCount = 0;
+      const size_t seqPos = readPos + findZeroZeroByteSequence(buf + readPos, size - readPos, 0x03);
+      const size_t spanEnd = (seqPos < size) ? seqPos + 2 : size;
+
+      if (writePos != readPos)
+      {
+        memmove(buf + writePos, buf + readPos, spanEnd - readPos);
+      }
+      writePos += spanEnd - readPos;
+      readPos   = spanEnd;
+
+      assert(seqPos == size || buf[seqPos + 2] == 0x03);
+      if (seqPos < size && buf[seqPos + 2] == 0x03)
+      {
+        bitstream.pushEmulationPreventionByteLocation( UInt(seqPos + 2) );
 #if RExt__DECODER_DEBUG_BIT_STATISTICS
-      TComCodingStatistics::IncrementStatisticEP(STATS__EMULATION_PREVENTION_3_BYTES, 8, 0);
+        TComCodingStatistics::IncrementStatisticEP(STATS__EMULATION_PREVENTION_3_BYTES, 8, 0);
 #endif
-      if (it_read == nalUnitBuf.end())
-      {
-        break;
+        readPos = seqPos + 3;
+        endsWithEmulationPreventionByte = (readPos == size);
+        assert(readPos == size || buf[readPos] <= 0x03);
       }
-      assert(*it_read <= 0x03);
     }
-    zeroCount = (*it_read == 0x00) ? zeroCount+1 : 0;
-    *it_write = *it_read;
   }
-  assert(zeroCount == 0);
+
+  const uint8_t *const buf = bitstream.getData();
+  assert(endsWithEmulationPreventionByte || writePos == 0 || buf[writePos - 1] != 0x00);
 
   if (isVclNalUnit)
   {
     // Remove cabac_zero_word from payload if present
     Int n = 0;
 
-    while (it_write[-1] == 0x00)
+    while (buf[writePos - 1] == 0x00)
     {
-      it_write--;
+      writePos--;
       n++;
     }
 
@@ -102,7 +125,14 @@ static Void convertPayloadToRBSP(vector<uint8_t>& nalUnitBuf, TComInputBitstream
     }
   }
 
-  nalUnitBuf.resize(it_write - nalUnitBuf.begin());
+  if (bitstream.isView())
+  {
+    bitstream.setView(buf, UInt(writePos));
+  }
+  else
+  {
+    bitstream.getFifo().resize(writePos);
+  }
 }
 
 #if ENC_DEC_TRACE && DEC_NUH_TRACE
@@ -175,9 +205,8 @@ Void readNalUnitHeader(InputNALUnit& nalu)
 Void read(InputNALUnit& nalu)
 {
   TComInputBitstream &bitstream = nalu.getBitstream();
-  vector<uint8_t>& nalUnitBuf=bitstream.getFifo();
   // perform anti-emulation prevention
-  convertPayloadToRBSP(nalUnitBuf, &bitstream, (nalUnitBuf[0] & 64) == 0);
+  convertPayloadToRBSP(bitstream, (bitstream.getData()[0] & 64) == 0);
   bitstream.resetToStart();
   readNalUnitHeader(nalu);
 }
@@ -138,35 +138,10 @@ Void SyntaxElementParser::xReadUvlc( UInt& ruiVal, const TChar *pSymbolName)
 Void SyntaxElementParser::xReadUvlc( UInt& ruiVal)
 #endif
 {
-  UInt uiVal = 0;
-  UInt uiCode = 0;
   UInt uiLength;
-  m_pcBitstream->read( 1, uiCode );
+  m_pcBitstream->readExpGolomb( ruiVal, uiLength );
 #if RExt__DECODER_DEBUG_BIT_STATISTICS
-  UInt totalLen=1;
-#endif
-
-  if( 0 == uiCode )
-  {
-    uiLength = 0;
-
-    while( ! ( uiCode & 1 ))
-    {
-      m_pcBitstream->read( 1, uiCode );
-      uiLength++;
-    }
-
-    m_pcBitstream->read( uiLength, uiVal );
-
-    uiVal += (1 << uiLength)-1;
-#if RExt__DECODER_DEBUG_BIT_STATISTICS
-    totalLen+=uiLength+uiLength;
-#endif
-  }
-
-  ruiVal = uiVal;
-#if RExt__DECODER_DEBUG_BIT_STATISTICS
-  TComCodingStatistics::IncrementStatisticEP(pSymbolName, Int(totalLen), ruiVal);
+  TComCodingStatistics::IncrementStatisticEP(pSymbolName, Int(uiLength), ruiVal);
 #endif
 }
 
@@ -176,35 +151,14 @@ Void SyntaxElementParser::xReadSvlc( Int& riVal, const TChar *pSymbolName)
 Void SyntaxElementParser::xReadSvlc( Int& riVal)
 #endif
 {
-  UInt uiBits = 0;
-  m_pcBitstream->read( 1, uiBits );
-#if RExt__DECODER_DEBUG_BIT_STATISTICS
-  UInt totalLen=1;
-#endif
-  if( 0 == uiBits )
-  {
-    UInt uiLength = 0;
-
-    while( ! ( uiBits & 1 ))
-    {
-      m_pcBitstream->read( 1, uiBits );
-      uiLength++;
-    }
-
-    m_pcBitstream->read( uiLength, uiBits );
+  UInt uiCodeNum;
+  UInt uiLength;
+  m_pcBitstream->readExpGolomb( uiCodeNum, uiLength );
 
-    uiBits += (1 << uiLength);
-    riVal = ( uiBits & 1) ? -(Int)(uiBits>>1) : (Int)(uiBits>>1);
-#if RExt__DECODER_DEBUG_BIT_STATISTICS
-    totalLen+=uiLength+uiLength;
-#endif
-  }
-  else
-  {
-    riVal = 0;
-  }
+  const UInt uiBits = uiCodeNum + 1;
+  riVal = ( uiBits & 1) ? -(Int)(uiBits>>1) : (Int)(uiBits>>1);
 #if RExt__DECODER_DEBUG_BIT_STATISTICS
-  TComCodingStatistics::IncrementStatisticEP(pSymbolName, Int(totalLen), riVal);
+  TComCodingStatistics::IncrementStatisticEP(pSymbolName, Int(uiLength), riVal);
 #endif
 }
 
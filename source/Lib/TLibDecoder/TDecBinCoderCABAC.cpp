@@ -44,8 +44,18 @@
 //! \ingroup TLibDecoder
 //! \{
 
+//! position of the least significant bit of the 9-bit arithmetic decoder offset in TDecBinCABAC::m_uiValue
+static const Int  CABAC_OFFSET_SHIFT = 54;
+static const UInt64 CABAC_PREFETCH_MASK = ( UInt64( 1 ) << CABAC_OFFSET_SHIFT ) - 1;
+//! maximum number of bypass bins decoded in one step (limited by the precision of the reciprocal multiplication)
+static const Int  CABAC_MAX_BYPASS_BINS_PER_STEP = 16;
+
 TDecBinCABAC::TDecBinCABAC()
 : m_pcTComBitstream( 0 )
+, m_pucBuffer( 0 )
+, m_uiBufferSize( 0 )
+, m_uiStartIdx( 0 )
+, m_uiNextIdx( 0 )
 {
 }
 
@@ -72,20 +82,28 @@ TDecBinCABAC::start()
 #if RExt__DECODER_DEBUG_BIT_STATISTICS
   TComCodingStatistics::UpdateCABACStat(STATS__CABAC_INITIALISATION, 512, 510, 0);
 #endif
+  m_pucBuffer    = m_pcTComBitstream->getData();
+  m_uiBufferSize = m_pcTComBitstream->getDataSize();
+  m_uiStartIdx   = m_pcTComBitstream->getByteLocation();
+  m_uiNextIdx    = m_uiStartIdx;
+
   m_uiRange    = 510;
-  m_bitsNeeded = -8;
-  m_uiValue    = (m_pcTComBitstream->readByte() << 8);
-  m_uiValue   |= m_pcTComBitstream->readByte();
+  m_uiValue    = 0;
+  m_bitsLeft   = -9;
+  xReadBytes();
 }
 
 Void
 TDecBinCABAC::finish()
 {
   UInt lastByte;
+  UInt numBytesRead;
+  Int  bitsNeeded;
 
+  xGetBytePosition( numBytesRead, bitsNeeded );
   m_pcTComBitstream->peekPreviousByte( lastByte );
   // Check for proper stop/alignment pattern
-  assert( ((lastByte << (8 + m_bitsNeeded)) & 0xff) == 0x80 );
+  assert( ((lastByte << (8 + bitsNeeded)) & 0xff) == 0x80 );
 }
 
 /**
@@ -97,11 +115,53 @@ Void
 TDecBinCABAC::copyState( const TDecBinIf* pcTDecBinIf )
 {
   const TDecBinCABAC* pcTDecBinCABAC = pcTDecBinIf->getTDecBinCABAC();
-  m_uiRange   = pcTDecBinCABAC->m_uiRange;
-  m_uiValue   = pcTDecBinCABAC->m_uiValue;
-  m_bitsNeeded= pcTDecBinCABAC->m_bitsNeeded;
+  m_pucBuffer    = pcTDecBinCABAC->m_pucBuffer;
+  m_uiBufferSize = pcTDecBinCABAC->m_uiBufferSize;
+  m_uiStartIdx   = pcTDecBinCABAC->m_uiStartIdx;
+  m_uiNextIdx    = pcTDecBinCABAC->m_uiNextIdx;
+  m_uiRange      = pcTDecBinCABAC->m_uiRange;
+  m_uiValue      = pcTDecBinCABAC->m_uiValue;
+  m_bitsLeft     = pcTDecBinCABAC->m_bitsLeft;
+}
+
+/** Refill the prefetched bits of m_uiValue with as many whole bytes as fit.
+ *  Eight bytes are loaded at once when available; bytes beyond the end of the bitstream are read as zero.
+ */
+Void
+TDecBinCABAC::xReadBytes()
+{
+  const Int numBytes = ( CABAC_OFFSET_SHIFT - m_bitsLeft ) >> 3;
+  UInt64    bytes    = 0;
+
+  if ( m_uiNextIdx + 8 <= m_uiBufferSize )
+  {
+    bytes = readBigEndian64( m_pucBuffer + m_uiNextIdx ) >> ( 64 - ( numBytes << 3 ) );
+  }
+  else
+  {
+    for ( Int i = 0; i < numBytes; i++ )
+    {
+      bytes = ( bytes << 8 ) | ( m_uiNextIdx + i < m_uiBufferSize ? m_pucBuffer[m_uiNextIdx + i] : 0 );
+    }
+  }
+
+  m_uiNextIdx += numBytes;
+  m_bitsLeft  += numBytes << 3;
+  m_uiValue   += bytes << ( CABAC_OFFSET_SHIFT - m_bitsLeft );
 }
 
+/** Get the position that a decoder reading one byte at a time would have reached.
+ * \param ruiNumBytesRead number of bytes read since start()
+ * \param riBitsNeeded    number of bits shifted into the offset since the last byte was read, minus 8
+ */
+Void
+TDecBinCABAC::xGetBytePosition( UInt& ruiNumBytesRead, Int& riBitsNeeded ) const
+{
+  const Int numBitsShifted = Int( ( m_uiNextIdx - m_uiStartIdx ) << 3 ) - 9 - m_bitsLeft;
+
+  ruiNumBytesRead = 2 + ( numBitsShifted >> 3 );
+  riBitsNeeded    = -8 + ( numBitsShifted & 7 );
+}
 
 
 #if RExt__DECODER_DEBUG_BIT_STATISTICS
@@ -116,7 +176,7 @@ Void TDecBinCABAC::decodeBin( UInt& ruiBin, ContextModel &rcCtxModel )
 
   UInt uiLPS = TComCABACTables::sm_aucLPSTable[ rcCtxModel.getState() ][ ( m_uiRange >> 6 ) - 4 ];
   m_uiRange -= uiLPS;
-  UInt scaledRange = m_uiRange << 7;
+  const UInt64 scaledRange = UInt64( m_uiRange ) << CABAC_OFFSET_SHIFT;
 
   if( m_uiValue < scaledRange )
   {
@@ -127,15 +187,14 @@ Void TDecBinCABAC::decodeBin( UInt& ruiBin, ContextModel &rcCtxModel )
 #endif
     rcCtxModel.updateMPS();
 
-    if ( scaledRange < ( 256 << 7 ) )
+    if ( m_uiRange < 256 )
     {
-      m_uiRange = scaledRange >> 6;
+      m_uiRange += m_uiRange;
       m_uiValue += m_uiValue;
 
-      if ( ++m_bitsNeeded == 0 )
+      if ( --m_bitsLeft < 0 )
       {
-        m_bitsNeeded = -8;
-        m_uiValue += m_pcTComBitstream->readByte();
+        xReadBytes();
       }
     }
   }
@@ -151,12 +210,11 @@ Void TDecBinCABAC::decodeBin( UInt& ruiBin, ContextModel &rcCtxModel )
     m_uiRange   = uiLPS << numBits;
     rcCtxModel.updateLPS();
 
-    m_bitsNeeded += numBits;
+    m_bitsLeft -= numBits;
 
-    if ( m_bitsNeeded >= 0 )
+    if ( m_bitsLeft < 0 )
     {
-      m_uiValue += m_pcTComBitstream->readByte() << m_bitsNeeded;
-      m_bitsNeeded -= 8;
+      xReadBytes();
     }
   }
 
@@ -186,26 +244,15 @@ Void TDecBinCABAC::decodeBinEP( UInt& ruiBin, const TComCodingStatisticsClassTyp
 Void TDecBinCABAC::decodeBinEP( UInt& ruiBin )
 #endif
 {
-  if (m_uiRange == 256)
-  {
-#if RExt__DECODER_DEBUG_BIT_STATISTICS
-    decodeAlignedBinsEP(ruiBin, 1, whichStat);
-#else
-    decodeAlignedBinsEP(ruiBin, 1);
-#endif
-    return;
-  }
-
   m_uiValue += m_uiValue;
 
-  if ( ++m_bitsNeeded >= 0 )
+  if ( --m_bitsLeft < 0 )
   {
-    m_bitsNeeded = -8;
-    m_uiValue += m_pcTComBitstream->readByte();
+    xReadBytes();
   }
 
   ruiBin = 0;
-  UInt scaledRange = m_uiRange << 7;
+  const UInt64 scaledRange = UInt64( m_uiRange ) << CABAC_OFFSET_SHIFT;
   if ( m_uiValue >= scaledRange )
   {
     ruiBin = 1;
@@ -216,6 +263,11 @@ Void TDecBinCABAC::decodeBinEP( UInt& ruiBin )
 #endif
 }
 
+/** Decode a run of bypass bins.
+ *  Decoding n bypass bins is equivalent to dividing the offset, extended by the next n bits, by the range: the quotient
+ *  holds the bins and the remainder is the new offset. The quotient is obtained for up to CABAC_MAX_BYPASS_BINS_PER_STEP
+ *  bins at once by multiplying with a reciprocal of the range, and corrected by at most one.
+ */
 #if RExt__DECODER_DEBUG_BIT_STATISTICS
 Void TDecBinCABAC::decodeBinsEP( UInt& ruiBin, Int numBins, const TComCodingStatisticsClassType &whichStat )
 #else
@@ -236,43 +288,30 @@ Void TDecBinCABAC::decodeBinsEP( UInt& ruiBin, Int numBins )
 #if RExt__DECODER_DEBUG_BIT_STATISTICS
   Int origNumBins=numBins;
 #endif
-  while ( numBins > 8 )
+  const UInt64 reciprocal = TComCABACTables::sm_auiRangeReciprocalTable[ m_uiRange - 256 ];
+
+  while ( numBins > 0 )
   {
-    m_uiValue = ( m_uiValue << 8 ) + ( m_pcTComBitstream->readByte() << ( 8 + m_bitsNeeded ) );
+    const Int binsToRead = std::min<Int>( numBins, CABAC_MAX_BYPASS_BINS_PER_STEP );
 
-    UInt scaledRange = m_uiRange << 15;
-    for ( Int i = 0; i < 8; i++ )
+    if ( m_bitsLeft < binsToRead )
     {
-      bins += bins;
-      scaledRange >>= 1;
-      if ( m_uiValue >= scaledRange )
-      {
-        bins++;
-        m_uiValue -= scaledRange;
-      }
+      xReadBytes();
     }
-    numBins -= 8;
-  }
-
-  m_bitsNeeded += numBins;
-  m_uiValue <<= numBins;
-
-  if ( m_bitsNeeded >= 0 )
-  {
-    m_uiValue += m_pcTComBitstream->readByte() << m_bitsNeeded;
-    m_bitsNeeded -= 8;
-  }
 
-  UInt scaledRange = m_uiRange << ( numBins + 7 );
-  for ( Int i = 0; i < numBins; i++ )
-  {
-    bins += bins;
-    scaledRange >>= 1;
-    if ( m_uiValue >= scaledRange )
+    // offset followed by the next binsToRead bits
+    const UInt64 extendedOffset = m_uiValue >> ( CABAC_OFFSET_SHIFT - binsToRead );
+    UInt newBins = UInt( ( extendedOffset * reciprocal ) >> 32 );
+    if ( UInt64( newBins ) * m_uiRange > extendedOffset ) // the reciprocal is rounded up, so the quotient may be one too large
     {
-      bins++;
-      m_uiValue -= scaledRange;
+      newBins--;
     }
+    const UInt64 offset = extendedOffset - UInt64( newBins ) * m_uiRange;
+
+    bins       = ( bins << binsToRead ) | newBins;
+    m_uiValue  = ( offset << CABAC_OFFSET_SHIFT ) | ( ( m_uiValue << binsToRead ) & CABAC_PREFETCH_MASK );
+    m_bitsLeft -= binsToRead;
+    numBins    -= binsToRead;
   }
 
   ruiBin = bins;
@@ -302,31 +341,27 @@ Void TDecBinCABAC::decodeAlignedBinsEP( UInt& ruiBins, Int numBins )
 
   while (binsRemaining > 0)
   {
-    const UInt binsToRead = std::min<UInt>(binsRemaining, 8); //read bytes if able to take advantage of the system's byte-read function
-    const UInt binMask    = (1 << binsToRead) - 1;
+    const Int binsToRead = std::min<Int>(binsRemaining, CABAC_MAX_BYPASS_BINS_PER_STEP);
+
+    if (m_bitsLeft < binsToRead)
+    {
+      xReadBytes();
+    }
 
-    //The MSB of m_uiValue is known to be 0 because range is 256. Therefore:
+    //The MSB of the offset is known to be 0 because range is 256. Therefore:
     // > The comparison against the symbol range of 128 is simply a test on the next-most-significant bit
     // > "Subtracting" the symbol range if the decoded bin is 1 simply involves clearing that bit.
     //
-    //As a result, the required bins are simply the <binsToRead> next-most-significant bits of m_uiValue
-    //(m_uiValue is stored MSB-aligned in a 16-bit buffer - hence the shift of 15)
-    //
-    //   m_uiValue = |0|V|V|V|V|V|V|V|V|B|B|B|B|B|B|B|        (V = usable bit, B = potential buffered bit (buffer refills when m_bitsNeeded >= 0))
+    //As a result, the required bins are simply the <binsToRead> bits that follow the MSB of the offset
+    //(the offset is stored in bits 54..62 of m_uiValue, so its MSB is bit 62)
     //
-    const UInt newBins = (m_uiValue >> (15 - binsToRead)) & binMask;
+    const UInt newBins = UInt(m_uiValue >> (CABAC_OFFSET_SHIFT + 8 - binsToRead)) & ((1 << binsToRead) - 1);
 
-    ruiBins   = (ruiBins   << binsToRead) | newBins;
-    m_uiValue = (m_uiValue << binsToRead) & 0x7FFF;
+    ruiBins   = (ruiBins << binsToRead) | newBins;
+    m_uiValue = (m_uiValue << binsToRead) & ((UInt64(1) << (CABAC_OFFSET_SHIFT + 8)) - 1);
 
     binsRemaining -= binsToRead;
-    m_bitsNeeded  += binsToRead;
-
-    if (m_bitsNeeded >= 0)
-    {
-      m_uiValue    |= m_pcTComBitstream->readByte() << m_bitsNeeded;
-      m_bitsNeeded -= 8;
-    }
+    m_bitsLeft    -= binsToRead;
   }
 
 #if RExt__DECODER_DEBUG_BIT_STATISTICS
@@ -338,13 +373,20 @@ Void
 TDecBinCABAC::decodeBinTrm( UInt& ruiBin )
 {
   m_uiRange -= 2;
-  UInt scaledRange = m_uiRange << 7;
+  const UInt64 scaledRange = UInt64( m_uiRange ) << CABAC_OFFSET_SHIFT;
   if( m_uiValue >= scaledRange )
   {
     ruiBin = 1;
+
+    // the arithmetic decoding is stopped (end of slice segment/substream or PCM samples follow):
+    // return the bytes that have been prefetched but not used to the bitstream
+    UInt numBytesRead;
+    Int  bitsNeeded;
+    xGetBytePosition( numBytesRead, bitsNeeded );
+    m_pcTComBitstream->setByteLocation( m_uiStartIdx + numBytesRead );
 #if RExt__DECODER_DEBUG_BIT_STATISTICS
     TComCodingStatistics::UpdateCABACStat(STATS__CABAC_TRM_BITS, m_uiRange+2, 2, ruiBin);
-    TComCodingStatistics::IncrementStatisticEP(STATS__BYTE_ALIGNMENT_BITS, -m_bitsNeeded, 0);
+    TComCodingStatistics::IncrementStatisticEP(STATS__BYTE_ALIGNMENT_BITS, -bitsNeeded, 0);
 #endif
   }
   else
@@ -353,15 +395,14 @@ TDecBinCABAC::decodeBinTrm( UInt& ruiBin )
 #if RExt__DECODER_DEBUG_BIT_STATISTICS
     TComCodingStatistics::UpdateCABACStat(STATS__CABAC_TRM_BITS, m_uiRange+2, m_uiRange, ruiBin);
 #endif
-    if ( scaledRange < ( 256 << 7 ) )
+    if ( m_uiRange < 256 )
     {
-      m_uiRange = scaledRange >> 6;
+      m_uiRange += m_uiRange;
       m_uiValue += m_uiValue;
 
-      if ( ++m_bitsNeeded == 0 )
+      if ( --m_bitsLeft < 0 )
       {
-        m_bitsNeeded = -8;
-        m_uiValue += m_pcTComBitstream->readByte();
+        xReadBytes();
       }
     }
   }
@@ -79,10 +79,17 @@ public:
   const TDecBinCABAC* getTDecBinCABAC() const { return this; }
 
 private:
+  Void  xReadBytes        ();
+  Void  xGetBytePosition  ( UInt& ruiNumBytesRead, Int& riBitsNeeded ) const;
+
   TComInputBitstream* m_pcTComBitstream;
+  const UChar*        m_pucBuffer;      ///< bytes of the bitstream
+  UInt                m_uiBufferSize;   ///< number of bytes in m_pucBuffer
+  UInt                m_uiStartIdx;     ///< index in m_pucBuffer at which the arithmetic decoding was started
+  UInt                m_uiNextIdx;      ///< index in m_pucBuffer of the next byte to be loaded into m_uiValue
   UInt                m_uiRange;
-  UInt                m_uiValue;
-  Int                 m_bitsNeeded;
+  UInt64              m_uiValue;        ///< 9-bit offset in bits 54..62, followed by m_bitsLeft prefetched bits
+  Int                 m_bitsLeft;       ///< number of prefetched bits in m_uiValue that have not been shifted into the offset
 };
 
 //! \}
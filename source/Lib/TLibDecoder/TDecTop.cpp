@@ -742,6 +742,12 @@ Bool TDecTop::decode(InputNALUnit& nalu, Int& iSkipFrame, Int& iPOCLastDisplay)
   m_cEntropyDecoder.setEntropyDecoder (&m_cCavlcDecoder);
   m_cEntropyDecoder.setBitstream      (&(nalu.getBitstream()));
 
+  if (nalu.m_nalUnitType == NAL_UNIT_VPS || nalu.m_nalUnitType == NAL_UNIT_SPS || nalu.m_nalUnitType == NAL_UNIT_PPS)
+  {
+    // the parameter set manager keeps a copy of the (small) parameter set NAL units to detect changes
+    nalu.getBitstream().copyViewToFifo();
+  }
+
   switch (nalu.m_nalUnitType)
   {
     case NAL_UNIT_VPS:
@@ -84,42 +84,32 @@ Void write(ostream& out, OutputNALUnit& nalu)
    *  - 0x00000302
    *  - 0x00000303
    */
-  vector<uint8_t>& rbsp   = nalu.m_Bitstream.getFIFO();
+  const vector<uint8_t>& rbsp = nalu.m_Bitstream.getFIFO();
+  const uint8_t *const   data = rbsp.empty() ? NULL : &rbsp[0];
+  const size_t           size = rbsp.size();
 
-  vector<uint8_t> outputBuffer;
-  outputBuffer.resize(rbsp.size()*2+1); //there can never be enough emulation_prevention_three_bytes to require this much space
-  std::size_t outputAmount = 0;
-  Int         zeroCount    = 0;
-  for (vector<uint8_t>::iterator it = rbsp.begin(); it != rbsp.end(); it++)
+  /* the spans between the emulated sequences are written out whole: an
+   * emulation_prevention_three_byte is inserted before the third byte of
+   * each 0x0000{00,01,02,03}, with which the search for the next one restarts */
+  size_t spanStart = 0;
+  for (size_t pos = findZeroZeroByteSequence(data, size, 0x03); pos < size; )
   {
-    const uint8_t v=(*it);
-    if (zeroCount==2 && v<=3)
-    {
-      outputBuffer[outputAmount++]=emulation_prevention_three_byte[0];
-      zeroCount=0;
-    }
-
-    if (v==0)
-    {
-      zeroCount++;
-    }
-    else
-    {
-      zeroCount=0;
-    }
-    outputBuffer[outputAmount++]=v;
+    out.write(reinterpret_cast<const TChar*>(data + spanStart), std::streamsize(pos + 2 - spanStart));
+    out.write(reinterpret_cast<const TChar*>(emulation_prevention_three_byte), 1);
+    spanStart = pos + 2;
+    pos = spanStart + findZeroZeroByteSequence(data + spanStart, size - spanStart, 0x03);
   }
+  out.write(reinterpret_cast<const TChar*>(data + spanStart), std::streamsize(size - spanStart));
 
   /* 7.4.1.1
    * ... when the last byte of the RBSP data is equal to 0x00 (which can
    * only occur when the RBSP ends in a cabac_zero_word), a final byte equal
    * to 0x03 is appended to the end of the data.
    */
-  if (zeroCount>0)
+  if (size > 0 && data[size - 1] == 0x00)
   {
-    outputBuffer[outputAmount++]=emulation_prevention_three_byte[0];
+    out.write(reinterpret_cast<const TChar*>(emulation_prevention_three_byte), 1);
   }
-  out.write(reinterpret_cast<const TChar*>(&(*outputBuffer.begin())), outputAmount);
 }
 
 //! \}
@@ -43,6 +43,11 @@
 //! \{
 
 
+//! number of bits by which TEncBinCABAC::m_uiLow can be shifted after start() without overflowing (9-bit register plus carry)
+static const Int  CABAC_LOW_SHIFT_CAPACITY = 64 - 10;
+//! number of bits that TEncBinCABAC::writeOut() moves from the low register to the bitstream
+static const Int  CABAC_OUTPUT_WORD_BITS   = 32;
+
 TEncBinCABAC::TEncBinCABAC()
 : m_pcTComBitIf( 0 )
 , m_binCountIncrement( 0 )
@@ -70,9 +75,9 @@ Void TEncBinCABAC::start()
 {
   m_uiLow            = 0;
   m_uiRange          = 510;
-  m_bitsLeft         = 23;
-  m_numBufferedBytes = 0;
-  m_bufferedByte     = 0xff;
+  m_bitsLeft         = CABAC_LOW_SHIFT_CAPACITY;
+  m_numBufferedWords = 0;
+  m_bufferedWord     = 0xffffffff;
 #if FAST_BIT_EST
   m_fracBits         = 0;
 #endif
@@ -80,31 +85,33 @@ Void TEncBinCABAC::start()
 
 Void TEncBinCABAC::finish()
 {
-  if ( m_uiLow >> ( 32 - m_bitsLeft ) )
+  const Int numPendingBits = CABAC_LOW_SHIFT_CAPACITY - m_bitsLeft;
+
+  if ( m_uiLow >> ( 9 + numPendingBits ) )
   {
-    //assert( m_numBufferedBytes > 0 );
-    //assert( m_bufferedByte != 0xff );
-    m_pcTComBitIf->write( m_bufferedByte + 1, 8 );
-    while ( m_numBufferedBytes > 1 )
+    //assert( m_numBufferedWords > 0 );
+    //assert( m_bufferedWord != 0xffffffff );
+    m_pcTComBitIf->write( m_bufferedWord + 1, 32 );
+    while ( m_numBufferedWords > 1 )
     {
-      m_pcTComBitIf->write( 0x00, 8 );
-      m_numBufferedBytes--;
+      m_pcTComBitIf->write( 0x00000000, 32 );
+      m_numBufferedWords--;
     }
-    m_uiLow -= 1 << ( 32 - m_bitsLeft );
+    m_uiLow -= UInt64( 1 ) << ( 9 + numPendingBits );
   }
   else
   {
-    if ( m_numBufferedBytes > 0 )
+    if ( m_numBufferedWords > 0 )
     {
-      m_pcTComBitIf->write( m_bufferedByte, 8 );
+      m_pcTComBitIf->write( m_bufferedWord, 32 );
     }
-    while ( m_numBufferedBytes > 1 )
+    while ( m_numBufferedWords > 1 )
     {
-      m_pcTComBitIf->write( 0xff, 8 );
-      m_numBufferedBytes--;
+      m_pcTComBitIf->write( 0xffffffff, 32 );
+      m_numBufferedWords--;
     }
   }
-  m_pcTComBitIf->write( m_uiLow >> 8, 24 - m_bitsLeft );
+  m_pcTComBitIf->write( UInt( m_uiLow >> 8 ), 1 + numPendingBits );
 }
 
 Void TEncBinCABAC::flush()
@@ -151,8 +158,8 @@ Void TEncBinCABAC::copyState( const TEncBinIf* pcTEncBinIf )
   m_uiLow           = pcTEncBinCABAC->m_uiLow;
   m_uiRange         = pcTEncBinCABAC->m_uiRange;
   m_bitsLeft        = pcTEncBinCABAC->m_bitsLeft;
-  m_bufferedByte    = pcTEncBinCABAC->m_bufferedByte;
-  m_numBufferedBytes = pcTEncBinCABAC->m_numBufferedBytes;
+  m_bufferedWord    = pcTEncBinCABAC->m_bufferedWord;
+  m_numBufferedWords = pcTEncBinCABAC->m_numBufferedWords;
 #if FAST_BIT_EST
   m_fracBits = pcTEncBinCABAC->m_fracBits;
 #endif
@@ -161,9 +168,9 @@ Void TEncBinCABAC::copyState( const TEncBinIf* pcTEncBinIf )
 Void TEncBinCABAC::resetBits()
 {
   m_uiLow            = 0;
-  m_bitsLeft         = 23;
-  m_numBufferedBytes = 0;
-  m_bufferedByte     = 0xff;
+  m_bitsLeft         = CABAC_LOW_SHIFT_CAPACITY;
+  m_numBufferedWords = 0;
+  m_bufferedWord     = 0xffffffff;
   if ( m_binCountIncrement )
   {
     m_uiBinsCoded = 0;
@@ -175,7 +182,7 @@ Void TEncBinCABAC::resetBits()
 
 UInt TEncBinCABAC::getNumWrittenBits()
 {
-  return m_pcTComBitIf->getNumberOfWrittenBits() + 8 * m_numBufferedBytes + 23 - m_bitsLeft;
+  return m_pcTComBitIf->getNumberOfWrittenBits() + CABAC_OUTPUT_WORD_BITS * m_numBufferedWords + CABAC_LOW_SHIFT_CAPACITY - m_bitsLeft;
 }
 
 /**
@@ -264,12 +271,6 @@ Void TEncBinCABAC::encodeBinEP( UInt binValue )
 
   m_uiBinsCoded += m_binCountIncrement;
 
-  if (m_uiRange == 256)
-  {
-    encodeAlignedBinsEP(binValue, 1);
-    return;
-  }
-
   m_uiLow <<= 1;
   if( binValue )
   {
@@ -301,26 +302,32 @@ Void TEncBinCABAC::encodeBinsEP( UInt binValues, Int numBins )
     }
   }
 
-  if (m_uiRange == 256)
-  {
-    encodeAlignedBinsEP(binValues, numBins);
-    return;
-  }
+  xEncodeBinsEP( binValues, numBins );
+}
 
-  while ( numBins > 8 )
-  {
-    numBins -= 8;
-    UInt pattern = binValues >> numBins;
-    m_uiLow <<= 8;
-    m_uiLow += m_uiRange * pattern;
-    binValues -= pattern << numBins;
-    m_bitsLeft -= 8;
+/**
+ * \brief Encode up to 32 equiprobable bins, in one step when the low register has room for them
+ *
+ * \param binValues bin values
+ * \param numBins number of bins
+ */
+Void TEncBinCABAC::xEncodeBinsEP( UInt binValues, Int numBins )
+{
+  assert( numBins <= 32 );
 
+  if ( numBins > m_bitsLeft )
+  {
+    // m_bitsLeft is at least CABAC_LOW_SHIFT_CAPACITY - CABAC_OUTPUT_WORD_BITS + 1 here: code all but the last 16 bins first
+    const Int numLeadingBins = numBins - 16;
+    m_uiLow     = ( m_uiLow << numLeadingBins ) + UInt64( m_uiRange ) * ( binValues >> 16 );
+    m_bitsLeft -= numLeadingBins;
     testAndWriteOut();
+
+    binValues &= 0xffff;
+    numBins    = 16;
   }
 
-  m_uiLow <<= numBins;
-  m_uiLow += m_uiRange * binValues;
+  m_uiLow     = ( m_uiLow << numBins ) + UInt64( m_uiRange ) * binValues;
   m_bitsLeft -= numBins;
 
   testAndWriteOut();
@@ -333,39 +340,27 @@ Void TEncBinCABAC::align()
 
 Void TEncBinCABAC::encodeAlignedBinsEP( UInt binValues, Int numBins )
 {
-  Int binsRemaining = numBins;
-
   assert(m_uiRange == 256); //aligned encode only works when range = 256
 
-  while (binsRemaining > 0)
-  {
-    const UInt binsToCode = std::min<UInt>(binsRemaining, 8); //code bytes if able to take advantage of the system's byte-write function
-    const UInt binMask    = (1 << binsToCode) - 1;
-
-    const UInt newBins = (binValues >> (binsRemaining - binsToCode)) & binMask;
-
-    //The process of encoding an EP bin is the same as that of coding a normal
-    //bin where the symbol ranges for 1 and 0 are both half the range:
-    //
-    //  low = (low + range/2) << 1       (to encode a 1)
-    //  low =  low            << 1       (to encode a 0)
-    //
-    //  i.e.
-    //  low = (low + (bin * range/2)) << 1
-    //
-    //  which is equivalent to:
-    //
-    //  low = (low << 1) + (bin * range)
-    //
-    //  this can be generalised for multiple bins, producing the following expression:
-    //
-    m_uiLow = (m_uiLow << binsToCode) + (newBins << 8); //range is known to be 256
-
-    binsRemaining -= binsToCode;
-    m_bitsLeft    -= binsToCode;
-
-    testAndWriteOut();
-  }
+  //The process of encoding an EP bin is the same as that of coding a normal
+  //bin where the symbol ranges for 1 and 0 are both half the range:
+  //
+  //  low = (low + range/2) << 1       (to encode a 1)
+  //  low =  low            << 1       (to encode a 0)
+  //
+  //  i.e.
+  //  low = (low + (bin * range/2)) << 1
+  //
+  //  which is equivalent to:
+  //
+  //  low = (low << 1) + (bin * range)
+  //
+  //  this can be generalised for multiple bins, producing the following expression:
+  //
+  //  low = (low << numBins) + (binValues * range)
+  //
+  //  which is the general bypass coding of xEncodeBinsEP (with range known to be 256)
+  xEncodeBinsEP(binValues, numBins);
 }
 
 /**
@@ -400,45 +395,49 @@ Void TEncBinCABAC::encodeBinTrm( UInt binValue )
 
 Void TEncBinCABAC::testAndWriteOut()
 {
-  if ( m_bitsLeft < 12 )
+  if ( m_bitsLeft <= CABAC_LOW_SHIFT_CAPACITY - CABAC_OUTPUT_WORD_BITS )
   {
     writeOut();
   }
 }
 
 /**
- * \brief Move bits from register into bitstream
+ * \brief Move 32 bits from register into bitstream
+ *
+ * A word of all ones is held back (counted in m_numBufferedWords) until it is known whether a carry will propagate through it.
  */
 Void TEncBinCABAC::writeOut()
 {
-  UInt leadByte = m_uiLow >> (24 - m_bitsLeft);
-  m_bitsLeft += 8;
-  m_uiLow &= 0xffffffffu >> m_bitsLeft;
+  const Int    numPendingBits = CABAC_LOW_SHIFT_CAPACITY - m_bitsLeft;
+  const Int    leadWordShift  = 9 + numPendingBits - CABAC_OUTPUT_WORD_BITS;
+  const UInt64 leadWord       = m_uiLow >> leadWordShift; // includes the carry in bit 32
+  m_bitsLeft += CABAC_OUTPUT_WORD_BITS;
+  m_uiLow    &= ( UInt64( 1 ) << leadWordShift ) - 1;
 
-  if ( leadByte == 0xff )
+  if ( leadWord == 0xffffffff )
   {
-    m_numBufferedBytes++;
+    m_numBufferedWords++;
   }
   else
   {
-    if ( m_numBufferedBytes > 0 )
+    if ( m_numBufferedWords > 0 )
     {
-      UInt carry = leadByte >> 8;
-      UInt byte = m_bufferedByte + carry;
-      m_bufferedByte = leadByte & 0xff;
-      m_pcTComBitIf->write( byte, 8 );
+      UInt carry = UInt( leadWord >> 32 );
+      UInt word = m_bufferedWord + carry;
+      m_bufferedWord = UInt( leadWord );
+      m_pcTComBitIf->write( word, 32 );
 
-      byte = ( 0xff + carry ) & 0xff;
-      while ( m_numBufferedBytes > 1 )
+      word = 0xffffffff + carry;
+      while ( m_numBufferedWords > 1 )
       {
-        m_pcTComBitIf->write( byte, 8 );
-        m_numBufferedBytes--;
+        m_pcTComBitIf->write( word, 32 );
+        m_numBufferedWords--;
       }
     }
     else
     {
-      m_numBufferedBytes = 1;
-      m_bufferedByte = leadByte;
+      m_numBufferedWords = 1;
+      m_bufferedWord = UInt( leadWord );
     }
   }
 }
@@ -88,13 +88,14 @@ private:
 #endif
   Void testAndWriteOut();
   Void writeOut();
+  Void xEncodeBinsEP( UInt binValues, Int numBins );
 
   TComBitIf*          m_pcTComBitIf;
-  UInt                m_uiLow;
+  UInt64              m_uiLow;             ///< 9-bit low register, preceded by the output bits that have not been written yet
   UInt                m_uiRange;
-  UInt                m_bufferedByte;
-  Int                 m_numBufferedBytes;
-  Int                 m_bitsLeft;
+  UInt                m_bufferedWord;      ///< last 32 output bits that have been completed, but may still receive a carry
+  Int                 m_numBufferedWords;  ///< 1 + number of 0xffffffff words that follow m_bufferedWord (0 if no word is buffered)
+  Int                 m_bitsLeft;          ///< number of bits by which m_uiLow can still be shifted
   UInt                m_uiBinsCoded;
   Int                 m_binCountIncrement;
 #if FAST_BIT_EST
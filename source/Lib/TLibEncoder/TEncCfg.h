@@ -178,6 +178,9 @@ protected:
   UInt      m_uiQuadtreeTULog2MinSize;
   UInt      m_uiQuadtreeTUMaxDepthInter;
   UInt      m_uiQuadtreeTUMaxDepthIntra;
+  Bool      m_fastRQTZeroCbf;
+  Bool      m_fastRQTSatd;
+  Bool      m_fastRQTFinalRDOQ;
 
   //====== Loop/Deblock Filter ========
   Bool      m_bLoopFilterDisable;
@@ -202,6 +205,10 @@ protected:
   Bool      m_bFastMEAssumingSmootherMVEnabled;
   Int       m_minSearchWindow;
   Bool      m_bRestrictMESampling;
+  Bool      m_bUseHierarchicalME;
+  Bool      m_bUseHashME;
+  Bool      m_bUseSubPelPlanes;
+  MotionVectorCacheMode m_motionVectorCacheMode;
 
   //====== Quality control ========
   Int       m_iMaxDeltaQP;                      //  Max. absolute delta QP (1:default)
@@ -223,6 +230,9 @@ protected:
   Bool      m_highPrecisionOffsetsEnabledFlag;
   Bool      m_bUseAdaptiveQP;
   Int       m_iQPAdaptationRange;
+  Bool      m_lookaheadAnalysis;
+  UInt      m_lookaheadDownsampleLog2;
+  Bool      m_sceneCutIntra;
 
   //====== Tool list ========
   Int       m_bitDepth[MAX_NUM_CHANNEL_TYPE];
@@ -231,9 +241,14 @@ protected:
   Bool      m_useRDOQ;
   Bool      m_useRDOQTS;
   Bool      m_useSelectiveRDOQ;
+  Bool      m_useFastRDOQ;
   UInt      m_rdPenalty;
   FastInterSearchMode m_fastInterSearchMode;
   Bool      m_bUseEarlyCU;
+  CuSplitPredictorMode m_cuSplitPredictorMode;
+  std::string m_cuSplitModelFileName;
+  std::string m_cuSplitTrainingDataFileName;
+  Double    m_cuSplitThreshold;
   Bool      m_useFastDecisionForMerge;
   Bool      m_bUseCbfFastMode;
   Bool      m_useEarlySkipDetection;
@@ -255,6 +270,7 @@ protected:
 
   Bool      m_bUseConstrainedIntraPred;
   Bool      m_bFastUDIUseMPMEnabled;
+  Int       m_intraGradientModes;
   Bool      m_bFastMEForGenBLowDelayEnabled;
   Bool      m_bUseBLambdaForNonKeyLowDelayPictures;
   Bool      m_usePCM;
@@ -494,6 +510,9 @@ public:
   Void      setQuadtreeTULog2MinSize        ( UInt  u )      { m_uiQuadtreeTULog2MinSize = u; }
   Void      setQuadtreeTUMaxDepthInter      ( UInt  u )      { m_uiQuadtreeTUMaxDepthInter = u; }
   Void      setQuadtreeTUMaxDepthIntra      ( UInt  u )      { m_uiQuadtreeTUMaxDepthIntra = u; }
+  Void      setFastRQTZeroCbf               ( Bool  b )      { m_fastRQTZeroCbf = b; }
+  Void      setFastRQTSatd                  ( Bool  b )      { m_fastRQTSatd = b; }
+  Void      setFastRQTFinalRDOQ             ( Bool  b )      { m_fastRQTFinalRDOQ = b; }
 
   Void setUseAMP( Bool b ) { m_useAMP = b; }
 
@@ -513,6 +532,10 @@ public:
   Void      setFastMEAssumingSmootherMVEnabled ( Bool b )    { m_bFastMEAssumingSmootherMVEnabled = b; }
   Void      setMinSearchWindow              ( Int   i )      { m_minSearchWindow = i; }
   Void      setRestrictMESampling           ( Bool  b )      { m_bRestrictMESampling = b; }
+  Void      setUseHierarchicalME            ( Bool  b )      { m_bUseHierarchicalME = b; }
+  Void      setUseHashME                    ( Bool  b )      { m_bUseHashME = b; }
+  Void      setUseSubPelPlanes              ( Bool  b )      { m_bUseSubPelPlanes = b; }
+  Void      setMotionVectorCacheMode        ( MotionVectorCacheMode m ) { m_motionVectorCacheMode = m; }
 
   //====== Quality control ========
   Void      setMaxDeltaQP                   ( Int   i )      { m_iMaxDeltaQP = i; }
@@ -548,6 +571,9 @@ public:
 
   Void      setUseAdaptiveQP                ( Bool  b )      { m_bUseAdaptiveQP = b; }
   Void      setQPAdaptationRange            ( Int   i )      { m_iQPAdaptationRange = i; }
+  Void      setLookaheadAnalysis            ( Bool  b )      { m_lookaheadAnalysis = b; }
+  Void      setLookaheadDownsampleLog2      ( UInt  u )      { m_lookaheadDownsampleLog2 = u; }
+  Void      setSceneCutIntra                ( Bool  b )      { m_sceneCutIntra = b; }
 
   //====== Sequence ========
   Int       getFrameRate                    ()      { return  m_iFrameRate; }
@@ -594,6 +620,9 @@ public:
   UInt      getQuadtreeTULog2MinSize        ()      const { return m_uiQuadtreeTULog2MinSize; }
   UInt      getQuadtreeTUMaxDepthInter      ()      const { return m_uiQuadtreeTUMaxDepthInter; }
   UInt      getQuadtreeTUMaxDepthIntra      ()      const { return m_uiQuadtreeTUMaxDepthIntra; }
+  Bool      getFastRQTZeroCbf               ()      const { return m_fastRQTZeroCbf; }
+  Bool      getFastRQTSatd                  ()      const { return m_fastRQTSatd; }
+  Bool      getFastRQTFinalRDOQ             ()      const { return m_fastRQTFinalRDOQ; }
 
   //==== Loop/Deblock Filter ========
   Bool      getLoopFilterDisable            ()      { return  m_bLoopFilterDisable;       }
@@ -610,12 +639,19 @@ public:
   Bool      getFastMEAssumingSmootherMVEnabled () const { return m_bFastMEAssumingSmootherMVEnabled; }
   Int       getMinSearchWindow                 () const { return m_minSearchWindow; }
   Bool      getRestrictMESampling              () const { return m_bRestrictMESampling; }
+  Bool      getUseHierarchicalME               () const { return m_bUseHierarchicalME; }
+  Bool      getUseHashME                       () const { return m_bUseHashME; }
+  Bool      getUseSubPelPlanes                 () const { return m_bUseSubPelPlanes; }
+  MotionVectorCacheMode getMotionVectorCacheMode() const { return m_motionVectorCacheMode; }
 
   //==== Quality control ========
   Int       getMaxDeltaQP                   () const { return  m_iMaxDeltaQP; }
   Int       getMaxCuDQPDepth                () const { return  m_iMaxCuDQPDepth; }
   Bool      getUseAdaptiveQP                () const { return  m_bUseAdaptiveQP; }
   Int       getQPAdaptationRange            () const { return  m_iQPAdaptationRange; }
+  Bool      getLookaheadAnalysis            () const { return  m_lookaheadAnalysis; }
+  UInt      getLookaheadDownsampleLog2      () const { return  m_lookaheadDownsampleLog2; }
+  Bool      getSceneCutIntra                () const { return  m_sceneCutIntra; }
 
   //==== Tool list ========
   Void      setBitDepth( const ChannelType chType, Int internalBitDepthForChannel ) { m_bitDepth[chType] = internalBitDepthForChannel; }
@@ -624,14 +660,20 @@ public:
   Void      setUseRDOQ                      ( Bool  b )     { m_useRDOQ    = b; }
   Void      setUseRDOQTS                    ( Bool  b )     { m_useRDOQTS  = b; }
   Void      setUseSelectiveRDOQ             ( Bool b )      { m_useSelectiveRDOQ = b; }
+  Void      setUseFastRDOQ                  ( Bool b )      { m_useFastRDOQ = b; }
   Void      setRDpenalty                    ( UInt  u )     { m_rdPenalty  = u; }
   Void      setFastInterSearchMode          ( FastInterSearchMode m ) { m_fastInterSearchMode = m; }
   Void      setUseEarlyCU                   ( Bool  b )     { m_bUseEarlyCU = b; }
+  Void      setCuSplitPredictorMode         ( CuSplitPredictorMode m ) { m_cuSplitPredictorMode = m; }
+  Void      setCuSplitModelFileName         ( const std::string &s ) { m_cuSplitModelFileName = s; }
+  Void      setCuSplitTrainingDataFileName  ( const std::string &s ) { m_cuSplitTrainingDataFileName = s; }
+  Void      setCuSplitThreshold             ( Double d )    { m_cuSplitThreshold = d; }
   Void      setUseFastDecisionForMerge      ( Bool  b )     { m_useFastDecisionForMerge = b; }
   Void      setUseCbfFastMode               ( Bool  b )     { m_bUseCbfFastMode = b; }
   Void      setUseEarlySkipDetection        ( Bool  b )     { m_useEarlySkipDetection = b; }
   Void      setUseConstrainedIntraPred      ( Bool  b )     { m_bUseConstrainedIntraPred = b; }
   Void      setFastUDIUseMPMEnabled         ( Bool  b )     { m_bFastUDIUseMPMEnabled = b; }
+  Void      setIntraGradientModes           ( Int   i )     { m_intraGradientModes = i; }
   Void      setFastMEForGenBLowDelayEnabled ( Bool  b )     { m_bFastMEForGenBLowDelayEnabled = b; }
   Void      setUseBLambdaForNonKeyLowDelayPictures ( Bool b ) { m_bUseBLambdaForNonKeyLowDelayPictures = b; }
 
@@ -649,14 +691,20 @@ public:
   Bool      getUseRDOQ                      ()      { return m_useRDOQ;    }
   Bool      getUseRDOQTS                    ()      { return m_useRDOQTS;  }
   Bool      getUseSelectiveRDOQ             ()      { return m_useSelectiveRDOQ; }
+  Bool      getUseFastRDOQ                  ()      { return m_useFastRDOQ; }
   Int       getRDpenalty                    ()      { return m_rdPenalty;  }
   FastInterSearchMode getFastInterSearchMode() const{ return m_fastInterSearchMode;  }
   Bool      getUseEarlyCU                   ()      { return m_bUseEarlyCU; }
+  CuSplitPredictorMode getCuSplitPredictorMode() const { return m_cuSplitPredictorMode; }
+  const std::string& getCuSplitModelFileName() const { return m_cuSplitModelFileName; }
+  const std::string& getCuSplitTrainingDataFileName() const { return m_cuSplitTrainingDataFileName; }
+  Double    getCuSplitThreshold             () const { return m_cuSplitThreshold; }
   Bool      getUseFastDecisionForMerge      ()      { return m_useFastDecisionForMerge; }
   Bool      getUseCbfFastMode               ()      { return m_bUseCbfFastMode; }
   Bool      getUseEarlySkipDetection        ()      { return m_useEarlySkipDetection; }
   Bool      getUseConstrainedIntraPred      ()      { return m_bUseConstrainedIntraPred; }
   Bool      getFastUDIUseMPMEnabled         ()      { return m_bFastUDIUseMPMEnabled; }
+  Int       getIntraGradientModes           () const { return m_intraGradientModes; }
   Bool      getFastMEForGenBLowDelayEnabled ()      { return m_bFastMEForGenBLowDelayEnabled; }
   Bool      getUseBLambdaForNonKeyLowDelayPictures () { return m_bUseBLambdaForNonKeyLowDelayPictures; }
   Bool      getPCMInputBitDepthFlag         ()      { return m_bPCMInputBitDepthFlag;   }
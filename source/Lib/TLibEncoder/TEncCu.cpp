@@ -219,6 +219,30 @@ Void TEncCu::init( TEncTop* pcEncTop )
   m_pcRateCtrl         = pcEncTop->getRateCtrl();
   m_lumaQPOffset       = 0;
   initLumaDeltaQpLUT();
+
+  for (Int depth = 0; depth < MAX_CU_DEPTH; depth++)
+  {
+    m_adSplitParentCost[depth] = 0;
+  }
+  if ( m_pcEncCfg->getCuSplitPredictorMode() == CU_SPLIT_PREDICTOR_PREDICT && !m_cSplitPredictor.loadModel( m_pcEncCfg->getCuSplitModelFileName() ) )
+  {
+    printf( "Cannot read the CU split model file %s\n", m_pcEncCfg->getCuSplitModelFileName().c_str() );
+    exit( EXIT_FAILURE );
+  }
+  if ( m_pcEncCfg->getCuSplitPredictorMode() == CU_SPLIT_PREDICTOR_TRAIN && !m_cSplitPredictor.startTraining( m_pcEncCfg->getCuSplitTrainingDataFileName() ) )
+  {
+    printf( "Cannot write the CU split training data file %s\n", m_pcEncCfg->getCuSplitTrainingDataFileName().c_str() );
+    exit( EXIT_FAILURE );
+  }
+}
+
+Void TEncCu::finishSplitPredictorTraining()
+{
+  m_cSplitPredictor.finishTraining();
+  if ( !m_cSplitPredictor.writeModel( m_pcEncCfg->getCuSplitModelFileName() ) )
+  {
+    printf( "Cannot write the CU split model file %s\n", m_pcEncCfg->getCuSplitModelFileName().c_str() );
+  }
 }
 
 // ====================================================================================================================
@@ -233,6 +257,10 @@ Void TEncCu::compressCtu( TComDataCU* pCtu )
   // initialize CU data
   m_ppcBestCU[0]->initCtu( pCtu->getPic(), pCtu->getCtuRsAddr() );
   m_ppcTempCU[0]->initCtu( pCtu->getPic(), pCtu->getCtuRsAddr() );
+  if ( m_pcEncCfg->getMotionVectorCacheMode() != MV_CACHE_DISABLED )
+  {
+    m_pcPredSearch->resetMvCache();
+  }
 
   // analysis of CU
   DEBUG_STRING_NEW(sDebug)
@@ -512,7 +540,23 @@ Void TEncCu::xCompressCU( TComDataCU*& rpcBestCU, TComDataCU*& rpcTempCU, const
 
   const Bool bBoundary = !( uiRPelX < sps.getPicWidthInLumaSamples() && uiBPelY < sps.getPicHeightInLumaSamples() );
 
-  if ( !bBoundary )
+  // CU split predictor: skip the non-split search when the split model expects the CU to be split
+  const CuSplitPredictorMode cuSplitPredictorMode = m_pcEncCfg->getCuSplitPredictorMode();
+  const Bool bSplitAllowed = uiDepth < sps.getLog2DiffMaxMinCodingBlockSize() && (!getFastDeltaQp() || uiWidth > fastDeltaQPCuMaxSize);
+  const Bool bSplitPredictorActive = cuSplitPredictorMode != CU_SPLIT_PREDICTOR_DISABLED && !bBoundary && bSplitAllowed;
+  Double adSplitFeatures[TEncCuSplitPredictor::NUM_FEATURES];
+  Bool bSkipNonSplit = false;
+  Bool bSkipSplit    = false;
+  if ( bSplitPredictorActive )
+  {
+    m_cSplitPredictor.getFeatures( rpcTempCU, m_ppcOrigYuv[uiDepth], uiDepth, iBaseQP, m_adSplitParentCost[uiDepth], adSplitFeatures );
+    if ( cuSplitPredictorMode == CU_SPLIT_PREDICTOR_PREDICT && m_cSplitPredictor.hasModel( TEncCuSplitPredictor::SPLIT_MODEL, uiDepth ) )
+    {
+      bSkipNonSplit = m_cSplitPredictor.getSplitProbability( TEncCuSplitPredictor::SPLIT_MODEL, uiDepth, adSplitFeatures ) >= m_pcEncCfg->getCuSplitThreshold();
+    }
+  }
+
+  if ( !bBoundary && !bSkipNonSplit )
   {
     for (Int iQP=iMinQP; iQP<=iMaxQP; iQP++)
     {
@@ -827,12 +871,30 @@ Void TEncCu::xCompressCU( TComDataCU*& rpcBestCU, TComDataCU*& rpcTempCU, const
     iMaxQP = iMinQP; // If all TUs are forced into using transquant bypass, do not loop here.
   }
 
-  const Bool bSubBranch = bBoundary || !( m_pcEncCfg->getUseEarlyCU() && rpcBestCU->getTotalCost()!=MAX_DOUBLE && rpcBestCU->isSkipped(0) );
+  // normalised RD cost of the CU without splitting; the termination model skips the split search when it expects no split
+  const Double dNonSplitCost = rpcBestCU->getTotalCost()!=MAX_DOUBLE ? rpcBestCU->getTotalCost() / ( m_pcRdCost->getLambda() * uiWidth * rpcBestCU->getHeight(0) ) : 0;
+  if ( bSplitPredictorActive && rpcBestCU->getTotalCost()!=MAX_DOUBLE )
+  {
+    m_cSplitPredictor.setCostFeature( dNonSplitCost, adSplitFeatures );
+    if ( cuSplitPredictorMode == CU_SPLIT_PREDICTOR_PREDICT && m_cSplitPredictor.hasModel( TEncCuSplitPredictor::TERMINATION_MODEL, uiDepth ) )
+    {
+      bSkipSplit = m_cSplitPredictor.getSplitProbability( TEncCuSplitPredictor::TERMINATION_MODEL, uiDepth, adSplitFeatures ) <= 1.0 - m_pcEncCfg->getCuSplitThreshold();
+    }
+  }
+
+  const Bool bSubBranch = bBoundary || !( ( m_pcEncCfg->getUseEarlyCU() && rpcBestCU->getTotalCost()!=MAX_DOUBLE && rpcBestCU->isSkipped(0) )
+                                        || ( bSkipSplit && rpcBestCU->getTotalCost()!=MAX_DOUBLE ) );
 
   if( bSubBranch && uiDepth < sps.getLog2DiffMaxMinCodingBlockSize() && (!getFastDeltaQp() || uiWidth > fastDeltaQPCuMaxSize || bBoundary))
   {
     // further split
     Double splitTotalCost = 0;
+    const Bool bNonSplitSearched = rpcBestCU->getTotalCost()!=MAX_DOUBLE;
+
+    if ( cuSplitPredictorMode != CU_SPLIT_PREDICTOR_DISABLED )
+    {
+      m_adSplitParentCost[uiDepth+1] = bNonSplitSearched ? dNonSplitCost : m_adSplitParentCost[uiDepth];
+    }
 
     for (Int iQP=iMinQP; iQP<=iMaxQP; iQP++)
     {
@@ -974,6 +1036,11 @@ Void TEncCu::xCompressCU( TComDataCU*& rpcBestCU, TComDataCU*& rpcTempCU, const
       xCheckBestMode( rpcBestCU, rpcTempCU, uiDepth DEBUG_STRING_PASS_INTO(sDebug) DEBUG_STRING_PASS_INTO(sTempDebug) DEBUG_STRING_PASS_INTO(false) ); // RD compare current larger prediction
                                                                                                                                                        // with sub partitioned prediction.
     }
+
+    if ( cuSplitPredictorMode == CU_SPLIT_PREDICTOR_TRAIN && bSplitPredictorActive && bNonSplitSearched )
+    {
+      m_cSplitPredictor.addTrainingSample( uiDepth, adSplitFeatures, rpcBestCU->getDepth(0) > uiDepth );
+    }
   }
 
   DEBUG_STRING_APPEND(sDebug_, sDebug);
@@ -49,6 +49,7 @@
 #include "TEncEntropy.h"
 #include "TEncSearch.h"
 #include "TEncRateCtrl.h"
+#include "TEncCuSplitPredictor.h"
 //! \ingroup TLibEncoder
 //! \{
 
@@ -87,6 +88,9 @@ private:
   Int                     m_lumaQPOffset;
   TEncSlice*              m_pcSliceEncoder;
 
+  TEncCuSplitPredictor    m_cSplitPredictor;
+  Double                  m_adSplitParentCost[MAX_CU_DEPTH]; ///< RD cost of the parent CU per luma sample, divided by lambda, at each depth
+
   //  Access channel
   TEncCfg*                m_pcEncCfg;
   TEncSearch*             m_pcPredSearch;
@@ -124,6 +128,9 @@ public:
 
   Int   updateCtuDataISlice ( TComDataCU* pCtu, Int width, Int height );
 
+  /// fit the CU split predictor to the decisions collected in training mode and write the model file
+  Void  finishSplitPredictorTraining();
+
   Void setFastDeltaQp       ( Bool b)                 { m_bFastDeltaQP = b;         }
 
 protected:
@@ -0,0 +1,467 @@
+/* The copyright in this software is being made available under the BSD
+ * License, included below. This software may be subject to other third party
+ * and contributor rights, including patent rights, and no such rights are
+ * granted under this license.
+ *
+ * Copyright (c) 2010-2016, ITU/ISO/IEC
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  * Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *  * Neither the name of the ITU/ISO/IEC nor the names of its contributors may
+ *    be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** \file     TEncCuSplitPredictor.cpp
+    \brief    CU split decision predictor class
+*/
+
+#include <cmath>
+#include <fstream>
+#include <sstream>
+#include <algorithm>
+
+#include "TEncCuSplitPredictor.h"
+
+using namespace std;
+
+//! \ingroup TLibEncoder
+//! \{
+
+//! number of Newton iterations of the logistic regression
+static const Int    CU_SPLIT_MAX_TRAINING_ITERATIONS = 50;
+//! ridge regularisation of the non-constant weights, relative to the number of samples
+static const Double CU_SPLIT_REGULARISATION          = 1e-4;
+
+static const TChar* const s_modelNames[TEncCuSplitPredictor::NUMBER_OF_MODELS] = { "split", "termination" };
+
+// ====================================================================================================================
+// Constructor / destructor / create / destroy
+// ====================================================================================================================
+
+TEncCuSplitPredictor::TEncCuSplitPredictor()
+: m_pTrainingDataFile( NULL )
+{
+  for( Int model = 0; model < NUMBER_OF_MODELS; model++ )
+  {
+    for( Int depth = 0; depth < MAX_CU_DEPTH; depth++ )
+    {
+      m_bModelValid[model][depth] = false;
+      for( Int i = 0; i < NUM_FEATURES; i++ )
+      {
+        m_aadWeights[model][depth][i] = 0;
+      }
+    }
+  }
+}
+
+TEncCuSplitPredictor::~TEncCuSplitPredictor()
+{
+  if( m_pTrainingDataFile )
+  {
+    fclose( m_pTrainingDataFile );
+  }
+}
+
+// ====================================================================================================================
+// Public member functions
+// ====================================================================================================================
+
+/** Read a model file. Each non-empty line that does not start with '#' holds a model name ("split" or
+ *  "termination"), a CU depth and the NUM_FEATURES weights of that model and depth. The split model ignores the
+ *  last weight. Depths without a line are never predicted.
+ */
+Bool TEncCuSplitPredictor::loadModel( const string &fileName )
+{
+  ifstream file( fileName.c_str() );
+  if( !file.good() )
+  {
+    return false;
+  }
+
+  string line;
+  while( getline( file, line ) )
+  {
+    const size_t first = line.find_first_not_of( " \t\r" );
+    if( first == string::npos || line[first] == '#' )
+    {
+      continue;
+    }
+
+    istringstream fields( line );
+    string name;
+    Int    depth;
+    Double weights[NUM_FEATURES];
+    fields >> name >> depth;
+    for( Int i = 0; i < NUM_FEATURES; i++ )
+    {
+      fields >> weights[i];
+    }
+    Int model = 0;
+    while( model < NUMBER_OF_MODELS && name != s_modelNames[model] )
+    {
+      model++;
+    }
+    if( fields.fail() || model == NUMBER_OF_MODELS || depth < 0 || depth >= MAX_CU_DEPTH )
+    {
+      return false;
+    }
+    for( Int i = 0; i < NUM_FEATURES; i++ )
+    {
+      m_aadWeights[model][depth][i] = weights[i];
+    }
+    if( model == SPLIT_MODEL )
+    {
+      m_aadWeights[model][depth][COST_FEATURE] = 0;
+    }
+    m_bModelValid[model][depth] = true;
+  }
+  return true;
+}
+
+Bool TEncCuSplitPredictor::writeModel( const string &fileName ) const
+{
+  FILE* file = fopen( fileName.c_str(), "w" );
+  if( file == NULL )
+  {
+    return false;
+  }
+  fprintf( file, "# CU split predictor: model, depth, then the weights of 1, log2(1+variance), log2(1+gradient),\n" );
+  fprintf( file, "# log2(1+parent cost), left depth, above depth, QP and log2(1+cost) (termination model only)\n" );
+  for( Int model = 0; model < NUMBER_OF_MODELS; model++ )
+  {
+    for( Int depth = 0; depth < MAX_CU_DEPTH; depth++ )
+    {
+      if( m_bModelValid[model][depth] )
+      {
+        fprintf( file, "%s %d", s_modelNames[model], depth );
+        for( Int i = 0; i < NUM_FEATURES; i++ )
+        {
+          fprintf( file, " %.9g", m_aadWeights[model][depth][i] );
+        }
+        fprintf( file, "\n" );
+      }
+    }
+  }
+  fclose( file );
+  return true;
+}
+
+/** Compute the features of a CU that are available before it is searched. The cost feature is set to 0.
+ * \param pcCU        CU, initialised at its depth
+ * \param pcOrgYuv    source samples of the CU
+ * \param uiDepth     CU depth
+ * \param iQP         QP of the CU
+ * \param dParentCost RD cost of the parent CU divided by lambda and by the number of luma samples, or 0 for a CTU
+ * \param adFeatures  output features
+ */
+Void TEncCuSplitPredictor::getFeatures( const TComDataCU* pcCU, const TComYuv* pcOrgYuv, const UInt uiDepth, const Int iQP,
+                                        const Double dParentCost, Double adFeatures[NUM_FEATURES] ) const
+{
+  const Int   iWidth    = pcCU->getWidth( 0 );
+  const Int   iHeight   = pcCU->getHeight( 0 );
+  const Int   iStride   = pcOrgYuv->getStride( COMPONENT_Y );
+  const Pel*  piOrg     = pcOrgYuv->getAddr( COMPONENT_Y, 0 );
+  const Int   iShift    = pcCU->getSlice()->getSPS()->getBitDepth( CHANNEL_TYPE_LUMA ) - 8;
+  const Double dScale   = 1.0 / Double( 1 << std::max( iShift, 0 ) );
+
+  Int64 iSum       = 0;
+  Int64 iSumSq     = 0;
+  Int64 iGradient  = 0;
+  for( Int y = 0; y < iHeight; y++ )
+  {
+    const Pel* piRow = piOrg + y * iStride;
+    for( Int x = 0; x < iWidth; x++ )
+    {
+      iSum   += piRow[x];
+      iSumSq += piRow[x] * piRow[x];
+      if( x > 0 )
+      {
+        iGradient += abs( piRow[x] - piRow[x-1] );
+      }
+      if( y > 0 )
+      {
+        iGradient += abs( piRow[x] - piRow[x-iStride] );
+      }
+    }
+  }
+  const Double dNumSamples = Double( iWidth * iHeight );
+  const Double dMean       = Double( iSum ) / dNumSamples;
+  const Double dVariance   = std::max( 0.0, Double( iSumSq ) / dNumSamples - dMean * dMean ) * dScale * dScale;
+  const Double dGradient   = Double( iGradient ) / dNumSamples * dScale;
+
+  Int iLeftDepth  = Int( uiDepth );
+  Int iAboveDepth = Int( uiDepth );
+  UInt uiPartIdx;
+  const TComDataCU* pcLeft  = pcCU->getPULeft ( uiPartIdx, pcCU->getZorderIdxInCtu() );
+  if( pcLeft )
+  {
+    iLeftDepth = pcLeft->getDepth( uiPartIdx );
+  }
+  const TComDataCU* pcAbove = pcCU->getPUAbove( uiPartIdx, pcCU->getZorderIdxInCtu() );
+  if( pcAbove )
+  {
+    iAboveDepth = pcAbove->getDepth( uiPartIdx );
+  }
+
+  adFeatures[0] = 1.0;
+  adFeatures[1] = log( 1.0 + dVariance ) / log( 2.0 );
+  adFeatures[2] = log( 1.0 + dGradient ) / log( 2.0 );
+  adFeatures[3] = log( 1.0 + dParentCost ) / log( 2.0 );
+  adFeatures[4] = Double( iLeftDepth  - Int( uiDepth ) );
+  adFeatures[5] = Double( iAboveDepth - Int( uiDepth ) );
+  adFeatures[6] = Double( iQP );
+  adFeatures[COST_FEATURE] = 0;
+}
+
+/** Set the feature of the RD cost of the CU searched without splitting, divided by lambda and by the number of luma samples.
+ */
+Void TEncCuSplitPredictor::setCostFeature( const Double dCost, Double adFeatures[NUM_FEATURES] ) const
+{
+  adFeatures[COST_FEATURE] = log( 1.0 + dCost ) / log( 2.0 );
+}
+
+Double TEncCuSplitPredictor::getSplitProbability( const Model model, const UInt uiDepth, const Double adFeatures[NUM_FEATURES] ) const
+{
+  Double dScore = 0;
+  for( Int i = 0; i < NUM_FEATURES; i++ )
+  {
+    dScore += m_aadWeights[model][uiDepth][i] * adFeatures[i];
+  }
+  return 1.0 / ( 1.0 + exp( -dScore ) );
+}
+
+Bool TEncCuSplitPredictor::startTraining( const string &dataFileName )
+{
+  for( Int depth = 0; depth < MAX_CU_DEPTH; depth++ )
+  {
+    m_trainingSamples[depth].clear();
+  }
+  if( dataFileName.empty() )
+  {
+    return true;
+  }
+
+  // samples of earlier encodings are kept, so that a model can be trained on several sequences and QPs
+  Bool bNewFile = true;
+  {
+    ifstream file( dataFileName.c_str() );
+    string line;
+    while( getline( file, line ) )
+    {
+      bNewFile = false;
+      if( line.empty() || line[0] == '#' )
+      {
+        continue;
+      }
+      istringstream fields( line );
+      Int    depth;
+      Int    split;
+      Double features[NUM_FEATURES];
+      features[0] = 1.0;
+      fields >> depth >> split;
+      for( Int i = 1; i < NUM_FEATURES; i++ )
+      {
+        fields >> features[i];
+      }
+      if( fields.fail() || depth < 0 || depth >= MAX_CU_DEPTH )
+      {
+        return false;
+      }
+      m_trainingSamples[depth].insert( m_trainingSamples[depth].end(), features, features + NUM_FEATURES );
+      m_trainingSamples[depth].push_back( split != 0 ? 1.0 : 0.0 );
+    }
+  }
+
+  m_pTrainingDataFile = fopen( dataFileName.c_str(), "a" );
+  if( m_pTrainingDataFile == NULL )
+  {
+    return false;
+  }
+  if( bNewFile )
+  {
+    fprintf( m_pTrainingDataFile, "# depth split log2(1+variance) log2(1+gradient) log2(1+parent cost) left_depth above_depth QP log2(1+cost)\n" );
+  }
+  return true;
+}
+
+Void TEncCuSplitPredictor::addTrainingSample( const UInt uiDepth, const Double adFeatures[NUM_FEATURES], const Bool bSplit )
+{
+  assert( uiDepth < MAX_CU_DEPTH );
+  m_trainingSamples[uiDepth].insert( m_trainingSamples[uiDepth].end(), adFeatures, adFeatures + NUM_FEATURES );
+  m_trainingSamples[uiDepth].push_back( bSplit ? 1.0 : 0.0 );
+
+  if( m_pTrainingDataFile )
+  {
+    fprintf( m_pTrainingDataFile, "%d %d", uiDepth, bSplit ? 1 : 0 );
+    for( Int i = 1; i < NUM_FEATURES; i++ )
+    {
+      fprintf( m_pTrainingDataFile, " %.6g", adFeatures[i] );
+    }
+    fprintf( m_pTrainingDataFile, "\n" );
+  }
+}
+
+Void TEncCuSplitPredictor::finishTraining()
+{
+  if( m_pTrainingDataFile )
+  {
+    fclose( m_pTrainingDataFile );
+    m_pTrainingDataFile = NULL;
+  }
+  for( Int model = 0; model < NUMBER_OF_MODELS; model++ )
+  {
+    for( UInt depth = 0; depth < MAX_CU_DEPTH; depth++ )
+    {
+      xFitModel( Model( model ), depth );
+    }
+  }
+}
+
+// ====================================================================================================================
+// Private member functions
+// ====================================================================================================================
+
+/** Fit one logistic model of one depth to the training samples of that depth by Newton's method, with a small
+ *  ridge penalty on the non-constant weights. The split model does not use the cost feature. The model is left
+ *  invalid when the samples do not contain both decisions.
+ */
+Void TEncCuSplitPredictor::xFitModel( const Model model, const UInt uiDepth )
+{
+  const vector<Double> &samples = m_trainingSamples[uiDepth];
+  const Int stride      = NUM_FEATURES + 1;
+  const Int numSamples  = Int( samples.size() ) / stride;
+  const Int numFeatures = model == SPLIT_MODEL ? COST_FEATURE : NUM_FEATURES;
+
+  Int numSplit = 0;
+  for( Int n = 0; n < numSamples; n++ )
+  {
+    numSplit += samples[n * stride + NUM_FEATURES] > 0.5 ? 1 : 0;
+  }
+  m_bModelValid[model][uiDepth] = numSplit > 0 && numSplit < numSamples;
+  if( !m_bModelValid[model][uiDepth] )
+  {
+    return;
+  }
+
+  Double* weights = m_aadWeights[model][uiDepth];
+  for( Int i = 0; i < NUM_FEATURES; i++ )
+  {
+    weights[i] = 0;
+  }
+  const Double regularisation = CU_SPLIT_REGULARISATION * numSamples;
+
+  for( Int iter = 0; iter < CU_SPLIT_MAX_TRAINING_ITERATIONS; iter++ )
+  {
+    // Hessian and gradient of the penalised negative log-likelihood; the last column of the system holds the gradient
+    Double system[NUM_FEATURES][NUM_FEATURES + 1];
+    for( Int i = 0; i < numFeatures; i++ )
+    {
+      for( Int j = 0; j <= numFeatures; j++ )
+      {
+        system[i][j] = 0;
+      }
+      if( i > 0 )
+      {
+        system[i][i]           = regularisation;
+        system[i][numFeatures] = regularisation * weights[i];
+      }
+    }
+    for( Int n = 0; n < numSamples; n++ )
+    {
+      const Double* features   = &samples[n * stride];
+      const Double probability = getSplitProbability( model, uiDepth, features );
+      const Double residual    = probability - features[NUM_FEATURES];
+      const Double curvature   = std::max( probability * ( 1.0 - probability ), 1e-12 );
+      for( Int i = 0; i < numFeatures; i++ )
+      {
+        system[i][numFeatures] += residual * features[i];
+        for( Int j = 0; j <= i; j++ )
+        {
+          system[i][j] += curvature * features[i] * features[j];
+        }
+      }
+    }
+    for( Int i = 0; i < numFeatures; i++ )
+    {
+      for( Int j = i + 1; j < numFeatures; j++ )
+      {
+        system[i][j] = system[j][i];
+      }
+    }
+
+    // solve for the Newton step by Gauss-Jordan elimination with partial pivoting
+    for( Int col = 0; col < numFeatures; col++ )
+    {
+      Int pivot = col;
+      for( Int row = col + 1; row < numFeatures; row++ )
+      {
+        if( fabs( system[row][col] ) > fabs( system[pivot][col] ) )
+        {
+          pivot = row;
+        }
+      }
+      if( fabs( system[pivot][col] ) < 1e-12 )
+      {
+        continue;
+      }
+      for( Int j = 0; j <= numFeatures; j++ )
+      {
+        std::swap( system[col][j], system[pivot][j] );
+      }
+      for( Int row = 0; row < numFeatures; row++ )
+      {
+        if( row != col )
+        {
+          const Double factor = system[row][col] / system[col][col];
+          for( Int j = col; j <= numFeatures; j++ )
+          {
+            system[row][j] -= factor * system[col][j];
+          }
+        }
+      }
+    }
+
+    Double maxStep = 0;
+    for( Int i = 0; i < numFeatures; i++ )
+    {
+      const Double step = fabs( system[i][i] ) < 1e-12 ? 0 : system[i][numFeatures] / system[i][i];
+      weights[i] -= step;
+      maxStep = std::max( maxStep, fabs( step ) );
+    }
+    if( maxStep < 1e-6 )
+    {
+      break;
+    }
+  }
+
+  Int numCorrect = 0;
+  for( Int n = 0; n < numSamples; n++ )
+  {
+    const Double* features = &samples[n * stride];
+    numCorrect += ( getSplitProbability( model, uiDepth, features ) >= 0.5 ) == ( features[NUM_FEATURES] > 0.5 ) ? 1 : 0;
+  }
+  printf( "CU %s model, depth %d: %d samples, %.1f%% split, %.1f%% classified correctly\n",
+          s_modelNames[model], uiDepth, numSamples, 100.0 * numSplit / numSamples, 100.0 * numCorrect / numSamples );
+}
+
+//! \}
@@ -0,0 +1,105 @@
+/* The copyright in this software is being made available under the BSD
+ * License, included below. This software may be subject to other third party
+ * and contributor rights, including patent rights, and no such rights are
+ * granted under this license.
+ *
+ * Copyright (c) 2010-2016, ITU/ISO/IEC
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  * Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *  * Neither the name of the ITU/ISO/IEC nor the names of its contributors may
+ *    be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** \file     TEncCuSplitPredictor.h
+    \brief    CU split decision predictor class (header)
+*/
+
+#ifndef __TENCCUSPLITPREDICTOR__
+#define __TENCCUSPLITPREDICTOR__
+
+#include "TLibCommon/CommonDef.h"
+#include "TLibCommon/TComDataCU.h"
+#include "TLibCommon/TComYuv.h"
+#include <cstdio>
+#include <string>
+#include <vector>
+
+//! \ingroup TLibEncoder
+//! \{
+
+// ====================================================================================================================
+// Class definition
+// ====================================================================================================================
+
+/** Predictor of the split decision of a CU from features available before it is split.
+ *  The features are the luma variance and gradient energy of the source block, the RD cost of the parent CU,
+ *  the depths of the left and above CUs relative to the current depth, the QP and, once the CU has been searched
+ *  without splitting, its own RD cost. Each CU depth has two logistic models, whose output is the probability
+ *  that the RD search would choose to split the CU: the split model uses the features available before the CU
+ *  is searched and decides whether the non-split search can be skipped; the termination model adds the RD cost
+ *  of the CU and decides whether the split search can be skipped.
+ *  In training mode the features and the decisions of the full search are collected, optionally appended to a
+ *  text file that accumulates the samples of several encodings, and a model is fitted to them when training finishes.
+ */
+class TEncCuSplitPredictor
+{
+public:
+  static const Int NUM_FEATURES = 8;                          ///< number of features, including the constant term
+  static const Int COST_FEATURE = NUM_FEATURES - 1;           ///< index of the RD cost of the CU, used by the termination model only
+
+  enum Model
+  {
+    SPLIT_MODEL       = 0,                                    ///< predicts the split before the CU is searched
+    TERMINATION_MODEL = 1,                                    ///< predicts the split after the CU has been searched without splitting
+    NUMBER_OF_MODELS  = 2
+  };
+
+  TEncCuSplitPredictor();
+  virtual ~TEncCuSplitPredictor();
+
+  Bool   loadModel           ( const std::string &fileName );  ///< returns false if the file cannot be read or is malformed
+  Bool   writeModel          ( const std::string &fileName ) const;
+  Bool   hasModel            ( const Model model, const UInt uiDepth ) const { return uiDepth < MAX_CU_DEPTH && m_bModelValid[model][uiDepth]; }
+
+  Void   getFeatures         ( const TComDataCU* pcCU, const TComYuv* pcOrgYuv, const UInt uiDepth, const Int iQP,
+                               const Double dParentCost, Double adFeatures[NUM_FEATURES] ) const;
+  Void   setCostFeature      ( const Double dCost, Double adFeatures[NUM_FEATURES] ) const;
+  Double getSplitProbability ( const Model model, const UInt uiDepth, const Double adFeatures[NUM_FEATURES] ) const;
+
+  Bool   startTraining       ( const std::string &dataFileName ); ///< samples already in the file are included; an empty name keeps the samples in memory only
+  Void   addTrainingSample   ( const UInt uiDepth, const Double adFeatures[NUM_FEATURES], const Bool bSplit );
+  Void   finishTraining      ();                               ///< fit the models of all depths with samples of both decisions
+
+private:
+  Void   xFitModel           ( const Model model, const UInt uiDepth );
+
+  Double                m_aadWeights[NUMBER_OF_MODELS][MAX_CU_DEPTH][NUM_FEATURES];
+  Bool                  m_bModelValid[NUMBER_OF_MODELS][MAX_CU_DEPTH];
+  std::vector<Double>   m_trainingSamples[MAX_CU_DEPTH];    ///< features followed by the decision (0 or 1) of each sample
+  FILE*                 m_pTrainingDataFile;
+};
+
+//! \}
+
+#endif // __TENCCUSPLITPREDICTOR__
@@ -991,6 +991,36 @@ Int EfficientFieldIRAPMapping::restoreGOPid(const Int GOPid)
   return GOPid;
 }
 
+/** Check whether every reference picture of a slice belongs to another scene than the slice, i.e. whether the lookahead
+ *  pre-analysis marked a picture between each reference picture and the current one as a scene cut. Pictures that are no
+ *  longer in the picture list are taken not to be scene cuts.
+ */
+static Bool isSeparatedBySceneCut(const TComSlice *pSlice, TComList<TComPic*>& rcListPic)
+{
+  Int numRefPics = 0;
+  for (Int iRefList = 0; iRefList < NUM_REF_PIC_LIST_01; iRefList++)
+  {
+    for (Int iRefIdx = 0; iRefIdx < pSlice->getNumRefIdx(RefPicList(iRefList)); iRefIdx++)
+    {
+      const Int iRefPOC   = pSlice->getRefPic(RefPicList(iRefList), iRefIdx)->getPOC();
+      const Int iFirstPOC = std::min(pSlice->getPOC(), iRefPOC) + 1;
+      const Int iLastPOC  = std::max(pSlice->getPOC(), iRefPOC);
+      Bool bSceneCut = false;
+      for (TComList<TComPic*>::iterator iterPic = rcListPic.begin(); iterPic != rcListPic.end() && !bSceneCut; iterPic++)
+      {
+        const TEncPicLookahead *pcLookahead = dynamic_cast<TEncPic*>(*iterPic)->getLookahead();
+        const Int iPOC = (*iterPic)->getPOC();
+        bSceneCut = iPOC >= iFirstPOC && iPOC <= iLastPOC && pcLookahead->isValid() && pcLookahead->isSceneCut();
+      }
+      if (!bSceneCut)
+      {
+        return false;
+      }
+      numRefPics++;
+    }
+  }
+  return numRefPics > 0;
+}
 
 #if X0038_LAMBDA_FROM_QP_CAPABILITY
 static UInt calculateCollocatedFromL0Flag(const TComSlice *pSlice)
@@ -1263,6 +1293,18 @@ Void TEncGOP::compressGOP( Int iPOCLast, Int iNumPicRcvd, TComList<TComPic*>& rc
 
     pcSlice->applyReferencePictureSet(rcListPic, pcSlice->getRPS());
 
+    if ( m_pcCfg->getUseHashME() )
+    {
+      // release the hash tables of the pictures that can no longer be referenced
+      for (TComList<TComPic*>::iterator iterPic = rcListPic.begin(); iterPic != rcListPic.end(); iterPic++)
+      {
+        if ( !(*iterPic)->getSlice(0)->isReferenced() )
+        {
+          dynamic_cast<TEncPic*>( *iterPic )->invalidateBlockHashes();
+        }
+      }
+    }
+
     if(pcSlice->getTLayer() > 0 
       &&  !( pcSlice->getNalUnitType() == NAL_UNIT_CODED_SLICE_RADL_N     // Check if not a leading picture
           || pcSlice->getNalUnitType() == NAL_UNIT_CODED_SLICE_RADL_R
@@ -1341,6 +1383,12 @@ Void TEncGOP::compressGOP( Int iPOCLast, Int iNumPicRcvd, TComList<TComPic*>& rc
     {
       pcSlice->setSliceType ( P_SLICE );
     }
+    if ( m_pcCfg->getSceneCutIntra() && (pcSlice->getSliceType() != I_SLICE) && isSeparatedBySceneCut(pcSlice, rcListPic) )
+    {
+      // nothing can be predicted from another scene
+      pcSlice->setSliceType ( I_SLICE );
+      pcSlice->setRefPicList ( rcListPic );
+    }
     pcSlice->setEncCABACTableIdx(m_pcSliceEncoder->getEncCABACTableIdx());
 
     if (pcSlice->getSliceType() == B_SLICE)
@@ -1592,6 +1640,21 @@ Void TEncGOP::compressGOP( Int iPOCLast, Int iNumPicRcvd, TComList<TComPic*>& rc
     duData.clear();
     pcSlice = pcPic->getSlice(0);
 
+    // reserve storage for the substreams from the sizes of the slice segments estimated while compressing them,
+    // with a margin, to avoid reallocations while writing them
+    {
+      UInt64 sliceSegmentBits = 0;
+      for (UInt sliceSegmentIdx = 0; sliceSegmentIdx < uiNumSliceSegments; sliceSegmentIdx++)
+      {
+        sliceSegmentBits += pcPic->getSlice(sliceSegmentIdx)->getSliceSegmentBits();
+      }
+      const UInt64 estimatedBytesPerSubstream = (sliceSegmentBits >> 3) / numSubstreams;
+      for (UInt ui = 0; ui < numSubstreams; ui++)
+      {
+        substreamsOut[ui].reserve(UInt(estimatedBytesPerSubstream + (estimatedBytesPerSubstream >> 3)));
+      }
+    }
+
     // SAO parameter estimation using non-deblocked pixels for CTU bottom and right boundary areas
     if( pcSlice->getSPS()->getUseSAO() && m_pcCfg->getSaoCtuBoundary() )
     {
@@ -1754,6 +1817,12 @@ Void TEncGOP::compressGOP( Int iPOCLast, Int iNumPicRcvd, TComList<TComPic*>& rc
         TComOutputBitstream *pcOut = pcBitstreamRedirect;
         const Int numZeroSubstreamsAtStartOfSlice  = pcPic->getSubstreamForCtuAddr(pcSlice->getSliceSegmentCurStartCtuTsAddr(), false, pcSlice);
         const Int numSubstreamsToCode  = pcSlice->getNumberOfSubstreamSizes()+1;
+        UInt numBitsToCode = pcOut->getNumberOfWrittenBits();
+        for ( UInt ui = 0 ; ui < numSubstreamsToCode; ui++ )
+        {
+          numBitsToCode += substreamsOut[ui+numZeroSubstreamsAtStartOfSlice].getNumberOfWrittenBits();
+        }
+        pcOut->reserve((numBitsToCode + 7) >> 3);
         for ( UInt ui = 0 ; ui < numSubstreamsToCode; ui++ )
         {
           pcOut->addSubstream(&(substreamsOut[ui+numZeroSubstreamsAtStartOfSlice]));
@@ -1877,6 +1946,12 @@ Void TEncGOP::compressGOP( Int iPOCLast, Int iNumPicRcvd, TComList<TComPic*>& rc
     {
       iGOPid=effFieldIRAPMap.restoreGOPid(iGOPid);
     }
+
+    if ( m_pcCfg->getUseHashME() )
+    {
+      // index the source picture for the hash-based motion search of the pictures that reference it
+      dynamic_cast<TEncPic*>( pcPic )->updateBlockHashes();
+    }
 #if REDUCED_ENCODER_MEMORY
 
     pcPic->releaseReconstructionIntermediateData();
@@ -2465,6 +2540,7 @@ Void TEncGOP::xAttachSliceDataToNalUnit (OutputNALUnit& rNalu, TComOutputBitstre
   // Perform bitstream concatenation
   if (codedSliceData->getNumberOfWrittenBits() > 0)
   {
+    rNalu.m_Bitstream.reserve((rNalu.m_Bitstream.getNumberOfWrittenBits() + codedSliceData->getNumberOfWrittenBits() + 7) >> 3);
     rNalu.m_Bitstream.addSubstream(codedSliceData);
   }
 
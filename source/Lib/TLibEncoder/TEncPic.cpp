@@ -36,6 +36,7 @@
 */
 
 #include "TEncPic.h"
+#include <algorithm>
 
 //! \ingroup TLibEncoder
 //! \{
@@ -100,12 +101,64 @@ Void TEncPicQPAdaptationLayer::destroy()
   }
 }
 
+/** Constructor
+ */
+TEncPicLookahead::TEncPicLookahead()
+: m_bValid(false)
+, m_uiLog2Scale(0)
+, m_uiNumBlkInWidth(0)
+, m_uiNumBlkInHeight(0)
+, m_bSceneCut(false)
+{
+}
+
+/** Allocate the per-block storage; existing storage is reused when the geometry is unchanged
+ * \param iWidth Picture width
+ * \param iHeight Picture height
+ * \param uiLog2Scale log2 of the downsampling factor of the analysed luma plane
+ * \return Void
+ */
+Void TEncPicLookahead::create( Int iWidth, Int iHeight, UInt uiLog2Scale )
+{
+  const UInt uiBlkSize = LOOKAHEAD_BLOCK_SIZE << uiLog2Scale;
+  m_uiLog2Scale      = uiLog2Scale;
+  m_uiNumBlkInWidth  = (iWidth  + uiBlkSize-1) / uiBlkSize;
+  m_uiNumBlkInHeight = (iHeight + uiBlkSize-1) / uiBlkSize;
+  const size_t numBlk = m_uiNumBlkInWidth * m_uiNumBlkInHeight;
+  m_mv.resize( numBlk );
+  m_bValid = false;
+}
+
+/** Clean up
+ * \return Void
+ */
+Void TEncPicLookahead::destroy()
+{
+  std::vector<TComMv>().swap( m_mv );
+  m_uiNumBlkInWidth  = 0;
+  m_uiNumBlkInHeight = 0;
+  m_bValid = false;
+}
+
 /** Constructor
  */
 TEncPic::TEncPic()
 : m_acAQLayer(NULL)
 , m_uiMaxAQDepth(0)
+, m_bRecDownValid(false)
+, m_bBlockHashesValid(false)
 {
+  for (UInt i = 0; i < HIERARCHICAL_ME_NUM_LEVELS; i++)
+  {
+    m_apcPicYuvRecDown[i] = NULL;
+  }
+  for (UInt i = 0; i < 4; i++)
+  {
+    for (UInt j = 0; j < 4; j++)
+    {
+      m_apcPicYuvRecSubPel[i][j] = NULL;
+    }
+  }
 }
 
 /** Destructor
@@ -153,7 +206,348 @@ Void TEncPic::destroy()
     delete[] m_acAQLayer;
     m_acAQLayer = NULL;
   }
+  m_cLookahead.destroy();
+  for (UInt i = 0; i < HIERARCHICAL_ME_NUM_LEVELS; i++)
+  {
+    if (m_apcPicYuvRecDown[i])
+    {
+      m_apcPicYuvRecDown[i]->destroy();
+      delete m_apcPicYuvRecDown[i];
+      m_apcPicYuvRecDown[i] = NULL;
+    }
+  }
+  m_bRecDownValid = false;
+  for (UInt i = 0; i < 4; i++)
+  {
+    for (UInt j = 0; j < 4; j++)
+    {
+      if (m_apcPicYuvRecSubPel[i][j])
+      {
+        m_apcPicYuvRecSubPel[i][j]->destroy();
+        delete m_apcPicYuvRecSubPel[i][j];
+        m_apcPicYuvRecSubPel[i][j] = NULL;
+      }
+    }
+  }
+  std::vector<Bool>().swap( m_subPelBandValid );
+  std::vector<Pel>().swap( m_subPelTmp );
+  invalidateBlockHashes();
   TComPic::destroy();
 }
+
+/** Derive the downsampled luma planes of the reconstruction used by the hierarchical motion search.
+ *  Each level halves the previous one by averaging 2x2 blocks, and has its borders extended like the reconstruction.
+ *  The planes are derived once, when the picture is first used as a reference, and kept until invalidatePicYuvRecDown().
+ */
+Void TEncPic::updatePicYuvRecDown()
+{
+  if (m_bRecDownValid)
+  {
+    return;
+  }
+
+  const TComSPS &sps = getPicSym()->getSPS();
+  const TComPicYuv *pcSrc = getPicYuvRec();
+  for (UInt i = 0; i < HIERARCHICAL_ME_NUM_LEVELS; i++)
+  {
+    const Int iWidth  = pcSrc->getWidth (COMPONENT_Y) >> 1;
+    const Int iHeight = pcSrc->getHeight(COMPONENT_Y) >> 1;
+    if (m_apcPicYuvRecDown[i] == NULL)
+    {
+      m_apcPicYuvRecDown[i] = new TComPicYuv;
+      m_apcPicYuvRecDown[i]->createWithoutCUInfo( iWidth, iHeight, CHROMA_400, true, sps.getMaxCUWidth() >> (i+1), sps.getMaxCUHeight() >> (i+1) );
+    }
+    TComPicYuv *pcDst = m_apcPicYuvRecDown[i];
+    assert( pcDst->getWidth(COMPONENT_Y) == iWidth && pcDst->getHeight(COMPONENT_Y) == iHeight );
+
+    const Int  iSrcStride = pcSrc->getStride(COMPONENT_Y);
+    const Int  iDstStride = pcDst->getStride(COMPONENT_Y);
+    const Pel *pSrc       = pcSrc->getAddr(COMPONENT_Y);
+    Pel       *pDst       = pcDst->getAddr(COMPONENT_Y);
+    for (Int y = 0; y < iHeight; y++, pSrc += 2*iSrcStride, pDst += iDstStride)
+    {
+      for (Int x = 0; x < iWidth; x++)
+      {
+        pDst[x] = Pel( ( pSrc[2*x] + pSrc[2*x+1] + pSrc[2*x+iSrcStride] + pSrc[2*x+1+iSrcStride] + 2 ) >> 2 );
+      }
+    }
+    pcDst->setBorderExtension(false);
+    pcDst->extendPicBorder();
+    pcSrc = pcDst;
+  }
+  m_bRecDownValid = true;
+}
+
+/** Derive the interpolated planes of the reconstruction used by the fractional motion search, for the luma rows from
+ *  iTop to iBottom. The planes are derived in bands of CTU height, each band once, when a motion search first needs it,
+ *  and kept until invalidatePicYuvRecSubPel(). They cover the reconstruction and its margin except for the outermost
+ *  samples needed by the interpolation filter, and use the same layout as the reconstruction, so that a sample of a plane
+ *  is at the same offset from the origin as the integer sample it is interpolated from.
+ *  Each sample is derived by the same horizontal then vertical filtering as the interpolated blocks of the motion search.
+ * \param iTop    first luma row needed, relative to the picture origin
+ * \param iBottom last luma row needed, relative to the picture origin
+ */
+Void TEncPic::updatePicYuvRecSubPel( Int iTop, Int iBottom )
+{
+  const TComSPS    &sps     = getPicSym()->getSPS();
+  TComPicYuv       *pcRec   = getPicYuvRec();
+  const Int         iWidth  = pcRec->getWidth (COMPONENT_Y);
+  const Int         iHeight = pcRec->getHeight(COMPONENT_Y);
+  const Int         iStride = pcRec->getStride(COMPONENT_Y);
+  const Int         iBorder = NTAPS_LUMA >> 1;
+  const Int         iMinX   = iBorder - pcRec->getMarginX(COMPONENT_Y);
+  const Int         iMaxX   = iWidth  + pcRec->getMarginX(COMPONENT_Y) - iBorder;
+  const Int         iMinY   = iBorder - pcRec->getMarginY(COMPONENT_Y);
+  const Int         iMaxY   = iHeight + pcRec->getMarginY(COMPONENT_Y) - iBorder;
+  const Int         iBandHeight = sps.getMaxCUHeight();
+  const Int         iBitDepth   = sps.getBitDepth(CHANNEL_TYPE_LUMA);
+
+  if (m_subPelBandValid.empty())
+  {
+    m_subPelBandValid.resize( ( iMaxY - iMinY + iBandHeight - 1 ) / iBandHeight, false );
+    m_subPelTmp.resize( iStride * ( iBandHeight + NTAPS_LUMA - 1 ) );
+  }
+
+  const Int iFirstBand = ( std::max( iTop,    iMinY     ) - iMinY ) / iBandHeight;
+  const Int iLastBand  = ( std::min( iBottom, iMaxY - 1 ) - iMinY ) / iBandHeight;
+  for (Int iBand = iFirstBand; iBand <= iLastBand; iBand++)
+  {
+    if (m_subPelBandValid[iBand])
+    {
+      continue;
+    }
+    const Int iBandTop    = iMinY + iBand * iBandHeight;
+    const Int iBandRows   = std::min( iBandHeight, iMaxY - iBandTop );
+    Pel      *piTmp       = &m_subPelTmp[0];
+    Pel      *piSrc       = pcRec->getAddr(COMPONENT_Y) + ( iBandTop - ( iBorder - 1 ) ) * iStride + iMinX;
+    for (Int iHorFrac = 0; iHorFrac < 4; iHorFrac++)
+    {
+      m_cInterpolationFilter.filterHor( COMPONENT_Y, piSrc, iStride, piTmp, iStride, iMaxX - iMinX, iBandRows + NTAPS_LUMA - 1, iHorFrac, false, CHROMA_400, iBitDepth );
+      for (Int iVerFrac = 0; iVerFrac < 4; iVerFrac++)
+      {
+        if (( iHorFrac | iVerFrac ) == 0)
+        {
+          continue;
+        }
+        if (m_apcPicYuvRecSubPel[iVerFrac][iHorFrac] == NULL)
+        {
+          m_apcPicYuvRecSubPel[iVerFrac][iHorFrac] = new TComPicYuv;
+          m_apcPicYuvRecSubPel[iVerFrac][iHorFrac]->createWithoutCUInfo( iWidth, iHeight, CHROMA_400, true, sps.getMaxCUWidth(), sps.getMaxCUHeight() );
+        }
+        TComPicYuv *pcDst = m_apcPicYuvRecSubPel[iVerFrac][iHorFrac];
+        assert( pcDst->getStride(COMPONENT_Y) == iStride );
+        m_cInterpolationFilter.filterVer( COMPONENT_Y, piTmp + ( iBorder - 1 ) * iStride, iStride, pcDst->getAddr(COMPONENT_Y) + iBandTop * iStride + iMinX, iStride, iMaxX - iMinX, iBandRows, iVerFrac, false, true, CHROMA_400, iBitDepth );
+      }
+    }
+    m_subPelBandValid[iBand] = true;
+  }
+}
+
+Void TEncPic::invalidatePicYuvRecSubPel()
+{
+  m_subPelBandValid.assign( m_subPelBandValid.size(), false );
+}
+
+/** CRC-32 (IEEE 802.3 polynomial) of the four bytes of a word, continuing from a previous CRC
+ */
+static UInt xUpdateCrc32( UInt uiCrc, UInt uiData )
+{
+  static UInt s_auiCrcTable[256];
+  static Bool s_bCrcTableInitialized = false;
+  if (!s_bCrcTableInitialized)
+  {
+    for (UInt n = 0; n < 256; n++)
+    {
+      UInt c = n;
+      for (Int k = 0; k < 8; k++)
+      {
+        c = ( c & 1 ) ? 0xedb88320 ^ ( c >> 1 ) : c >> 1;
+      }
+      s_auiCrcTable[n] = c;
+    }
+    s_bCrcTableInitialized = true;
+  }
+  for (Int k = 0; k < 4; k++, uiData >>= 8)
+  {
+    uiCrc = s_auiCrcTable[( uiCrc ^ uiData ) & 0xff] ^ ( uiCrc >> 8 );
+  }
+  return uiCrc;
+}
+
+/** Hash of the samples of one row of a block of the smallest indexed size
+ */
+static UInt xGetRowHash( const Pel* piSrc )
+{
+  UInt uiHash = 0xffffffff;
+  for (Int x = 0; x < ( 1 << HASH_ME_MIN_LOG2_SIZE ); x += 2)
+  {
+    uiHash = xUpdateCrc32( uiHash, UInt( UShort( piSrc[x] ) ) | ( UInt( UShort( piSrc[x+1] ) ) << 16 ) );
+  }
+  return uiHash;
+}
+
+/** Hash of a block of the smallest indexed size, from the hashes of its rows
+ */
+static UInt xGetMinSizeHash( const UInt* puiRowHash, Int iStride )
+{
+  UInt uiHash = 0xffffffff;
+  for (Int y = 0; y < ( 1 << HASH_ME_MIN_LOG2_SIZE ); y++, puiRowHash += iStride)
+  {
+    uiHash = xUpdateCrc32( uiHash, *puiRowHash );
+  }
+  return uiHash;
+}
+
+/** Hash of a block, from the hashes of its four quadrants
+ */
+static UInt xGetQuadHash( UInt uiTopLeft, UInt uiTopRight, UInt uiBottomLeft, UInt uiBottomRight )
+{
+  UInt uiHash = 0xffffffff;
+  uiHash = xUpdateCrc32( uiHash, uiTopLeft );
+  uiHash = xUpdateCrc32( uiHash, uiTopRight );
+  uiHash = xUpdateCrc32( uiHash, uiBottomLeft );
+  uiHash = xUpdateCrc32( uiHash, uiBottomRight );
+  return uiHash;
+}
+
+/** Hash of a square block, as stored by updateBlockHashes()
+ * \param piSrc      top-left sample of the block
+ * \param iStride    stride of the samples
+ * \param uiLog2Size log2 of the block size, from HASH_ME_MIN_LOG2_SIZE to HASH_ME_MAX_LOG2_SIZE
+ */
+UInt TEncPic::getBlockHash( const Pel* piSrc, Int iStride, UInt uiLog2Size )
+{
+  if (uiLog2Size == HASH_ME_MIN_LOG2_SIZE)
+  {
+    UInt auiRowHash[1 << HASH_ME_MIN_LOG2_SIZE];
+    for (Int y = 0; y < ( 1 << HASH_ME_MIN_LOG2_SIZE ); y++)
+    {
+      auiRowHash[y] = xGetRowHash( piSrc + y * iStride );
+    }
+    return xGetMinSizeHash( auiRowHash, 1 );
+  }
+  const Int iHalf = 1 << ( uiLog2Size - 1 );
+  return xGetQuadHash( getBlockHash( piSrc,                          iStride, uiLog2Size - 1 ),
+                       getBlockHash( piSrc + iHalf,                  iStride, uiLog2Size - 1 ),
+                       getBlockHash( piSrc + iHalf * iStride,        iStride, uiLog2Size - 1 ),
+                       getBlockHash( piSrc + iHalf * iStride + iHalf, iStride, uiLog2Size - 1 ) );
+}
+
+/** Derive the hash tables of the source picture used by the hash-based motion search.
+ *  Every square block position of each indexed size is hashed, using the hashes of the next smaller size, except blocks
+ *  whose samples are all equal, which the regular motion search and intra prediction already handle well and which would
+ *  otherwise flood the tables with identical entries. Each table is sorted by hash, then by position.
+ *  The tables are derived once, when the picture has been coded and may become a reference, while its source samples are
+ *  still available, and released by invalidateBlockHashes() when the picture is no longer referenced.
+ */
+Void TEncPic::updateBlockHashes()
+{
+  if (m_bBlockHashesValid)
+  {
+    return;
+  }
+
+  const TComPicYuv *pcPicYuv = getPicYuvOrg();
+  const Int  iWidth  = pcPicYuv->getWidth (COMPONENT_Y);
+  const Int  iHeight = pcPicYuv->getHeight(COMPONENT_Y);
+  const Int  iStride = pcPicYuv->getStride(COMPONENT_Y);
+  const Pel *piSrc   = pcPicYuv->getAddr(COMPONENT_Y);
+
+  // length of the run of equal samples starting at each position, horizontally and then vertically over whole rows
+  std::vector<Int>  rowRun( iWidth * iHeight );
+  std::vector<Int>  blkRun( iWidth * iHeight );
+  std::vector<UInt> hashes( iWidth * iHeight );
+  std::vector<UInt> subHashes( iWidth * iHeight );
+  for (Int y = 0; y < iHeight; y++)
+  {
+    const Pel *piRow = piSrc + y * iStride;
+    rowRun[y * iWidth + iWidth - 1] = 1;
+    for (Int x = iWidth - 2; x >= 0; x--)
+    {
+      rowRun[y * iWidth + x] = piRow[x] == piRow[x+1] ? rowRun[y * iWidth + x + 1] + 1 : 1;
+    }
+  }
+
+  for (UInt uiLog2Size = HASH_ME_MIN_LOG2_SIZE; uiLog2Size <= HASH_ME_MAX_LOG2_SIZE; uiLog2Size++)
+  {
+    const Int iSize = 1 << uiLog2Size;
+    std::vector<TEncBlockHash> &blockHashes = m_blockHashes[uiLog2Size - HASH_ME_MIN_LOG2_SIZE];
+    blockHashes.clear();
+    if (iSize > iWidth || iSize > iHeight)
+    {
+      continue;
+    }
+    const Int iNumPosX = iWidth  - iSize + 1;
+    const Int iNumPosY = iHeight - iSize + 1;
+
+    if (uiLog2Size == HASH_ME_MIN_LOG2_SIZE)
+    {
+      for (Int y = 0; y < iHeight; y++)
+      {
+        for (Int x = 0; x < iNumPosX; x++)
+        {
+          subHashes[y * iWidth + x] = xGetRowHash( piSrc + y * iStride + x );
+        }
+      }
+      for (Int y = 0; y < iNumPosY; y++)
+      {
+        for (Int x = 0; x < iNumPosX; x++)
+        {
+          hashes[y * iWidth + x] = xGetMinSizeHash( &subHashes[y * iWidth + x], iWidth );
+        }
+      }
+    }
+    else
+    {
+      hashes.swap( subHashes );
+      const Int iHalf = iSize >> 1;
+      for (Int y = 0; y < iNumPosY; y++)
+      {
+        for (Int x = 0; x < iNumPosX; x++)
+        {
+          const UInt *puiSub = &subHashes[y * iWidth + x];
+          hashes[y * iWidth + x] = xGetQuadHash( puiSub[0], puiSub[iHalf], puiSub[iHalf * iWidth], puiSub[iHalf * iWidth + iHalf] );
+        }
+      }
+    }
+
+    for (Int y = iHeight - 1; y >= 0; y--)
+    {
+      const Pel *piRow = piSrc + y * iStride;
+      for (Int x = 0; x < iNumPosX; x++)
+      {
+        const Int iPos = y * iWidth + x;
+        const Bool bRowFlat = rowRun[iPos] >= iSize;
+        blkRun[iPos] = !bRowFlat ? 0 : ( y + 1 < iHeight && blkRun[iPos + iWidth] > 0 && piRow[x] == piRow[x + iStride] ) ? blkRun[iPos + iWidth] + 1 : 1;
+      }
+    }
+
+    blockHashes.reserve( iNumPosX * iNumPosY );
+    for (Int y = 0; y < iNumPosY; y++)
+    {
+      for (Int x = 0; x < iNumPosX; x++)
+      {
+        if (blkRun[y * iWidth + x] < iSize)
+        {
+          blockHashes.push_back( TEncBlockHash( hashes[y * iWidth + x], UInt( y * iWidth + x ) ) );
+        }
+      }
+    }
+    std::sort( blockHashes.begin(), blockHashes.end() );
+  }
+  m_bBlockHashesValid = true;
+}
+
+/** Release the hash tables, which take several bytes per luma sample, once the picture can no longer be referenced
+ *  or its buffer is reused.
+ */
+Void TEncPic::invalidateBlockHashes()
+{
+  for (UInt i = 0; i < HASH_ME_NUM_SIZES; i++)
+  {
+    std::vector<TEncBlockHash>().swap( m_blockHashes[i] );
+  }
+  m_bBlockHashesValid = false;
+}
 //! \}
 
@@ -40,6 +40,8 @@
 
 #include "TLibCommon/CommonDef.h"
 #include "TLibCommon/TComPic.h"
+#include "TLibCommon/TComInterpolationFilter.h"
+#include <vector>
 
 //! \ingroup TLibEncoder
 //! \{
@@ -91,12 +93,55 @@ public:
   Void                   setAvgActivity( Double d )  { m_dAvgActivity = d; }
 };
 
-/// Picture class including local image characteristics information for QP adaptation
+/// Low-resolution motion estimates and scene-cut decision of a source picture, produced by the lookahead pre-analysis
+class TEncPicLookahead
+{
+private:
+  Bool                    m_bValid;
+  UInt                    m_uiLog2Scale;          ///< log2 of the downsampling factor of the analysed luma plane
+  UInt                    m_uiNumBlkInWidth;
+  UInt                    m_uiNumBlkInHeight;
+  std::vector<TComMv>     m_mv;                   ///< per-block motion vector, in downsampled integer samples
+  Bool                    m_bSceneCut;            ///< whether the picture starts a new scene, relative to the previous picture in input order
+
+public:
+  TEncPicLookahead();
+
+  Void        create( Int iWidth, Int iHeight, UInt uiLog2Scale );
+  Void        destroy();
+
+  Bool        isValid()                                   const { return m_bValid;           }
+  Void        setValid( Bool b )                                { m_bValid = b;              }
+  UInt        getLog2Scale()                              const { return m_uiLog2Scale;      }
+  UInt        getBlkSize()                                const { return LOOKAHEAD_BLOCK_SIZE << m_uiLog2Scale; } ///< block size in full-resolution luma samples
+  UInt        getNumBlkInWidth()                          const { return m_uiNumBlkInWidth;  }
+  UInt        getNumBlkInHeight()                         const { return m_uiNumBlkInHeight; }
+  UInt        getBlkIdx( Int iPosX, Int iPosY )           const { return ( iPosY / getBlkSize() ) * m_uiNumBlkInWidth + iPosX / getBlkSize(); } ///< block covering a full-resolution luma position
+
+  const TComMv& getMv( UInt uiBlkIdx )                    const { return m_mv[uiBlkIdx];        }
+  Void        setMv( UInt uiBlkIdx, const TComMv& rcMv )        { m_mv[uiBlkIdx] = rcMv;     }
+
+  Bool        isSceneCut()                                const { return m_bSceneCut;        }
+  Void        setSceneCut( Bool b )                             { m_bSceneCut = b;           }
+};
+
+typedef std::pair<UInt, UInt> TEncBlockHash; ///< hash of a block of the source picture and raster position of its top-left luma sample
+
+/// Picture class including local image characteristics information for QP adaptation and the lookahead pre-analysis
 class TEncPic : public TComPic
 {
 private:
   TEncPicQPAdaptationLayer* m_acAQLayer;
   UInt                      m_uiMaxAQDepth;
+  TEncPicLookahead          m_cLookahead;
+  TComPicYuv*               m_apcPicYuvRecDown[HIERARCHICAL_ME_NUM_LEVELS]; ///< downsampled luma of the reconstruction, for the hierarchical motion search
+  Bool                      m_bRecDownValid;
+  TComPicYuv*               m_apcPicYuvRecSubPel[4][4]; ///< luma of the reconstruction interpolated at each quarter-sample fraction [vertical][horizontal], for the fractional motion search; [0][0] is unused
+  std::vector<Bool>         m_subPelBandValid;          ///< per band of CTU height, whether the interpolated planes are derived
+  std::vector<Pel>          m_subPelTmp;                ///< horizontally filtered samples of one band
+  TComInterpolationFilter   m_cInterpolationFilter;
+  std::vector<TEncBlockHash> m_blockHashes[HASH_ME_NUM_SIZES]; ///< hashes of all non-flat square blocks of the source picture, sorted, for the hash-based motion search
+  Bool                      m_bBlockHashesValid;
 
 public:
   TEncPic();
@@ -111,6 +156,22 @@ public:
 
   TEncPicQPAdaptationLayer* getAQLayer( UInt uiDepth )  { return &m_acAQLayer[uiDepth]; }
   UInt                      getMaxAQDepth()             { return m_uiMaxAQDepth;        }
+  TEncPicLookahead*         getLookahead()              { return &m_cLookahead;         }
+
+  Void                      updatePicYuvRecDown();
+  Void                      invalidatePicYuvRecDown()   { m_bRecDownValid = false;      }
+  TComPicYuv*               getPicYuvRecDown( UInt uiLevel ) { assert( m_bRecDownValid && uiLevel >= 1 && uiLevel <= HIERARCHICAL_ME_NUM_LEVELS ); return m_apcPicYuvRecDown[uiLevel-1]; } ///< level 1: half, 2: quarter resolution
+
+  Void                      updatePicYuvRecSubPel( Int iTop, Int iBottom );
+  Void                      invalidatePicYuvRecSubPel();
+  TComPicYuv*               getPicYuvRecSubPel( Int iVerFrac, Int iHorFrac ) { assert( ( iVerFrac | iHorFrac ) != 0 ); return m_apcPicYuvRecSubPel[iVerFrac][iHorFrac]; }
+
+  Void                      updateBlockHashes();
+  Void                      invalidateBlockHashes();
+  Bool                      hasBlockHashes()      const { return m_bBlockHashesValid;   }
+  const std::vector<TEncBlockHash>& getBlockHashes( UInt uiLog2Size ) const { assert( m_bBlockHashesValid && uiLog2Size >= HASH_ME_MIN_LOG2_SIZE && uiLog2Size <= HASH_ME_MAX_LOG2_SIZE ); return m_blockHashes[uiLog2Size-HASH_ME_MIN_LOG2_SIZE]; }
+
+  static UInt               getBlockHash( const Pel* piSrc, Int iStride, UInt uiLog2Size );
 };
 
 //! \}
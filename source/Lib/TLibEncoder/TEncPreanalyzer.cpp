@@ -36,7 +36,10 @@
 */
 
 #include <cfloat>
+#include <cstring>
+#include <cstdlib>
 #include <algorithm>
+#include <limits>
 
 #include "TEncPreanalyzer.h"
 
@@ -48,6 +51,11 @@ using namespace std;
 /** Constructor
  */
 TEncPreanalyzer::TEncPreanalyzer()
+: m_iLowResWidth(0)
+, m_iLowResHeight(0)
+, m_uiLog2Scale(0)
+, m_iCurrPlane(0)
+, m_iRefPOC(-1)
 {
 }
 
@@ -149,5 +157,293 @@ Void TEncPreanalyzer::xPreanalyze( TEncPic* pcEPic )
     pcAQLayer->setAvgActivity( dAvgAct );
   }
 }
-//! \}
 
+/** Downsample the luma plane of a source picture by box filtering.
+ *  The destination has the padded dimensions m_iLowResWidth x m_iLowResHeight; the padding replicates the last column and row.
+ * \param pcPicYuv    source picture
+ * \param uiLog2Scale log2 of the downsampling factor
+ * \param pDst        destination plane
+ * \return Void
+ */
+Void TEncPreanalyzer::xDownsample( const TComPicYuv* pcPicYuv, UInt uiLog2Scale, Pel* pDst )
+{
+  const Int  iStride = pcPicYuv->getStride(COMPONENT_Y);
+  const Int  iScale  = 1 << uiLog2Scale;
+  const Int  iShift  = 2 * uiLog2Scale;
+  const Int  iOffset = (1 << iShift) >> 1;
+  const Int  iWidth  = pcPicYuv->getWidth (COMPONENT_Y) >> uiLog2Scale;
+  const Int  iHeight = pcPicYuv->getHeight(COMPONENT_Y) >> uiLog2Scale;
+  const Pel* pSrc    = pcPicYuv->getAddr(COMPONENT_Y);
+
+  Pel* pLine = pDst;
+  for ( Int y = 0; y < iHeight; y++, pSrc += iScale * iStride, pLine += m_iLowResWidth )
+  {
+    for ( Int x = 0; x < iWidth; x++ )
+    {
+      const Pel* pBlk = pSrc + x * iScale;
+      Int iSum = 0;
+      for ( Int by = 0; by < iScale; by++, pBlk += iStride )
+      {
+        for ( Int bx = 0; bx < iScale; bx++ )
+        {
+          iSum += pBlk[bx];
+        }
+      }
+      pLine[x] = Pel( (iSum + iOffset) >> iShift );
+    }
+    for ( Int x = iWidth; x < m_iLowResWidth; x++ )
+    {
+      pLine[x] = pLine[iWidth-1];
+    }
+  }
+  for ( Int y = iHeight; y < m_iLowResHeight; y++, pLine += m_iLowResWidth )
+  {
+    ::memcpy( pLine, pLine - m_iLowResWidth, m_iLowResWidth * sizeof(Pel) );
+  }
+}
+
+/** Estimate the intra cost of a downsampled block as the lowest SATD of DC, horizontal and vertical prediction from the neighbouring source samples
+ * \param pCur     downsampled plane of the current picture
+ * \param iPosX    horizontal position of the block in the downsampled plane
+ * \param iPosY    vertical position of the block in the downsampled plane
+ * \param bitDepth luma bit depth
+ * \return SATD of the best prediction
+ */
+Distortion TEncPreanalyzer::xGetIntraCost( const Pel* pCur, Int iPosX, Int iPosY, Int bitDepth )
+{
+  const Int  iStride = m_iLowResWidth;
+  const Pel* pBlk    = pCur + iPosY * iStride + iPosX;
+  const Pel* pAbove  = iPosY > 0 ? pBlk - iStride : NULL;
+  const Pel* pLeft   = iPosX > 0 ? pBlk - 1       : NULL;
+  Pel        pred[LOOKAHEAD_BLOCK_SIZE * LOOKAHEAD_BLOCK_SIZE];
+
+  Int iDC      = 1 << (bitDepth - 1);
+  Int iNumNbrs = 0;
+  Int iSum     = 0;
+  for ( Int i = 0; i < LOOKAHEAD_BLOCK_SIZE; i++ )
+  {
+    if ( pAbove != NULL )
+    {
+      iSum += pAbove[i];
+      iNumNbrs++;
+    }
+    if ( pLeft != NULL )
+    {
+      iSum += pLeft[i * iStride];
+      iNumNbrs++;
+    }
+  }
+  if ( iNumNbrs > 0 )
+  {
+    iDC = (iSum + (iNumNbrs >> 1)) / iNumNbrs;
+  }
+  for ( Int i = 0; i < LOOKAHEAD_BLOCK_SIZE * LOOKAHEAD_BLOCK_SIZE; i++ )
+  {
+    pred[i] = Pel(iDC);
+  }
+  Distortion uiBestCost = m_cRdCost.getDistPart( bitDepth, pred, LOOKAHEAD_BLOCK_SIZE, pBlk, iStride, LOOKAHEAD_BLOCK_SIZE, LOOKAHEAD_BLOCK_SIZE, COMPONENT_Y, DF_HADS );
+
+  if ( pLeft != NULL )
+  {
+    for ( Int y = 0; y < LOOKAHEAD_BLOCK_SIZE; y++ )
+    {
+      for ( Int x = 0; x < LOOKAHEAD_BLOCK_SIZE; x++ )
+      {
+        pred[y * LOOKAHEAD_BLOCK_SIZE + x] = pLeft[y * iStride];
+      }
+    }
+    uiBestCost = std::min( uiBestCost, m_cRdCost.getDistPart( bitDepth, pred, LOOKAHEAD_BLOCK_SIZE, pBlk, iStride, LOOKAHEAD_BLOCK_SIZE, LOOKAHEAD_BLOCK_SIZE, COMPONENT_Y, DF_HADS ) );
+  }
+  if ( pAbove != NULL )
+  {
+    for ( Int y = 0; y < LOOKAHEAD_BLOCK_SIZE; y++ )
+    {
+      ::memcpy( pred + y * LOOKAHEAD_BLOCK_SIZE, pAbove, LOOKAHEAD_BLOCK_SIZE * sizeof(Pel) );
+    }
+    uiBestCost = std::min( uiBestCost, m_cRdCost.getDistPart( bitDepth, pred, LOOKAHEAD_BLOCK_SIZE, pBlk, iStride, LOOKAHEAD_BLOCK_SIZE, LOOKAHEAD_BLOCK_SIZE, COMPONENT_Y, DF_HADS ) );
+  }
+  return uiBestCost;
+}
+
+/** SATD of a downsampled block against its motion-compensated match in the previously analysed picture
+ * \param pCur     downsampled plane of the current picture
+ * \param pRef     downsampled plane of the reference picture
+ * \param iPosX    horizontal position of the block in the downsampled plane
+ * \param iPosY    vertical position of the block in the downsampled plane
+ * \param rcMv     motion vector, in downsampled integer samples; must keep the match inside the plane
+ * \param bitDepth luma bit depth
+ * \return SATD of the match
+ */
+Distortion TEncPreanalyzer::xGetInterCost( const Pel* pCur, const Pel* pRef, Int iPosX, Int iPosY, const TComMv& rcMv, Int bitDepth )
+{
+  const Int iStride = m_iLowResWidth;
+  return m_cRdCost.getDistPart( bitDepth, pRef + (iPosY + rcMv.getVer()) * iStride + iPosX + rcMv.getHor(), iStride,
+                                pCur + iPosY * iStride + iPosX, iStride, LOOKAHEAD_BLOCK_SIZE, LOOKAHEAD_BLOCK_SIZE, COMPONENT_Y, DF_HADS );
+}
+
+/** Evaluate one motion vector of the lookahead motion estimation and keep it if it has the lowest cost so far.
+ *  The cost is the SATD of the match plus LOOKAHEAD_MV_COST per downsampled sample of difference to the predictor.
+ * \param pCur        downsampled plane of the current picture
+ * \param pRef        downsampled plane of the reference picture
+ * \param iPosX       horizontal position of the block in the downsampled plane
+ * \param iPosY       vertical position of the block in the downsampled plane
+ * \param iMvX        horizontal motion vector component
+ * \param iMvY        vertical motion vector component
+ * \param rcMvPred    motion vector predictor
+ * \param bitDepth    luma bit depth
+ * \param ruiBestCost lowest cost so far
+ * \param ruiBestDist SATD of the best motion vector so far
+ * \param rcBestMv    best motion vector so far
+ * \return Void
+ */
+Void TEncPreanalyzer::xCheckInterCandidate( const Pel* pCur, const Pel* pRef, Int iPosX, Int iPosY, Int iMvX, Int iMvY, const TComMv& rcMvPred, Int bitDepth,
+                                            Distortion& ruiBestCost, Distortion& ruiBestDist, TComMv& rcBestMv )
+{
+  const TComMv     cMv( iMvX, iMvY );
+  const Distortion uiDist = xGetInterCost( pCur, pRef, iPosX, iPosY, cMv, bitDepth );
+  const Distortion uiCost = uiDist + LOOKAHEAD_MV_COST * ( abs( iMvX - rcMvPred.getHor() ) + abs( iMvY - rcMvPred.getVer() ) );
+  if ( uiCost < ruiBestCost )
+  {
+    ruiBestCost = uiCost;
+    ruiBestDist = uiDist;
+    rcBestMv    = cMv;
+  }
+}
+
+/** Lookahead pre-analysis of a source picture.
+ *  The luma plane is downsampled and, for each LOOKAHEAD_BLOCK_SIZE block of the downsampled plane, an intra cost and a
+ *  motion-compensated inter cost against the previously analysed picture are estimated. Source pictures are analysed as
+ *  they are received, so the whole GOP has been analysed before it is compressed. The per-block motion vectors, which
+ *  seed the analysis of the next picture, and the scene-cut decision used by SceneCutIntra are stored in the picture.
+ * \param pcEPic      picture to be analyzed; must be the picture following the previously analysed one in input order
+ * \param uiLog2Scale log2 of the downsampling factor (1: half, 2: quarter resolution)
+ * \return Void
+ */
+Void TEncPreanalyzer::xPreanalyzeLookahead( TEncPic* pcEPic, UInt uiLog2Scale )
+{
+  const TComPicYuv* pcPicYuv = pcEPic->getPicYuvOrg();
+  const Int         bitDepth = pcEPic->getPicSym()->getSPS().getBitDepth(CHANNEL_TYPE_LUMA);
+  const Int         iWidth   = pcPicYuv->getWidth (COMPONENT_Y) >> uiLog2Scale;
+  const Int         iHeight  = pcPicYuv->getHeight(COMPONENT_Y) >> uiLog2Scale;
+  const Int         iPadW    = (iWidth  + LOOKAHEAD_BLOCK_SIZE-1) / LOOKAHEAD_BLOCK_SIZE * LOOKAHEAD_BLOCK_SIZE;
+  const Int         iPadH    = (iHeight + LOOKAHEAD_BLOCK_SIZE-1) / LOOKAHEAD_BLOCK_SIZE * LOOKAHEAD_BLOCK_SIZE;
+
+  if ( iPadW != m_iLowResWidth || iPadH != m_iLowResHeight || uiLog2Scale != m_uiLog2Scale )
+  {
+    m_iLowResWidth  = iPadW;
+    m_iLowResHeight = iPadH;
+    m_uiLog2Scale   = uiLog2Scale;
+    m_lowResPlane[0].resize( iPadW * iPadH );
+    m_lowResPlane[1].resize( iPadW * iPadH );
+    m_iRefPOC = -1;
+  }
+
+  TEncPicLookahead* pcLookahead = pcEPic->getLookahead();
+  pcLookahead->create( pcPicYuv->getWidth(COMPONENT_Y), pcPicYuv->getHeight(COMPONENT_Y), uiLog2Scale );
+  assert( pcLookahead->getNumBlkInWidth()  * LOOKAHEAD_BLOCK_SIZE == iPadW );
+  assert( pcLookahead->getNumBlkInHeight() * LOOKAHEAD_BLOCK_SIZE == iPadH );
+
+  xDownsample( pcPicYuv, uiLog2Scale, &m_lowResPlane[m_iCurrPlane][0] );
+
+  const Pel*  pCur       = &m_lowResPlane[m_iCurrPlane][0];
+  const Pel*  pRef       = &m_lowResPlane[1-m_iCurrPlane][0];
+  const Bool  bHasRef    = m_iRefPOC >= 0;
+  const Int   iNumBlkW   = pcLookahead->getNumBlkInWidth();
+  const Int   iNumBlkH   = pcLookahead->getNumBlkInHeight();
+  const Int   iMaxX      = iPadW - LOOKAHEAD_BLOCK_SIZE;
+  const Int   iMaxY      = iPadH - LOOKAHEAD_BLOCK_SIZE;
+
+  if ( !bHasRef )
+  {
+    m_refMv.assign( iNumBlkW * iNumBlkH, TComMv() );
+  }
+
+  UInt64 uiIntraCostSum = 0;
+  UInt64 uiBestCostSum  = 0;
+  for ( Int by = 0; by < iNumBlkH; by++ )
+  {
+    for ( Int bx = 0; bx < iNumBlkW; bx++ )
+    {
+      const UInt uiBlkIdx  = by * iNumBlkW + bx;
+      const Int  iPosX     = bx * LOOKAHEAD_BLOCK_SIZE;
+      const Int  iPosY     = by * LOOKAHEAD_BLOCK_SIZE;
+      const Distortion uiIntraCost = xGetIntraCost( pCur, iPosX, iPosY, bitDepth );
+      Distortion uiInterCost = uiIntraCost;
+      TComMv     cBestMv;
+
+      if ( bHasRef )
+      {
+        // motion vectors are kept inside the padded plane and within the search range
+        const Int iMinMvX = std::max( -LOOKAHEAD_SEARCH_RANGE, -iPosX );
+        const Int iMaxMvX = std::min(  LOOKAHEAD_SEARCH_RANGE, iMaxX - iPosX );
+        const Int iMinMvY = std::max( -LOOKAHEAD_SEARCH_RANGE, -iPosY );
+        const Int iMaxMvY = std::min(  LOOKAHEAD_SEARCH_RANGE, iMaxY - iPosY );
+
+        const TComMv cMvPred = bx > 0 ? pcLookahead->getMv( uiBlkIdx-1 ) : ( by > 0 ? pcLookahead->getMv( uiBlkIdx-iNumBlkW ) : TComMv() );
+        Distortion uiBestCost = std::numeric_limits<Distortion>::max();
+
+        // spatial and temporal predictors
+        TComMv acCand[5];
+        Int    iNumCand = 0;
+        acCand[iNumCand++] = TComMv();
+        acCand[iNumCand++] = m_refMv[uiBlkIdx];
+        if ( bx > 0 )
+        {
+          acCand[iNumCand++] = pcLookahead->getMv( uiBlkIdx-1 );
+        }
+        if ( by > 0 )
+        {
+          acCand[iNumCand++] = pcLookahead->getMv( uiBlkIdx-iNumBlkW );
+          if ( bx+1 < iNumBlkW )
+          {
+            acCand[iNumCand++] = pcLookahead->getMv( uiBlkIdx-iNumBlkW+1 );
+          }
+        }
+        for ( Int i = 0; i < iNumCand; i++ )
+        {
+          xCheckInterCandidate( pCur, pRef, iPosX, iPosY, Clip3( iMinMvX, iMaxMvX, Int(acCand[i].getHor()) ), Clip3( iMinMvY, iMaxMvY, Int(acCand[i].getVer()) ),
+                                cMvPred, bitDepth, uiBestCost, uiInterCost, cBestMv );
+        }
+
+        // small diamond refinement around the best candidate, followed by one square step
+        static const Int aiPattern[8][2] = { {0,-1}, {-1,0}, {1,0}, {0,1}, {-1,-1}, {1,-1}, {-1,1}, {1,1} };
+        for ( Int iStep = 0; iStep <= LOOKAHEAD_SEARCH_RANGE; iStep++ )
+        {
+          const Bool   bSquareStep = iStep == LOOKAHEAD_SEARCH_RANGE;
+          const TComMv cCentre     = cBestMv;
+          for ( Int i = bSquareStep ? 4 : 0; i < ( bSquareStep ? 8 : 4 ); i++ )
+          {
+            const Int iMvX = cCentre.getHor() + aiPattern[i][0];
+            const Int iMvY = cCentre.getVer() + aiPattern[i][1];
+            if ( iMvX >= iMinMvX && iMvX <= iMaxMvX && iMvY >= iMinMvY && iMvY <= iMaxMvY )
+            {
+              xCheckInterCandidate( pCur, pRef, iPosX, iPosY, iMvX, iMvY, cMvPred, bitDepth, uiBestCost, uiInterCost, cBestMv );
+            }
+          }
+          if ( !bSquareStep && cBestMv == cCentre )
+          {
+            iStep = LOOKAHEAD_SEARCH_RANGE - 1; // converged: continue with the square step
+          }
+        }
+      }
+
+      pcLookahead->setMv( uiBlkIdx, cBestMv );
+      uiIntraCostSum += uiIntraCost;
+      uiBestCostSum  += std::min( uiIntraCost, uiInterCost );
+    }
+  }
+
+  // fraction of the intra cost that inter prediction fails to remove; close to 1 at a scene cut
+  const Double dScore = ( bHasRef && uiIntraCostSum > 0 ) ? Double(uiBestCostSum) / Double(uiIntraCostSum) : 1.0;
+  pcLookahead->setSceneCut( bHasRef && dScore > LOOKAHEAD_SCENE_CUT_THRESHOLD );
+  pcLookahead->setValid( true );
+
+  // the current picture becomes the reference of the next one
+  for ( UInt i = 0; i < m_refMv.size(); i++ )
+  {
+    m_refMv[i] = pcLookahead->getMv( i );
+  }
+  m_iRefPOC    = pcEPic->getPOC();
+  m_iCurrPlane = 1 - m_iCurrPlane;
+}
+//! \}
@@ -39,6 +39,8 @@
 #define __TENCPREANALYZER__
 
 #include "TEncPic.h"
+#include "TLibCommon/TComRdCost.h"
+#include <vector>
 
 //! \ingroup TLibEncoder
 //! \{
@@ -55,6 +57,23 @@ public:
   virtual ~TEncPreanalyzer();
 
   Void xPreanalyze( TEncPic* pcPic );
+  Void xPreanalyzeLookahead( TEncPic* pcPic, UInt uiLog2Scale );
+
+private:
+  Void       xDownsample     ( const TComPicYuv* pcPicYuv, UInt uiLog2Scale, Pel* pDst );
+  Distortion xGetIntraCost   ( const Pel* pCur, Int iPosX, Int iPosY, Int bitDepth );
+  Distortion xGetInterCost   ( const Pel* pCur, const Pel* pRef, Int iPosX, Int iPosY, const TComMv& rcMv, Int bitDepth );
+  Void       xCheckInterCandidate( const Pel* pCur, const Pel* pRef, Int iPosX, Int iPosY, Int iMvX, Int iMvY, const TComMv& rcMvPred, Int bitDepth,
+                                   Distortion& ruiBestCost, Distortion& ruiBestDist, TComMv& rcBestMv );
+
+  TComRdCost            m_cRdCost;
+  std::vector<Pel>      m_lowResPlane[2];         ///< downsampled luma of the current and of the previously analysed picture
+  std::vector<TComMv>   m_refMv;                  ///< lookahead motion field of the previously analysed picture
+  Int                   m_iLowResWidth;           ///< width of the downsampled planes, padded to a multiple of LOOKAHEAD_BLOCK_SIZE
+  Int                   m_iLowResHeight;
+  UInt                  m_uiLog2Scale;
+  Int                   m_iCurrPlane;
+  Int                   m_iRefPOC;                ///< POC of the previously analysed picture; -1 when there is none
 };
 
 //! \}
@@ -36,11 +36,16 @@
  \brief       estimation part of sample adaptive offset class
  */
 #include "TEncSampleAdaptiveOffset.h"
+#include "TLibCommon/TComSimd.h"
 #include <string.h>
 #include <stdlib.h>
 #include <stdio.h>
 #include <math.h>
 
+#if VECTOR_CODING__SAMPLE_ADAPTIVE_OFFSET && (RExt__HIGH_BIT_DEPTH_SUPPORT==0)
+#include <emmintrin.h>
+#endif
+
 //! \ingroup TLibEncoder
 //! \{
 
@@ -246,8 +251,6 @@ Void TEncSampleAdaptiveOffset::SAOProcess(TComPic* pPic, Bool* sliceEnabled, con
   memcpy(m_lambda, lambdas, sizeof(m_lambda));
   TComPicYuv* srcYuv = m_tempPicYuv;
   resYuv->copyToPic(srcYuv);
-  srcYuv->setBorderExtension(false);
-  srcYuv->extendPicBorder();
 
   //collect statistics
   getStatistics(m_statData, orgYuv, srcYuv, pPic);
@@ -801,6 +804,9 @@ Void TEncSampleAdaptiveOffset::decideBlkParams(TComPic* pic, Bool* sliceEnabled,
 
   Double totalCost = 0; // Used if bTestSAODisableAtPictureLevel==true
 
+#if INCREMENTAL_BORDER_EXTENSION
+  const Bool bExtendBorder = !xIsPCMRestorationRequired(pic);
+#endif
   for(Int ctuRsAddr=0; ctuRsAddr< m_numCTUsPic; ctuRsAddr++)
   {
     if(allBlksDisabled)
@@ -860,6 +866,12 @@ Void TEncSampleAdaptiveOffset::decideBlkParams(TComPic* pic, Bool* sliceEnabled,
     reconParams[ctuRsAddr] = codedParams[ctuRsAddr];
     reconstructBlkSAOParam(reconParams[ctuRsAddr], mergeList);
     offsetCTU(ctuRsAddr, srcYuv, resYuv, reconParams[ctuRsAddr], pic);
+#if INCREMENTAL_BORDER_EXTENSION
+    if (bExtendBorder)
+    {
+      xExtendCompletedCtuRowBorder(pic, ctuRsAddr);
+    }
+#endif
   } //ctuRsAddr
 
   if (!allBlksDisabled && (totalCost >= 0) && bTestSAODisableAtPictureLevel) //SAO has not beneficial in this case - disable it
@@ -908,37 +920,134 @@ Void TEncSampleAdaptiveOffset::decideBlkParams(TComPic* pic, Bool* sliceEnabled,
 }
 
 
-Void TEncSampleAdaptiveOffset::getBlkStats(const ComponentID compIdx, const Int channelBitDepth, SAOStatData* statsDataTypes
-                        , Pel* srcBlk, Pel* orgBlk, Int srcStride, Int orgStride, Int width, Int height
-                        , Bool isLeftAvail,  Bool isRightAvail, Bool isAboveAvail, Bool isBelowAvail, Bool isAboveLeftAvail, Bool isAboveRightAvail
-                        , Bool isCalculatePreDeblockSamples
-                        )
+#if VECTOR_CODING__SAMPLE_ADAPTIVE_OFFSET && (RExt__HIGH_BIT_DEPTH_SUPPORT==0)
+static inline Int simdHorizontalSum32( const __m128i &mmVal )
 {
-  if(m_lineBufWidth != m_maxCUWidth)
+  __m128i mmSum = _mm_add_epi32( mmVal , _mm_shuffle_epi32( mmVal , 0x4e ) );  // 01001110
+  mmSum = _mm_add_epi32( mmSum , _mm_shuffle_epi32( mmSum , 0xb1 ) );          // 10110001
+  return _mm_cvtsi128_si32( mmSum );
+}
+
+/** Accumulate edge offset statistics over rows [startY, endY) and samples [startX, endX) of a block.
+ *  The edge class of each sample is sgn(c - a) + sgn(c - b) for the neighbours at offsets neighbourA and
+ *  neighbourB. Each class keeps its own vector accumulators, which are reduced once at the end, so there is
+ *  no scatter into the diff/count arrays inside the loop. diff and count point at the entry of class 0.
+ */
+static Void simdSaoEdgeStatsRows( const Pel *srcBlk , const Pel *orgBlk , Int srcStride , Int orgStride , Int startY , Int endY , Int startX , Int endX
+                                , Int neighbourA , Int neighbourB , Int64 *diff , Int64 *count )
+{
+  const __m128i mmOne = _mm_set1_epi16( 1 );
+  __m128i mmClass[NUM_SAO_EO_CLASSES];
+  __m128i mmDiff [NUM_SAO_EO_CLASSES];
+  __m128i mmCount[NUM_SAO_EO_CLASSES];
+  for( Int k = 0 ; k < NUM_SAO_EO_CLASSES ; k++ )
   {
-    m_lineBufWidth = m_maxCUWidth;
+    mmClass[k] = _mm_set1_epi16( k - 2 );
+    mmDiff [k] = _mm_setzero_si128();
+    mmCount[k] = _mm_setzero_si128();
+  }
 
-    if (m_signLineBuf1)
+  for( Int y = startY ; y < endY ; y++ )
+  {
+    const Pel *srcLine = srcBlk + y * srcStride;
+    const Pel *orgLine = orgBlk + y * orgStride;
+    Int x = startX;
+    for( ; x + 8 <= endX ; x += 8 )
     {
-      delete[] m_signLineBuf1;
-      m_signLineBuf1 = NULL;
+      const __m128i mmCur  = _mm_loadu_si128( ( const __m128i * )( srcLine + x ) );
+      const __m128i mmA    = _mm_loadu_si128( ( const __m128i * )( srcLine + x + neighbourA ) );
+      const __m128i mmB    = _mm_loadu_si128( ( const __m128i * )( srcLine + x + neighbourB ) );
+      const __m128i mmOrg  = _mm_loadu_si128( ( const __m128i * )( orgLine + x ) );
+      const __m128i mmSgnA = _mm_sub_epi16( _mm_cmpgt_epi16( mmA , mmCur ) , _mm_cmpgt_epi16( mmCur , mmA ) );
+      const __m128i mmSgnB = _mm_sub_epi16( _mm_cmpgt_epi16( mmB , mmCur ) , _mm_cmpgt_epi16( mmCur , mmB ) );
+      const __m128i mmEdge = _mm_add_epi16( mmSgnA , mmSgnB );
+      const __m128i mmDelta = _mm_sub_epi16( mmOrg , mmCur );
+      for( Int k = 0 ; k < NUM_SAO_EO_CLASSES ; k++ )
+      {
+        const __m128i mmMask = _mm_cmpeq_epi16( mmEdge , mmClass[k] );
+        mmCount[k] = _mm_sub_epi16( mmCount[k] , mmMask );
+        mmDiff [k] = _mm_add_epi32( mmDiff[k] , _mm_madd_epi16( _mm_and_si128( mmMask , mmDelta ) , mmOne ) );
+      }
     }
-    m_signLineBuf1 = new SChar[m_lineBufWidth+1];
+    for( ; x < endX ; x++ )
+    {
+      const Int edgeType = sgn( srcLine[x] - srcLine[x + neighbourA] ) + sgn( srcLine[x] - srcLine[x + neighbourB] );
+      diff [edgeType] += ( orgLine[x] - srcLine[x] );
+      count[edgeType] ++;
+    }
+  }
 
-    if (m_signLineBuf2)
+  for( Int k = 0 ; k < NUM_SAO_EO_CLASSES ; k++ )
+  {
+    diff [k - 2] += simdHorizontalSum32( mmDiff[k] );
+    count[k - 2] += simdHorizontalSum32( _mm_madd_epi16( mmCount[k] , mmOne ) );
+  }
+}
+
+/** Accumulate band offset statistics over rows [startY, endY) and samples [startX, endX) of a block.
+ *  Band indices and differences are computed eight samples at a time; they are then accumulated into four
+ *  interleaved per-lane histograms, so that consecutive samples of the same band do not serialise on one
+ *  counter. The histograms are reduced into diff/count at the end.
+ */
+static Void simdSaoBandStatsRows( const Pel *srcBlk , const Pel *orgBlk , Int srcStride , Int orgStride , Int startY , Int endY , Int startX , Int endX
+                                , Int shiftBits , Int64 *diff , Int64 *count )
+{
+  static const Int numLanes = 4;
+  Int laneDiff [numLanes][NUM_SAO_BO_CLASSES];
+  Int laneCount[numLanes][NUM_SAO_BO_CLASSES];
+  ::memset( laneDiff  , 0 , sizeof( laneDiff  ) );
+  ::memset( laneCount , 0 , sizeof( laneCount ) );
+
+  Short bandBuf [8];
+  Short deltaBuf[8];
+  for( Int y = startY ; y < endY ; y++ )
+  {
+    const Pel *srcLine = srcBlk + y * srcStride;
+    const Pel *orgLine = orgBlk + y * orgStride;
+    Int x = startX;
+    for( ; x + 8 <= endX ; x += 8 )
     {
-      delete[] m_signLineBuf2;
-      m_signLineBuf2 = NULL;
+      const __m128i mmCur = _mm_loadu_si128( ( const __m128i * )( srcLine + x ) );
+      const __m128i mmOrg = _mm_loadu_si128( ( const __m128i * )( orgLine + x ) );
+      _mm_storeu_si128( ( __m128i * )bandBuf  , _mm_srai_epi16( mmCur , shiftBits ) );
+      _mm_storeu_si128( ( __m128i * )deltaBuf , _mm_sub_epi16( mmOrg , mmCur ) );
+      for( Int i = 0 ; i < 8 ; i++ )
+      {
+        laneDiff [i & ( numLanes - 1 )][bandBuf[i]] += deltaBuf[i];
+        laneCount[i & ( numLanes - 1 )][bandBuf[i]] ++;
+      }
+    }
+    for( ; x < endX ; x++ )
+    {
+      const Int bandIdx = srcLine[x] >> shiftBits;
+      laneDiff [0][bandIdx] += ( orgLine[x] - srcLine[x] );
+      laneCount[0][bandIdx] ++;
     }
-    m_signLineBuf2 = new SChar[m_lineBufWidth+1];
   }
 
+  for( Int bandIdx = 0 ; bandIdx < NUM_SAO_BO_CLASSES ; bandIdx++ )
+  {
+    for( Int lane = 0 ; lane < numLanes ; lane++ )
+    {
+      diff [bandIdx] += laneDiff [lane][bandIdx];
+      count[bandIdx] += laneCount[lane][bandIdx];
+    }
+  }
+}
+#endif
+
+/** Collect the SAO statistics of all types for one block. signLineBuf1 and signLineBuf2 hold at least width+1 signs each.
+ */
+static Void getBlkStatsScalar(const Int channelBitDepth, SAOStatData* statsDataTypes
+                             , Pel* srcBlk, Pel* orgBlk, Int srcStride, Int orgStride, Int width, Int height
+                             , Bool isLeftAvail,  Bool isRightAvail, Bool isAboveAvail, Bool isBelowAvail, Bool isAboveLeftAvail, Bool isAboveRightAvail
+                             , Bool isCalculatePreDeblockSamples, Int* skipLinesR, Int* skipLinesB
+                             , SChar* signLineBuf1, SChar* signLineBuf2)
+{
   Int x,y, startX, startY, endX, endY, edgeType, firstLineStartX, firstLineEndX;
   SChar signLeft, signRight, signDown;
   Int64 *diff, *count;
   Pel *srcLine, *orgLine;
-  Int* skipLinesR = m_skipLinesR[compIdx];
-  Int* skipLinesB = m_skipLinesB[compIdx];
 
   for(Int typeIdx=0; typeIdx< NUM_SAO_NEW_TYPES; typeIdx++)
   {
@@ -949,6 +1058,7 @@ Void TEncSampleAdaptiveOffset::getBlkStats(const ComponentID compIdx, const Int
     orgLine = orgBlk;
     diff    = statsData.diff;
     count   = statsData.count;
+
     switch(typeIdx)
     {
     case SAO_TYPE_EO_0:
@@ -1007,7 +1117,7 @@ Void TEncSampleAdaptiveOffset::getBlkStats(const ComponentID compIdx, const Int
       {
         diff +=2;
         count+=2;
-        SChar *signUpLine = m_signLineBuf1;
+        SChar *signUpLine = signLineBuf1;
 
         startX = (!isCalculatePreDeblockSamples) ? 0
                                                  : (isRightAvail ? (width - skipLinesR[typeIdx]) : width)
@@ -1078,8 +1188,8 @@ Void TEncSampleAdaptiveOffset::getBlkStats(const ComponentID compIdx, const Int
         count+=2;
         SChar *signUpLine, *signDownLine, *signTmpLine;
 
-        signUpLine  = m_signLineBuf1;
-        signDownLine= m_signLineBuf2;
+        signUpLine  = signLineBuf1;
+        signDownLine= signLineBuf2;
 
         startX = (!isCalculatePreDeblockSamples) ? (isLeftAvail  ? 0 : 1)
                                                  : (isRightAvail ? (width - skipLinesR[typeIdx]) : (width - 1))
@@ -1163,7 +1273,7 @@ Void TEncSampleAdaptiveOffset::getBlkStats(const ComponentID compIdx, const Int
       {
         diff +=2;
         count+=2;
-        SChar *signUpLine = m_signLineBuf1+1;
+        SChar *signUpLine = signLineBuf1+1;
 
         startX = (!isCalculatePreDeblockSamples) ? (isLeftAvail  ? 0 : 1)
                                                  : (isRightAvail ? (width - skipLinesR[typeIdx]) : (width - 1))
@@ -1299,5 +1409,178 @@ Void TEncSampleAdaptiveOffset::getBlkStats(const ComponentID compIdx, const Int
   }
 }
 
+#if VECTOR_CODING__SAMPLE_ADAPTIVE_OFFSET && (RExt__HIGH_BIT_DEPTH_SUPPORT==0)
+/** Collect the SAO statistics of all types for one block with the row kernels above. The sample ranges are those
+ *  of getBlkStatsScalar, expressed as row/column spans.
+ */
+static Void simdGetBlkStats(const Int channelBitDepth, SAOStatData* statsDataTypes
+                           , Pel* srcBlk, Pel* orgBlk, Int srcStride, Int orgStride, Int width, Int height
+                           , Bool isLeftAvail,  Bool isRightAvail, Bool isAboveAvail, Bool isBelowAvail, Bool isAboveLeftAvail, Bool isAboveRightAvail
+                           , Bool isCalculatePreDeblockSamples, Int* skipLinesR, Int* skipLinesB
+                           , SChar* signLineBuf1, SChar* signLineBuf2)
+{
+  Int startX, startY, endX, endY, firstLineStartX, firstLineEndX;
+  Int64 *diff, *count;
+
+  for(Int typeIdx=0; typeIdx< NUM_SAO_NEW_TYPES; typeIdx++)
+  {
+    SAOStatData& statsData= statsDataTypes[typeIdx];
+    statsData.reset();
+
+    diff    = statsData.diff;
+    count   = statsData.count;
+
+    // Same sample ranges as the scalar implementation below, expressed as row/column spans.
+    if (typeIdx == SAO_TYPE_BO)
+    {
+      startX = (!isCalculatePreDeblockSamples) ? 0
+                                               : (isRightAvail ? (width - skipLinesR[typeIdx]) : width)
+                                               ;
+      endX   = (!isCalculatePreDeblockSamples) ? (isRightAvail ? (width - skipLinesR[typeIdx]) : width)
+                                               : width
+                                               ;
+      endY   = isBelowAvail ? (height - skipLinesB[typeIdx]) : height;
+      const Int shiftBits = channelBitDepth - NUM_SAO_BO_CLASSES_LOG2;
+
+      simdSaoBandStatsRows(srcBlk, orgBlk, srcStride, orgStride, 0, endY, startX, endX, shiftBits, diff, count);
+      if (isCalculatePreDeblockSamples && isBelowAvail)
+      {
+        simdSaoBandStatsRows(srcBlk, orgBlk, srcStride, orgStride, endY, endY + skipLinesB[typeIdx], 0, width, shiftBits, diff, count);
+      }
+    }
+    else
+    {
+      diff +=2;
+      count+=2;
+
+      Int neighbourA, neighbourB;
+      startX = (!isCalculatePreDeblockSamples) ? (isLeftAvail  ? 0 : 1)
+                                               : (isRightAvail ? (width - skipLinesR[typeIdx]) : (width - 1))
+                                               ;
+      endX   = (!isCalculatePreDeblockSamples) ? (isRightAvail ? (width - skipLinesR[typeIdx]) : (width - 1))
+                                               : (isRightAvail ? width : (width - 1))
+                                               ;
+      endY   = isBelowAvail ? (height - skipLinesB[typeIdx]) : (height - 1);
+      startY = 1;
+      Int lastLinesStartX = isLeftAvail  ? 0 : 1;
+      Int lastLinesEndX   = isRightAvail ? width : (width - 1);
+      firstLineStartX = startX;
+      firstLineEndX   = endX;
+
+      switch(typeIdx)
+      {
+      case SAO_TYPE_EO_0:
+        neighbourA = -1;
+        neighbourB =  1;
+        endY       = isBelowAvail ? (height - skipLinesB[typeIdx]) : height;
+        break;
+      case SAO_TYPE_EO_90:
+        neighbourA = -srcStride;
+        neighbourB =  srcStride;
+        startX     = (!isCalculatePreDeblockSamples) ? 0
+                                                     : (isRightAvail ? (width - skipLinesR[typeIdx]) : width)
+                                                     ;
+        endX       = (!isCalculatePreDeblockSamples) ? (isRightAvail ? (width - skipLinesR[typeIdx]) : width)
+                                                     : width
+                                                     ;
+        firstLineStartX = startX;
+        firstLineEndX   = isAboveAvail ? endX : startX;
+        lastLinesStartX = 0;
+        lastLinesEndX   = width;
+        break;
+      case SAO_TYPE_EO_135:
+        neighbourA = -srcStride-1;
+        neighbourB =  srcStride+1;
+        if (!isCalculatePreDeblockSamples)
+        {
+          firstLineStartX = isAboveLeftAvail ? 0    : 1;
+          firstLineEndX   = isAboveAvail     ? endX : 1;
+        }
+        break;
+      default:
+        neighbourA = -srcStride+1;
+        neighbourB =  srcStride-1;
+        if (!isCalculatePreDeblockSamples)
+        {
+          firstLineStartX = isAboveAvail ? startX : endX;
+          firstLineEndX   = (!isRightAvail && isAboveRightAvail) ? width : endX;
+        }
+        break;
+      }
+
+      if (typeIdx == SAO_TYPE_EO_0)
+      {
+        simdSaoEdgeStatsRows(srcBlk, orgBlk, srcStride, orgStride, 0, endY, startX, endX, neighbourA, neighbourB, diff, count);
+      }
+      else
+      {
+        simdSaoEdgeStatsRows(srcBlk, orgBlk, srcStride, orgStride, 0, 1, firstLineStartX, firstLineEndX, neighbourA, neighbourB, diff, count);
+        simdSaoEdgeStatsRows(srcBlk, orgBlk, srcStride, orgStride, startY, endY, startX, endX, neighbourA, neighbourB, diff, count);
+      }
+      if (isCalculatePreDeblockSamples && isBelowAvail)
+      {
+        simdSaoEdgeStatsRows(srcBlk, orgBlk, srcStride, orgStride, endY, endY + skipLinesB[typeIdx], lastLinesStartX, lastLinesEndX, neighbourA, neighbourB, diff, count);
+      }
+    }
+  }
+}
+#endif
+
+/// SAO statistics kernels of the selected instruction set level (see TComSimd)
+struct SaoStatsKernels
+{
+  Void (*getBlkStats)(const Int channelBitDepth, SAOStatData* statsDataTypes
+                      , Pel* srcBlk, Pel* orgBlk, Int srcStride, Int orgStride, Int width, Int height
+                      , Bool isLeftAvail,  Bool isRightAvail, Bool isAboveAvail, Bool isBelowAvail, Bool isAboveLeftAvail, Bool isAboveRightAvail
+                      , Bool isCalculatePreDeblockSamples, Int* skipLinesR, Int* skipLinesB
+                      , SChar* signLineBuf1, SChar* signLineBuf2);
+};
+
+static SaoStatsKernels saoStatsKernels;
+
+static Void initSaoStatsKernels( const SIMDLevel level )
+{
+  saoStatsKernels.getBlkStats = getBlkStatsScalar;
+#if VECTOR_CODING__SAMPLE_ADAPTIVE_OFFSET && (RExt__HIGH_BIT_DEPTH_SUPPORT==0)
+  if( level >= SIMD_SSE2 )
+  {
+    saoStatsKernels.getBlkStats = simdGetBlkStats;
+  }
+#endif
+}
+
+static const Bool saoStatsKernelsRegistered = TComSimd::registerKernels( initSaoStatsKernels );
+
+Void TEncSampleAdaptiveOffset::getBlkStats(const ComponentID compIdx, const Int channelBitDepth, SAOStatData* statsDataTypes
+                        , Pel* srcBlk, Pel* orgBlk, Int srcStride, Int orgStride, Int width, Int height
+                        , Bool isLeftAvail,  Bool isRightAvail, Bool isAboveAvail, Bool isBelowAvail, Bool isAboveLeftAvail, Bool isAboveRightAvail
+                        , Bool isCalculatePreDeblockSamples
+                        )
+{
+  if(m_lineBufWidth != m_maxCUWidth)
+  {
+    m_lineBufWidth = m_maxCUWidth;
+
+    if (m_signLineBuf1)
+    {
+      delete[] m_signLineBuf1;
+      m_signLineBuf1 = NULL;
+    }
+    m_signLineBuf1 = new SChar[m_lineBufWidth+1];
+
+    if (m_signLineBuf2)
+    {
+      delete[] m_signLineBuf2;
+      m_signLineBuf2 = NULL;
+    }
+    m_signLineBuf2 = new SChar[m_lineBufWidth+1];
+  }
+
+  saoStatsKernels.getBlkStats(channelBitDepth, statsDataTypes, srcBlk, orgBlk, srcStride, orgStride, width, height
+                             , isLeftAvail, isRightAvail, isAboveAvail, isBelowAvail, isAboveLeftAvail, isAboveRightAvail
+                             , isCalculatePreDeblockSamples, m_skipLinesR[compIdx], m_skipLinesB[compIdx]
+                             , m_signLineBuf1, m_signLineBuf2);
+}
+
 
 //! \}
@@ -39,11 +39,17 @@
 #include "TLibCommon/TComRom.h"
 #include "TLibCommon/TComMotionInfo.h"
 #include "TEncSearch.h"
+#include "TEncPic.h"
 #include "TLibCommon/TComTU.h"
+#include "TLibCommon/TComSimd.h"
 #include "TLibCommon/Debug.h"
 #include <math.h>
 #include <limits>
 
+#if VECTOR_CODING__INTRA_GRADIENT_ANALYSIS && (RExt__HIGH_BIT_DEPTH_SUPPORT==0)
+#include <emmintrin.h>
+#endif
+
 
 //! \ingroup TLibEncoder
 //! \{
@@ -74,6 +80,10 @@ static const TComMv s_acMvRefineQ[9] =
   TComMv(  1,  1 )  // 8
 };
 
+//! FastRQTSatd, in tenths of the sub-TU Hadamard energy: up to the first ratio only the whole TU is tested, above the second only the sub-TUs
+static const UInt64 FAST_RQT_SATD_FULL_RATIO  = 10;
+static const UInt64 FAST_RQT_SATD_SPLIT_RATIO = 13;
+
 static Void offsetSubTUCBFs(TComTU &rTu, const ComponentID compID)
 {
         TComDataCU *pcCU              = rTu.getCU();
@@ -145,6 +155,14 @@ TEncSearch::TEncSearch()
   }
 
   setWpScalingDistParam( NULL, -1, REF_PIC_LIST_X );
+  resetMvCache();
+}
+
+
+//! empty the motion vector cache, at the start of each CTU
+Void TEncSearch::resetMvCache()
+{
+  memset( m_cacheArea, 0, sizeof( m_cacheArea ) );
 }
 
 
@@ -823,15 +841,16 @@ __inline Void TEncSearch::xTZ8PointDiamondSearch( const TComPattern*const  pcPat
 Distortion TEncSearch::xPatternRefinement( TComPattern* pcPatternKey,
                                            TComMv baseRefMv,
                                            Int iFrac, TComMv& rcMvFrac,
-                                           Bool bAllowUseOfHadamard
+                                           Bool bAllowUseOfHadamard,
+                                           const Pel* const apiSubPelRef[4][4], Int iSubPelStride
                                          )
 {
   Distortion  uiDist;
   Distortion  uiDistBest  = std::numeric_limits<Distortion>::max();
   UInt        uiDirecBest = 0;
 
-  Pel*  piRefPos;
-  Int iRefStride = m_filteredBlock[0][0].getStride(COMPONENT_Y);
+  const Pel*  piRefPos;
+  Int iRefStride = apiSubPelRef != NULL ? iSubPelStride : m_filteredBlock[0][0].getStride(COMPONENT_Y);
 
   m_pcRdCost->setDistParam( pcPatternKey, m_filteredBlock[0][0].getAddr(COMPONENT_Y), iRefStride, 1, m_cDistParam, m_pcEncCfg->getUseHADME() && bAllowUseOfHadamard );
 
@@ -844,14 +863,21 @@ Distortion TEncSearch::xPatternRefinement( TComPattern* pcPatternKey,
 
     Int horVal = cMvTest.getHor() * iFrac;
     Int verVal = cMvTest.getVer() * iFrac;
-    piRefPos = m_filteredBlock[ verVal & 3 ][ horVal & 3 ].getAddr(COMPONENT_Y);
-    if ( horVal == 2 && ( verVal & 1 ) == 0 )
+    if ( apiSubPelRef != NULL )
     {
-      piRefPos += 1;
+      piRefPos = apiSubPelRef[ verVal & 3 ][ horVal & 3 ] + ( verVal >> 2 ) * iRefStride + ( horVal >> 2 );
     }
-    if ( ( horVal & 1 ) == 0 && verVal == 2 )
+    else
     {
-      piRefPos += iRefStride;
+      piRefPos = m_filteredBlock[ verVal & 3 ][ horVal & 3 ].getAddr(COMPONENT_Y);
+      if ( horVal == 2 && ( verVal & 1 ) == 0 )
+      {
+        piRefPos += 1;
+      }
+      if ( ( horVal & 1 ) == 0 && verVal == 2 )
+      {
+        piRefPos += iRefStride;
+      }
     }
     cMvTest = pcMvRefine[i];
     cMvTest += rcMvFrac;
@@ -2252,18 +2278,28 @@ TEncSearch::estIntraPredLumaQT(TComDataCU* pcCU,
     {
       assert(numModesForFullRD < numModesAvailable);
 
-      for( Int i=0; i < numModesForFullRD; i++ )
-      {
-        CandCostList[ i ] = MAX_DOUBLE;
-      }
-      CandNum = 0;
-
       const TComRectangle &puRect=tuRecurseWithPU.getRect(COMPONENT_Y);
       const UInt uiAbsPartIdx=tuRecurseWithPU.GetAbsPartIdxTU();
 
       Pel* piOrg         = pcOrgYuv ->getAddr( COMPONENT_Y, uiAbsPartIdx );
       Pel* piPred        = pcPredYuv->getAddr( COMPONENT_Y, uiAbsPartIdx );
       UInt uiStride      = pcPredYuv->getStride( COMPONENT_Y );
+
+      // pre-select the modes tested by the rough search from the gradients of the source block
+      const Bool bGradientPreselection = m_pcEncCfg->getIntraGradientModes() > 0;
+      Bool abModeSelected[NUM_INTRA_MODE];
+      if (bGradientPreselection)
+      {
+        const Int numModesSelected = xSelectIntraModesByGradient( pcCU, uiPartOffset, piOrg, uiStride, puRect, sps.getBitDepth(CHANNEL_TYPE_LUMA), abModeSelected );
+        numModesForFullRD = std::min( numModesForFullRD, numModesSelected );
+      }
+
+      for( Int i=0; i < numModesForFullRD; i++ )
+      {
+        CandCostList[ i ] = MAX_DOUBLE;
+      }
+      CandNum = 0;
+
       DistParam distParam;
       const Bool bUseHadamard=pcCU->getCUTransquantBypass(0) == 0;
       m_pcRdCost->setDistParam(distParam, sps.getBitDepth(CHANNEL_TYPE_LUMA), piOrg, uiStride, piPred, uiStride, puRect.width, puRect.height, bUseHadamard);
@@ -2273,6 +2309,11 @@ TEncSearch::estIntraPredLumaQT(TComDataCU* pcCU,
         UInt       uiMode = modeIdx;
         Distortion uiSad  = 0;
 
+        if (bGradientPreselection && !abModeSelected[uiMode])
+        {
+          continue;
+        }
+
         const Bool bUseFilter=TComPrediction::filteringIntraReferenceSamples(COMPONENT_Y, uiMode, puRect.width, puRect.height, chFmt, sps.getSpsRangeExtension().getIntraSmoothingDisabledFlag());
 
         predIntraAng( COMPONENT_Y, uiMode, piOrg, uiStride, piPred, uiStride, tuRecurseWithPU, bUseFilter, TComPrediction::UseDPCMForFirstPassIntraEstimation(tuRecurseWithPU, uiMode) );
@@ -3720,8 +3761,18 @@ Void TEncSearch::xMotionEstimation( TComDataCU* pcCU, TComYuv* pcYuvOrg, Int iPa
   m_pcRdCost->setCostScale  ( 2 );
 
   setWpScalingDistParam( pcCU, iRefIdxPred, eRefPicList );
+  const Bool bHashMatch = m_pcEncCfg->getUseHashME() && !bBi && xHashSearch( pcCU, pcPatternKey, pcCU->getSlice()->getRefPic( eRefPicList, iRefIdxPred ), uiPartAddr, rcMv, ruiCost );
   //  Do integer search
-  if ( (m_motionEstimationSearchMethod==MESEARCH_FULL) || bBi )
+  if ( bHashMatch )
+  {
+    // a block the prediction unit is an exact copy of needs no integer search; the fractional search still runs from it, so
+    // that the cost is the same Hadamard distortion as for the other references
+    if (pcCU->getPartitionSize(0) == SIZE_2Nx2N)
+    {
+      m_integerMv2Nx2N[eRefPicList][iRefIdxPred] = rcMv;
+    }
+  }
+  else if ( (m_motionEstimationSearchMethod==MESEARCH_FULL) || bBi )
   {
     xPatternSearch      ( pcPatternKey, piRefY, iRefStride, &cMvSrchRngLT, &cMvSrchRngRB, rcMv, ruiCost );
   }
@@ -3733,18 +3784,57 @@ Void TEncSearch::xMotionEstimation( TComDataCU* pcCU, TComYuv* pcYuvOrg, Int iPa
     {
       pIntegerMv2Nx2NPred = &(m_integerMv2Nx2N[eRefPicList][iRefIdxPred]);
     }
-    xPatternSearchFast  ( pcCU, pcPatternKey, piRefY, iRefStride, &cMvSrchRngLT, &cMvSrchRngRB, rcMv, ruiCost, pIntegerMv2Nx2NPred );
+    const TComMv *pCachedMv=0;
+    TComMv     cachedMv;
+    Distortion uiCachedSad  = 0;
+    UInt       uiCachedArea = 0;
+    if ( m_pcEncCfg->getMotionVectorCacheMode() != MV_CACHE_DISABLED && xGetCachedMv( pcCU, uiPartAddr, iRoiWidth, iRoiHeight, eRefPicList, iRefIdxPred, cachedMv, uiCachedSad, uiCachedArea ) )
+    {
+      pCachedMv = &cachedMv;
+    }
+
+    // skip the search when the vector of a larger covering block fits the prediction unit at least as well as it fit that block
+    Bool bCachedMvFits = false;
+    if ( pCachedMv != 0 && m_pcEncCfg->getMotionVectorCacheMode() == MV_CACHE_SEED_AND_SKIP && uiCachedArea > UInt( iRoiWidth * iRoiHeight ) )
+    {
+      m_pcRdCost->setDistParam( pcPatternKey, piRefY + cachedMv.getVer() * iRefStride + cachedMv.getHor(), iRefStride, m_cDistParam );
+      setDistParamComp(COMPONENT_Y);
+      m_cDistParam.bitDepth = pcPatternKey->getBitDepthY();
+      const Distortion uiSad = m_cDistParam.DistFunc( &m_cDistParam );
+      if ( UInt64( uiSad ) * uiCachedArea <= UInt64( uiCachedSad ) * UInt( iRoiWidth * iRoiHeight ) )
+      {
+        rcMv          = cachedMv;
+        ruiCost       = uiSad;
+        bCachedMvFits = true;
+      }
+    }
+
+    if ( !bCachedMvFits )
+    {
+      const TComMv *pHierarchicalMv=0;
+      TComMv hierarchicalMv;
+      if ( m_pcEncCfg->getUseHierarchicalME() && xHierarchicalSearch( pcCU, pcPatternKey, pcCU->getSlice()->getRefPic( eRefPicList, iRefIdxPred ), uiPartAddr, *pcMvPred, hierarchicalMv ) )
+      {
+        pHierarchicalMv = &hierarchicalMv;
+      }
+      xPatternSearchFast  ( pcCU, pcPatternKey, piRefY, iRefStride, &cMvSrchRngLT, &cMvSrchRngRB, rcMv, ruiCost, pIntegerMv2Nx2NPred, pCachedMv, pHierarchicalMv );
+    }
     if (pcCU->getPartitionSize(0) == SIZE_2Nx2N)
     {
       m_integerMv2Nx2N[eRefPicList][iRefIdxPred] = rcMv;
     }
   }
 
+  if ( m_pcEncCfg->getMotionVectorCacheMode() != MV_CACHE_DISABLED && !bBi )
+  {
+    xSetCachedMv( pcCU, uiPartAddr, iRoiWidth, iRoiHeight, eRefPicList, iRefIdxPred, rcMv, ruiCost );
+  }
+
   m_pcRdCost->selectMotionLambda( true, 0, pcCU->getCUTransquantBypass(uiPartAddr) );
   m_pcRdCost->setCostScale ( 1 );
 
   const Bool bIsLosslessCoded = pcCU->getCUTransquantBypass(uiPartAddr) != 0;
-  xPatternSearchFracDIF( bIsLosslessCoded, pcPatternKey, piRefY, iRefStride, &rcMv, cMvHalf, cMvQter, ruiCost );
+  xPatternSearchFracDIF( bIsLosslessCoded, pcPatternKey, piRefY, iRefStride, pcCU->getSlice()->getRefPic( eRefPicList, iRefIdxPred ), &rcMv, cMvHalf, cMvQter, ruiCost );
 
   m_pcRdCost->setCostScale( 0 );
   rcMv <<= 2;
@@ -3758,6 +3848,277 @@ Void TEncSearch::xMotionEstimation( TComDataCU* pcCU, TComYuv* pcYuvOrg, Int iPa
 }
 
 
+/** Look up the motion vector cache for a prediction unit
+ * \param pcCU        CU containing the prediction unit
+ * \param uiPartAddr  address of the prediction unit within the CU
+ * \param iWidth      width of the prediction unit
+ * \param iHeight     height of the prediction unit
+ * \param eRefPicList reference list
+ * \param iRefIdx     reference index
+ * \param rcMv        cached integer vector of the last prediction unit covering the centre of this one, clipped for this one
+ * \param ruiSAD      SAD of that prediction unit at the cached vector
+ * \param ruiArea     luma area of that prediction unit
+ * \returns false if no prediction unit covering the centre has been searched in the current CTU
+ */
+Bool TEncSearch::xGetCachedMv( const TComDataCU* const pcCU,
+                               const UInt              uiPartAddr,
+                               const Int               iWidth,
+                               const Int               iHeight,
+                               const RefPicList        eRefPicList,
+                               const Int               iRefIdx,
+                               TComMv&                 rcMv,
+                               Distortion&             ruiSAD,
+                               UInt&                   ruiArea ) const
+{
+  const UInt uiUnitSize   = pcCU->getPic()->getMinCUWidth();
+  const UInt uiUnitStride = pcCU->getPic()->getNumPartInCtuWidth();
+  const UInt uiIdx        = g_auiZscanToRaster[ pcCU->getZorderIdxInCtu() + uiPartAddr ] + ( ( iHeight >> 1 ) / uiUnitSize ) * uiUnitStride + ( iWidth >> 1 ) / uiUnitSize;
+  ruiArea = m_cacheArea[eRefPicList][iRefIdx][uiIdx];
+  if ( ruiArea == 0 )
+  {
+    return false;
+  }
+  ruiSAD = m_cacheSad[eRefPicList][iRefIdx][uiIdx];
+  rcMv   = m_cacheMv [eRefPicList][iRefIdx][uiIdx];
+  rcMv <<= 2;
+  pcCU->clipMv( rcMv );
+#if ME_ENABLE_ROUNDING_OF_MVS
+  rcMv.divideByPowerOf2(2);
+#else
+  rcMv >>= 2;
+#endif
+  return true;
+}
+
+/** Store the integer motion search result of a prediction unit in the motion vector cache
+ * \param pcCU        CU containing the prediction unit
+ * \param uiPartAddr  address of the prediction unit within the CU
+ * \param iWidth      width of the prediction unit
+ * \param iHeight     height of the prediction unit
+ * \param eRefPicList reference list
+ * \param iRefIdx     reference index
+ * \param rcMv        integer vector
+ * \param uiSAD       SAD of the prediction unit at the vector
+ */
+Void TEncSearch::xSetCachedMv( const TComDataCU* const pcCU,
+                               const UInt              uiPartAddr,
+                               const Int               iWidth,
+                               const Int               iHeight,
+                               const RefPicList        eRefPicList,
+                               const Int               iRefIdx,
+                               const TComMv&           rcMv,
+                               const Distortion        uiSAD )
+{
+  const UInt uiUnitSize   = pcCU->getPic()->getMinCUWidth();
+  const UInt uiUnitStride = pcCU->getPic()->getNumPartInCtuWidth();
+  const UInt uiIdx        = g_auiZscanToRaster[ pcCU->getZorderIdxInCtu() + uiPartAddr ];
+  for ( UInt y = 0; y < iHeight / uiUnitSize; y++ )
+  {
+    for ( UInt x = 0; x < iWidth / uiUnitSize; x++ )
+    {
+      m_cacheMv  [eRefPicList][iRefIdx][uiIdx + y * uiUnitStride + x] = rcMv;
+      m_cacheSad [eRefPicList][iRefIdx][uiIdx + y * uiUnitStride + x] = uiSAD;
+      m_cacheArea[eRefPicList][iRefIdx][uiIdx + y * uiUnitStride + x] = iWidth * iHeight;
+    }
+  }
+}
+
+/** Hash-based motion search: look up the blocks of the source of the reference picture whose hash equals that of the
+ *  prediction unit, i.e. the blocks the prediction unit is an exact copy of, and select the one with the lowest SAD against
+ *  the reconstruction plus motion vector cost.
+ *  Only square prediction units with a size indexed by TEncPic::updateBlockHashes() are searched; units whose samples are
+ *  all equal are left to the regular search, as they are not indexed.
+ * \param pcCU         CU containing the prediction unit
+ * \param pcPatternKey original samples of the prediction unit
+ * \param pcRefPic     reference picture
+ * \param uiPartAddr   address of the prediction unit within the CU
+ * \param rcMv         result, in integer samples
+ * \param ruiSAD       SAD of the result; the motion vector cost predictor and scale must already be set
+ * \returns true if a match is found
+ */
+Bool TEncSearch::xHashSearch( const TComDataCU* const  pcCU,
+                              const TComPattern* const pcPatternKey,
+                              TComPic*                 pcRefPic,
+                              const UInt               uiPartAddr,
+                              TComMv&                  rcMv,
+                              Distortion&              ruiSAD )
+{
+  const Int  iSize      = pcPatternKey->getROIYWidth();
+  const UInt uiLog2Size = g_aucConvertToBit[ iSize ] + 2;
+  TEncPic*   pcRefEPic  = dynamic_cast<TEncPic*>( pcRefPic );
+  if ( iSize != pcPatternKey->getROIYHeight() || iSize < ( 1 << HASH_ME_MIN_LOG2_SIZE ) || iSize > ( 1 << HASH_ME_MAX_LOG2_SIZE ) || m_cDistParam.bApplyWeight || pcRefEPic == NULL || !pcRefEPic->hasBlockHashes() )
+  {
+    return false;
+  }
+
+  const Pel* piOrg      = pcPatternKey->getROIY();
+  const Int  iOrgStride = pcPatternKey->getPatternLStride();
+  Bool bFlat = true;
+  for ( Int y = 0; y < iSize && bFlat; y++ )
+  {
+    for ( Int x = 0; x < iSize; x++ )
+    {
+      if ( piOrg[y * iOrgStride + x] != piOrg[0] )
+      {
+        bFlat = false;
+        break;
+      }
+    }
+  }
+  if ( bFlat )
+  {
+    return false;
+  }
+
+  const std::vector<TEncBlockHash>& blockHashes = pcRefEPic->getBlockHashes( uiLog2Size );
+  const TEncBlockHash cKey( TEncPic::getBlockHash( piOrg, iOrgStride, uiLog2Size ), 0 );
+  std::vector<TEncBlockHash>::const_iterator it = std::lower_bound( blockHashes.begin(), blockHashes.end(), cKey );
+
+  const TComPicYuv* pcRefYuv  = pcRefEPic->getPicYuvRec();
+  const Int  iRefWidth  = pcRefYuv->getWidth (COMPONENT_Y);
+  const Int  iRefStride = pcRefYuv->getStride(COMPONENT_Y);
+  const Pel* piRef      = pcRefYuv->getAddr(COMPONENT_Y);
+  const Int  iPosX      = pcCU->getCUPelX() + g_auiRasterToPelX[ g_auiZscanToRaster[ pcCU->getZorderIdxInCtu() + uiPartAddr ] ] - g_auiRasterToPelX[ g_auiZscanToRaster[ pcCU->getZorderIdxInCtu() ] ];
+  const Int  iPosY      = pcCU->getCUPelY() + g_auiRasterToPelY[ g_auiZscanToRaster[ pcCU->getZorderIdxInCtu() + uiPartAddr ] ] - g_auiRasterToPelY[ g_auiZscanToRaster[ pcCU->getZorderIdxInCtu() ] ];
+
+  Bool       bFound     = false;
+  Distortion uiCostBest = std::numeric_limits<Distortion>::max();
+  for ( Int iNumChecked = 0; it != blockHashes.end() && it->first == cKey.first && iNumChecked < HASH_ME_MAX_CANDIDATES; it++, iNumChecked++ )
+  {
+    const Int iCandX = Int( it->second ) % iRefWidth;
+    const Int iCandY = Int( it->second ) / iRefWidth;
+    m_pcRdCost->setDistParam( pcPatternKey, piRef + iCandY * iRefStride + iCandX, iRefStride, m_cDistParam );
+    setDistParamComp(COMPONENT_Y);
+    m_cDistParam.bitDepth = pcPatternKey->getBitDepthY();
+    const Distortion uiSad  = m_cDistParam.DistFunc( &m_cDistParam );
+    const Distortion uiCost = uiSad + m_pcRdCost->getCostOfVectorWithPredictor( iCandX - iPosX, iCandY - iPosY );
+    if ( uiCost < uiCostBest )
+    {
+      rcMv.set( iCandX - iPosX, iCandY - iPosY );
+      ruiSAD     = uiSad;
+      uiCostBest = uiCost;
+      bFound     = true;
+    }
+  }
+  return bFound;
+}
+
+
+/** Coarse-to-fine motion search on the downsampled planes of the reference picture.
+ *  The coarsest level is searched exhaustively within +/-HIERARCHICAL_ME_SEARCH_RANGE of the scaled predictor, and the zero
+ *  vector is also tested; the best vector is then refined at each finer level by testing its eight neighbours.
+ *  The result is used as an additional start point of the integer search at full resolution.
+ * \param pcCU         CU containing the prediction unit
+ * \param pcPatternKey original samples of the prediction unit
+ * \param pcRefPic     reference picture
+ * \param uiPartAddr   address of the prediction unit within the CU
+ * \param rcMvPred     motion vector predictor, in quarter samples; the motion vector cost predictor must already be set
+ * \param rcMv         result, in integer samples
+ * \returns false if the prediction unit is too small or too narrow for the downsampled search, or the reference has no downsampled planes
+ */
+Bool TEncSearch::xHierarchicalSearch( const TComDataCU* const  pcCU,
+                                      const TComPattern* const pcPatternKey,
+                                      TComPic*                 pcRefPic,
+                                      const UInt               uiPartAddr,
+                                      const TComMv&            rcMvPred,
+                                      TComMv&                  rcMv )
+{
+  const Int iWidth  = pcPatternKey->getROIYWidth();
+  const Int iHeight = pcPatternKey->getROIYHeight();
+  TEncPic*  pcRefEPic = dynamic_cast<TEncPic*>( pcRefPic );
+  // the SAD functions need a block width that is a multiple of 4 at the coarsest level
+  if ( iWidth < HIERARCHICAL_ME_MIN_SIZE || iHeight < HIERARCHICAL_ME_MIN_SIZE || ( ( iWidth >> HIERARCHICAL_ME_NUM_LEVELS ) & 3 ) != 0 || pcRefEPic == NULL )
+  {
+    return false;
+  }
+  pcRefEPic->updatePicYuvRecDown();
+
+  const Int bitDepth = pcPatternKey->getBitDepthY();
+  const Int iPosX    = pcCU->getCUPelX() + g_auiRasterToPelX[ g_auiZscanToRaster[ pcCU->getZorderIdxInCtu() + uiPartAddr ] ] - g_auiRasterToPelX[ g_auiZscanToRaster[ pcCU->getZorderIdxInCtu() ] ];
+  const Int iPosY    = pcCU->getCUPelY() + g_auiRasterToPelY[ g_auiZscanToRaster[ pcCU->getZorderIdxInCtu() + uiPartAddr ] ] - g_auiRasterToPelY[ g_auiZscanToRaster[ pcCU->getZorderIdxInCtu() ] ];
+
+  // downsample the original block in the same way as the reference
+  const Pel* pSrc       = pcPatternKey->getROIY();
+  Int        iSrcStride = pcPatternKey->getPatternLStride();
+  for ( Int iLevel = 1; iLevel <= HIERARCHICAL_ME_NUM_LEVELS; iLevel++ )
+  {
+    const Int iLevelWidth  = iWidth  >> iLevel;
+    const Int iLevelHeight = iHeight >> iLevel;
+    Pel*      pDst         = m_hierarchicalOrg[iLevel-1];
+    for ( Int y = 0; y < iLevelHeight; y++, pSrc += 2*iSrcStride, pDst += iLevelWidth )
+    {
+      for ( Int x = 0; x < iLevelWidth; x++ )
+      {
+        pDst[x] = Pel( ( pSrc[2*x] + pSrc[2*x+1] + pSrc[2*x+iSrcStride] + pSrc[2*x+1+iSrcStride] + 2 ) >> 2 );
+      }
+    }
+    pSrc       = m_hierarchicalOrg[iLevel-1];
+    iSrcStride = iLevelWidth;
+  }
+
+  Int iBestX = 0;
+  Int iBestY = 0;
+  for ( Int iLevel = HIERARCHICAL_ME_NUM_LEVELS; iLevel >= 1; iLevel-- )
+  {
+    const TComPicYuv* pcRefYuv  = pcRefEPic->getPicYuvRecDown( iLevel );
+    const Int  iRefStride   = pcRefYuv->getStride( COMPONENT_Y );
+    const Int  iBlkX        = iPosX   >> iLevel;
+    const Int  iBlkY        = iPosY   >> iLevel;
+    const Int  iBlkWidth    = iWidth  >> iLevel;
+    const Int  iBlkHeight   = iHeight >> iLevel;
+    const Pel* piRef        = pcRefYuv->getAddr( COMPONENT_Y ) + iBlkY * iRefStride + iBlkX;
+
+    // keep the block inside the extended borders of the downsampled plane
+    const Int  iMinX        = -pcRefYuv->getMarginX( COMPONENT_Y ) - iBlkX;
+    const Int  iMaxX        =  pcRefYuv->getWidth  ( COMPONENT_Y ) + pcRefYuv->getMarginX( COMPONENT_Y ) - iBlkWidth  - iBlkX;
+    const Int  iMinY        = -pcRefYuv->getMarginY( COMPONENT_Y ) - iBlkY;
+    const Int  iMaxY        =  pcRefYuv->getHeight ( COMPONENT_Y ) + pcRefYuv->getMarginY( COMPONENT_Y ) - iBlkHeight - iBlkY;
+
+    DistParam cDistParam;
+    m_pcRdCost->setDistParam( cDistParam, bitDepth, m_hierarchicalOrg[iLevel-1], iBlkWidth, piRef, iRefStride, iBlkWidth, iBlkHeight );
+
+    Int iRange   = 1;
+    Int iCentreX = iBestX << 1;
+    Int iCentreY = iBestY << 1;
+    if ( iLevel == HIERARCHICAL_ME_NUM_LEVELS )
+    {
+      iRange   = HIERARCHICAL_ME_SEARCH_RANGE;
+      iCentreX = rcMvPred.getHor() >> ( 2 + iLevel );
+      iCentreY = rcMvPred.getVer() >> ( 2 + iLevel );
+    }
+
+    Distortion uiBestCost = std::numeric_limits<Distortion>::max();
+    for ( Int y = std::max( iMinY, iCentreY - iRange ); y <= std::min( iMaxY, iCentreY + iRange ); y++ )
+    {
+      for ( Int x = std::max( iMinX, iCentreX - iRange ); x <= std::min( iMaxX, iCentreX + iRange ); x++ )
+      {
+        cDistParam.pCur = piRef + y * iRefStride + x;
+        const Distortion uiCost = ( cDistParam.DistFunc( &cDistParam ) << ( 2 * iLevel ) ) + m_pcRdCost->getCostOfVectorWithPredictor( x << iLevel, y << iLevel );
+        if ( uiCost < uiBestCost )
+        {
+          uiBestCost = uiCost;
+          iBestX     = x;
+          iBestY     = y;
+        }
+      }
+    }
+    if ( iLevel == HIERARCHICAL_ME_NUM_LEVELS && ( abs( iCentreX ) > iRange || abs( iCentreY ) > iRange ) )
+    {
+      cDistParam.pCur = piRef;
+      const Distortion uiCost = ( cDistParam.DistFunc( &cDistParam ) << ( 2 * iLevel ) ) + m_pcRdCost->getCostOfVectorWithPredictor( 0, 0 );
+      if ( uiCost < uiBestCost )
+      {
+        iBestX = 0;
+        iBestY = 0;
+      }
+    }
+  }
+
+  rcMv.set( iBestX << 1, iBestY << 1 );
+  return true;
+}
+
+
 Void TEncSearch::xSetSearchRange ( const TComDataCU* const pcCU, const TComMv& cMvPred, const Int iSrchRng,
                                    TComMv& rcMvSrchRngLT, TComMv& rcMvSrchRngRB )
 {
@@ -3813,11 +4174,57 @@ Void TEncSearch::xPatternSearch( const TComPattern* const pcPatternKey,
     }
   }
 
+  // successive elimination: the difference between the sums of the original block and of a candidate block is a lower
+  // bound of their SAD, so a candidate whose bound plus motion vector cost exceeds the cost of a candidate already evaluated
+  // cannot be selected and is skipped. The search result is identical to the exhaustive search.
+  // The bound does not hold for weighted or row-subsampled SADs.
+  const Bool bSuccessiveElimination = !m_cDistParam.bApplyWeight && m_cDistParam.iSubShift == 0;
+  const Int  iBlkWidth    = m_cDistParam.iCols;
+  const Int  iBlkHeight   = m_cDistParam.iRows;
+  const Int  iSumsStride  = iSrchRngHorRight - iSrchRngHorLeft + iBlkWidth + 1;
+  const Int  iDistShift   = DISTORTION_PRECISION_ADJUSTMENT(pcPatternKey->getBitDepthY()-8);
+  Int        iOrgSum      = 0;
+  Distortion uiSadBound   = std::numeric_limits<Distortion>::max();
+  if ( bSuccessiveElimination )
+  {
+    xGetSearchWindowSums( piRefY + iSrchRngVerTop * iRefStride + iSrchRngHorLeft, iRefStride,
+                          iSrchRngHorRight - iSrchRngHorLeft + iBlkWidth, iSrchRngVerBottom - iSrchRngVerTop + iBlkHeight );
+    const Pel* piOrg = pcPatternKey->getROIY();
+    for ( Int y = 0; y < iBlkHeight; y++, piOrg += pcPatternKey->getPatternLStride() )
+    {
+      for ( Int x = 0; x < iBlkWidth; x++ )
+      {
+        iOrgSum += piOrg[x];
+      }
+    }
+
+    // start from the cost of the centre of the window, which is usually close to the predictor
+    const Int iCentreX = ( iSrchRngHorLeft + iSrchRngHorRight ) >> 1;
+    const Int iCentreY = ( iSrchRngVerTop + iSrchRngVerBottom ) >> 1;
+    m_cDistParam.pCur     = piRefY + iCentreY * iRefStride + iCentreX;
+    setDistParamComp(COMPONENT_Y);
+    m_cDistParam.bitDepth = pcPatternKey->getBitDepthY();
+    uiSadBound = m_cDistParam.DistFunc( &m_cDistParam ) + m_pcRdCost->getCostOfVectorWithPredictor( iCentreX, iCentreY );
+  }
+
   piRefY += (iSrchRngVerTop * iRefStride);
   for ( Int y = iSrchRngVerTop; y <= iSrchRngVerBottom; y++ )
   {
+    const UInt* puiSumsTop    = bSuccessiveElimination ? &m_searchWindowSums[ ( y - iSrchRngVerTop ) * iSumsStride ] : NULL;
+    const UInt* puiSumsBottom = bSuccessiveElimination ? puiSumsTop + iBlkHeight * iSumsStride : NULL;
     for ( Int x = iSrchRngHorLeft; x <= iSrchRngHorRight; x++ )
     {
+      if ( bSuccessiveElimination )
+      {
+        const Int  ix      = x - iSrchRngHorLeft;
+        const Int  iRefSum = Int( puiSumsBottom[ix + iBlkWidth] - puiSumsBottom[ix] - puiSumsTop[ix + iBlkWidth] + puiSumsTop[ix] );
+        const Distortion uiBound = Distortion( abs( iOrgSum - iRefSum ) >> iDistShift ) + m_pcRdCost->getCostOfVectorWithPredictor( x, y );
+        if ( uiBound > uiSadBound )
+        {
+          continue;
+        }
+      }
+
       //  find min. distortion position
       m_cDistParam.pCur = piRefY + x;
 
@@ -3835,6 +4242,7 @@ Void TEncSearch::xPatternSearch( const TComPattern* const pcPatternKey,
         iBestX    = x;
         iBestY    = y;
         m_cDistParam.m_maximumDistortionForEarlyExit = uiSad;
+        uiSadBound = std::min( uiSadBound, uiSad );
       }
     }
     piRefY += iRefStride;
@@ -3847,6 +4255,35 @@ Void TEncSearch::xPatternSearch( const TComPattern* const pcPatternKey,
 }
 
 
+/** build the summed-area table of a search window
+ * \param piRef      top-left sample of the window
+ * \param iRefStride stride of the reference picture
+ * \param iWidth     window width, including the block width
+ * \param iHeight    window height, including the block height
+ * Entry (y, x) of the table holds the sum of the samples above and left of (x, y). Block sums are taken as differences
+ * of four entries and wrap around consistently in unsigned arithmetic.
+ */
+Void TEncSearch::xGetSearchWindowSums( const Pel* piRef, const Int iRefStride, const Int iWidth, const Int iHeight )
+{
+  const Int iSumsStride = iWidth + 1;
+  m_searchWindowSums.resize( iSumsStride * ( iHeight + 1 ) );
+
+  UInt* puiSums = &m_searchWindowSums[0];
+  memset( puiSums, 0, sizeof( UInt ) * iSumsStride );
+  for ( Int y = 0; y < iHeight; y++ )
+  {
+    UInt uiRowSum = 0;
+    puiSums += iSumsStride;
+    puiSums[0] = 0;
+    for ( Int x = 0; x < iWidth; x++ )
+    {
+      uiRowSum += piRef[x];
+      puiSums[x + 1] = puiSums[x + 1 - iSumsStride] + uiRowSum;
+    }
+    piRef += iRefStride;
+  }
+}
+
 Void TEncSearch::xPatternSearchFast( const TComDataCU* const  pcCU,
                                      const TComPattern* const pcPatternKey,
                                      const Pel* const         piRefY,
@@ -3855,7 +4292,9 @@ Void TEncSearch::xPatternSearchFast( const TComDataCU* const  pcCU,
                                      const TComMv* const      pcMvSrchRngRB,
                                      TComMv&                  rcMv,
                                      Distortion&              ruiSAD,
-                                     const TComMv* const      pIntegerMv2Nx2NPred )
+                                     const TComMv* const      pIntegerMv2Nx2NPred,
+                                     const TComMv* const      pCachedMv,
+                                     const TComMv* const      pHierarchicalMv )
 {
   assert (MD_LEFT < NUM_MV_PREDICTORS);
   pcCU->getMvPredLeft       ( m_acMvPredictors[MD_LEFT] );
@@ -3867,7 +4306,7 @@ Void TEncSearch::xPatternSearchFast( const TComDataCU* const  pcCU,
   switch ( m_motionEstimationSearchMethod )
   {
     case MESEARCH_DIAMOND:
-      xTZSearch( pcCU, pcPatternKey, piRefY, iRefStride, pcMvSrchRngLT, pcMvSrchRngRB, rcMv, ruiSAD, pIntegerMv2Nx2NPred, false );
+      xTZSearch( pcCU, pcPatternKey, piRefY, iRefStride, pcMvSrchRngLT, pcMvSrchRngRB, rcMv, ruiSAD, pIntegerMv2Nx2NPred, pCachedMv, pHierarchicalMv, false );
       break;
 
     case MESEARCH_SELECTIVE:
@@ -3875,7 +4314,7 @@ Void TEncSearch::xPatternSearchFast( const TComDataCU* const  pcCU,
       break;
 
     case MESEARCH_DIAMOND_ENHANCED:
-      xTZSearch( pcCU, pcPatternKey, piRefY, iRefStride, pcMvSrchRngLT, pcMvSrchRngRB, rcMv, ruiSAD, pIntegerMv2Nx2NPred, true );
+      xTZSearch( pcCU, pcPatternKey, piRefY, iRefStride, pcMvSrchRngLT, pcMvSrchRngRB, rcMv, ruiSAD, pIntegerMv2Nx2NPred, pCachedMv, pHierarchicalMv, true );
       break;
 
     case MESEARCH_FULL: // shouldn't get here.
@@ -3889,11 +4328,13 @@ Void TEncSearch::xTZSearch( const TComDataCU* const pcCU,
                             const TComPattern* const pcPatternKey,
                             const Pel* const         piRefY,
                             const Int                iRefStride,
-                            const TComMv* const      pcMvSrchRngLT,
-                            const TComMv* const      pcMvSrchRngRB,
+                            const TComMv*            pcMvSrchRngLT,
+                            const TComMv*            pcMvSrchRngRB,
                             TComMv&                  rcMv,
                             Distortion&              ruiSAD,
                             const TComMv* const      pIntegerMv2Nx2NPred,
+                            const TComMv* const      pCachedMv,
+                            const TComMv* const      pHierarchicalMv,
                             const Bool               bExtendedSettings)
 {
   const Bool bUseAdaptiveRaster                      = bExtendedSettings;
@@ -3965,6 +4406,39 @@ Void TEncSearch::xTZSearch( const TComDataCU* const pcCU,
     }
   }
 
+  // test the vector found for a block covering the prediction unit earlier in the CTU
+  if (pCachedMv != 0 && (pCachedMv->getHor() != cStruct.iBestX || pCachedMv->getVer() != cStruct.iBestY))
+  {
+    xTZSearchHelp( pcPatternKey, cStruct, pCachedMv->getHor(), pCachedMv->getVer(), 0, 0 );
+  }
+
+  // test the result of the hierarchical search, and centre the search window on it if it is the best start point
+  TComMv cHierarchicalSrchRngLT;
+  TComMv cHierarchicalSrchRngRB;
+  if (pHierarchicalMv != 0)
+  {
+    TComMv hierarchicalMv = *pHierarchicalMv;
+    hierarchicalMv <<= 2;
+    pcCU->clipMv( hierarchicalMv );
+#if ME_ENABLE_ROUNDING_OF_MVS
+    hierarchicalMv.divideByPowerOf2(2);
+#else
+    hierarchicalMv >>= 2;
+#endif
+    if (hierarchicalMv.getHor() != cStruct.iBestX || hierarchicalMv.getVer() != cStruct.iBestY)
+    {
+      xTZSearchHelp( pcPatternKey, cStruct, hierarchicalMv.getHor(), hierarchicalMv.getVer(), 0, 0 );
+      if (hierarchicalMv.getHor() == cStruct.iBestX && hierarchicalMv.getVer() == cStruct.iBestY)
+      {
+        TComMv currBestMv( cStruct.iBestX, cStruct.iBestY );
+        currBestMv <<= 2;
+        xSetSearchRange( pcCU, currBestMv, m_iSearchRange, cHierarchicalSrchRngLT, cHierarchicalSrchRngRB );
+        pcMvSrchRngLT = &cHierarchicalSrchRngLT;
+        pcMvSrchRngRB = &cHierarchicalSrchRngRB;
+      }
+    }
+  }
+
   Int   iSrchRngHorLeft   = pcMvSrchRngLT->getHor();
   Int   iSrchRngHorRight  = pcMvSrchRngRB->getHor();
   Int   iSrchRngVerTop    = pcMvSrchRngLT->getVer();
@@ -4372,6 +4846,7 @@ Void TEncSearch::xPatternSearchFracDIF(
                                        TComPattern* pcPatternKey,
                                        Pel*         piRefY,
                                        Int          iRefStride,
+                                       TComPic*     pcRefPic,
                                        TComMv*      pcMvInt,
                                        TComMv&      rcMvHalf,
                                        TComMv&      rcMvQter,
@@ -4387,22 +4862,46 @@ Void TEncSearch::xPatternSearchFracDIF(
                           iRefStride,
                           pcPatternKey->getBitDepthY());
 
+  // with precomputed sub-sample planes, the interpolated samples are looked up at the same offset in each plane instead
+  TEncPic*    pcRefEPic = m_pcEncCfg->getUseSubPelPlanes() ? dynamic_cast<TEncPic*>( pcRefPic ) : NULL;
+  const Pel*  apiSubPelRef[4][4];
+  if ( pcRefEPic != NULL )
+  {
+    const TComPicYuv* pcRecYuv   = pcRefEPic->getPicYuvRec();
+    const Int         iRefOffset = Int( cPatternRoi.getROIY() - pcRecYuv->getAddr(COMPONENT_Y) );
+    const Int         iRefPosY   = ( iRefOffset + pcRecYuv->getMarginY(COMPONENT_Y) * iRefStride + pcRecYuv->getMarginX(COMPONENT_Y) ) / iRefStride - pcRecYuv->getMarginY(COMPONENT_Y);
+    pcRefEPic->updatePicYuvRecSubPel( iRefPosY - 1, iRefPosY + pcPatternKey->getROIYHeight() );
+    for ( Int iVerFrac = 0; iVerFrac < 4; iVerFrac++ )
+    {
+      for ( Int iHorFrac = 0; iHorFrac < 4; iHorFrac++ )
+      {
+        apiSubPelRef[iVerFrac][iHorFrac] = ( iVerFrac | iHorFrac ) == 0 ? cPatternRoi.getROIY() : pcRefEPic->getPicYuvRecSubPel( iVerFrac, iHorFrac )->getAddr(COMPONENT_Y) + iRefOffset;
+      }
+    }
+  }
+
   //  Half-pel refinement
-  xExtDIFUpSamplingH ( &cPatternRoi );
+  if ( pcRefEPic == NULL )
+  {
+    xExtDIFUpSamplingH ( &cPatternRoi );
+  }
 
   rcMvHalf = *pcMvInt;   rcMvHalf <<= 1;    // for mv-cost
   TComMv baseRefMv(0, 0);
-  ruiCost = xPatternRefinement( pcPatternKey, baseRefMv, 2, rcMvHalf, !bIsLosslessCoded );
+  ruiCost = xPatternRefinement( pcPatternKey, baseRefMv, 2, rcMvHalf, !bIsLosslessCoded, pcRefEPic != NULL ? apiSubPelRef : NULL, iRefStride );
 
   m_pcRdCost->setCostScale( 0 );
 
-  xExtDIFUpSamplingQ ( &cPatternRoi, rcMvHalf );
+  if ( pcRefEPic == NULL )
+  {
+    xExtDIFUpSamplingQ ( &cPatternRoi, rcMvHalf );
+  }
   baseRefMv = rcMvHalf;
   baseRefMv <<= 1;
 
   rcMvQter = *pcMvInt;   rcMvQter <<= 1;    // for mv-cost
   rcMvQter += rcMvHalf;  rcMvQter <<= 1;
-  ruiCost = xPatternRefinement( pcPatternKey, baseRefMv, 1, rcMvQter, !bIsLosslessCoded );
+  ruiCost = xPatternRefinement( pcPatternKey, baseRefMv, 1, rcMvQter, !bIsLosslessCoded, pcRefEPic != NULL ? apiSubPelRef : NULL, iRefStride );
 }
 
 
@@ -4481,7 +4980,34 @@ Void TEncSearch::encodeResAndCalcRdInterCU( TComDataCU* pcCU, TComYuv* pcYuvOrg,
 
   m_pcRDGoOnSbacCoder->load( m_pppcRDSbacCoder[ pcCU->getDepth( 0 ) ][ CI_CURR_BEST ] );
 
-  xEstimateInterResidualQT( pcYuvResi,  nonZeroCost, nonZeroBits, nonZeroDistortion, &zeroDistortion, tuLevel0 DEBUG_STRING_PASS_INTO(sDebug) );
+  // with FastRQTFinalRDOQ, the TU tree is searched with plain quantisation, and only the selected tree is coded again with RDOQ
+  const Bool bFinalRDOQ = m_pcEncCfg->getFastRQTFinalRDOQ() && ( m_pcEncCfg->getUseRDOQ() || m_pcEncCfg->getUseRDOQTS() ) && !pcCU->isLosslessCoded( 0 );
+  if ( bFinalRDOQ )
+  {
+    DEBUG_STRING_NEW(sSearchDebug)
+    m_pcTrQuant->setUseRDOQ( false, false );
+    xEstimateInterResidualQT( pcYuvResi,  nonZeroCost, nonZeroBits, nonZeroDistortion, &zeroDistortion, false, tuLevel0 DEBUG_STRING_PASS_INTO(sSearchDebug) );
+    m_pcTrQuant->setUseRDOQ( m_pcEncCfg->getUseRDOQ(), m_pcEncCfg->getUseRDOQTS() );
+
+    if ( pcCU->getQtRootCbf( 0 ) )
+    {
+      nonZeroCost       = 0;
+      nonZeroBits       = 0;
+      nonZeroDistortion = 0;
+      zeroDistortion    = 0;
+      m_pcRDGoOnSbacCoder->load( m_pppcRDSbacCoder[ pcCU->getDepth( 0 ) ][ CI_CURR_BEST ] );
+      xEstimateInterResidualQT( pcYuvResi,  nonZeroCost, nonZeroBits, nonZeroDistortion, &zeroDistortion, true, tuLevel0 DEBUG_STRING_PASS_INTO(sDebug) );
+    }
+    else
+    {
+      // no coefficients survive plain quantisation, which RDOQ would not change in most cases
+      DEBUG_STRING_SWAP(sDebug, sSearchDebug)
+    }
+  }
+  else
+  {
+    xEstimateInterResidualQT( pcYuvResi,  nonZeroCost, nonZeroBits, nonZeroDistortion, &zeroDistortion, false, tuLevel0 DEBUG_STRING_PASS_INTO(sDebug) );
+  }
 
   // -------------------------------------------------------
   // set the coefficients in the pcCU, and also calculates the residual data.
@@ -4553,11 +5079,69 @@ Void TEncSearch::encodeResAndCalcRdInterCU( TComDataCU* pcCU, TComYuv* pcYuvOrg,
 
 
 
+//! sum of the absolute Walsh-Hadamard coefficients of a square block of up to MAX_TU_SIZE x MAX_TU_SIZE residual samples (unnormalised)
+static Distortion xGetResidualHadamardEnergy( const Pel* piResi, const Int iStride, const Int iSize )
+{
+  Int aiCoeff[MAX_TU_SIZE*MAX_TU_SIZE];
+
+  for( Int y = 0; y < iSize; y++ )
+  {
+    Int* piRow = aiCoeff + y * iSize;
+    for( Int x = 0; x < iSize; x++ )
+    {
+      piRow[x] = piResi[y * iStride + x];
+    }
+    for( Int len = 1; len < iSize; len <<= 1 )
+    {
+      for( Int i = 0; i < iSize; i += 2 * len )
+      {
+        for( Int j = i; j < i + len; j++ )
+        {
+          const Int a = piRow[j];
+          const Int b = piRow[j + len];
+          piRow[j]       = a + b;
+          piRow[j + len] = a - b;
+        }
+      }
+    }
+  }
+
+  for( Int len = 1; len < iSize; len <<= 1 )
+  {
+    for( Int i = 0; i < iSize; i += 2 * len )
+    {
+      for( Int j = i; j < i + len; j++ )
+      {
+        Int* piTop    = aiCoeff + j * iSize;
+        Int* piBottom = aiCoeff + ( j + len ) * iSize;
+        for( Int x = 0; x < iSize; x++ )
+        {
+          const Int a = piTop[x];
+          const Int b = piBottom[x];
+          piTop[x]    = a + b;
+          piBottom[x] = a - b;
+        }
+      }
+    }
+  }
+
+  Distortion uiSum = 0;
+  for( Int i = 0; i < iSize * iSize; i++ )
+  {
+    uiSum += abs( aiCoeff[i] );
+  }
+  return uiSum;
+}
+
+/** Estimate the RD cost of the residual quadtree of an inter CU and select its TU splits, transform skip and cross-component prediction modes.
+ * \param bFixedTree  code the TU tree already stored in the CU (by its transform indices) instead of searching it
+ */
 Void TEncSearch::xEstimateInterResidualQT( TComYuv    *pcResi,
                                            Double     &rdCost,
                                            UInt       &ruiBits,
                                            Distortion &ruiDist,
                                            Distortion *puiZeroDist,
+                                           const Bool  bFixedTree,
                                            TComTU     &rTu
                                            DEBUG_STRING_FN_DECLARE(sDebug) )
 {
@@ -4588,7 +5172,40 @@ Void TEncSearch::xEstimateInterResidualQT( TComYuv    *pcResi,
     bCheckFull =  ( uiLog2TrSize <= pcCU->getSlice()->getSPS()->getQuadtreeTULog2MaxSize() );
   }
 
-  const Bool bCheckSplit  = ( uiLog2TrSize >  pcCU->getQuadtreeTULog2MinSizeInCU(uiAbsPartIdx) );
+  Bool bCheckSplit  = ( uiLog2TrSize >  pcCU->getQuadtreeTULog2MinSizeInCU(uiAbsPartIdx) );
+
+  if ( bFixedTree )
+  {
+    bCheckFull  = pcCU->getTransformIdx( uiAbsPartIdx ) == uiTrMode;
+    bCheckSplit = !bCheckFull;
+  }
+  else if ( bCheckFull && bCheckSplit && m_pcEncCfg->getFastRQTSatd() && !pcCU->isLosslessCoded( 0 ) )
+  {
+    // compare the Hadamard energy of the luma residual in one TU and in its four sub-TUs. The transform of twice the size has
+    // twice the gain, so the sum of the sub-TUs is doubled. Both sizes are tested when the whole TU has slightly more energy,
+    // since it needs less side information.
+    const TComRectangle &lumaRect = rTu.getRect( COMPONENT_Y );
+    const Int  iStride    = pcResi->getStride( COMPONENT_Y );
+    const Pel* piResi     = pcResi->getAddrPix( COMPONENT_Y, lumaRect.x0, lumaRect.y0 );
+    const Int  iSubSize   = lumaRect.width >> 1;
+
+    const Distortion uiFullEnergy = xGetResidualHadamardEnergy( piResi, iStride, lumaRect.width );
+    Distortion uiSplitEnergy = 0;
+    for( Int i = 0; i < 4; i++ )
+    {
+      uiSplitEnergy += xGetResidualHadamardEnergy( piResi + ( i >> 1 ) * iSubSize * iStride + ( i & 1 ) * iSubSize, iStride, iSubSize );
+    }
+    uiSplitEnergy *= 2;
+
+    if ( UInt64( uiFullEnergy ) * 10 <= UInt64( uiSplitEnergy ) * FAST_RQT_SATD_FULL_RATIO )
+    {
+      bCheckSplit = false;
+    }
+    else if ( UInt64( uiFullEnergy ) * 10 > UInt64( uiSplitEnergy ) * FAST_RQT_SATD_SPLIT_RATIO )
+    {
+      bCheckFull = false;
+    }
+  }
 
   assert( bCheckFull || bCheckSplit );
 
@@ -4707,7 +5324,7 @@ Void TEncSearch::xEstimateInterResidualQT( TComYuv    *pcResi,
               pcCU->setTransformSkipPartRange(transformSkipModeId, compID, subTUAbsPartIdx, partIdxesPerSubTU);
               pcCU->setCrossComponentPredictionAlphaPartRange((bUseCrossCPrediction ? preCalcAlpha : 0), compID, subTUAbsPartIdx, partIdxesPerSubTU );
 
-              if ((compID != COMPONENT_Cr) && ((transformSkipModeId == 1) ? m_pcEncCfg->getUseRDOQTS() : m_pcEncCfg->getUseRDOQ()))
+              if ((compID != COMPONENT_Cr) && m_pcTrQuant->getUseRDOQ(transformSkipModeId == 1))
               {
                 COEFF_SCAN_TYPE scanType = COEFF_SCAN_TYPE(pcCU->getCoefScanIdx(uiAbsPartIdx, tuCompRect.width, tuCompRect.height, compID));
                 m_pcEntropyCoder->estimateBit(m_pcTrQuant->m_pcEstBitsSbac, tuCompRect.width, tuCompRect.height, toChannelType(compID), scanType);
@@ -5014,6 +5631,17 @@ Void TEncSearch::xEstimateInterResidualQT( TComYuv    *pcResi,
     uiSingleBits = m_pcEntropyCoder->getNumberOfWrittenBits();
 
     dSingleCost = m_pcRdCost->calcRdCost( uiSingleBits, uiSingleDist );
+
+    if ( bCheckSplit && m_pcEncCfg->getFastRQTZeroCbf() )
+    {
+      // the residual of the whole TU quantises to zero, so the sub-TUs are not expected to code it better
+      Bool bAllZero = true;
+      for(UInt ch = 0; ch < numValidComp; ch++)
+      {
+        bAllZero = bAllZero && uiAbsSum[ch][0] == 0 && uiAbsSum[ch][1] == 0;
+      }
+      bCheckSplit = !bAllZero;
+    }
   } // check full
 
   // code sub-blocks
@@ -5062,7 +5690,7 @@ Void TEncSearch::xEstimateInterResidualQT( TComYuv    *pcResi,
     do
     {
       DEBUG_STRING_NEW(childString)
-      xEstimateInterResidualQT( pcResi, dSubdivCost, uiSubdivBits, uiSubdivDist, bCheckFull ? NULL : puiZeroDist,  tuRecurseChild DEBUG_STRING_PASS_INTO(childString));
+      xEstimateInterResidualQT( pcResi, dSubdivCost, uiSubdivBits, uiSubdivDist, bCheckFull ? NULL : puiZeroDist, bFixedTree, tuRecurseChild DEBUG_STRING_PASS_INTO(childString));
 #if DEBUG_STRING
       // split the string by component and append to the relevant output (because decoder decodes in channel order, whereas this search searches by TU-order)
       std::size_t lastPos=0;
@@ -5408,6 +6036,191 @@ UInt TEncSearch::xUpdateCandList( UInt uiMode, Double uiCost, UInt uiFastCandNum
 }
 
 
+/** Sobel gradients of the samples [1, width-1) of one block row; gradX[x-1] and gradY[x-1] are centred on piRow[x].
+ */
+static Void xGetSobelGradientsRow( const Pel* piRow, const Int iStride, const Int iWidth, Int* piGradX, Int* piGradY )
+{
+  const Pel* piAbove = piRow - iStride;
+  const Pel* piBelow = piRow + iStride;
+  for( Int x = 1; x < iWidth - 1; x++ )
+  {
+    piGradX[x-1] = ( piAbove[x+1] + 2 * piRow[x+1] + piBelow[x+1] ) - ( piAbove[x-1] + 2 * piRow[x-1] + piBelow[x-1] );
+    piGradY[x-1] = ( piBelow[x-1] + 2 * piBelow[x] + piBelow[x+1] ) - ( piAbove[x-1] + 2 * piAbove[x] + piAbove[x+1] );
+  }
+}
+
+#if VECTOR_CODING__INTRA_GRADIENT_ANALYSIS && (RExt__HIGH_BIT_DEPTH_SUPPORT==0)
+/** SSE2 version of xGetSobelGradientsRow, eight samples at a time. The responses are formed in 16 bits, which
+ *  holds them for bit depths up to 12.
+ */
+static Void simdGetSobelGradientsRow( const Pel* piRow, const Int iStride, const Int iWidth, Int* piGradX, Int* piGradY )
+{
+  const Pel* piAbove = piRow - iStride;
+  const Pel* piBelow = piRow + iStride;
+  Int x = 1;
+  for( ; x + 8 <= iWidth - 1; x += 8 )
+  {
+    const __m128i mmAboveL = _mm_loadu_si128( ( const __m128i * )( piAbove + x - 1 ) );
+    const __m128i mmAboveC = _mm_loadu_si128( ( const __m128i * )( piAbove + x     ) );
+    const __m128i mmAboveR = _mm_loadu_si128( ( const __m128i * )( piAbove + x + 1 ) );
+    const __m128i mmRowL   = _mm_loadu_si128( ( const __m128i * )( piRow   + x - 1 ) );
+    const __m128i mmRowR   = _mm_loadu_si128( ( const __m128i * )( piRow   + x + 1 ) );
+    const __m128i mmBelowL = _mm_loadu_si128( ( const __m128i * )( piBelow + x - 1 ) );
+    const __m128i mmBelowC = _mm_loadu_si128( ( const __m128i * )( piBelow + x     ) );
+    const __m128i mmBelowR = _mm_loadu_si128( ( const __m128i * )( piBelow + x + 1 ) );
+
+    const __m128i mmRight  = _mm_add_epi16( _mm_add_epi16( mmAboveR, mmBelowR ), _mm_slli_epi16( mmRowR, 1 ) );
+    const __m128i mmLeft   = _mm_add_epi16( _mm_add_epi16( mmAboveL, mmBelowL ), _mm_slli_epi16( mmRowL, 1 ) );
+    const __m128i mmBottom = _mm_add_epi16( _mm_add_epi16( mmBelowL, mmBelowR ), _mm_slli_epi16( mmBelowC, 1 ) );
+    const __m128i mmTop    = _mm_add_epi16( _mm_add_epi16( mmAboveL, mmAboveR ), _mm_slli_epi16( mmAboveC, 1 ) );
+    const __m128i mmGradX  = _mm_sub_epi16( mmRight, mmLeft );
+    const __m128i mmGradY  = _mm_sub_epi16( mmBottom, mmTop );
+
+    // sign-extend to 32 bits
+    _mm_storeu_si128( ( __m128i * )( piGradX + x - 1 ), _mm_srai_epi32( _mm_unpacklo_epi16( mmGradX, mmGradX ), 16 ) );
+    _mm_storeu_si128( ( __m128i * )( piGradX + x + 3 ), _mm_srai_epi32( _mm_unpackhi_epi16( mmGradX, mmGradX ), 16 ) );
+    _mm_storeu_si128( ( __m128i * )( piGradY + x - 1 ), _mm_srai_epi32( _mm_unpacklo_epi16( mmGradY, mmGradY ), 16 ) );
+    _mm_storeu_si128( ( __m128i * )( piGradY + x + 3 ), _mm_srai_epi32( _mm_unpackhi_epi16( mmGradY, mmGradY ), 16 ) );
+  }
+  if( x < iWidth - 1 )
+  {
+    xGetSobelGradientsRow( piRow + x - 1, iStride, iWidth - x + 1, piGradX + x - 1, piGradY + x - 1 );
+  }
+}
+#endif
+
+/// gradient analysis kernels of the selected instruction set level (see TComSimd); the vector kernel is exact up to 12 bits
+struct GradientKernels
+{
+  Void (*getSobelGradientsRow)( const Pel* piRow, const Int iStride, const Int iWidth, Int* piGradX, Int* piGradY );
+};
+
+static GradientKernels gradientKernels;
+
+static Void initGradientKernels( const SIMDLevel level )
+{
+  gradientKernels.getSobelGradientsRow = xGetSobelGradientsRow;
+#if VECTOR_CODING__INTRA_GRADIENT_ANALYSIS && (RExt__HIGH_BIT_DEPTH_SUPPORT==0)
+  if( level >= SIMD_SSE2 )
+  {
+    gradientKernels.getSobelGradientsRow = simdGetSobelGradientsRow;
+  }
+#endif
+}
+
+static const Bool gradientKernelsRegistered = TComSimd::registerKernels( initGradientKernels );
+
+//! twice the mid-points between consecutive intra angle magnitudes {0, 2, 5, 9, 13, 17, 21, 26, 32}
+static const Int s_aiIntraAngleThresholds[8] = { 2, 7, 14, 22, 30, 38, 47, 58 };
+
+/** Angular intra mode whose direction is closest to the edge orientation of a Sobel gradient.
+ *  An edge with gradient (gx, gy) is followed by the vertical mode with angle 32*gy/gx, or by the
+ *  horizontal mode with angle 32*gx/gy, whichever family has the smaller angle magnitude.
+ */
+static inline Int xGetGradientIntraMode( const Int iGradX, const Int iGradY )
+{
+  const Int iAbsX  = abs( iGradX );
+  const Int iAbsY  = abs( iGradY );
+  const Int iMajor = std::max( iAbsX, iAbsY );
+  const Int iMinor = 64 * std::min( iAbsX, iAbsY );
+  Int iStep = 0;
+  while( iStep < 8 && iMinor > s_aiIntraAngleThresholds[iStep] * iMajor )
+  {
+    iStep++;
+  }
+  const Bool bPositive = ( iGradX < 0 ) == ( iGradY < 0 );
+  if( iAbsX >= iAbsY )
+  {
+    return bPositive ? VER_IDX + iStep : VER_IDX - iStep;
+  }
+  return bPositive ? HOR_IDX - iStep : HOR_IDX + iStep;
+}
+
+/** Select the modes tested by the rough intra search from an orientation histogram of the source block.
+ *  Each interior sample adds the magnitude |gx|+|gy| of its Sobel gradient to the bin of the closest angular mode.
+ *  The IntraGradientModes strongest bins are selected with the two modes on either side of each, together with
+ *  planar, DC and the most probable modes.
+ * \param pcCU           coding unit
+ * \param uiPartOffset   partition offset of the prediction unit
+ * \param piOrg          source samples of the prediction unit
+ * \param uiStride       stride of piOrg
+ * \param rect           luma rectangle of the prediction unit
+ * \param bitDepth       luma bit depth
+ * \param pbModeSelected set to true for each selected mode (NUM_INTRA_MODE entries)
+ * \returns the number of selected modes
+ */
+Int TEncSearch::xSelectIntraModesByGradient( TComDataCU* pcCU, UInt uiPartOffset, const Pel* piOrg, UInt uiStride, const TComRectangle &rect, const Int bitDepth, Bool* pbModeSelected )
+{
+  UInt auiHistogram[NUM_INTRA_MODE] = { 0 };
+  Int  aiGradX[MAX_CU_SIZE];
+  Int  aiGradY[MAX_CU_SIZE];
+  const Int iWidth  = rect.width;
+  const Int iHeight = rect.height;
+
+  for( Int y = 1; y < iHeight - 1; y++ )
+  {
+    const Pel* piRow = piOrg + y * uiStride;
+    if( bitDepth <= 12 )
+    {
+      gradientKernels.getSobelGradientsRow( piRow, uiStride, iWidth, aiGradX, aiGradY );
+    }
+    else
+    {
+      xGetSobelGradientsRow( piRow, uiStride, iWidth, aiGradX, aiGradY );
+    }
+    for( Int x = 0; x < iWidth - 2; x++ )
+    {
+      if( aiGradX[x] != 0 || aiGradY[x] != 0 )
+      {
+        auiHistogram[xGetGradientIntraMode( aiGradX[x], aiGradY[x] )] += abs( aiGradX[x] ) + abs( aiGradY[x] );
+      }
+    }
+  }
+
+  for( Int iMode = 0; iMode < NUM_INTRA_MODE; iMode++ )
+  {
+    pbModeSelected[iMode] = false;
+  }
+  pbModeSelected[PLANAR_IDX] = true;
+  pbModeSelected[DC_IDX]     = true;
+
+  for( Int iDirection = 0; iDirection < m_pcEncCfg->getIntraGradientModes(); iDirection++ )
+  {
+    Int iBestMode = -1;
+    for( Int iMode = DC_IDX + 1; iMode < NUM_INTRA_MODE - 1; iMode++ )
+    {
+      if( auiHistogram[iMode] > 0 && ( iBestMode < 0 || auiHistogram[iMode] > auiHistogram[iBestMode] ) )
+      {
+        iBestMode = iMode;
+      }
+    }
+    if( iBestMode < 0 )
+    {
+      break;
+    }
+    auiHistogram[iBestMode] = 0;
+    for( Int iMode = std::max( iBestMode - 2, DC_IDX + 1 ); iMode <= std::min( iBestMode + 2, NUM_INTRA_MODE - 2 ); iMode++ )
+    {
+      pbModeSelected[iMode] = true;
+    }
+  }
+
+  Int aiPreds[NUM_MOST_PROBABLE_MODES] = { -1, -1, -1 };
+  pcCU->getIntraDirPredictor( uiPartOffset, aiPreds, COMPONENT_Y );
+  for( Int i = 0; i < NUM_MOST_PROBABLE_MODES; i++ )
+  {
+    pbModeSelected[aiPreds[i]] = true;
+  }
+
+  Int iNumSelected = 0;
+  for( Int iMode = 0; iMode < NUM_INTRA_MODE - 1; iMode++ )
+  {
+    iNumSelected += pbModeSelected[iMode] ? 1 : 0;
+  }
+  return iNumSelected;
+}
+
+
 
 
 
@@ -49,6 +49,7 @@
 #include "TEncEntropy.h"
 #include "TEncSbac.h"
 #include "TEncCfg.h"
+#include <vector>
 
 
 //! \ingroup TLibEncoder
@@ -117,6 +118,14 @@ protected:
 
   TComMv          m_integerMv2Nx2N[NUM_REF_PIC_LIST_01][MAX_NUM_REF];
 
+  // motion vector cache of the current CTU: for each reference and minimum partition in raster order, the integer motion
+  // search result of the last prediction unit covering the partition
+  TComMv          m_cacheMv  [NUM_REF_PIC_LIST_01][MAX_NUM_REF][MAX_NUM_PART_IDXS_IN_CTU_WIDTH*MAX_NUM_PART_IDXS_IN_CTU_WIDTH];
+  Distortion      m_cacheSad [NUM_REF_PIC_LIST_01][MAX_NUM_REF][MAX_NUM_PART_IDXS_IN_CTU_WIDTH*MAX_NUM_PART_IDXS_IN_CTU_WIDTH]; ///< SAD of the prediction unit at the cached vector
+  UInt            m_cacheArea[NUM_REF_PIC_LIST_01][MAX_NUM_REF][MAX_NUM_PART_IDXS_IN_CTU_WIDTH*MAX_NUM_PART_IDXS_IN_CTU_WIDTH]; ///< luma area of the prediction unit; 0 for an empty entry
+  Pel             m_hierarchicalOrg[HIERARCHICAL_ME_NUM_LEVELS][(MAX_CU_SIZE>>1)*(MAX_CU_SIZE>>1)]; ///< downsampled original block of the hierarchical motion search
+  std::vector<UInt> m_searchWindowSums; ///< summed-area table of the full search window, used for successive elimination
+
   Bool            m_isInitialized;
 public:
   TEncSearch();
@@ -137,12 +146,15 @@ public:
 
   Void destroy();
 
+  Void resetMvCache();
+
 protected:
 
   /// sub-function for motion vector refinement used in fractional-pel accuracy
   Distortion  xPatternRefinement( TComPattern* pcPatternKey,
                                   TComMv baseRefMv,
-                                  Int iFrac, TComMv& rcMvFrac, Bool bAllowUseOfHadamard
+                                  Int iFrac, TComMv& rcMvFrac, Bool bAllowUseOfHadamard,
+                                  const Pel* const apiSubPelRef[4][4], Int iSubPelStride
                                  );
 
   typedef struct
@@ -369,15 +381,50 @@ protected:
                                     Distortion&  ruiCost,
                                     Bool         bBi = false  );
 
+  Bool xHierarchicalSearch        ( const TComDataCU* const  pcCU,
+                                    const TComPattern* const pcPatternKey,
+                                    TComPic*                 pcRefPic,
+                                    const UInt               uiPartAddr,
+                                    const TComMv&            rcMvPred,
+                                    TComMv&                  rcMv );
+
+  Bool xGetCachedMv               ( const TComDataCU* const  pcCU,
+                                    const UInt               uiPartAddr,
+                                    const Int                iWidth,
+                                    const Int                iHeight,
+                                    const RefPicList         eRefPicList,
+                                    const Int                iRefIdx,
+                                    TComMv&                  rcMv,
+                                    Distortion&              ruiSAD,
+                                    UInt&                    ruiArea ) const;
+
+  Void xSetCachedMv               ( const TComDataCU* const  pcCU,
+                                    const UInt               uiPartAddr,
+                                    const Int                iWidth,
+                                    const Int                iHeight,
+                                    const RefPicList         eRefPicList,
+                                    const Int                iRefIdx,
+                                    const TComMv&            rcMv,
+                                    const Distortion         uiSAD );
+
+  Bool xHashSearch                ( const TComDataCU* const  pcCU,
+                                    const TComPattern* const pcPatternKey,
+                                    TComPic*                 pcRefPic,
+                                    const UInt               uiPartAddr,
+                                    TComMv&                  rcMv,
+                                    Distortion&              ruiCost );
+
   Void xTZSearch                  ( const TComDataCU* const  pcCU,
                                     const TComPattern* const pcPatternKey,
                                     const Pel* const         piRefY,
                                     const Int                iRefStride,
-                                    const TComMv* const      pcMvSrchRngLT,
-                                    const TComMv* const      pcMvSrchRngRB,
+                                    const TComMv*            pcMvSrchRngLT,
+                                    const TComMv*            pcMvSrchRngRB,
                                     TComMv&                  rcMv,
                                     Distortion&              ruiSAD,
                                     const TComMv* const      pIntegerMv2Nx2NPred,
+                                    const TComMv* const      pCachedMv,
+                                    const TComMv* const      pHierarchicalMv,
                                     const Bool               bExtendedSettings
                                     );
 
@@ -406,7 +453,9 @@ protected:
                                     const TComMv* const      pcMvSrchRngRB,
                                     TComMv&                  rcMv,
                                     Distortion&              ruiSAD,
-                                    const TComMv* const      pIntegerMv2Nx2NPred
+                                    const TComMv* const      pIntegerMv2Nx2NPred,
+                                    const TComMv* const      pCachedMv,
+                                    const TComMv* const      pHierarchicalMv
                                   );
 
   Void xPatternSearch             ( const TComPattern* const pcPatternKey,
@@ -417,11 +466,14 @@ protected:
                                     TComMv&      rcMv,
                                     Distortion&  ruiSAD );
 
+  Void xGetSearchWindowSums       ( const Pel* piRef, const Int iRefStride, const Int iWidth, const Int iHeight );
+
   Void xPatternSearchFracDIF      (
                                     Bool         bIsLosslessCoded,
                                     TComPattern* pcPatternKey,
                                     Pel*         piRefY,
                                     Int          iRefStride,
+                                    TComPic*     pcRefPic,
                                     TComMv*      pcMvInt,
                                     TComMv&      rcMvHalf,
                                     TComMv&      rcMvQter,
@@ -437,11 +489,12 @@ protected:
 
 
   Void xEncodeInterResidualQT( const ComponentID compID, TComTU &rTu );
-  Void xEstimateInterResidualQT( TComYuv* pcResi, Double &rdCost, UInt &ruiBits, Distortion &ruiDist, Distortion *puiZeroDist, TComTU &rTu DEBUG_STRING_FN_DECLARE(sDebug) );
+  Void xEstimateInterResidualQT( TComYuv* pcResi, Double &rdCost, UInt &ruiBits, Distortion &ruiDist, Distortion *puiZeroDist, const Bool bFixedTree, TComTU &rTu DEBUG_STRING_FN_DECLARE(sDebug) );
   Void xSetInterResidualQTData( TComYuv* pcResi, Bool bSpatial, TComTU &rTu  );
 
   UInt  xModeBitsIntra ( TComDataCU* pcCU, UInt uiMode, UInt uiPartOffset, UInt uiDepth, const ChannelType compID );
   UInt  xUpdateCandList( UInt uiMode, Double uiCost, UInt uiFastCandNum, UInt * CandModeList, Double * CandCostList );
+  Int   xSelectIntraModesByGradient( TComDataCU* pcCU, UInt uiPartOffset, const Pel* piOrg, UInt uiStride, const TComRectangle &rect, const Int bitDepth, Bool* pbModeSelected );
 
   // -------------------------------------------------------------------------------------------------------------------
   // compute symbol bits
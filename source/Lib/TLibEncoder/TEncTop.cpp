@@ -146,6 +146,11 @@ Void TEncTop::create ()
 
 Void TEncTop::destroy ()
 {
+  if ( getCuSplitPredictorMode() == CU_SPLIT_PREDICTOR_TRAIN )
+  {
+    m_cCuEncoder.finishSplitPredictorTraining();
+  }
+
   // destroy processing unit classes
   m_cGOPEncoder.        destroy();
   m_cSliceEncoder.      destroy();
@@ -220,6 +225,7 @@ Void TEncTop::init(Bool isFieldCoding)
                    m_useRDOQ,
                    m_useRDOQTS,
                    m_useSelectiveRDOQ,
+                   m_useFastRDOQ,
                    true
                   ,m_useTransformSkipFast
 #if ADAPTIVE_QP_SELECTION
@@ -347,6 +353,10 @@ Void TEncTop::encode( Bool flush, TComPicYuv* pcPicYuvOrg, TComPicYuv* pcPicYuvT
     {
       m_cPreanalyzer.xPreanalyze( dynamic_cast<TEncPic*>( pcPicCurr ) );
     }
+    if ( getLookaheadAnalysis() )
+    {
+      m_cPreanalyzer.xPreanalyzeLookahead( dynamic_cast<TEncPic*>( pcPicCurr ), getLookaheadDownsampleLog2() );
+    }
   }
 
   if ((m_iNumPicRcvd == 0) || (!flush && (m_iPOCLast != 0) && (m_iNumPicRcvd != m_iGOPSize) && (m_iGOPSize != 0)))
@@ -460,6 +470,10 @@ Void TEncTop::encode(Bool flush, TComPicYuv* pcPicYuvOrg, TComPicYuv* pcPicYuvTr
       {
         m_cPreanalyzer.xPreanalyze( dynamic_cast<TEncPic*>( pcField ) );
       }
+      if ( getLookaheadAnalysis() )
+      {
+        m_cPreanalyzer.xPreanalyzeLookahead( dynamic_cast<TEncPic*>( pcField ), getLookaheadDownsampleLog2() );
+      }
     }
 
     if ( m_iNumPicRcvd && ((flush&&fieldNum==1) || (m_iPOCLast/2)==0 || m_iNumPicRcvd==m_iGOPSize ) )
@@ -535,13 +549,14 @@ Void TEncTop::xGetNewPicBuffer ( TComPic*& rpcPic, Int ppsId )
 
   if (rpcPic==0)
   {
-    if ( getUseAdaptiveQP() )
+    if ( getUseAdaptiveQP() || getLookaheadAnalysis() || getUseHierarchicalME() || getUseHashME() || getUseSubPelPlanes() )
     {
       TEncPic* pcEPic = new TEncPic;
+      const UInt uiMaxAQDepth = getUseAdaptiveQP() ? pps.getMaxCuDQPDepth()+1 : 0;
 #if REDUCED_ENCODER_MEMORY
-      pcEPic->create( sps, pps, pps.getMaxCuDQPDepth()+1);
+      pcEPic->create( sps, pps, uiMaxAQDepth );
 #else
-      pcEPic->create( sps, pps, pps.getMaxCuDQPDepth()+1, false);
+      pcEPic->create( sps, pps, uiMaxAQDepth, false );
 #endif
       rpcPic = pcEPic;
     }
@@ -558,6 +573,18 @@ Void TEncTop::xGetNewPicBuffer ( TComPic*& rpcPic, Int ppsId )
     m_cListPic.pushBack( rpcPic );
   }
   rpcPic->setReconMark (false);
+  if ( getUseHierarchicalME() )
+  {
+    dynamic_cast<TEncPic*>( rpcPic )->invalidatePicYuvRecDown();
+  }
+  if ( getUseHashME() )
+  {
+    dynamic_cast<TEncPic*>( rpcPic )->invalidateBlockHashes();
+  }
+  if ( getUseSubPelPlanes() )
+  {
+    dynamic_cast<TEncPic*>( rpcPic )->invalidatePicYuvRecSubPel();
+  }
 
   m_iPOCLast++;
   m_iNumPicRcvd++;